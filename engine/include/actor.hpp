@@ -3,14 +3,28 @@
 
 #include <string>
 #include <memory>
-#include <unordered_map>
+#include <vector>
+
+#include <SDL3/SDL.h>
 
 #include "component.hpp"
+#include "pool_allocator.hpp"
+#include "type_id.hpp"
 
 namespace lum
 {
+    // Owns its components in the order they were added, each allocated from the
+    // pool of its type. Update and Draw walk them in that order so a component
+    // always sees the ones added before it already updated this frame.
+    // Components are looked up by type, one per type, names are only kept on
+    // the component for debugging. Snapshots save every component's state in
+    // the same order.
     class Actor
     {
+    public:
+        static constexpr uint8_t NO_SLOT = 0xFF;
+        static constexpr size_t MAX_COMPONENTS = NO_SLOT;
+
     public:
         const char *tag{};
 
@@ -18,38 +32,80 @@ namespace lum
         Actor();
         virtual ~Actor();
 
-        Actor(Actor &&other) noexcept : tag(other.tag), m_components(std::move(other.m_components))
-        {
-        }
+        Actor(Actor &&other) noexcept = default;
 
         void SetTag(const char *p_tag);
         void Update(float p_delta);
         void Draw();
 
+        // Fails if the actor doesn't have as many components as when it was saved
+        void SaveState(SnapshotWriter &p_writer) const;
+        bool LoadState(SnapshotReader &p_reader);
+
+        // Null if the actor already has a component of type T. Two components of
+        // the same type, told apart by name, aren't supported anymore, derive a
+        // type for each instead.
         template<typename T, typename... Args>
-        T *AddComponent(const std::string &p_name, Args... p_args)
+        T *AddComponent(const std::string &p_name, Args&&... p_args)
         {
             static_assert(std::is_base_of<lum::Component, T>::value, "T must derive from lum::Component");
 
-            auto comp = std::make_unique<T>(p_name, std::forward<Args>(p_args)...);
+            const uint32_t typeId = TypeId<T>();
+            if (typeId < m_typeToSlot.size() && m_typeToSlot[typeId] != NO_SLOT)
+            {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Actor: %s already has a component of the type of %s", tag ? tag : "<untagged>", p_name.c_str());
+                return nullptr;
+            }
+
+            if (m_components.size() >= MAX_COMPONENTS)
+            {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Actor: Can't add more than %zu components", MAX_COMPONENTS);
+                return nullptr;
+            }
+
+            PoolPtr<T> comp = MakePooled<T>(p_name, std::forward<Args>(p_args)...);
+            if (!comp)
+                return nullptr;
+
             T *rawPtr = comp.get();
 
-            m_components.emplace(p_name, std::move(comp));
+            if (typeId >= m_typeToSlot.size())
+                m_typeToSlot.resize(typeId + 1, NO_SLOT);
+
+            m_typeToSlot[typeId] = static_cast<uint8_t>(m_components.size());
+            m_components.push_back(std::move(comp));
 
             return rawPtr;
         }
 
         template<typename T>
-        T *GetComponent(const std::string &p_name)
+        T *GetComponent()
         {
             static_assert(std::is_base_of<lum::Component, T>::value, "T must derive from lum::Component");
 
-            auto it = m_components.find(p_name);
-            return (it != m_components.end()) ? static_cast<T *>(it->second.get()) : nullptr;
+            const uint32_t typeId = TypeId<T>();
+            if (typeId >= m_typeToSlot.size() || m_typeToSlot[typeId] == NO_SLOT)
+                return nullptr;
+
+            return static_cast<T *>(m_components[m_typeToSlot[typeId]].get());
+        }
+
+        template<typename T>
+        bool HasComponent() const
+        {
+            const uint32_t typeId = TypeId<T>();
+            return typeId < m_typeToSlot.size() && m_typeToSlot[typeId] != NO_SLOT;
         }
 
+        // Linear search by name, for debugging and tools only
+        Component *FindComponent(const std::string &p_name);
+
+        size_t GetComponentCount() const;
+        Component *GetComponentAt(size_t p_index);
+
     private:
-        std::unordered_map<std::string, std::unique_ptr<Component>> m_components{};
+        std::vector<PoolPtr<Component>> m_components{};
+        std::vector<uint8_t> m_typeToSlot{};
 
     private:
         //Actor(const Actor &) = delete;
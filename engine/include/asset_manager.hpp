@@ -2,12 +2,19 @@
 #define ASSET_MANAGER_H
 
 #include <string>
+#include <vector>
+#include <utility>
 #include <unordered_map>
 
+#include "string_id.hpp"
 #include "asset_types.hpp"
+#include "shader_compiler.hpp"
 
 namespace lum
 {
+    template<typename T>
+    class AssetHandle;
+
     class AssetManager
     {
     public:
@@ -17,23 +24,144 @@ namespace lum
         bool Init();
         void Shutdown();
 
-        Shader *GetShader(const char *p_tag);
-        Texture *GetTexture(const char *p_tag);
-        Sound *GetSound(const char *p_tag);
+        Shader *GetShader(StringId p_tag);
+        Texture *GetTexture(StringId p_tag);
+        Sound *GetSound(StringId p_tag);
+        Music *GetMusic(StringId p_tag);
         bool LoadShader(const char *p_tag, const char *p_path, bool p_reload = false);
         bool LoadTexture(const char *p_tag, const char *p_path, bool p_reload = false);
         bool LoadSound(const char *p_tag, const char *p_path);
+        bool LoadMusic(const char *p_tag, const char *p_path);
         void CheckForModifiedAssets();
+        const std::vector<ShaderCompileError> &GetShaderCompileErrors() const;
+
+        // Lifetimes
+        //
+        // Assets stay resident while referenced. Once the last reference goes
+        // away they are kept as a cache and evicted least recently used first
+        // when the CPU or GPU budget is exceeded.
+
+        AssetHandle<Shader> AcquireShader(StringId p_tag);
+        AssetHandle<Texture> AcquireTexture(StringId p_tag);
+        AssetHandle<Sound> AcquireSound(StringId p_tag);
+        AssetHandle<Music> AcquireMusic(StringId p_tag);
+        bool IsResident(AssetType p_type, StringId p_tag) const;
+        void AddRef(AssetType p_type, StringId p_tag);
+        void Release(AssetType p_type, StringId p_tag);
+        void SetMemoryBudgets(uint64_t p_cpuBytes, uint64_t p_gpuBytes);
+        void EvictUnused();
+        AssetMemoryStats GetMemoryStats() const;
 
     private:
         std::string m_assetsDirectoryPath{};
-        std::unordered_map<uint32_t, Shader> m_shaderStorage{};
-        std::unordered_map<uint32_t, Texture> m_textureStorage{};
-        std::unordered_map<uint32_t, Sound> m_soundStorage{};
+        std::unordered_map<StringId, Shader> m_shaderStorage{};
+        std::unordered_map<StringId, Texture> m_textureStorage{};
+        std::unordered_map<StringId, Sound> m_soundStorage{};
+        std::unordered_map<StringId, Music> m_musicStorage{};
+
+        ShaderCompiler m_shaderCompiler{};
+        std::vector<SDL_GPUShader *> m_retiredShaders{};
+
+        // Every shader a queued compile builds with, held until the compiler
+        // goes idle so eviction can't release one under it
+        std::vector<AssetHandle<Shader>> m_compilingShaders{};
+        std::vector<ShaderCompileError> m_shaderCompileErrors{};
+
+        uint64_t m_frameIndex{};
+        uint64_t m_cpuBudget{ 256ull * 1024 * 1024 };
+        uint64_t m_gpuBudget{ 512ull * 1024 * 1024 };
 
     private:
-        bool CompileShader(const char *p_path);
+        void SubmitShaderCompile(Shader &p_shader, SDL_Time p_modifyTime);
+        void ApplyShaderCompileResults();
+        bool LoadTexture(StringId p_tag, const char *p_path, bool p_reload);
         bool LoadOGG(const char *p_path, SDL_AudioSpec *p_spec, std::vector<uint8_t> &p_outBuffer);
+        bool EvictLeastRecentlyUsed(bool p_gpu);
+        void UnloadAsset(AssetType p_type, StringId p_tag);
+    };
+
+    // Keeps one reference to an asset alive for as long as the handle lives
+    template<typename T>
+    class AssetHandle
+    {
+    public:
+        AssetHandle() = default;
+
+        AssetHandle(AssetManager *p_manager, AssetType p_type, StringId p_tag, T *p_asset)
+            : m_manager(p_manager), m_type(p_type), m_tag(p_tag), m_asset(p_asset)
+        {
+            if (m_asset)
+                m_manager->AddRef(m_type, m_tag);
+        }
+
+        AssetHandle(const AssetHandle &p_other) : AssetHandle(p_other.m_manager, p_other.m_type, p_other.m_tag, p_other.m_asset)
+        {
+        }
+
+        AssetHandle(AssetHandle &&p_other) noexcept
+            : m_manager(p_other.m_manager), m_type(p_other.m_type), m_tag(p_other.m_tag), m_asset(p_other.m_asset)
+        {
+            p_other.m_asset = nullptr;
+        }
+
+        AssetHandle &operator=(AssetHandle p_other) noexcept
+        {
+            std::swap(m_manager, p_other.m_manager);
+            std::swap(m_type, p_other.m_type);
+            std::swap(m_tag, p_other.m_tag);
+            std::swap(m_asset, p_other.m_asset);
+            return *this;
+        }
+
+        ~AssetHandle()
+        {
+            Reset();
+        }
+
+        void Reset()
+        {
+            if (m_asset)
+                m_manager->Release(m_type, m_tag);
+
+            m_asset = nullptr;
+        }
+
+        T *Get() const { return m_asset; }
+        T *operator->() const { return m_asset; }
+        explicit operator bool() const { return m_asset != nullptr; }
+
+    private:
+        AssetManager *m_manager{};
+        AssetType m_type{};
+        StringId m_tag{};
+        T *m_asset{};
+    };
+
+    // Set of assets owned by a scene. Loads what isn't resident yet and holds a
+    // reference to everything it was asked for until released.
+    class AssetScope
+    {
+    public:
+        explicit AssetScope(AssetManager &p_assetManager);
+        ~AssetScope();
+
+        bool LoadTexture(const char *p_tag, const char *p_path);
+        bool LoadSound(const char *p_tag, const char *p_path);
+        bool LoadMusic(const char *p_tag, const char *p_path);
+        bool Load(const AssetManifestEntry &p_entry);
+        bool Holds(AssetType p_type, StringId p_tag) const;
+        size_t GetCount() const;
+        void ReleaseAll();
+
+    private:
+        AssetManager &m_assetManager;
+        std::vector<std::pair<AssetType, StringId>> m_assets{};
+
+    private:
+        bool Hold(AssetType p_type, StringId p_tag);
+
+        AssetScope(const AssetScope &) = delete;
+        AssetScope &operator=(const AssetScope &) = delete;
     };
 }
 
@@ -1,13 +1,40 @@
 #ifndef ASSET_TYPES_H
 #define ASSET_TYPES_H
 
+#include <string>
+#include <vector>
+
 #include <glm/glm.hpp>
 #include <SDL3/SDL.h>
 
+#include "string_id.hpp"
+
 using namespace glm;
 
 namespace lum
 {
+    enum class AssetType
+    {
+        SHADER,
+        TEXTURE,
+        SOUND,
+        MUSIC,
+        COUNT
+    };
+
+    // Resident memory per asset type. Textures and shaders live in GPU memory,
+    // sounds and music in CPU memory.
+    struct AssetMemoryStats
+    {
+        uint64_t residentBytes[static_cast<size_t>(AssetType::COUNT)]{};
+        uint32_t residentCount[static_cast<size_t>(AssetType::COUNT)]{};
+        uint32_t cachedCount[static_cast<size_t>(AssetType::COUNT)]{}; // Zero references, evictable
+        uint64_t cpuBytes{};
+        uint64_t gpuBytes{};
+        uint64_t cpuBudget{};
+        uint64_t gpuBudget{};
+    };
+
     enum class ShaderType
     {
         VERTEX,
@@ -16,30 +43,107 @@ namespace lum
 
     struct Shader
     {
-        const char     *tag{};
+        StringId        tag{};
         ShaderType      type{};
         SDL_GPUShader  *data{};
-        const char     *filePath{};
+        std::string     filePath{};
         SDL_Time        lastModifyTime{};
+        uint64_t        sizeBytes{};
+        uint32_t        refCount{};
+        uint64_t        lastUsedFrame{};
+    };
+
+    struct ShaderCompileError
+    {
+        StringId        tag{};
+        std::string     filePath{};
+        std::string     log{};
     };
 
     struct Texture
     {
-        const char     *tag{};
+        StringId        tag{};
         vec2            size{};
         SDL_GPUTexture *data{};
-        const char     *filePath{};
+        std::string     filePath{};
         SDL_Time        lastModifyTime{};
+        uint64_t        sizeBytes{};
+        uint32_t        refCount{};
+        uint64_t        lastUsedFrame{};
+    };
+
+    enum class VoiceStealPolicy
+    {
+        NONE,             // Drop the new trigger
+        OLDEST,
+        QUIETEST,
+        LOWEST_PRIORITY
+    };
+
+    // How many copies of a sound may play at once and what gives way when the
+    // limit or the voice pool is full
+    struct SoundPlayback
+    {
+        uint16_t         maxInstances{ 8 };
+        uint8_t          priority{ 128 }; // Higher wins
+        VoiceStealPolicy steal{ VoiceStealPolicy::OLDEST };
+    };
+
+    // Slot of a loaded sound in the mixer, lets the game trigger it by index
+    struct SoundId
+    {
+        uint16_t slot{};
+        uint16_t generation{}; // Zero is never a registered sound
+
+        explicit operator bool() const { return generation != 0; }
+        bool operator==(const SoundId &p_other) const { return slot == p_other.slot && generation == p_other.generation; }
+        bool operator!=(const SoundId &p_other) const { return !(*this == p_other); }
     };
 
+    // Stored in the mixer format, converted and resampled once at load
     struct Sound
     {
-        const char          *tag{};
+        StringId             tag{};
+        SoundId              mixerId{};
+        SoundPlayback        playback{};
         SDL_AudioSpec        audioSpec{};
-        std::vector<uint8_t> buffer;
-        uint32_t             length{};
+        std::vector<float>   samples{};
+        uint32_t             frameCount{};
         std::string          filePath{};
         SDL_Time             lastModifyTime{};
+        uint64_t             sizeBytes{};
+        uint32_t             refCount{};
+        uint64_t             lastUsedFrame{};
+    };
+
+    struct AssetManifestEntry
+    {
+        AssetType       type{};
+        const char     *tag{};
+        const char     *path{};
+    };
+
+    // Assets a scene needs resident while it's current
+    struct AssetManifest
+    {
+        std::vector<AssetManifestEntry> entries{};
+
+        void AddTexture(const char *p_tag, const char *p_path) { entries.push_back({ AssetType::TEXTURE, p_tag, p_path }); }
+        void AddSound(const char *p_tag, const char *p_path) { entries.push_back({ AssetType::SOUND, p_tag, p_path }); }
+        void AddMusic(const char *p_tag, const char *p_path) { entries.push_back({ AssetType::MUSIC, p_tag, p_path }); }
+    };
+
+    // Streamed from disk while playing, only the header info is kept resident
+    struct Music
+    {
+        StringId             tag{};
+        SDL_AudioSpec        audioSpec{};
+        int64_t              totalFrames{};
+        std::string          filePath{}; // Full path, opened by every MusicStream playing it
+        SDL_Time             lastModifyTime{};
+        uint64_t             sizeBytes{};
+        uint32_t             refCount{};
+        uint64_t             lastUsedFrame{};
     };
 }
 
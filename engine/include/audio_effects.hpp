@@ -0,0 +1,207 @@
+#ifndef AUDIO_EFFECTS_H
+#define AUDIO_EFFECTS_H
+
+#include <array>
+#include <atomic>
+#include <vector>
+
+#include <SDL3/SDL.h>
+
+namespace lum
+{
+	// Effect parameter shared between the game and the mix callback. The game
+	// thread only stores the target, the audio thread eases its own copy towards
+	// it once per block so changes never click and never take a lock.
+	class SmoothedParam
+	{
+	public:
+		static constexpr float SMOOTHING_TIME_MS = 20.0f;
+
+	public:
+		SmoothedParam(float p_value = 0.0f);
+
+		void Set(float p_value);
+		float GetTarget() const;
+
+		// Audio thread only
+		float Get() const;
+		bool Advance(uint32_t p_frames, int p_sampleRate);
+		void Snap();
+
+	private:
+		std::atomic<float> m_target{};
+		float m_current{};
+	};
+
+	// Bus levels of the last processed block, lets effects key off other buses
+	struct EffectContext
+	{
+		const float *busPeaks{};
+		uint32_t     busCount{};
+	};
+
+	// Processes interleaved float blocks in place. Prepare runs on the game thread
+	// before the effect is handed to the mixer, Process only on the audio thread.
+	class AudioEffect
+	{
+	public:
+		virtual ~AudioEffect() = default;
+
+		virtual void Prepare(const SDL_AudioSpec &p_spec);
+		virtual void Process(float *p_samples, uint32_t p_frames, const EffectContext &p_context) = 0;
+
+		void SetBypass(bool p_bypass);
+		bool IsBypassed() const;
+
+	protected:
+		static constexpr uint32_t MAX_CHANNELS = 8;
+
+		uint32_t m_channels{};
+		int m_sampleRate{};
+		std::atomic<bool> m_bypass{};
+	};
+
+	// FILTER
+	//
+
+	enum class BiquadType
+	{
+		LOW_PASS,
+		HIGH_PASS
+	};
+
+	class BiquadFilter : public AudioEffect
+	{
+	public:
+		BiquadFilter(BiquadType p_type, float p_cutoffHz, float p_q = 0.7071f);
+
+		void Prepare(const SDL_AudioSpec &p_spec) override;
+		void Process(float *p_samples, uint32_t p_frames, const EffectContext &p_context) override;
+
+		void SetCutoff(float p_cutoffHz);
+		void SetQ(float p_q);
+
+	private:
+		BiquadType m_type{};
+		SmoothedParam m_cutoff{};
+		SmoothedParam m_q{};
+
+		// Normalised coefficients, transposed direct form II state per channel
+		float m_b0{}, m_b1{}, m_b2{}, m_a1{}, m_a2{};
+		alignas(16) std::array<float, MAX_CHANNELS> m_z1{};
+		alignas(16) std::array<float, MAX_CHANNELS> m_z2{};
+
+	private:
+		void UpdateCoefficients();
+		void ProcessScalar(float *p_samples, uint32_t p_frames);
+	};
+
+	// DYNAMICS
+	//
+
+	// Feed forward peak compressor working on block peaks. The gain is ramped
+	// across each block, a ratio of 0 turns it into a limiter.
+	class Compressor : public AudioEffect
+	{
+	public:
+		Compressor(float p_thresholdDB, float p_ratio, float p_attackMS = 5.0f, float p_releaseMS = 120.0f, float p_makeupDB = 0.0f);
+
+		void Process(float *p_samples, uint32_t p_frames, const EffectContext &p_context) override;
+
+		void SetThreshold(float p_thresholdDB);
+		void SetRatio(float p_ratio);
+		void SetMakeup(float p_makeupDB);
+
+	private:
+		SmoothedParam m_threshold{};
+		SmoothedParam m_ratio{};
+		SmoothedParam m_makeup{};
+		float m_attackMS{};
+		float m_releaseMS{};
+
+		float m_envelope{};
+		float m_gain{ 1.0f };
+	};
+
+	// Pulls the bus down while another bus is loud, SFX ducking the music
+	class Ducker : public AudioEffect
+	{
+	public:
+		Ducker(uint8_t p_sidechainBus, float p_depthDB = -9.0f, float p_thresholdDB = -30.0f, float p_attackMS = 10.0f, float p_releaseMS = 300.0f);
+
+		void Process(float *p_samples, uint32_t p_frames, const EffectContext &p_context) override;
+
+		void SetDepth(float p_depthDB);
+		void SetThreshold(float p_thresholdDB);
+
+	private:
+		uint8_t m_sidechainBus{};
+		SmoothedParam m_depth{};
+		SmoothedParam m_threshold{};
+		float m_attackMS{};
+		float m_releaseMS{};
+
+		float m_envelope{};
+		float m_gain{ 1.0f };
+	};
+
+	// REVERB
+	//
+
+	// Schroeder style reverb, four parallel combs into two allpasses per channel.
+	// Later channels get slightly longer delays so stereo output decorrelates.
+	//
+	// Runs a channel at a time in chunks no longer than the shortest delay, so
+	// nothing a chunk writes gets read back within it. That leaves only the comb
+	// damping filters recursive, and the four of them run side by side.
+	class Reverb : public AudioEffect
+	{
+	public:
+		static constexpr uint32_t COMB_COUNT = 4;
+		static constexpr uint32_t ALLPASS_COUNT = 2;
+		static constexpr uint32_t CHUNK_FRAMES = 256;
+
+	public:
+		Reverb(float p_roomSize = 0.8f, float p_damping = 0.3f, float p_wet = 0.25f);
+
+		void Prepare(const SDL_AudioSpec &p_spec) override;
+		void Process(float *p_samples, uint32_t p_frames, const EffectContext &p_context) override;
+
+		void SetRoomSize(float p_roomSize);
+		void SetDamping(float p_damping);
+		void SetWet(float p_wet);
+
+	private:
+		struct DelayLine
+		{
+			std::vector<float> buffer{};
+			uint32_t position{};
+			float filterState{};
+		};
+
+		struct ChannelState
+		{
+			std::array<DelayLine, COMB_COUNT> combs{};
+			std::array<DelayLine, ALLPASS_COUNT> allpasses{};
+		};
+
+		SmoothedParam m_roomSize{};
+		SmoothedParam m_damping{};
+		SmoothedParam m_wet{};
+
+		std::vector<ChannelState> m_state{};
+		uint32_t m_chunkFrames{ CHUNK_FRAMES };
+
+		// One channel of one chunk
+		std::array<float, CHUNK_FRAMES> m_input{};
+		std::array<float, CHUNK_FRAMES> m_output{};
+		std::array<float, CHUNK_FRAMES> m_scratch{};
+		std::array<std::array<float, CHUNK_FRAMES>, COMB_COUNT> m_delayed{};
+		std::array<std::array<float, CHUNK_FRAMES>, COMB_COUNT> m_filtered{};
+
+	private:
+		void ProcessChunk(ChannelState &p_state, uint32_t p_frames, float p_feedback, float p_damping);
+	};
+}
+
+#endif // !AUDIO_EFFECTS_H
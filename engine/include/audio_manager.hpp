@@ -1,18 +1,50 @@
 #ifndef AUDIO_MANAGER_H
 #define AUDIO_MANAGER_H
 
+#include "mixer.hpp"
+#include "music_stream.hpp"
+
 namespace lum
 {
-	class AudioChannel
+	// Game side of a mixer bus. Volume and effect parameter changes are lock
+	// free, the mixer smooths them on the audio thread.
+	class AudioBus
 	{
 	public:
-		AudioChannel();
-		~AudioChannel();
+		AudioBus();
+		~AudioBus();
 
-		bool Init(SDL_AudioDeviceID p_device);
+		bool Init(Mixer *p_mixer, uint8_t p_index);
 		void Shutdown();
 
-		void PlaySound(SDL_AudioSpec &p_audioSpec, uint8_t *p_buffer, uint32_t p_length);
+		uint8_t GetIndex() const;
+
+		template<typename T, typename... Args>
+		T *AddEffect(Args&&... p_args)
+		{
+			auto *effect = static_cast<T *>(m_mixer->AddBusEffect(m_index, std::make_unique<T>(std::forward<Args>(p_args)...)));
+			if (effect)
+				m_effects.push_back(effect);
+
+			return effect;
+		}
+
+		template<typename T>
+		T *GetEffect() const
+		{
+			for (auto *effect : m_effects)
+			{
+				if (auto *typed = dynamic_cast<T *>(effect))
+					return typed;
+			}
+
+			return nullptr;
+		}
+
+		VoiceHandle PlaySound(SoundId p_sound, float p_gain = 1.0f, float p_pitch = 1.0f);
+		void PlayMusic(const Music &p_music, bool p_loop);
+		void StopMusic();
+		void SeekMusic(double p_seconds);
 		void StopAll();
 		void SetVolume(float p_newVolume);
 		float GetVolume() const;
@@ -20,26 +52,74 @@ namespace lum
 		void Resume();
 
 	private:
-		SDL_AudioDeviceID m_device{};
+		Mixer *m_mixer{};
+		uint8_t m_index{};
 		float m_volume{ 1.0f };
-		std::vector<SDL_AudioStream *> m_activeStreams{};
+		std::unique_ptr<MusicStream> m_music{};
+		std::vector<AudioEffect *> m_effects{}; // Owned by the mixer
 	};
 
 	class AudioManager
 	{
+	public:
+		static constexpr float MUSIC_OPEN_CUTOFF_HZ = 20000.0f;
+		static constexpr float MUSIC_PAUSED_CUTOFF_HZ = 600.0f;
+
 	public:
 		AudioManager();
 		~AudioManager();
 
 		bool Init();
+		bool InitOffline(const SDL_AudioSpec &p_spec);
 		void Shutdown();
 
-		void PlaySound(const std::string &p_tag, const std::string &p_channelTag);
-		void SetChannelVolume(const std::string &p_tag, float p_volume);
+		void Update();
+		void Render(float *p_out, uint32_t p_frames);
+
+		AudioBus *CreateBus(const std::string &p_tag, const std::string &p_parentTag = "MASTER");
+		AudioBus *GetBus(const std::string &p_tag);
+
+		SoundId RegisterSound(const Sound &p_sound);
+		void UnregisterSound(Sound &p_sound);
+		bool IsSoundPlaying(SoundId p_sound) const;
+		SoundId GetSoundId(StringId p_tag);
+
+		// Instance cap, priority and steal policy of a sound. By tag the settings
+		// are kept on the asset and survive a reload, by id only the mixer has them.
+		void SetSoundPlayback(StringId p_tag, const SoundPlayback &p_playback);
+		void SetSoundPlayback(SoundId p_sound, const SoundPlayback &p_playback);
+		int32_t GetBusId(const std::string &p_tag);
+
+		// Fast path, resolve the ids once and keep them around
+		VoiceHandle PlaySound(SoundId p_sound, uint8_t p_bus, float p_gain = 1.0f, float p_pitch = 1.0f);
+		VoiceHandle PlaySound(const std::string &p_tag, const std::string &p_busTag, float p_gain = 1.0f);
+		void StopVoice(VoiceHandle p_voice);
+		void SetVoiceGain(VoiceHandle p_voice, float p_gain);
+		void SetVoicePitch(VoiceHandle p_voice, float p_pitch);
+		bool IsVoicePlaying(VoiceHandle p_voice) const;
+		void PlayMusic(const std::string &p_tag, const std::string &p_busTag, bool p_loop = true);
+		void StopMusic(const std::string &p_busTag);
+		void SeekMusic(const std::string &p_busTag, double p_seconds);
+		void SetBusVolume(const std::string &p_tag, float p_volume);
+
+		// Holds the SFX where they are and muffles the music behind the low pass
+		void SetPaused(bool p_paused);
+		bool IsPaused() const;
+		const SDL_AudioSpec &GetMixSpec() const;
+		MixerStats GetMixerStats() const;
 
 	private:
 		SDL_AudioDeviceID m_device{};
-		std::unordered_map<std::string, std::unique_ptr<AudioChannel>> m_channels;
+		Mixer m_mixer{};
+		std::unordered_map<std::string, std::unique_ptr<AudioBus>> m_buses;
+		bool m_paused{};
+
+		// Resolved once with the default buses, pausing runs every frame
+		int32_t m_sfxBus{ -1 };
+		BiquadFilter *m_musicFilter{};
+
+	private:
+		bool CreateDefaultBuses();
 
 	private:
 		AudioManager(const AudioManager &) = delete;
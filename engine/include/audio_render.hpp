@@ -0,0 +1,79 @@
+#ifndef AUDIO_RENDER_H
+#define AUDIO_RENDER_H
+
+#include <string>
+#include <vector>
+
+#include <SDL3/SDL.h>
+
+#include "string_id.hpp"
+
+namespace lum
+{
+	enum class AudioScriptAction
+	{
+		PLAY,
+		STOP_BUS,
+		BUS_VOLUME
+	};
+
+	struct AudioScriptEvent
+	{
+		double            seconds{};
+		uint64_t          frame{};    // Set from seconds once the format is known
+		AudioScriptAction action{};
+		StringId          sound{};
+		std::string       bus{};
+		float             gain{ 1.0f };
+		float             pitch{ 1.0f };
+	};
+
+	struct AudioScriptSound
+	{
+		std::string tag{};
+		std::string path{};
+	};
+
+	// Runs a scripted sequence of audio commands through the mixer without a
+	// device, writes the result as a float WAV and optionally compares it with a
+	// reference render. Commands land on the exact frame they're scheduled for,
+	// so the same script always produces the same samples. Times become frames
+	// after the whole script is read, the format line can go anywhere.
+	//
+	//     # times are in seconds
+	//     format 48000 2
+	//     sound shot sounds/shot.wav
+	//     0.00 play shot SFX [gain] [pitch]
+	//     0.50 volume SFX 0.5
+	//     1.00 stop SFX
+	//     2.00 end
+	class AudioRender
+	{
+	public:
+		AudioRender();
+		~AudioRender();
+
+		bool LoadScript(const char *p_path);
+		const SDL_AudioSpec &GetSpec() const;
+
+		// Needs the audio manager initialised offline with GetSpec
+		bool Run(const char *p_outPath, const char *p_referencePath, float p_tolerance);
+
+	private:
+		SDL_AudioSpec m_spec{ SDL_AUDIO_F32, 2, 48000 };
+		double m_endSeconds{};
+		uint64_t m_endFrame{};
+		std::vector<AudioScriptSound> m_sounds{};
+		std::vector<AudioScriptEvent> m_events{};
+
+	private:
+		bool ParseLine(char *p_line, const char *p_path, int p_lineNumber);
+		bool WriteWav(const char *p_path, const std::vector<float> &p_samples) const;
+		bool CompareWithReference(const char *p_path, const std::vector<float> &p_samples, float p_tolerance) const;
+
+		AudioRender(const AudioRender &) = delete;
+		AudioRender &operator=(const AudioRender &) = delete;
+	};
+}
+
+#endif // !AUDIO_RENDER_H
@@ -0,0 +1,63 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <cstdint>
+#include <vector>
+
+#include "job_system.hpp"
+
+namespace lum
+{
+    // Times engine systems on fixed synthetic loads without a window or device.
+    // Every load is seeded, so runs compare across machines and commits. Logs the
+    // timings, writes them as csv with --bench-out and fails when the load goes
+    // over its budget.
+    //
+    //     --bench collision    player, 40 enemies and 10k bullets from each side
+    //     --bench projectiles  50k bullets stepped and written out for drawing
+    //     --bench ecs          100k entities moved through a registered query
+    class Benchmark
+    {
+    public:
+        static constexpr uint32_t WARMUP_FRAMES = 30;
+        static constexpr uint32_t FRAMES = 600;
+        static constexpr uint64_t SEED = 0x5EED;
+
+        static constexpr uint32_t COLLISION_ENEMIES = 40;
+        static constexpr uint32_t COLLISION_BULLETS = 10000; // Per side
+        static constexpr float    COLLISION_BUDGET_MS = 0.5f;
+
+        static constexpr uint32_t PROJECTILE_COUNT = 50000;
+        static constexpr float    PROJECTILE_BUDGET_MS = 2.0f; // An eighth of a 60 fps frame
+
+        static constexpr uint32_t ECS_ENTITIES = 100000;
+        static constexpr float    ECS_BUDGET_MS = 1.0f;
+
+    public:
+        Benchmark();
+        ~Benchmark();
+
+        // False for an unknown name or a load over its budget
+        bool Run(const char *p_name, const char *p_outPath);
+
+    private:
+        uint64_t m_random{ SEED };
+        std::vector<JobTiming> m_timings{};
+
+    private:
+        bool RunCollision(float &p_budgetMS);
+        bool RunProjectiles(float &p_budgetMS);
+        bool RunEcs(float &p_budgetMS);
+
+        // Adds p_ms to the timing called p_name, frames before the warmup is over
+        // are dropped
+        void Record(const char *p_name, uint32_t p_frame, float p_ms);
+
+        bool Report(const char *p_name, const char *p_outPath, float p_budgetMS) const;
+
+        Benchmark(const Benchmark &) = delete;
+        Benchmark &operator=(const Benchmark &) = delete;
+    };
+}
+
+#endif // !BENCHMARK_H
@@ -0,0 +1,154 @@
+#ifndef COLLISION_H
+#define COLLISION_H
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace lum
+{
+    // Pair of overlapping colliders. a is the one whose mask asked for b's layer.
+    // When both asked for each other it's the one whose kind, same layers and
+    // mask, has fewer colliders, the lower index if they're the same kind.
+    struct Contact
+    {
+        uint32_t a{};
+        uint32_t b{};
+        uint32_t userA{};
+        uint32_t userB{};
+    };
+
+    struct CollisionStats
+    {
+        uint32_t colliders{};
+        uint32_t gridEntries{};
+        uint32_t gridCells{};
+        uint32_t queries{};
+        uint32_t contacts{};
+        float    buildMS{};
+        float    queryMS{};
+    };
+
+    // Broadphase over a uniform grid covering the playfield, refilled every frame.
+    // Colliders go in with the layers they're on and a mask of the layers they
+    // want contacts with. Only layers some mask asks for are put in the grid and
+    // only colliders with a mask query it, so thousands of bullets that never
+    // hit each other cost one query each and nothing else.
+    //
+    // When two kinds of collider want each other only the smaller kind queries,
+    // so ten thousand bullets against forty enemies is forty queries. With that
+    // few queries filling a fine grid costs more than it saves, so the cells are
+    // merged four by four for the frame.
+    //
+    // Inside a cell, entries are grouped by the set of layers they're on and a
+    // query only visits the groups its mask can hit, so a player bullet never
+    // scans the enemy bullets sharing its cell.
+    //
+    // Positions outside the bounds still collide, they just pile into the edge
+    // cells.
+    class CollisionWorld
+    {
+    public:
+        static constexpr float DEFAULT_CELL_SIZE = 16.0f;
+        static constexpr uint32_t MAX_CELLS_PER_AXIS = 1024;
+        static constexpr uint32_t MAX_LAYER_GROUPS = 8;
+        static constexpr uint32_t MAX_QUERY_KINDS = 8;
+        static constexpr uint32_t MAX_COARSE_QUERIES = 64;
+        static constexpr uint32_t COARSE_CELL_SHIFT = 2;
+
+    public:
+        CollisionWorld();
+        ~CollisionWorld();
+
+        void SetBounds(glm::vec2 p_min, glm::vec2 p_max, float p_cellSize = DEFAULT_CELL_SIZE);
+
+        // Drops every collider, call before adding this frame's
+        void Clear();
+
+        uint32_t AddCircle(glm::vec2 p_center, float p_radius, uint32_t p_layers, uint32_t p_mask, uint32_t p_userData = 0);
+        uint32_t AddBox(glm::vec2 p_center, glm::vec2 p_halfExtents, uint32_t p_layers, uint32_t p_mask, uint32_t p_userData = 0);
+
+        // Builds the grid and collects the contacts
+        void Update();
+
+        const std::vector<Contact> &GetContacts() const;
+        CollisionStats GetStats() const;
+
+    private:
+        static constexpr uint8_t NO_GROUP = 0xFF;
+
+        struct QueryKind
+        {
+            uint32_t layers{};
+            uint32_t mask{};
+            uint32_t count{};
+            uint8_t  reportsOver{}; // Bit per kind this one reports mutual contacts for
+            bool     skip{};        // Every contact it wants is reported by the other side
+        };
+
+        struct CellRange
+        {
+            uint16_t minX{};
+            uint16_t minY{};
+            uint16_t maxX{};
+            uint16_t maxY{};
+        };
+
+        glm::vec2 m_min{ 0.0f };
+        float m_invCellSize{};
+        uint32_t m_columns{};
+        uint32_t m_rows{};
+
+        // Layout of this frame's grid, coarser when there are few queries
+        uint32_t m_gridColumns{};
+        uint32_t m_gridCells{};
+
+        // Colliders in the order they were added
+        std::vector<float> m_cx{};
+        std::vector<float> m_cy{};
+        std::vector<float> m_hx{};
+        std::vector<float> m_hy{};
+        std::vector<float> m_r{};
+        std::vector<uint32_t> m_layers{};
+        std::vector<uint32_t> m_masks{};
+        std::vector<uint32_t> m_userData{};
+        std::vector<CellRange> m_ranges{};
+
+        // Kinds of this frame's colliders with a mask, past the limit every one
+        // is kind 0, queries and the lower index reports
+        std::vector<QueryKind> m_kinds{};
+        std::vector<uint8_t> m_colliderKinds{};
+
+        // Layer sets of this frame's grid entries, past the limit the last group
+        // takes every remaining set and the per entry layer test sorts them out
+        std::vector<uint32_t> m_groupLayers{};
+        std::vector<uint8_t> m_groups{}; // Per collider, NO_GROUP if it's not in the grid
+
+        // Grid entries sorted by cell, then by group. Group g of cell c owns
+        // [m_cellStarts[c * groups + g], m_cellStarts[c * groups + g + 1])
+        std::vector<uint32_t> m_cellStarts{};
+        std::vector<float> m_gridCX{};
+        std::vector<float> m_gridCY{};
+        std::vector<float> m_gridHX{};
+        std::vector<float> m_gridHY{};
+        std::vector<float> m_gridR{};
+        std::vector<uint32_t> m_gridLayers{};
+        std::vector<uint32_t> m_gridIndex{};
+        std::vector<uint32_t> m_hits{};
+
+        std::vector<Contact> m_contacts{};
+        CollisionStats m_stats{};
+
+    private:
+        uint32_t Add(glm::vec2 p_center, glm::vec2 p_halfExtents, float p_radius, uint32_t p_layers, uint32_t p_mask, uint32_t p_userData);
+        uint32_t AssignQueryKinds();
+        void BuildGrid(uint32_t p_gridLayers);
+        void FindContacts();
+
+        CollisionWorld(const CollisionWorld &) = delete;
+        CollisionWorld &operator=(const CollisionWorld &) = delete;
+    };
+}
+
+#endif // !COLLISION_H
@@ -16,6 +16,12 @@ namespace lum
         const char *name{};
         CommandType type{};
     };
+
+    // Held commands of one player as bits, in the order the scene bound them
+    using InputBits = uint32_t;
+
+    static constexpr uint32_t MAX_PLAYERS = 2;
+    static constexpr uint32_t MAX_INPUT_COMMANDS = 32;
 }
 
 #endif // !COMMAND_H
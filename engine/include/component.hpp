@@ -5,6 +5,9 @@
 
 namespace lum
 {
+    class SnapshotReader;
+    class SnapshotWriter;
+
     class Component
     {
     public:
@@ -17,6 +20,11 @@ namespace lum
 
         virtual void Update(float) = 0;
         virtual void Draw();
+
+        // Whatever the component changes while the game runs, for snapshots.
+        // Nothing by default.
+        virtual void SaveState(SnapshotWriter &p_writer) const;
+        virtual bool LoadState(SnapshotReader &p_reader);
     };
 }
 
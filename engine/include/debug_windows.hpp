@@ -6,6 +6,17 @@
 #include <imgui.h>
 #include <implot.h>
 
+#include "asset_types.hpp"
+#include "collision.hpp"
+#include "frame_arena.hpp"
+#include "job_system.hpp"
+#include "mixer.hpp"
+#include "pool_allocator.hpp"
+#include "projectiles.hpp"
+#include "rollback.hpp"
+#include "snapshot.hpp"
+#include "transform_hierarchy.hpp"
+
 namespace lum::metrics
 {
     class MetricsWindows
@@ -18,6 +29,23 @@ namespace lum::metrics
         uint32_t drawCalls{};
         float renderFrameTime{};
         float updateFrameTime{};
+        uint32_t ticks{};
+        uint32_t droppedTicks{};
+        float tickRate{};
+        float interpolation{};
+        lum::AssetMemoryStats assetStats{};
+        lum::MixerStats audioStats{};
+        std::vector<lum::PoolStats> poolStats{};
+        lum::FrameArenaStats arenaStats{};
+        uint32_t frameHeapAllocations{};
+        uint32_t jobWorkers{};
+        std::vector<lum::JobTiming> jobTimings{};
+        lum::CollisionStats collisionStats{};
+        lum::ProjectileStats projectileStats{};
+        lum::TransformStats transformStats{};
+        lum::SnapshotStats snapshotStats{};
+        lum::RollbackStats rollbackStats{};
+        bool networked{};
 
     public:
         MetricsWindows() = default;
@@ -79,6 +107,90 @@ namespace lum::metrics
 
             ImGui::Text("Draw Calls: %d", drawCalls);
 
+            // Simulation
+
+            ImGui::Text("Ticks: %u at %.0f Hz (%u dropped) interpolation %.2f", ticks, tickRate, droppedTicks, interpolation);
+
+            // Resident asset memory
+
+            static const char *assetTypeNames[] = { "Shaders", "Textures", "Sounds", "Music" };
+
+            ImGui::Text("Asset GPU Memory: %.2f / %.0f MB", assetStats.gpuBytes / (1024.0f * 1024.0f), assetStats.gpuBudget / (1024.0f * 1024.0f));
+            ImGui::Text("Asset CPU Memory: %.2f / %.0f MB", assetStats.cpuBytes / (1024.0f * 1024.0f), assetStats.cpuBudget / (1024.0f * 1024.0f));
+
+            for (int i = 0; i < IM_ARRAYSIZE(assetTypeNames); i++)
+            {
+                ImGui::Text("  %s: %u (%u cached) %.1f KB", assetTypeNames[i], assetStats.residentCount[i],
+                    assetStats.cachedCount[i], assetStats.residentBytes[i] / 1024.0f);
+            }
+
+            // Audio mixer
+
+            ImGui::Text("Audio Voices: %u / %u", audioStats.activeVoices, audioStats.maxVoices);
+            ImGui::Text("Audio Mix Time: %.3f ms (%.1f ms block)", audioStats.mixTimeMS, audioStats.blockTimeMS);
+
+            // Frame memory
+
+            ImGui::Text("Frame Arena: %.1f / %.0f KB (peak %.1f KB)", arenaStats.lastFrameUsed / 1024.0f, arenaStats.capacity / 1024.0f, arenaStats.peak / 1024.0f);
+            ImGui::Text("Frame Heap Allocations: %u", frameHeapAllocations);
+
+            // Jobs
+
+            ImGui::Text("Job Workers: %u", jobWorkers);
+
+            for (const auto &job : jobTimings)
+                ImGui::Text("  %s: %u runs %.3f ms (max %.3f ms)", job.name, job.count, job.totalMS, job.maxMS);
+
+            // Collision
+
+            ImGui::Text("Colliders: %u (%u in grid, %u queries) %u contacts", collisionStats.colliders, collisionStats.gridEntries,
+                collisionStats.queries, collisionStats.contacts);
+            ImGui::Text("Collision Time: %.3f ms build %.3f ms query", collisionStats.buildMS, collisionStats.queryMS);
+
+            // Projectiles
+
+            ImGui::Text("Projectiles: %u / %u (peak %u) +%u -%u", projectileStats.live, projectileStats.capacity, projectileStats.peak,
+                projectileStats.spawned, projectileStats.despawned);
+            ImGui::Text("Projectile Update: %.3f ms", projectileStats.updateMS);
+
+            // Transforms
+
+            ImGui::Text("Transforms: %u nodes, %u recomputed", transformStats.nodes, transformStats.recomputed);
+
+            // Snapshots
+
+            ImGui::Text("Snapshots: %u / %u, %.1f KB full %.1f KB deltas", snapshotStats.count, snapshotStats.capacity,
+                snapshotStats.fullBytes / 1024.0f, snapshotStats.deltaBytes / 1024.0f);
+            ImGui::Text("Snapshot Time: %.3f ms save %.3f ms restore", snapshotStats.saveMS, snapshotStats.restoreMS);
+
+            // Rollback, resimulating the deepest rollback has to fit in one tick
+
+            if (networked)
+            {
+                const float budgetMS = 1000.0f / SDL_max(tickRate, 1.0f);
+                const float worstMS = rollbackStats.tickMS * lum::RollbackSession::MAX_PREDICTION;
+
+                ImGui::Text("Rollback: tick %llu, %u delay, %u predicted", static_cast<unsigned long long>(rollbackStats.tick),
+                    rollbackStats.inputDelay, rollbackStats.predicted);
+                ImGui::Text("Rollbacks: %u depth %u (max %u), %u stalls", rollbackStats.rollbacks, rollbackStats.rollbackDepth,
+                    rollbackStats.maxRollbackDepth, rollbackStats.stalls);
+                ImGui::Text("Resim: %.3f ms, %.3f ms per tick", rollbackStats.resimMS, rollbackStats.tickMS);
+                ImGui::TextColored(worstMS > budgetMS ? ImVec4(1.0f, 0.3f, 0.3f, 1.0f) : ImVec4(0.6f, 1.0f, 0.6f, 1.0f),
+                    "Resim %u ticks: %.2f ms of %.2f ms", lum::RollbackSession::MAX_PREDICTION, worstMS, budgetMS);
+                ImGui::Text("Net: %u sent %u received %u lost", rollbackStats.transport.sent, rollbackStats.transport.received,
+                    rollbackStats.transport.dropped);
+                ImGui::TextColored(rollbackStats.desyncs ? ImVec4(1.0f, 0.3f, 0.3f, 1.0f) : ImVec4(0.6f, 1.0f, 0.6f, 1.0f),
+                    "Sync: checked to tick %llu, %u desyncs", static_cast<unsigned long long>(rollbackStats.checkedTick), rollbackStats.desyncs);
+            }
+
+            // Object pools
+
+            for (const auto &pool : poolStats)
+            {
+                ImGui::Text("Pool %s: %u / %u (peak %u, %u slabs) %.0f%% used %.0f%% fragmented", pool.name, pool.used, pool.capacity,
+                    pool.peak, pool.slabCount, pool.occupancy * 100.0f, pool.fragmentation * 100.0f);
+            }
+
             // Display a graph of frame times
             if (ImPlot::BeginPlot("Frame Time Plot", ImVec2(-1, 150)))
             {
@@ -93,12 +205,32 @@ namespace lum::metrics
             ImGui::End();
         }
 
-        void ShowEngineControls(float *timeScale)
+        void ShowShaderCompileErrors(const std::vector<lum::ShaderCompileError> &p_errors)
+        {
+            if (p_errors.empty())
+                return;
+
+            ImGui::Begin("Shader Errors");
+
+            for (const auto &error : p_errors)
+            {
+                ImGui::TextColored(ImVec4(0.8f, 0.1f, 0.1f, 1.0f), "%s (%s.glsl)", lum::StringTable::GetString(error.tag), error.filePath.c_str());
+                ImGui::TextUnformatted(error.log.c_str());
+                ImGui::Separator();
+            }
+
+            ImGui::End();
+        }
+
+        void ShowEngineControls(float *timeScale, bool *rewind)
         {
             ImGui::Begin("Engine Debug");
 
             ImGui::SliderFloat("Time scale", timeScale, 0.0f, 2.0f);
 
+            if (rewind)
+                ImGui::Checkbox("Rewind", rewind);
+
             ImGui::End();
         }
     };
@@ -0,0 +1,490 @@
+#ifndef ECS_H
+#define ECS_H
+
+#include <array>
+#include <bitset>
+#include <functional>
+#include <memory>
+#include <new>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <SDL3/SDL.h>
+
+#include "frame_arena.hpp"
+#include "job_system.hpp"
+#include "snapshot.hpp"
+#include "type_id.hpp"
+
+namespace lum
+{
+    static constexpr uint32_t MAX_COMPONENTS = 64;
+
+    using ComponentIndex = uint8_t;
+    using Signature = std::bitset<MAX_COMPONENTS>;
+
+    static constexpr ComponentIndex INVALID_COMPONENT = 0xFF;
+
+    // Index into the entity records plus the generation it was created with, the
+    // index gets reused after a destroy but the generation never matches again
+    struct Entity
+    {
+        uint32_t index{};
+        uint32_t generation{}; // Zero is never alive
+
+        explicit operator bool() const { return generation != 0; }
+        bool operator==(const Entity &p_other) const { return index == p_other.index && generation == p_other.generation; }
+        bool operator!=(const Entity &p_other) const { return !(*this == p_other); }
+    };
+
+    // Type erased operations, lets archetypes move components around without
+    // knowing their type
+    struct ComponentInfo
+    {
+        size_t size{};
+        size_t alignment{};
+        bool   trivial{}; // Relocated with memcpy, and saved in snapshots as raw bytes
+        void (*moveConstruct)(void *p_dst, void *p_src){};
+        void (*destroy)(void *p_ptr){};
+        void (*defaultConstruct)(void *p_ptr){}; // Null if there's no default constructor
+
+        // Snapshot hooks of components that aren't trivially copyable, null otherwise
+        void (*saveState)(const void *p_ptr, SnapshotWriter &p_writer){};
+        bool (*loadState)(void *p_ptr, SnapshotReader &p_reader){};
+    };
+
+    // Whether T saves itself with SaveState(SnapshotWriter &) const and
+    // LoadState(SnapshotReader &)
+    template<typename T, typename = void>
+    struct HasSnapshotState : std::false_type {};
+
+    template<typename T>
+    struct HasSnapshotState<T, std::void_t<
+        decltype(std::declval<const T &>().SaveState(std::declval<SnapshotWriter &>())),
+        decltype(std::declval<T &>().LoadState(std::declval<SnapshotReader &>()))>> : std::true_type {};
+
+    // Table of every entity with exactly one set of components. Each component
+    // gets its own contiguous column, row i of every column belongs to
+    // entities[i], so iterating a component is a linear walk over one array.
+    class Archetype
+    {
+    public:
+        static constexpr uint32_t INITIAL_CAPACITY = 64;
+
+    public:
+        Signature signature{};
+        std::vector<Entity> entities{};
+        uint32_t id{}; // Position in the ECS, archetypes are never removed
+
+        // Cached transitions to the archetype with one component added or removed
+        std::array<Archetype *, MAX_COMPONENTS> addEdges{};
+        std::array<Archetype *, MAX_COMPONENTS> removeEdges{};
+
+    public:
+        Archetype(const Signature &p_signature, const std::array<ComponentInfo, MAX_COMPONENTS> &p_components);
+        ~Archetype();
+
+        uint32_t Size() const;
+        bool Has(ComponentIndex p_component) const;
+        void *GetColumn(ComponentIndex p_component);
+        void *GetComponent(ComponentIndex p_component, uint32_t p_row);
+
+        // New row with every component left unconstructed, the caller has to
+        // construct all of them before the row is used
+        uint32_t AddRow(Entity p_entity);
+
+        // Destroys the row and fills the hole with the last one. Returns the entity
+        // that moved into p_row, or a null entity if nothing moved.
+        Entity RemoveRow(uint32_t p_row);
+
+        // Moves the components both archetypes share into a new row of p_dst and
+        // removes the row from this one. Components only p_dst has are left
+        // unconstructed.
+        uint32_t MoveRowTo(uint32_t p_row, Archetype &p_dst, Entity &p_outMoved);
+
+        // Row count, entities and every column. Trivially copyable columns are
+        // copied whole, the others go through their hooks row by row behind a
+        // byte count so a check can skip them. Loading keeps the objects already
+        // in the rows and default constructs new ones before the hooks run.
+        void SaveRows(SnapshotWriter &p_writer) const;
+
+        // With p_apply false only checks the rows could be loaded
+        bool LoadRows(SnapshotReader &p_reader, bool p_apply);
+
+        // Destroys every row, records pointing into it are left to the caller
+        void Clear();
+
+    private:
+        struct Column
+        {
+            const ComponentInfo *info{};
+            uint8_t             *data{};
+        };
+
+        std::vector<Column> m_columns{};
+        std::array<int8_t, MAX_COMPONENTS> m_columnLookup{};
+        uint32_t m_capacity{};
+
+    private:
+        void Grow();
+        void Resize(uint32_t p_rows);
+
+        Archetype(const Archetype &) = delete;
+        Archetype &operator=(const Archetype &) = delete;
+    };
+
+    // Every archetype whose components include the signature. The ECS appends
+    // new archetypes as they get created, and entities gaining or losing
+    // components only move between tables already in or out of the list, so
+    // walking a query never looks at anything that doesn't match.
+    class Query
+    {
+    public:
+        Signature signature{};
+
+    public:
+        Query(const Signature &p_signature);
+        ~Query();
+
+        const std::vector<Archetype *> &GetArchetypes() const;
+
+        // Matching entities, summed over the tables
+        uint32_t Size() const;
+
+    private:
+        friend class ECS;
+
+        std::vector<Archetype *> m_archetypes{};
+
+    private:
+        Query(const Query &) = delete;
+        Query &operator=(const Query &) = delete;
+    };
+
+    // Archetype based entity component system. Components are plain types
+    // registered up front, entities move between archetype tables as
+    // components get added or removed, and systems iterate the tables of every
+    // archetype matching what they need.
+    //
+    // Adding, removing and destroying invalidates component references and must
+    // not happen inside ForEach.
+    class ECS
+    {
+    public:
+        ECS();
+        ~ECS();
+
+        template<typename T>
+        ComponentIndex RegisterComponent()
+        {
+            static_assert(std::is_move_constructible_v<T>, "Components must be move constructible");
+            static_assert(std::is_trivially_copyable_v<T> || HasSnapshotState<T>::value,
+                "Components that aren't trivially copyable need SaveState and LoadState, snapshots save every column");
+
+            const uint32_t typeId = TypeId<T>();
+            if (typeId < m_typeToComponent.size() && m_typeToComponent[typeId] != INVALID_COMPONENT)
+                return m_typeToComponent[typeId];
+
+            if (m_componentCount >= MAX_COMPONENTS)
+            {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "ECS: Can't register more than %u component types", MAX_COMPONENTS);
+                return INVALID_COMPONENT;
+            }
+
+            ComponentInfo info{};
+            info.size = sizeof(T);
+            info.alignment = alignof(T);
+            info.trivial = std::is_trivially_copyable_v<T>;
+            info.moveConstruct = [](void *p_dst, void *p_src) { new (p_dst) T(std::move(*static_cast<T *>(p_src))); };
+            info.destroy = [](void *p_ptr) { static_cast<T *>(p_ptr)->~T(); };
+
+            if constexpr (std::is_default_constructible_v<T>)
+                info.defaultConstruct = [](void *p_ptr) { new (p_ptr) T(); };
+
+            if constexpr (!std::is_trivially_copyable_v<T>)
+            {
+                info.saveState = [](const void *p_ptr, SnapshotWriter &p_writer) { static_cast<const T *>(p_ptr)->SaveState(p_writer); };
+                info.loadState = [](void *p_ptr, SnapshotReader &p_reader) { return static_cast<T *>(p_ptr)->LoadState(p_reader); };
+            }
+
+            const ComponentIndex index = static_cast<ComponentIndex>(m_componentCount++);
+            m_components[index] = info;
+
+            if (typeId >= m_typeToComponent.size())
+                m_typeToComponent.resize(typeId + 1, INVALID_COMPONENT);
+
+            m_typeToComponent[typeId] = index;
+
+            return index;
+        }
+
+        template<typename T>
+        ComponentIndex GetComponentIndex() const
+        {
+            const uint32_t typeId = TypeId<T>();
+            const ComponentIndex index = typeId < m_typeToComponent.size() ? m_typeToComponent[typeId] : INVALID_COMPONENT;
+
+            SDL_assert(index != INVALID_COMPONENT && "Component type used before RegisterComponent");
+
+            return index;
+        }
+
+        template<typename... Ts>
+        Signature MakeSignature() const
+        {
+            Signature signature{};
+            (signature.set(GetComponentIndex<Ts>()), ...);
+            return signature;
+        }
+
+        Entity CreateEntity();
+        void DestroyEntity(Entity p_entity);
+        bool IsAlive(Entity p_entity) const;
+        uint32_t GetEntityCount() const;
+        Signature GetSignature(Entity p_entity) const;
+
+        // Every entity and component. Loading checks the whole snapshot first and
+        // leaves the world alone if it doesn't fit.
+        void SaveState(SnapshotWriter &p_writer) const;
+        bool LoadState(SnapshotReader &p_reader);
+
+        // Replaces the component if the entity already has one
+        template<typename T>
+        std::decay_t<T> &AddComponent(Entity p_entity, T &&p_component)
+        {
+            return EmplaceComponent<std::decay_t<T>>(p_entity, std::forward<T>(p_component));
+        }
+
+        template<typename T, typename... Args>
+        T &EmplaceComponent(Entity p_entity, Args&&... p_args)
+        {
+            const ComponentIndex component = GetComponentIndex<T>();
+
+            SDL_assert(IsAlive(p_entity));
+            auto &record = m_records[p_entity.index];
+
+            if (record.archetype->Has(component))
+            {
+                T *existing = static_cast<T *>(record.archetype->GetComponent(component, record.row));
+                *existing = T(std::forward<Args>(p_args)...);
+                return *existing;
+            }
+
+            void *slot = MoveToArchetype(p_entity, record.archetype->signature | Signature{}.set(component), component);
+            return *new (slot) T(std::forward<Args>(p_args)...);
+        }
+
+        template<typename T>
+        void RemoveComponent(Entity p_entity)
+        {
+            const ComponentIndex component = GetComponentIndex<T>();
+
+            if (!IsAlive(p_entity) || !m_records[p_entity.index].archetype->Has(component))
+                return;
+
+            Signature signature = m_records[p_entity.index].archetype->signature;
+            signature.reset(component);
+
+            MoveToArchetype(p_entity, signature, INVALID_COMPONENT);
+        }
+
+        template<typename T>
+        bool HasComponent(Entity p_entity) const
+        {
+            return IsAlive(p_entity) && m_records[p_entity.index].archetype->Has(GetComponentIndex<T>());
+        }
+
+        template<typename T>
+        std::optional<std::reference_wrapper<T>> GetComponent(Entity p_entity)
+        {
+            const ComponentIndex component = GetComponentIndex<T>();
+
+            if (!IsAlive(p_entity))
+                return std::nullopt;
+
+            const auto &record = m_records[p_entity.index];
+            if (!record.archetype->Has(component))
+                return std::nullopt;
+
+            return std::ref(*static_cast<T *>(record.archetype->GetComponent(component, record.row)));
+        }
+
+        // The query for the signature, created and filled the first time it's
+        // asked for. Register queries up front, not from systems running in
+        // parallel. The reference stays valid for the life of the ECS.
+        Query &RegisterQuery(const Signature &p_signature);
+
+        template<typename... Ts>
+        Query &RegisterQuery()
+        {
+            return RegisterQuery(MakeSignature<Ts...>());
+        }
+
+        // Every entity whose components include the signature, copied out so the
+        // caller can add and remove components while walking it. Goes through the
+        // registered query for the signature when there is one. Lives in the
+        // frame arena, don't keep it past the frame.
+        FrameVector<Entity> QueryEntitiesWithSignature(const Signature &p_signature) const;
+
+        // Calls p_func(Ts &...) or p_func(Entity, Ts &...) for every entity that has
+        // all of Ts, straight over the archetype columns. Checks every archetype,
+        // anything running each frame should go through a registered query.
+        template<typename... Ts, typename F>
+        void ForEach(F &&p_func)
+        {
+            const Signature signature = MakeSignature<Ts...>();
+            const std::array<ComponentIndex, sizeof...(Ts)> components{ GetComponentIndex<Ts>()... };
+
+            for (const auto &archetype : m_archetypes)
+            {
+                if ((archetype->signature & signature) != signature || archetype->Size() == 0)
+                    continue;
+
+                ForEachInArchetype<Ts...>(*archetype, components, p_func, 0, archetype->Size(), std::index_sequence_for<Ts...>{});
+            }
+        }
+
+        // Same as above over the tables of a registered query only
+        template<typename... Ts, typename F>
+        void ForEach(const Query &p_query, F &&p_func)
+        {
+            SDL_assert(CoversComponents<Ts...>(p_query) && "Query doesn't include every component asked for");
+
+            const std::array<ComponentIndex, sizeof...(Ts)> components{ GetComponentIndex<Ts>()... };
+
+            for (Archetype *archetype : p_query.GetArchetypes())
+            {
+                if (archetype->Size() == 0)
+                    continue;
+
+                ForEachInArchetype<Ts...>(*archetype, components, p_func, 0, archetype->Size(), std::index_sequence_for<Ts...>{});
+            }
+        }
+
+        // Calls p_func(uint32_t count, const Entity *entities, Ts *...columns) once
+        // per non empty table of the query, row i of every array is the same entity
+        template<typename... Ts, typename F>
+        void ForEachChunk(const Query &p_query, F &&p_func)
+        {
+            SDL_assert(CoversComponents<Ts...>(p_query) && "Query doesn't include every component asked for");
+
+            for (Archetype *archetype : p_query.GetArchetypes())
+            {
+                if (archetype->Size() == 0)
+                    continue;
+
+                p_func(archetype->Size(), static_cast<const Entity *>(archetype->entities.data()),
+                    static_cast<Ts *>(archetype->GetColumn(GetComponentIndex<Ts>()))...);
+            }
+        }
+
+        // ForEach split into chunks of p_grain rows spread over the job system.
+        // p_func runs concurrently and may only touch the components it's given.
+        template<typename... Ts, typename F>
+        void ParallelForEach(JobSystem &p_jobs, const char *p_name, F &&p_func, uint32_t p_grain = 1024)
+        {
+            const Signature signature = MakeSignature<Ts...>();
+            const std::array<ComponentIndex, sizeof...(Ts)> components{ GetComponentIndex<Ts>()... };
+
+            for (const auto &archetype : m_archetypes)
+            {
+                if ((archetype->signature & signature) != signature || archetype->Size() == 0)
+                    continue;
+
+                Archetype &table = *archetype;
+                auto chunk = [&](uint32_t p_begin, uint32_t p_end)
+                {
+                    ForEachInArchetype<Ts...>(table, components, p_func, p_begin, p_end, std::index_sequence_for<Ts...>{});
+                };
+
+                p_jobs.ParallelFor(p_name, table.Size(), p_grain, chunk);
+            }
+        }
+
+        template<typename... Ts, typename F>
+        void ParallelForEach(const Query &p_query, JobSystem &p_jobs, const char *p_name, F &&p_func, uint32_t p_grain = 1024)
+        {
+            SDL_assert(CoversComponents<Ts...>(p_query) && "Query doesn't include every component asked for");
+
+            const std::array<ComponentIndex, sizeof...(Ts)> components{ GetComponentIndex<Ts>()... };
+
+            for (Archetype *archetype : p_query.GetArchetypes())
+            {
+                if (archetype->Size() == 0)
+                    continue;
+
+                Archetype &table = *archetype;
+                auto chunk = [&](uint32_t p_begin, uint32_t p_end)
+                {
+                    ForEachInArchetype<Ts...>(table, components, p_func, p_begin, p_end, std::index_sequence_for<Ts...>{});
+                };
+
+                p_jobs.ParallelFor(p_name, table.Size(), p_grain, chunk);
+            }
+        }
+
+    private:
+        struct EntityRecord
+        {
+            uint32_t   generation{ 1 };
+            bool       alive{};
+            Archetype *archetype{};
+            uint32_t   row{};
+        };
+
+        std::vector<EntityRecord> m_records{};
+        std::vector<uint32_t> m_freeIndices{};
+        uint32_t m_entityCount{};
+
+        std::array<ComponentInfo, MAX_COMPONENTS> m_components{};
+        uint32_t m_componentCount{};
+        std::vector<ComponentIndex> m_typeToComponent{};
+
+        std::vector<std::unique_ptr<Archetype>> m_archetypes{};
+        std::unordered_map<Signature, Archetype *> m_archetypeLookup{};
+        Archetype *m_emptyArchetype{};
+
+        std::vector<std::unique_ptr<Query>> m_queries{};
+        std::unordered_map<Signature, Query *> m_queryLookup{};
+
+    private:
+        Archetype *GetOrCreateArchetype(const Signature &p_signature);
+
+        // Moves the entity to the archetype matching p_signature and returns the
+        // unconstructed slot of p_added, or nullptr when nothing was added
+        void *MoveToArchetype(Entity p_entity, const Signature &p_signature, ComponentIndex p_added);
+
+        template<typename... Ts>
+        bool CoversComponents(const Query &p_query) const
+        {
+            const Signature signature = MakeSignature<Ts...>();
+            return (p_query.signature & signature) == signature;
+        }
+
+        template<typename... Ts, typename F, size_t... Is>
+        static void ForEachInArchetype(Archetype &p_archetype, const std::array<ComponentIndex, sizeof...(Ts)> &p_components, F &p_func,
+            uint32_t p_begin, uint32_t p_end, std::index_sequence<Is...>)
+        {
+            std::tuple<Ts *...> columns{ static_cast<Ts *>(p_archetype.GetColumn(p_components[Is]))... };
+
+            const Entity *entities = p_archetype.entities.data();
+
+            for (uint32_t i = p_begin; i < p_end; i++)
+            {
+                if constexpr (std::is_invocable_v<F &, Entity, Ts &...>)
+                    p_func(entities[i], std::get<Is>(columns)[i]...);
+                else
+                    p_func(std::get<Is>(columns)[i]...);
+            }
+        }
+
+        ECS(const ECS &) = delete;
+        ECS &operator=(const ECS &) = delete;
+    };
+}
+
+#endif // !ECS_H
@@ -8,17 +8,63 @@
 #include "renderer.hpp"
 #include "scene_manager.hpp"
 #include "asset_manager.hpp"
+#include "profiler.hpp"
 #include "debug_windows.hpp"
+#include "frame_arena.hpp"
+#include "job_system.hpp"
+#include "input_recorder.hpp"
+#include "rollback.hpp"
+#include "snapshot.hpp"
 
 namespace lum
 {
+    // Parsed from the command line before SDL is initialized
+    struct EngineConfig
+    {
+        bool        headless{};         // --headless, offscreen video and dummy audio drivers
+        bool        profileStartup{};   // --profile-startup, log a cost report and write a trace
+        bool        exitAfterStartup{}; // --exit-after-startup, quit once Init is done
+        const char *tracePath{ "startup_trace.json" }; // --trace <path>
+        float       tickRate{ 60.0f };  // --tick-rate <hz>, simulation steps per second
+        const char *scene{ "playground_lvl" }; // --scene <tag>, playground_lvl or test_ground, --loopback starts test_ground
+
+        const char *recordPath{};       // --record <path>, write the run's input for replay
+        const char *replayPath{};       // --replay <path>, play a recording back one tick per frame and exit
+        const char *benchOutPath{};     // --bench-out <path>, per system times of the replay or benchmark as csv
+        const char *benchmark{};        // --bench <name>, time a system on a synthetic load and exit, see benchmark.hpp
+        bool        noRender{};         // --no-render, skip drawing, for replays
+        bool        snapshots{};        // --snapshots, save the world every tick so it can be rewound
+
+        bool        loopback{};         // --loopback, play as player one against a scripted copy of the scene over a simulated network
+        float       netLatencyMS{ 50.0f }; // --net-latency <ms>, one way
+        float       netJitterMS{ 10.0f };  // --net-jitter <ms>
+        float       netLoss{ 0.05f };      // --net-loss <0-1>
+        uint32_t    inputDelay{ 2 };       // --input-delay <ticks>
+
+        const char *audioScript{};                         // --audio-render <script>, mix it offline and exit
+        const char *audioOutPath{ "audio_render.wav" };    // --audio-out <path>
+        const char *audioReferencePath{};                  // --audio-reference <path>, fail if the render differs
+        float       audioTolerance{ 1e-5f };               // --audio-tolerance <value>, max per sample difference
+    };
+
     class Engine
     {
     public:
+        // Frames after a scene change before heap allocations get flagged
+        static constexpr uint32_t HEAP_CHECK_WARMUP_FRAMES = 120;
+
+        // Ticks one frame may run to catch up, past that the backlog is dropped
+        // instead of every frame falling further behind
+        static constexpr uint32_t MAX_TICKS_PER_FRAME = 5;
+
+    public:
+        JobSystem jobSystem;
         Renderer renderer;
         AssetManager assetManager;
         SceneManager sceneManager;
         AudioManager audioManager;
+        Profiler profiler;
+        EngineConfig config;
 
         metrics::MetricsWindows metricsWindows;
 
@@ -30,14 +76,32 @@ namespace lum
         float engineTime{};
         float timeScalar{1.0f};
 
+        // Scenes update in fixed ticks, scaled time fills the accumulator and
+        // every whole tick in it runs. Draw blends the last two ticks by interpolation.
+        float fixedDeltaTime{ 1.0f / 60.0f };
+        float accumulator{};
+        float interpolation{};
+        uint64_t tick{};
+
         bool minimized{};
+        bool quitRequested{};
+
+        // Last ticks of the simulation, filled every tick with --snapshots
+        SnapshotRing snapshots;
+        bool rewinding{}; // Steps back through the ring instead of ticking
+
+        // Runs the ticks instead of the fixed step loop while it's running
+        RollbackSession session;
 
     public:
         Engine();
         ~Engine();
 
         static Engine &Get();
+        static EngineConfig ParseArgs(int p_argc, char **p_argv);
         bool Init();
+        bool RunAudioRender();
+        bool RunBenchmark();
         void Shutdown();
 
         void Input(SDL_Event *p_event);
@@ -46,9 +110,65 @@ namespace lum
 
         void HandleCommands(SDL_EventType p_type, SDL_Scancode p_scancode);
 
+        // Use instead of SDL_srand so recordings and replays see the same numbers
+        void SeedRandom(uint64_t p_seed);
+
+        // Simulation random numbers, their state is part of every snapshot
+        Sint32 Random(Sint32 p_n);
+        float RandomFloat();
+
+        // Saves the current scene, the tick and the random state into the ring
+        void SaveSnapshot();
+
+        // Puts all of it back as it was p_age saves ago. With p_discardNewer the
+        // snapshots after it are dropped, for stepping back or resimulating.
+        bool RestoreSnapshot(uint32_t p_age = 0, bool p_discardNewer = false);
+
     private:
         static std::unique_ptr<Engine> m_instance;
 
+        const Scene *m_steadyScene{};
+        uint32_t m_steadyFrames{};
+        uint64_t m_lastHeapWarning{};
+
+        InputRecorder m_input;
+        uint64_t m_randomState{};
+        const Scene *m_snapshotScene{};
+
+        // The other end of a --loopback session, a second copy of the scene
+        // pressing scripted input. Its tick, time and random state are swapped
+        // in while it runs, scenes only know the engine's.
+        LoopbackTransport m_localLink;
+        LoopbackTransport m_peerLink;
+        RollbackSession m_peer;
+        std::shared_ptr<Scene> m_peerScene{};
+        std::unique_ptr<SnapshotRing> m_peerSnapshots{};
+        uint64_t m_peerTick{};
+        float m_peerTime{};
+        uint64_t m_peerRandomState{};
+        uint64_t m_peerRandom{}; // The script's, not the simulation's
+        InputBits m_peerInput{};
+        uint32_t m_peerHold{};
+        uint64_t m_replayStartNS{};
+        uint64_t m_replayTickNS{};
+        uint64_t m_replayWorstTickNS{};
+
+    private:
+        void BeginFrame();
+        void EndFrame();
+        void DispatchCommand(SDL_Scancode p_scancode, CommandType p_type);
+        void FinishReplay();
+        bool CreatePeerScene();
+        void StartLoopbackSession();
+        InputBits NextPeerInput();
+        void SwapPeerWorld();
+
+        // The tick, time, random state and p_scene, what a snapshot holds
+        void SaveWorld(SnapshotRing &p_ring, const Scene &p_scene);
+        bool LoadWorld(SnapshotReader &p_reader, Scene &p_scene);
+        void AdvanceWorld(Scene &p_scene, const InputBits *p_inputs);
+        bool HashWorld(SnapshotRing &p_ring, uint64_t p_tick, uint64_t &p_outChecksum);
+
     private:
         Engine(const Engine &) = delete;
         Engine &operator=(const Engine &) = delete;
@@ -0,0 +1,127 @@
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <SDL3/SDL.h>
+
+// Counts general heap allocations on threads that ask for it, used to catch
+// mallocs sneaking into the steady state frame loop. On by default in debug.
+#if !defined(NDEBUG) && !defined(LUM_NO_HEAP_TRACKING)
+#define LUM_TRACK_HEAP
+#endif
+
+namespace lum
+{
+    struct FrameArenaStats
+    {
+        size_t capacity{};
+        size_t used{};          // Bytes handed out so far this frame
+        size_t lastFrameUsed{}; // High-water mark of the previous frame
+        size_t peak{};          // Highest frame since startup
+        size_t overflowBytes{}; // Served from the heap because the block ran out
+    };
+
+    // Bump pointer allocator for data that only lives until the end of the frame.
+    // Every thread gets its own arena through Get, which resets itself the first
+    // time it's used after BeginFrame, so nothing allocated from it may be kept
+    // across frames. Freeing individual allocations does nothing.
+    //
+    // Running out of space falls back to the heap for the rest of the frame and
+    // the block grows to fit on the next reset, so a steady state frame ends up
+    // never touching the heap.
+    class FrameArena
+    {
+    public:
+        static constexpr size_t DEFAULT_CAPACITY = 1024 * 1024;
+
+    public:
+        explicit FrameArena(size_t p_capacity = DEFAULT_CAPACITY);
+        ~FrameArena();
+
+        void *Allocate(size_t p_size, size_t p_alignment = alignof(std::max_align_t));
+
+        template<typename T>
+        T *AllocateArray(size_t p_count)
+        {
+            return static_cast<T *>(Allocate(sizeof(T) * p_count, alignof(T)));
+        }
+
+        // Formats into arena memory, handy for paths and labels built every frame
+        const char *Format(SDL_PRINTF_FORMAT_STRING const char *p_fmt, ...) SDL_PRINTF_VARARG_FUNC(2);
+
+        void Reset();
+        FrameArenaStats GetStats() const;
+
+        // Arena of the calling thread
+        static FrameArena &Get();
+
+        // Starts a new frame for every thread's arena, main thread only
+        static void BeginFrame();
+
+    private:
+        uint8_t *m_block{};
+        size_t m_capacity{};
+        size_t m_offset{};
+        size_t m_lastFrameUsed{};
+        size_t m_peak{};
+
+        std::vector<void *> m_overflow{};
+        size_t m_overflowBytes{};
+
+        uint64_t m_frame{};
+
+    private:
+        FrameArena(const FrameArena &) = delete;
+        FrameArena &operator=(const FrameArena &) = delete;
+    };
+
+    // Lets std containers allocate from the calling thread's frame arena
+    template<typename T>
+    class FrameAllocator
+    {
+    public:
+        using value_type = T;
+
+    public:
+        FrameAllocator() noexcept = default;
+
+        template<typename U>
+        FrameAllocator(const FrameAllocator<U> &) noexcept {}
+
+        T *allocate(size_t p_count)
+        {
+            return FrameArena::Get().AllocateArray<T>(p_count);
+        }
+
+        void deallocate(T *, size_t) noexcept {}
+
+        template<typename U>
+        bool operator==(const FrameAllocator<U> &) const noexcept { return true; }
+
+        template<typename U>
+        bool operator!=(const FrameAllocator<U> &) const noexcept { return false; }
+    };
+
+    template<typename T>
+    using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+    using FrameString = std::basic_string<char, std::char_traits<char>, FrameAllocator<char>>;
+
+    // HEAP TRACKING
+    //
+    // Counts operator new and SDL_malloc, SDL_calloc and SDL_realloc calls on
+    // the calling thread between Begin and End. SDL's allocator is only counted
+    // once TrackSDLAllocations has run. Compiles to nothing without LUM_TRACK_HEAP.
+
+    namespace heap
+    {
+        void TrackSDLAllocations();
+        void BeginTracking();
+        uint32_t EndTracking();
+    }
+}
+
+#endif // !FRAME_ARENA_H
@@ -0,0 +1,81 @@
+#ifndef INPUT_RECORDER_H
+#define INPUT_RECORDER_H
+
+#include <vector>
+
+#include <SDL3/SDL.h>
+
+namespace lum
+{
+    enum class InputEventType : uint8_t
+    {
+        COMMAND_START,
+        COMMAND_END,
+        SEED,
+    };
+
+    // Scancode for commands, the seed for seeds
+    struct InputEvent
+    {
+        uint64_t       tick{};
+        InputEventType type{};
+        uint64_t       value{};
+    };
+
+    // Records the bound key presses and random seeds of a run against the tick
+    // they happened before, and plays them back. With a fixed timestep that is
+    // everything a scene sees, so a replay goes through the exact same ticks.
+    //
+    // File layout, little endian: magic, version, tick rate, start seed, length
+    // in ticks, event count, then every event as a varint tick delta, a type
+    // byte and a varint value.
+    class InputRecorder
+    {
+    public:
+        static constexpr uint32_t MAGIC = 0x524D554C; // "LUMR"
+        static constexpr uint16_t VERSION = 1;
+
+    public:
+        InputRecorder();
+        ~InputRecorder();
+
+        void StartRecording(const char *p_path, float p_tickRate, uint64_t p_seed);
+        void Record(uint64_t p_tick, InputEventType p_type, uint64_t p_value);
+        bool StopRecording(uint64_t p_length);
+
+        bool LoadReplay(const char *p_path);
+
+        // Next command due at p_tick, false once there are none left for it
+        bool PollCommand(uint64_t p_tick, InputEvent &p_outEvent);
+
+        // Seeds come back in the order they were recorded, whatever tick asks
+        bool PollSeed(uint64_t &p_outSeed);
+
+        bool IsRecording() const;
+        bool IsReplaying() const;
+        bool IsReplayFinished(uint64_t p_tick) const;
+
+        float GetTickRate() const;
+        uint64_t GetSeed() const;
+        uint64_t GetLength() const;
+
+    private:
+        const char *m_recordPath{};
+        bool m_replaying{};
+
+        float m_tickRate{};
+        uint64_t m_seed{};
+        uint64_t m_length{};
+
+        std::vector<InputEvent> m_events{};
+        std::vector<uint64_t> m_seeds{};
+        size_t m_nextEvent{};
+        size_t m_nextSeed{};
+
+    private:
+        InputRecorder(const InputRecorder &) = delete;
+        InputRecorder &operator=(const InputRecorder &) = delete;
+    };
+}
+
+#endif // !INPUT_RECORDER_H
@@ -0,0 +1,145 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <array>
+#include <atomic>
+#include <vector>
+
+#include <SDL3/SDL.h>
+
+namespace lum
+{
+    // Number of jobs still running for something, waited on with JobSystem::Wait
+    class JobCounter
+    {
+    public:
+        bool IsDone() const { return m_pending.load(std::memory_order_acquire) == 0; }
+
+    private:
+        std::atomic<int32_t> m_pending{};
+
+        friend class JobSystem;
+    };
+
+    // A function over a range, the data pointer has to stay valid until the
+    // counter it was submitted with is done
+    struct Job
+    {
+        void (*func)(void *p_data, uint32_t p_begin, uint32_t p_end){};
+        void       *data{};
+        uint32_t    begin{};
+        uint32_t    end{};
+        JobCounter *counter{};
+        const char *name{}; // Timings are grouped by this pointer
+    };
+
+    struct JobTiming
+    {
+        const char *name{};
+        uint32_t    count{};
+        float       totalMS{};
+        float       maxMS{};
+    };
+
+    // Fixed pool of worker threads, each with its own deque. Owners push and pop
+    // at the bottom, idle workers steal from the top of someone else's. The main
+    // thread owns deque zero and helps out while it waits, so with zero workers
+    // everything just runs inline.
+    class JobSystem
+    {
+    public:
+        static constexpr uint32_t MAX_THREADS = 32; // Main thread included
+        static constexpr uint32_t DEQUE_CAPACITY = 1024;
+        static constexpr uint32_t MAX_TIMED_JOBS = 32;
+
+    public:
+        JobSystem();
+        ~JobSystem();
+
+        // Zero workers means one per core besides the main thread
+        bool Init(uint32_t p_workerCount = 0);
+        void Shutdown();
+
+        uint32_t GetWorkerCount() const;
+
+        void Submit(const Job &p_job);
+
+        // Runs other jobs until the counter reaches zero
+        void Wait(JobCounter &p_counter);
+
+        // Splits [0, p_count) into chunks of p_grain and calls p_func(begin, end)
+        // for each, p_func has to outlive the wait on p_counter
+        template<typename F>
+        void ParallelFor(const char *p_name, uint32_t p_count, uint32_t p_grain, F &p_func, JobCounter &p_counter)
+        {
+            const uint32_t grain = SDL_max(p_grain, 1u);
+
+            for (uint32_t begin = 0; begin < p_count; begin += grain)
+            {
+                Job job{};
+                job.func = [](void *p_data, uint32_t p_begin, uint32_t p_end) { (*static_cast<F *>(p_data))(p_begin, p_end); };
+                job.data = &p_func;
+                job.begin = begin;
+                job.end = SDL_min(begin + grain, p_count);
+                job.counter = &p_counter;
+                job.name = p_name;
+
+                Submit(job);
+            }
+        }
+
+        template<typename F>
+        void ParallelFor(const char *p_name, uint32_t p_count, uint32_t p_grain, F &&p_func)
+        {
+            JobCounter counter{};
+            ParallelFor(p_name, p_count, p_grain, p_func, counter);
+            Wait(counter);
+        }
+
+        // Per name timings since the last call, merged over every thread
+        void CollectTimings(std::vector<JobTiming> &p_outTimings);
+
+    private:
+        struct alignas(64) WorkerQueue
+        {
+            SDL_SpinLock lock{};
+            uint32_t top{};
+            uint32_t bottom{};
+            std::array<Job, DEQUE_CAPACITY> jobs{};
+
+            SDL_SpinLock timingLock{};
+            uint32_t timingCount{};
+            std::array<JobTiming, MAX_TIMED_JOBS> timings{};
+        };
+
+        struct WorkerStart
+        {
+            JobSystem *system{};
+            uint32_t   index{};
+        };
+
+        std::array<WorkerQueue, MAX_THREADS> m_queues{};
+        std::array<WorkerStart, MAX_THREADS> m_starts{};
+        std::vector<SDL_Thread *> m_threads{};
+        uint32_t m_threadCount{ 1 };
+
+        SDL_Semaphore *m_wake{};
+        std::atomic<bool> m_running{};
+        std::atomic<int32_t> m_queued{};
+        std::atomic<int32_t> m_sleeping{};
+
+    private:
+        bool Pop(uint32_t p_queue, Job &p_outJob);
+        bool Steal(uint32_t p_thief, Job &p_outJob);
+        bool TryRunOne(uint32_t p_queue);
+        void Execute(uint32_t p_queue, const Job &p_job);
+
+        static uint32_t GetThreadIndex();
+        static int SDLCALL WorkerMain(void *p_data);
+
+        JobSystem(const JobSystem &) = delete;
+        JobSystem &operator=(const JobSystem &) = delete;
+    };
+}
+
+#endif // !JOB_SYSTEM_H
@@ -0,0 +1,214 @@
+#ifndef MIXER_H
+#define MIXER_H
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <SDL3/SDL.h>
+
+#include "asset_types.hpp"
+#include "audio_effects.hpp"
+#include "spsc_queue.hpp"
+
+namespace lum
+{
+	class MusicStream;
+
+	// Refers to one playback of a sound. Ids are never reused, calls with the
+	// handle of a finished voice do nothing.
+	struct VoiceHandle
+	{
+		uint32_t id{}; // Zero is never a voice
+
+		explicit operator bool() const { return id != 0; }
+	};
+
+	enum class AudioCommandType : uint8_t
+	{
+		PLAY,
+		STOP_VOICE,
+		SET_VOICE_GAIN,
+		SET_VOICE_PITCH,
+		STOP_BUS,
+		SET_BUS_PAUSED,
+		SET_SOUND_PLAYBACK
+	};
+
+	// Game to mixer message, plain data so it can go through the command ring
+	struct AudioCommand
+	{
+		AudioCommandType type{};
+		uint8_t          bus{};
+		SoundId          sound{};
+		uint32_t         voice{};
+		float            gain{};
+		float            pitch{};
+		SoundPlayback    playback{};
+		bool             paused{};
+	};
+
+	struct MixerStats
+	{
+		uint32_t activeVoices{};
+		uint32_t maxVoices{};
+		float    mixTimeMS{};  // Time spent in the last mix callback
+		float    blockTimeMS{}; // Audio length produced by that callback
+		uint32_t droppedCommands{};
+	};
+
+	// Software mixer feeding a single device stream. Sounds play on a fixed pool
+	// of voices that read straight from the Sound sample data and get summed into
+	// their bus. Buses run their effect chain and gain, then sum into their parent
+	// bus, bus 0 is the master and writes the output. Sounds are already in the
+	// mix format, so there's no conversion at runtime.
+	//
+	// Playing, stopping and adjusting voices and pausing buses only push a
+	// command on a lock free ring that the mix callback drains, so they never block and must all come
+	// from the same thread. Bus gains and effect parameters are atomics smoothed
+	// on the audio thread. Registering sounds and changing the bus graph are rare
+	// and take the stream lock, the mix callback runs with it held.
+	class Mixer
+	{
+	public:
+		static constexpr uint32_t MAX_VOICES = 64;
+		static constexpr uint32_t MAX_BUSES = 16;
+		static constexpr uint32_t MAX_BUS_EFFECTS = 8;
+		static constexpr uint8_t MASTER_BUS = 0;
+		static constexpr uint32_t MAX_SOUNDS = 512;
+		static constexpr uint32_t COMMAND_QUEUE_SIZE = 256;
+		static constexpr uint32_t MAX_FRAME_TRIGGERS = COMMAND_QUEUE_SIZE;
+		static constexpr float MIN_PITCH = 0.125f;
+		static constexpr float MAX_PITCH = 8.0f;
+		static constexpr uint32_t MIX_BLOCK_FRAMES = 256;
+
+	public:
+		Mixer();
+		~Mixer();
+
+		bool Init(SDL_AudioDeviceID p_device);
+		bool InitOffline(const SDL_AudioSpec &p_spec);
+		void Shutdown();
+
+		// Offline only, mixes straight into p_out on the calling thread
+		void Render(float *p_out, uint32_t p_frames);
+
+		const SDL_AudioSpec &GetSpec() const;
+
+		SoundId RegisterSound(const Sound &p_sound);
+		void UnregisterSound(SoundId p_sound);
+		bool IsSoundPlaying(SoundId p_sound) const;
+
+		// Applies to voices the sound starts from now on
+		void SetSoundPlayback(SoundId p_sound, const SoundPlayback &p_playback);
+
+		void BeginFrame();
+
+		// Invalid handle if the command ring is full and the sound won't play
+		VoiceHandle PlaySound(SoundId p_sound, uint8_t p_bus, float p_gain = 1.0f, float p_pitch = 1.0f);
+		void StopVoice(VoiceHandle p_voice);
+		void SetVoiceGain(VoiceHandle p_voice, float p_gain);
+		void SetVoicePitch(VoiceHandle p_voice, float p_pitch);
+		bool IsVoicePlaying(VoiceHandle p_voice) const;
+		int32_t CreateBus(uint8_t p_parent);
+		AudioEffect *AddBusEffect(uint8_t p_bus, std::unique_ptr<AudioEffect> p_effect);
+		void StopBus(uint8_t p_bus);
+		void SetBusGain(uint8_t p_bus, float p_gain);
+		void SetBusPaused(uint8_t p_bus, bool p_paused);
+		void SetBusMusic(uint8_t p_bus, MusicStream *p_music);
+
+		MixerStats GetStats() const;
+
+	private:
+		// Written under the stream lock, the active voice count by the mixer only
+		struct SoundSlot
+		{
+			const float          *samples{};
+			uint32_t              frameCount{};
+			SoundPlayback         playback{};
+			uint16_t              generation{};
+			bool                  used{};
+			std::atomic<uint32_t> activeVoices{};
+		};
+
+		struct Voice
+		{
+			const float *samples{};
+			uint32_t     frameCount{};
+			uint32_t     position{};
+			float        fraction{}; // Between samples while pitched
+			float        gain{ 1.0f };
+			float        pitch{ 1.0f };
+			uint64_t     startOrder{};
+			uint32_t     id{};
+			uint16_t     slot{};
+			uint8_t      priority{};
+			uint8_t      bus{};
+			bool         active{};
+		};
+
+		// Sounds started since the last BeginFrame, repeated triggers of one of
+		// them are folded into the voice already playing it. Game thread only.
+		struct FrameTrigger
+		{
+			SoundId     sound{};
+			uint8_t     bus{};
+			VoiceHandle voice{};
+			float       gainSquared{};
+		};
+
+		// Children always have a higher index than their parent, so walking the
+		// buses backwards finishes every child before its parent gets processed
+		struct Bus
+		{
+			SmoothedParam      gain{ 1.0f };
+			uint8_t            parent{};
+			bool               used{};
+			bool               paused{};
+			MusicStream       *music{};
+			std::vector<float> buffer{};
+			std::vector<std::unique_ptr<AudioEffect>> effects{};
+		};
+
+		SDL_AudioStream *m_stream{};
+		SDL_AudioSpec m_spec{};
+
+		std::array<Voice, MAX_VOICES> m_voices{};
+		std::array<Bus, MAX_BUSES> m_buses{};
+		std::array<float, MAX_BUSES> m_busPeaks{}; // Mix callback only
+		std::array<SoundSlot, MAX_SOUNDS> m_sounds{};
+		std::vector<FrameTrigger> m_frameTriggers{};
+		uint64_t m_playOrder{};
+		uint32_t m_nextVoiceId{ 1 };
+
+		SpscQueue<AudioCommand, COMMAND_QUEUE_SIZE> m_commands{};
+		std::array<std::atomic<uint32_t>, MAX_VOICES> m_voiceIds{}; // Published by the mixer for IsVoicePlaying
+		std::atomic<uint32_t> m_droppedCommands{};
+
+		// Scratch buffers, only touched by the mix callback
+		std::vector<float> m_mixBuffer{};
+		std::vector<float> m_musicBuffer{};
+
+		std::atomic<uint32_t> m_activeVoices{};
+		std::atomic<uint64_t> m_mixTimeNS{};
+		std::atomic<uint32_t> m_mixedFrames{};
+
+	private:
+		bool CreateStream(const SDL_AudioSpec &p_outSpec);
+		static void SDLCALL MixCallback(void *p_userdata, SDL_AudioStream *p_stream, int p_additionalAmount, int p_totalAmount);
+		void Mix(float *p_out, uint32_t p_frames);
+		void MixVoice(Voice &p_voice, float *p_out, uint32_t p_frames);
+		bool PushCommand(const AudioCommand &p_command);
+		void ProcessCommands();
+		void StartVoice(const AudioCommand &p_command);
+		void ReleaseVoice(uint32_t p_index);
+		Voice *FindVoice(uint32_t p_id);
+		int32_t PickVoiceToSteal(const SoundSlot &p_sound, uint16_t p_slot, bool p_sameSoundOnly) const;
+
+		Mixer(const Mixer &) = delete;
+		Mixer &operator=(const Mixer &) = delete;
+	};
+}
+
+#endif // !MIXER_H
@@ -0,0 +1,74 @@
+#ifndef MUSIC_STREAM_H
+#define MUSIC_STREAM_H
+
+#include <atomic>
+#include <vector>
+
+#include <SDL3/SDL.h>
+#include <vorbis/vorbisfile.h>
+
+#include "asset_types.hpp"
+
+namespace lum
+{
+	// Plays a Music asset by decoding it ahead on a worker thread into a small
+	// ring buffer, already converted to the mixer format. The mixer pulls from
+	// the ring as it drains, so the memory used doesn't depend on the length of
+	// the track.
+	class MusicStream
+	{
+	public:
+		static constexpr uint32_t RING_BUFFER_FRAMES = 16 * 1024;
+		static constexpr uint32_t DECODE_CHUNK_SIZE = 4096;
+
+	public:
+		MusicStream();
+		~MusicStream();
+
+		bool Init(const Music &p_music, const SDL_AudioSpec &p_mixSpec, bool p_loop);
+		void Shutdown();
+
+		uint32_t Read(float *p_out, uint32_t p_frames);
+		void Seek(double p_seconds);
+		void Pause();
+		void Resume();
+		bool IsFinished() const;
+
+		static bool OpenVorbisFile(const char *p_path, OggVorbis_File *p_outFile);
+
+	private:
+		SDL_AudioStream *m_converter{}; // Decoder thread only, resamples to the mix format
+		SDL_Thread *m_decoderThread{};
+		SDL_Semaphore *m_drained{};
+
+		OggVorbis_File m_vorbisFile{};
+		bool m_vorbisOpen{};
+		bool m_endOfFile{};
+		SDL_AudioSpec m_audioSpec{};
+		SDL_AudioSpec m_mixSpec{};
+		bool m_loop{};
+
+		std::vector<char> m_decodeBuffer{};
+		std::vector<float> m_ring{};
+		uint32_t m_ringSamples{};
+		std::atomic<uint64_t> m_readPos{};
+		std::atomic<uint64_t> m_writePos{};
+		std::atomic<uint64_t> m_discardPos{}; // Set on seek, the reader skips everything before it
+
+		std::atomic<int64_t> m_seekFrame{ -1 };
+		std::atomic<bool> m_quit{};
+		std::atomic<bool> m_paused{};
+		std::atomic<bool> m_decodeFinished{};
+
+	private:
+		static int DecoderMain(void *p_data);
+
+		void Decode();
+		void ApplySeek(int64_t p_frame);
+
+		MusicStream(const MusicStream &) = delete;
+		MusicStream &operator=(const MusicStream &) = delete;
+	};
+}
+
+#endif // !MUSIC_STREAM_H
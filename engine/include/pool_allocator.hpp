@@ -0,0 +1,125 @@
+#ifndef POOL_ALLOCATOR_H
+#define POOL_ALLOCATOR_H
+
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <SDL3/SDL.h>
+
+#include "type_id.hpp"
+
+namespace lum
+{
+    struct PoolStats
+    {
+        const char *name{};
+        size_t   slotSize{};
+        uint32_t slabCount{};
+        uint32_t capacity{};
+        uint32_t used{};
+        uint32_t peak{};
+        float    occupancy{};     // used / capacity
+        float    fragmentation{}; // Free slots stuck in slabs that can't be released, over capacity
+    };
+
+    // Hands out fixed size slots carved from large slabs. Every slab keeps its own
+    // free list and allocations always come from the lowest slab with room, so
+    // live objects pack towards the front and the back slabs drain and can be
+    // released by Compact. Objects never move, pointers stay valid until freed.
+    // Game thread only.
+    class PoolAllocator
+    {
+    public:
+        static constexpr uint32_t DEFAULT_SLOTS_PER_SLAB = 256;
+
+    public:
+        PoolAllocator(const char *p_name, size_t p_slotSize, size_t p_alignment, uint32_t p_slotsPerSlab = DEFAULT_SLOTS_PER_SLAB);
+        ~PoolAllocator();
+
+        // Returns nullptr when a new slab can't be allocated
+        void *Allocate();
+        void Free(void *p_ptr);
+
+        // Releases every empty slab, keeping p_keepEmpty of them around for the
+        // next burst of allocations
+        void Compact(uint32_t p_keepEmpty = 1);
+
+        // Compact whenever the pool is less than this full, zero turns it off
+        void SetAutoCompactThreshold(float p_occupancy);
+
+        PoolStats GetStats() const;
+
+        static const std::vector<PoolAllocator *> &GetAll();
+
+    private:
+        struct Slab
+        {
+            uint8_t *memory{};
+            void    *freeList{};
+            uint32_t used{};
+        };
+
+        const char *m_name{};
+        size_t   m_slotSize{};
+        size_t   m_alignment{};
+        uint32_t m_slotsPerSlab{};
+
+        // Sorted by address so Free can find the owner with a binary search
+        std::vector<Slab> m_slabs{};
+        size_t   m_firstFree{}; // Lowest slab that may have a free slot
+        uint32_t m_used{};
+        uint32_t m_peak{};
+        float    m_autoCompact{};
+
+    private:
+        size_t FindSlab(const void *p_ptr) const;
+        size_t AddSlab();
+
+        static std::vector<PoolAllocator *> &Registry();
+
+        PoolAllocator(const PoolAllocator &) = delete;
+        PoolAllocator &operator=(const PoolAllocator &) = delete;
+    };
+
+    // One pool per type, created on first use. Never destroyed, objects held by
+    // other statics (the engine and its scenes) can still be freed at exit.
+    template<typename T>
+    PoolAllocator &GetPool()
+    {
+        static PoolAllocator *pool = new PoolAllocator(TypeName<T>(), sizeof(T), alignof(T));
+        return *pool;
+    }
+
+    // Deleter for pooled objects, remembers the pool and the exact block so it
+    // also works through a base class pointer
+    struct PoolDeleter
+    {
+        PoolAllocator *pool{};
+        void          *block{};
+
+        template<typename T>
+        void operator()(T *p_ptr) const
+        {
+            p_ptr->~T();
+            pool->Free(block);
+        }
+    };
+
+    template<typename T>
+    using PoolPtr = std::unique_ptr<T, PoolDeleter>;
+
+    template<typename T, typename... Args>
+    PoolPtr<T> MakePooled(Args&&... p_args)
+    {
+        PoolAllocator &pool = GetPool<T>();
+        void *block = pool.Allocate();
+        if (!block)
+            return nullptr;
+
+        return PoolPtr<T>(new (block) T(std::forward<Args>(p_args)...), PoolDeleter{ &pool, block });
+    }
+}
+
+#endif // !POOL_ALLOCATOR_H
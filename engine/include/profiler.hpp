@@ -0,0 +1,86 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include <SDL3/SDL.h>
+
+namespace lum
+{
+    enum class ProfilePhase
+    {
+        INIT,
+        FILE_READ,
+        DECODE,
+        FORMAT_CONVERT,
+        GPU_UPLOAD,
+        SHADER_COMPILE,
+        PIPELINE_CREATE,
+        SCENE_SETUP,
+        COUNT
+    };
+
+    struct ProfileEvent
+    {
+        ProfilePhase phase{};
+        std::string  name{};
+        uint64_t     startNS{};
+        uint64_t     durationNS{};
+        SDL_ThreadID threadId{};
+    };
+
+    // Collects timed scopes while a capture is running. Meant for startup and
+    // loading, not per frame work, every scope takes the lock once.
+    class Profiler
+    {
+    public:
+        Profiler();
+        ~Profiler();
+
+        void BeginCapture();
+        void EndCapture();
+        bool IsCapturing() const;
+
+        void Record(ProfilePhase p_phase, const char *p_name, uint64_t p_startNS, uint64_t p_durationNS);
+        void LogReport() const;
+        bool WriteTrace(const char *p_path) const;
+
+        static const char *GetPhaseName(ProfilePhase p_phase);
+
+    private:
+        SDL_Mutex *m_mutex{};
+        std::atomic<bool> m_capturing{};
+        uint64_t m_captureStartNS{};
+        uint64_t m_captureEndNS{};
+        std::vector<ProfileEvent> m_events{};
+
+    private:
+        // Names come from tags and paths, anything can be in them
+        static std::string EscapeJson(const std::string &p_str);
+
+        Profiler(const Profiler &) = delete;
+        Profiler &operator=(const Profiler &) = delete;
+    };
+
+    // Times the enclosing block and records it on the engine profiler
+    class ProfileScope
+    {
+    public:
+        ProfileScope(ProfilePhase p_phase, const char *p_name);
+        ~ProfileScope();
+
+    private:
+        ProfilePhase m_phase{};
+        const char *m_name{};
+        uint64_t m_startNS{};
+        bool m_active{};
+
+    private:
+        ProfileScope(const ProfileScope &) = delete;
+        ProfileScope &operator=(const ProfileScope &) = delete;
+    };
+}
+
+#endif // !PROFILER_H
@@ -0,0 +1,156 @@
+#ifndef PROJECTILES_H
+#define PROJECTILES_H
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "string_id.hpp"
+
+namespace lum
+{
+    class CollisionWorld;
+    class Renderer;
+    struct QuadInstance;
+    class SnapshotReader;
+    class SnapshotWriter;
+
+    enum class EmitterPatternType
+    {
+        RADIAL, // Volley centred on a fixed angle
+        SPIRAL, // Like radial, the angle turns by spin every volley
+        AIMED,  // Volley centred on the direction to the target
+    };
+
+    // What an emitter fires, plain data so patterns can live in tables. Angles
+    // are in degrees, zero points right and ninety points up.
+    struct EmitterPattern
+    {
+        EmitterPatternType type{};
+        uint32_t bullets{ 1 };     // Per volley, spread evenly over the spread
+        float    spread{ 360.0f }; // A full circle leaves no gap between first and last
+        float    angle{ -90.0f };  // Offset from the target direction when aimed
+        float    spin{};           // Per volley, spiral only
+        float    interval{ 0.1f }; // Seconds between volleys
+        float    speed{ 100.0f };
+        float    acceleration{};   // Along the direction fired
+        float    turnRate{};       // Degrees per second the bullets curve
+        float    lifetime{ 5.0f };
+        float    frame{};
+    };
+
+    // Running state of one pattern, fed to ProjectileManager::UpdateEmitter
+    struct Emitter
+    {
+        EmitterPattern pattern{};
+        glm::vec2 position{ 0.0f };
+        glm::vec2 target{ 0.0f };
+        float     timer{};
+        uint32_t  volley{};
+        bool      active{ true };
+    };
+
+    struct ProjectileStats
+    {
+        uint32_t live{};
+        uint32_t capacity{};
+        uint32_t peak{};
+        uint32_t spawned{};   // Between the last two updates
+        uint32_t despawned{}; // By the last update
+        float    updateMS{};
+    };
+
+    // Bullets kept as parallel arrays instead of actors, so stepping thousands of
+    // them is a couple of straight passes with no allocation or virtual call per
+    // bullet. Dead and off screen bullets are dropped in one compaction pass that
+    // keeps the rest in spawn order, which keeps the draw order stable.
+    //
+    // The pool starts empty and doubles when a spawn finds it full, up to
+    // MAX_CAPACITY. Scenes that know their peak reserve it in Setup so the
+    // growth doesn't land in the middle of play.
+    //
+    // Indices are only valid until the next Update.
+    class ProjectileManager
+    {
+    public:
+        static constexpr uint32_t MIN_CAPACITY = 1024;
+        static constexpr uint32_t MAX_CAPACITY = 65536;
+        static constexpr float DEFAULT_MARGIN = 16.0f;
+
+    public:
+        ProjectileManager();
+        ~ProjectileManager();
+
+        // Grows the pool to hold at least p_capacity bullets, keeping the live ones.
+        // False past MAX_CAPACITY or when the allocation fails.
+        bool Reserve(uint32_t p_capacity);
+
+        // Bullets further than p_margin outside these are despawned
+        void SetBounds(glm::vec2 p_min, glm::vec2 p_max, float p_margin = DEFAULT_MARGIN);
+
+        // False when the pool is full and can't grow
+        bool Spawn(glm::vec2 p_position, glm::vec2 p_velocity, glm::vec2 p_acceleration = glm::vec2(0.0f),
+            float p_turnRate = 0.0f, float p_lifetime = 5.0f, float p_frame = 0.0f);
+
+        // Fires one volley of the pattern centred on p_angle, returns how many fit
+        uint32_t Fire(const EmitterPattern &p_pattern, glm::vec2 p_origin, float p_angle);
+
+        // Fires every volley that came due over p_delta
+        void UpdateEmitter(Emitter &p_emitter, float p_delta);
+
+        // Marks a bullet for removal on the next update, for hits
+        void Kill(uint32_t p_index);
+        void Clear();
+
+        void Update(float p_delta);
+
+        // Adds every bullet to the collision world as a circle, the user value is its index
+        void AddColliders(CollisionWorld &p_world, float p_radius, uint32_t p_layers, uint32_t p_mask) const;
+
+        // Writes every bullet straight into the renderer's instance buffer, placed
+        // p_interpolation of the way from the previous update to the last one.
+        // Bullets spawned since the last update are drawn where they spawned.
+        void Draw(Renderer &p_renderer, StringId p_textureTag, int p_horizontalFrames, uint8_t p_layer, float p_interpolation = 1.0f) const;
+
+        // What Draw writes, into any buffer with room for GetCount instances
+        void WriteInstances(QuadInstance *p_instances, float p_interpolation) const;
+
+        // Live bullets only, one copy per array
+        void SaveState(SnapshotWriter &p_writer) const;
+        bool LoadState(SnapshotReader &p_reader);
+
+        uint32_t GetCount() const;
+        glm::vec2 GetPosition(uint32_t p_index) const;
+        ProjectileStats GetStats() const;
+
+    private:
+        uint32_t m_capacity{};
+        uint32_t m_count{};
+        uint32_t m_spawned{};
+        float m_lastDelta{};
+
+        float *m_px{};
+        float *m_py{};
+        float *m_vx{};
+        float *m_vy{};
+        float *m_ax{};
+        float *m_ay{};
+        float *m_turnRate{};
+        float *m_life{};
+        float *m_frame{};
+        std::vector<uint8_t> m_keep{};
+
+        glm::vec2 m_min{ 0.0f };
+        glm::vec2 m_max{ 0.0f };
+
+        ProjectileStats m_stats{};
+
+    private:
+        void Compact();
+
+        ProjectileManager(const ProjectileManager &) = delete;
+        ProjectileManager &operator=(const ProjectileManager &) = delete;
+    };
+}
+
+#endif // !PROJECTILES_H
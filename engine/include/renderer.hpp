@@ -28,6 +28,9 @@ namespace lum
     {
         friend AssetManager;
 
+    public:
+        static constexpr uint32_t MAX_QUAD_INSTANCES = 65536; // Per frame, over every batch
+
     public:
         WindowDesc windowDesc{};
         SDL_GPUDevice *gpuDevice{};
@@ -49,7 +52,26 @@ namespace lum
         void DrawSprite(shmup::cDrawable *p_drawable);
         void DrawAnimSprite(shmup::cDrawable *p_drawable);
 
+        // Reserves room for p_count quads drawn with one instanced call on p_layer,
+        // the caller fills every one of them straight into the upload buffer.
+        // Null when the frame is out of instances.
+        QuadInstance *AddInstancedQuads(StringId p_textureTag, int p_horizontalFrames, uint8_t p_layer, uint32_t p_count);
+
+        SDL_GPUGraphicsPipeline *BuildGraphicsPipeline(SDL_GPUShader *p_vertShader, SDL_GPUShader *p_fragShader, VertexLayout p_layout = VertexLayout::QUAD) const;
+
     private:
+        static constexpr StringId TEXTURE_QUAD_PIPELINE = "texture_quad"_sid;
+        static constexpr StringId INSTANCED_QUAD_PIPELINE = "instanced_quad"_sid;
+
+        struct InstanceBatch
+        {
+            StringId textureTag{};
+            int      horizontalFrames{};
+            uint8_t  layer{};
+            uint32_t first{};
+            uint32_t count{};
+        };
+
         bool m_windowFullscreen{};
 
         mat4 m_modelMat{ 1.0 };
@@ -57,6 +79,7 @@ namespace lum
         mat4 m_projMat{};
 
         SDL_Window *m_window{};
+        SDL_GPUTextureFormat m_swapchainTextureFormat{};
 
         SDL_GPURenderPass *m_renderPass{};
         SDL_GPUCommandBuffer *m_commandBuffer{};
@@ -65,6 +88,10 @@ namespace lum
         SDL_GPUBuffer *m_rtIndexBuffer{};
         SDL_GPUBuffer *m_quadVertexBuffer{};
         SDL_GPUBuffer *m_quadIndexBuffer{};
+        SDL_GPUBuffer *m_instanceBuffer{};
+        SDL_GPUTransferBuffer *m_instanceTransferBuffer{};
+        QuadInstance *m_mappedInstances{};
+        uint32_t m_instanceCount{};
 
         SDL_GPUSampler *m_rtSampler{};
 
@@ -74,16 +101,21 @@ namespace lum
 
         // std::vector<DrawDesc> m_frameDrawQueue{};
         std::vector<shmup::cDrawable *> m_drawQueue{};
-        std::unordered_map<uint32_t, GraphicPipelineInfo> m_graphicsPipelines{};
+        std::vector<InstanceBatch> m_instanceBatches{};
+        std::unordered_map<StringId, GraphicPipelineInfo> m_graphicsPipelines{};
+        std::vector<AssetHandle<Shader>> m_shaderHandles{};
 
         SDL_GPUGraphicsPipeline *currentPipelineBinded{ nullptr };
 
     private:
         bool CreateWindowAndGPUDevice();
-        bool CreateGraphicsPipeline(const char *p_tag, const char *p_vertTag, const char *p_fragTag, bool p_reload = false);
+        bool CreateGraphicsPipeline(const char *p_tag, const char *p_vertTag, const char *p_fragTag, VertexLayout p_layout = VertexLayout::QUAD, bool p_reload = false);
         SDL_GPUBuffer *CreateGPUBuffer(SDL_GPUBufferUsageFlags p_usage, uint32_t p_size, const char *p_debugName) const;
         bool SetupRenderTarget();
         bool SetupQuadData();
+        bool SetupInstanceBuffers();
+        void UploadInstances();
+        void DrawInstanceBatch(const InstanceBatch &p_batch);
         bool SetupRenderTargetSampler();
         void CalculateRenderTargetResolution();
 
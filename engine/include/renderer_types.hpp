@@ -4,6 +4,8 @@
 #include <glm/glm.hpp>
 #include <SDL3/SDL.h>
 
+#include "string_id.hpp"
+
 using namespace glm;
 
 namespace lum
@@ -19,6 +21,15 @@ namespace lum
         vec2 texCoord;
     };
 
+    // Per instance data of the instanced quad pipeline, the quad is turned so
+    // its up side follows the heading, which doesn't have to be normalized
+    struct QuadInstance
+    {
+        vec2 position;
+        vec2 heading;
+        float frame;
+    };
+
     struct ProjMatUniform
     {
         mat4 model;
@@ -34,12 +45,27 @@ namespace lum
         alignas(16) vec4 modulateColor;
     };
 
+    struct InstancedQuadUniform
+    {
+        mat4 view;
+        mat4 proj;
+        vec2 size;
+        float horizontalFrames;
+    };
+
+    enum class VertexLayout
+    {
+        QUAD,
+        QUAD_INSTANCED,
+    };
+
     struct GraphicPipelineInfo
     {
-        const char *tag;
+        StringId tag;
         SDL_GPUGraphicsPipeline *pipeline;
-        const char *vertTag;
-        const char *fragTag;
+        StringId vertTag;
+        StringId fragTag;
+        VertexLayout layout{};
     };
 }
 
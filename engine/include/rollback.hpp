@@ -0,0 +1,145 @@
+#ifndef ROLLBACK_H
+#define ROLLBACK_H
+
+#include <array>
+#include <functional>
+#include <vector>
+
+#include <SDL3/SDL.h>
+
+#include "command.hpp"
+#include "transport.hpp"
+
+namespace lum
+{
+    struct RollbackStats
+    {
+        uint64_t tick{};
+        uint32_t inputDelay{};
+        uint32_t predicted{};        // Ticks run on guessed remote input
+        uint32_t rollbacks{};        // This frame
+        uint32_t rollbackDepth{};    // Most ticks resimulated by one rollback this frame
+        uint32_t maxRollbackDepth{};
+        uint32_t stalls{};           // Ticks spent waiting for the remote to catch up
+        float    resimMS{};          // This frame
+        float    tickMS{};           // One simulated tick, smoothed
+        uint64_t checkedTick{};      // Last tick both ends hashed the same
+        uint32_t desyncs{};          // Checked ticks the ends hashed differently
+        TransportStats transport{};
+    };
+
+    // How a session drives the simulation. Save snapshots the state at the
+    // start of the current tick, load goes back to the one taken at p_tick and
+    // drops the ones after it, advance runs one tick with every player's input.
+    // Checksum is optional, it hashes the snapshot taken at p_tick.
+    struct RollbackCallbacks
+    {
+        std::function<void()> save{};
+        std::function<bool(uint64_t p_tick)> load{};
+        std::function<void(const InputBits *p_inputs)> advance{};
+        std::function<bool(uint64_t p_tick, uint64_t &p_outChecksum)> checksum{};
+    };
+
+    // Two player session that never waits on the network while it can guess.
+    // Remote input that hasn't arrived is predicted to repeat the last one that
+    // did. When the real input turns out different, the simulation loads the
+    // snapshot of that tick and runs forward again with it. Local input is
+    // applied a few ticks late so most remote input arrives before it's needed.
+    //
+    // Every packet carries all the local input the peer hasn't acknowledged, so
+    // lost packets cost latency and nothing else.
+    //
+    // Every CHECKSUM_INTERVAL ticks, once all the input before a tick is
+    // confirmed, its snapshot is hashed and sent along. Both ends ran it on the
+    // same input, so a different hash means the simulation isn't deterministic.
+    class RollbackSession
+    {
+    public:
+        static constexpr uint32_t MAX_PREDICTION = 8;
+        static constexpr uint32_t MAX_INPUT_DELAY = 8;
+        static constexpr uint32_t INPUT_WINDOW = 64;
+        static constexpr uint32_t MAX_INPUTS_PER_PACKET = 32;
+        static constexpr uint32_t CHECKSUM_INTERVAL = 30;
+        static constexpr uint32_t CHECKSUM_HISTORY = 8;
+
+    public:
+        RollbackSession();
+        ~RollbackSession();
+
+        // Both ends have to start on the same tick with the same input delay
+        void Start(Transport &p_transport, uint32_t p_localPlayer, uint64_t p_startTick, uint32_t p_inputDelay, const RollbackCallbacks &p_callbacks);
+        void Stop();
+        bool IsRunning() const;
+
+        // Reads the network, rolls back if a guess was wrong, then runs the next
+        // tick. False when it's too far ahead of the remote and waits instead.
+        bool AdvanceTick(InputBits p_localInput);
+
+        // Clears the per frame stats
+        void BeginFrame();
+        RollbackStats GetStats() const;
+
+    private:
+        struct TickInput
+        {
+            uint64_t  tick{};
+            InputBits local{};
+            InputBits remote{};
+            InputBits usedRemote{}; // What the last simulation of the tick went with
+            bool      received{};
+            bool      simulated{};
+        };
+
+        struct TickChecksum
+        {
+            uint64_t tick{};
+            uint64_t local{};
+            uint64_t remote{};
+            bool     hasLocal{};
+            bool     hasRemote{};
+            bool     compared{};
+        };
+
+        static constexpr uint64_t NO_ROLLBACK = ~0ull;
+        static constexpr uint64_t NO_CHECKSUM = ~0ull;
+
+        bool m_running{};
+        Transport *m_transport{};
+        RollbackCallbacks m_callbacks{};
+        uint32_t m_localPlayer{};
+        uint32_t m_inputDelay{};
+
+        uint64_t m_startTick{};
+        uint64_t m_tick{};          // Next to simulate
+        uint64_t m_localEnd{};      // First tick without local input
+        uint64_t m_confirmedEnd{};  // First tick without remote input
+        uint64_t m_peerAckEnd{};    // First tick of local input the peer hasn't confirmed
+        uint64_t m_rollbackTo{ NO_ROLLBACK };
+        uint64_t m_checkTick{};     // Next to hash once it's final
+        uint64_t m_sentChecksumTick{ NO_CHECKSUM };
+
+        std::array<TickInput, INPUT_WINDOW> m_inputs{};
+        std::array<TickChecksum, CHECKSUM_HISTORY> m_checksums{};
+        std::vector<uint8_t> m_packet{};
+        std::vector<uint8_t> m_received{};
+
+        RollbackStats m_stats{};
+
+    private:
+        TickInput &GetInput(uint64_t p_tick);
+        InputBits PredictRemote();
+        void Simulate(uint64_t p_tick);
+        void Poll();
+        void SendInputs();
+
+        // Null when the slot already moved on to a later tick
+        TickChecksum *GetChecksum(uint64_t p_tick);
+        void HashConfirmedTicks();
+        void CompareChecksums(TickChecksum &p_checksum);
+
+        RollbackSession(const RollbackSession &) = delete;
+        RollbackSession &operator=(const RollbackSession &) = delete;
+    };
+}
+
+#endif // !ROLLBACK_H
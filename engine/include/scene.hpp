@@ -9,6 +9,12 @@
 #include "renderer.hpp"
 #include "audio_manager.hpp"
 #include "command.hpp"
+#include "collision.hpp"
+#include "ecs.hpp"
+#include "projectiles.hpp"
+#include "system_scheduler.hpp"
+#include "snapshot.hpp"
+#include "transform_hierarchy.hpp"
 
 namespace lum
 {
@@ -19,20 +25,46 @@ namespace lum
         AssetManager &assetMgr;
         Renderer &renderer;
         AudioManager &audioMgr;
+        ECS ecs;
+        SystemScheduler systems;
+        CollisionWorld collision;
+        ProjectileManager projectiles;
+        TransformHierarchy transforms;
+        AssetScope assets;
+        AssetManifest manifest;
+        bool assetsPreloaded{};
 
         std::unordered_map<SDL_Scancode, const char *> commandMap;
         std::unordered_set<const char *> activeCommands;
 
+        // Bound commands in the order they were bound, a command's bit is its index
+        std::vector<const char *> commandBits;
+
+        // Input of every player for the tick being simulated, set by the engine
+        // before Update. Simulation reads this instead of activeCommands so a
+        // rollback can run a tick again with different input.
+        InputBits playerInput[MAX_PLAYERS]{};
+
     public:
         Scene();
         virtual ~Scene();
 
+        virtual void DeclareAssets(AssetManifest &p_manifest);
         virtual void Setup() = 0;
         virtual void Update(float p_delta) = 0;
         virtual void Draw() = 0;
 
+        // Everything the simulation needs to carry on from here. Scenes with state
+        // of their own write it after calling these.
+        virtual void SaveState(SnapshotWriter &p_writer) const;
+        virtual bool LoadState(SnapshotReader &p_reader);
+
         void BindCommand(SDL_Scancode p_key, const char *p_command);
         void DoCommand(Command &p_command);
+
+        // activeCommands as bits
+        InputBits GetLocalInput() const;
+        bool IsCommandActive(uint32_t p_player, const char *p_command) const;
     };
 }
 
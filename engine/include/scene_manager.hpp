@@ -25,6 +25,8 @@ namespace lum
         void Shutdown();
 
         bool ChangeSceneTo(const std::string &p_tag);
+        bool PreloadScene(const std::string &p_tag);
+        bool UnloadScene(const std::string &p_tag);
         bool RegisterScene(const std::string &p_tag, std::shared_ptr<Scene> p_scene, bool p_setCurrent = false);
         bool LoadAutoload(const std::string &p_tag, std::shared_ptr<Autoload> p_autoload);
 
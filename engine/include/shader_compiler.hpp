@@ -0,0 +1,94 @@
+#ifndef SHADER_COMPILER_H
+#define SHADER_COMPILER_H
+
+#include <deque>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include <SDL3/SDL.h>
+
+#include "asset_types.hpp"
+#include "renderer_types.hpp"
+
+namespace lum
+{
+    // Pipeline that has to be rebuilt once a shader finishes compiling. The
+    // shader handles are the ones resident when the job was submitted.
+    struct PipelineRebuild
+    {
+        StringId                 tag{};
+        StringId                 vertTag{};
+        StringId                 fragTag{};
+        VertexLayout             layout{};
+        SDL_GPUShader           *vertShader{};
+        SDL_GPUShader           *fragShader{};
+        SDL_GPUGraphicsPipeline *pipeline{};
+    };
+
+    // Owns copies of the strings it needs, the worker never touches the string table
+    struct ShaderCompileJob
+    {
+        StringId                     tag{};
+        std::string                  name{};
+        std::string                  path{};
+        ShaderType                   type{};
+        SDL_Time                     modifyTime{};
+        std::vector<PipelineRebuild> pipelines{};
+    };
+
+    struct ShaderCompileResult
+    {
+        ShaderCompileJob job{};
+        SDL_GPUShader   *shader{};
+        bool             success{};
+        std::string      log{};
+    };
+
+    // Runs glslc, the SPIR-V cross-compilation and the pipeline rebuilds on a
+    // worker thread so a shader edit never stalls the frame. Results are
+    // handed back to the main thread, which swaps them in at a frame boundary.
+    class ShaderCompiler
+    {
+    public:
+        ShaderCompiler();
+        ~ShaderCompiler();
+
+        bool Init(const std::string &p_assetsDirectoryPath);
+        void Shutdown();
+
+        void Submit(ShaderCompileJob p_job);
+        bool PollResult(ShaderCompileResult &p_outResult);
+        bool IsBusy();
+
+        static ShaderType GetShaderTypeFromPath(const char *p_path);
+        static SDL_GPUShader *CreateShaderFromSPIRV(const char *p_tag, ShaderType p_type, const void *p_code, size_t p_size);
+        static bool RunGlslc(const std::string &p_assetsDirectoryPath, const char *p_path, std::string &p_outLog);
+
+    private:
+        std::string m_assetsDirectoryPath{};
+
+        SDL_Thread *m_thread{};
+        SDL_Mutex *m_mutex{};
+        SDL_Condition *m_condition{};
+        bool m_quit{};
+        uint32_t m_inFlight{};
+
+        std::deque<ShaderCompileJob> m_jobs{};
+        std::deque<ShaderCompileResult> m_results{};
+
+        // Newest shader produced by the worker for each tag, so pipelines built
+        // by later jobs pick it up even before the main thread applied it.
+        // Cleared whenever the queue runs dry.
+        std::unordered_map<StringId, SDL_GPUShader *> m_latestShaders{};
+
+    private:
+        static int WorkerMain(void *p_data);
+        void ProcessJob(ShaderCompileJob &p_job);
+
+        ShaderCompiler(const ShaderCompiler &) = delete;
+        ShaderCompiler &operator=(const ShaderCompiler &) = delete;
+    };
+}
+
+#endif // !SHADER_COMPILER_H
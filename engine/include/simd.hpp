@@ -0,0 +1,456 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LUM_SIMD_SSE
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define LUM_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+namespace lum::simd
+{
+    // p_dst[i] += p_src[i] * p_gain
+    inline void MixAdd(float *p_dst, const float *p_src, float p_gain, size_t p_count)
+    {
+        size_t i = 0;
+
+#if defined(LUM_SIMD_SSE)
+        const __m128 gain = _mm_set1_ps(p_gain);
+        for (; i + 4 <= p_count; i += 4)
+        {
+            __m128 src = _mm_loadu_ps(p_src + i);
+            __m128 dst = _mm_loadu_ps(p_dst + i);
+            _mm_storeu_ps(p_dst + i, _mm_add_ps(dst, _mm_mul_ps(src, gain)));
+        }
+#elif defined(LUM_SIMD_NEON)
+        const float32x4_t gain = vdupq_n_f32(p_gain);
+        for (; i + 4 <= p_count; i += 4)
+        {
+            float32x4_t src = vld1q_f32(p_src + i);
+            float32x4_t dst = vld1q_f32(p_dst + i);
+            vst1q_f32(p_dst + i, vmlaq_f32(dst, src, gain));
+        }
+#endif
+
+        for (; i < p_count; i++)
+            p_dst[i] += p_src[i] * p_gain;
+    }
+
+    // p_dst[i] *= p_gain
+    inline void Scale(float *p_dst, float p_gain, size_t p_count)
+    {
+        size_t i = 0;
+
+#if defined(LUM_SIMD_SSE)
+        const __m128 gain = _mm_set1_ps(p_gain);
+        for (; i + 4 <= p_count; i += 4)
+            _mm_storeu_ps(p_dst + i, _mm_mul_ps(_mm_loadu_ps(p_dst + i), gain));
+#elif defined(LUM_SIMD_NEON)
+        const float32x4_t gain = vdupq_n_f32(p_gain);
+        for (; i + 4 <= p_count; i += 4)
+            vst1q_f32(p_dst + i, vmulq_f32(vld1q_f32(p_dst + i), gain));
+#endif
+
+        for (; i < p_count; i++)
+            p_dst[i] *= p_gain;
+    }
+
+    // p_dst[i] *= gain moving linearly from p_from to p_to over the buffer, the
+    // step is per sample so interleaved channels are a fraction of a step apart
+    inline void ScaleRamp(float *p_dst, float p_from, float p_to, size_t p_count)
+    {
+        if (p_count == 0)
+            return;
+
+        const float step = (p_to - p_from) / static_cast<float>(p_count);
+        size_t i = 0;
+
+#if defined(LUM_SIMD_SSE)
+        __m128 gain = _mm_setr_ps(p_from, p_from + step, p_from + 2.0f * step, p_from + 3.0f * step);
+        const __m128 gainStep = _mm_set1_ps(4.0f * step);
+        for (; i + 4 <= p_count; i += 4)
+        {
+            _mm_storeu_ps(p_dst + i, _mm_mul_ps(_mm_loadu_ps(p_dst + i), gain));
+            gain = _mm_add_ps(gain, gainStep);
+        }
+#elif defined(LUM_SIMD_NEON)
+        const float start[4] = { p_from, p_from + step, p_from + 2.0f * step, p_from + 3.0f * step };
+        float32x4_t gain = vld1q_f32(start);
+        const float32x4_t gainStep = vdupq_n_f32(4.0f * step);
+        for (; i + 4 <= p_count; i += 4)
+        {
+            vst1q_f32(p_dst + i, vmulq_f32(vld1q_f32(p_dst + i), gain));
+            gain = vaddq_f32(gain, gainStep);
+        }
+#endif
+
+        for (; i < p_count; i++)
+            p_dst[i] *= p_from + step * static_cast<float>(i);
+    }
+
+    // Largest absolute sample value
+    inline float PeakAbs(const float *p_src, size_t p_count)
+    {
+        size_t i = 0;
+        float peak = 0.0f;
+
+#if defined(LUM_SIMD_SSE)
+        const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+        __m128 peaks = _mm_setzero_ps();
+        for (; i + 4 <= p_count; i += 4)
+            peaks = _mm_max_ps(peaks, _mm_and_ps(_mm_loadu_ps(p_src + i), absMask));
+
+        peaks = _mm_max_ps(peaks, _mm_movehl_ps(peaks, peaks));
+        peaks = _mm_max_ss(peaks, _mm_shuffle_ps(peaks, peaks, 1));
+        peak = _mm_cvtss_f32(peaks);
+#elif defined(LUM_SIMD_NEON)
+        float32x4_t peaks = vdupq_n_f32(0.0f);
+        for (; i + 4 <= p_count; i += 4)
+            peaks = vmaxq_f32(peaks, vabsq_f32(vld1q_f32(p_src + i)));
+
+        float lanes[4];
+        vst1q_f32(lanes, peaks);
+        peak = lanes[0] > lanes[1] ? lanes[0] : lanes[1];
+        peak = peak > lanes[2] ? peak : lanes[2];
+        peak = peak > lanes[3] ? peak : lanes[3];
+#endif
+
+        for (; i < p_count; i++)
+        {
+            float sample = p_src[i] < 0.0f ? -p_src[i] : p_src[i];
+            peak = sample > peak ? sample : peak;
+        }
+
+        return peak;
+    }
+
+    // Clamps to [-1, 1] so the device conversion never wraps
+    inline void Clip(float *p_dst, size_t p_count)
+    {
+        size_t i = 0;
+
+#if defined(LUM_SIMD_SSE)
+        const __m128 lo = _mm_set1_ps(-1.0f);
+        const __m128 hi = _mm_set1_ps(1.0f);
+        for (; i + 4 <= p_count; i += 4)
+            _mm_storeu_ps(p_dst + i, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(p_dst + i), lo), hi));
+#elif defined(LUM_SIMD_NEON)
+        const float32x4_t lo = vdupq_n_f32(-1.0f);
+        const float32x4_t hi = vdupq_n_f32(1.0f);
+        for (; i + 4 <= p_count; i += 4)
+            vst1q_f32(p_dst + i, vminq_f32(vmaxq_f32(vld1q_f32(p_dst + i), lo), hi));
+#endif
+
+        for (; i < p_count; i++)
+            p_dst[i] = p_dst[i] < -1.0f ? -1.0f : (p_dst[i] > 1.0f ? 1.0f : p_dst[i]);
+    }
+
+    // p_dst[i] = p_a[i] + p_b[i] * p_scale, p_dst may be either source
+    inline void AddScaled(float *p_dst, const float *p_a, const float *p_b, float p_scale, size_t p_count)
+    {
+        size_t i = 0;
+
+#if defined(LUM_SIMD_SSE)
+        const __m128 scale = _mm_set1_ps(p_scale);
+        for (; i + 4 <= p_count; i += 4)
+            _mm_storeu_ps(p_dst + i, _mm_add_ps(_mm_loadu_ps(p_a + i), _mm_mul_ps(_mm_loadu_ps(p_b + i), scale)));
+#elif defined(LUM_SIMD_NEON)
+        const float32x4_t scale = vdupq_n_f32(p_scale);
+        for (; i + 4 <= p_count; i += 4)
+            vst1q_f32(p_dst + i, vmlaq_f32(vld1q_f32(p_a + i), vld1q_f32(p_b + i), scale));
+#endif
+
+        for (; i < p_count; i++)
+            p_dst[i] = p_a[i] + p_b[i] * p_scale;
+    }
+
+    // p_dst[i] = p_a[i] - p_b[i], p_dst may be either source
+    inline void Subtract(float *p_dst, const float *p_a, const float *p_b, size_t p_count)
+    {
+        size_t i = 0;
+
+#if defined(LUM_SIMD_SSE)
+        for (; i + 4 <= p_count; i += 4)
+            _mm_storeu_ps(p_dst + i, _mm_sub_ps(_mm_loadu_ps(p_a + i), _mm_loadu_ps(p_b + i)));
+#elif defined(LUM_SIMD_NEON)
+        for (; i + 4 <= p_count; i += 4)
+            vst1q_f32(p_dst + i, vsubq_f32(vld1q_f32(p_a + i), vld1q_f32(p_b + i)));
+#endif
+
+        for (; i < p_count; i++)
+            p_dst[i] = p_a[i] - p_b[i];
+    }
+
+    // Shapes laid out as separate arrays, each one a box with half extents hx, hy
+    // grown by radius r. Circles have zero extents, boxes zero radius.
+    struct RoundedBoxes
+    {
+        const float    *cx{};
+        const float    *cy{};
+        const float    *hx{};
+        const float    *hy{};
+        const float    *r{};
+        const uint32_t *layers{};
+    };
+
+    // Writes the index of every shape overlapping the query that's on a layer in
+    // p_mask to p_outHits, returns how many. Two rounded boxes overlap when the
+    // distance between their centres, less the summed extents, is within the
+    // summed radii, exact for circles, boxes and any mix of them.
+    inline size_t OverlapRoundedBoxes(float p_cx, float p_cy, float p_hx, float p_hy, float p_r, uint32_t p_mask,
+        const RoundedBoxes &p_boxes, size_t p_count, uint32_t *p_outHits)
+    {
+        size_t i = 0;
+        size_t hits = 0;
+
+#if defined(LUM_SIMD_SSE)
+        const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 qx = _mm_set1_ps(p_cx);
+        const __m128 qy = _mm_set1_ps(p_cy);
+        const __m128 qhx = _mm_set1_ps(p_hx);
+        const __m128 qhy = _mm_set1_ps(p_hy);
+        const __m128 qr = _mm_set1_ps(p_r);
+        const __m128i mask = _mm_set1_epi32(static_cast<int>(p_mask));
+        const __m128i zeroi = _mm_setzero_si128();
+
+        for (; i + 4 <= p_count; i += 4)
+        {
+            __m128 dx = _mm_and_ps(_mm_sub_ps(_mm_loadu_ps(p_boxes.cx + i), qx), absMask);
+            __m128 dy = _mm_and_ps(_mm_sub_ps(_mm_loadu_ps(p_boxes.cy + i), qy), absMask);
+            dx = _mm_max_ps(_mm_sub_ps(dx, _mm_add_ps(_mm_loadu_ps(p_boxes.hx + i), qhx)), zero);
+            dy = _mm_max_ps(_mm_sub_ps(dy, _mm_add_ps(_mm_loadu_ps(p_boxes.hy + i), qhy)), zero);
+
+            const __m128 radius = _mm_add_ps(_mm_loadu_ps(p_boxes.r + i), qr);
+            const __m128 overlap = _mm_cmple_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(radius, radius));
+
+            const __m128i layers = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p_boxes.layers + i)), mask);
+            const __m128 noLayer = _mm_castsi128_ps(_mm_cmpeq_epi32(layers, zeroi));
+
+            const int bits = _mm_movemask_ps(_mm_andnot_ps(noLayer, overlap));
+            if (!bits)
+                continue;
+
+            for (uint32_t lane = 0; lane < 4; lane++)
+            {
+                if (bits & (1 << lane))
+                    p_outHits[hits++] = static_cast<uint32_t>(i) + lane;
+            }
+        }
+#elif defined(LUM_SIMD_NEON)
+        const float32x4_t zero = vdupq_n_f32(0.0f);
+        const float32x4_t qx = vdupq_n_f32(p_cx);
+        const float32x4_t qy = vdupq_n_f32(p_cy);
+        const float32x4_t qhx = vdupq_n_f32(p_hx);
+        const float32x4_t qhy = vdupq_n_f32(p_hy);
+        const float32x4_t qr = vdupq_n_f32(p_r);
+        const uint32x4_t mask = vdupq_n_u32(p_mask);
+
+        for (; i + 4 <= p_count; i += 4)
+        {
+            float32x4_t dx = vabsq_f32(vsubq_f32(vld1q_f32(p_boxes.cx + i), qx));
+            float32x4_t dy = vabsq_f32(vsubq_f32(vld1q_f32(p_boxes.cy + i), qy));
+            dx = vmaxq_f32(vsubq_f32(dx, vaddq_f32(vld1q_f32(p_boxes.hx + i), qhx)), zero);
+            dy = vmaxq_f32(vsubq_f32(dy, vaddq_f32(vld1q_f32(p_boxes.hy + i), qhy)), zero);
+
+            const float32x4_t radius = vaddq_f32(vld1q_f32(p_boxes.r + i), qr);
+            const uint32x4_t overlap = vcleq_f32(vmlaq_f32(vmulq_f32(dx, dx), dy, dy), vmulq_f32(radius, radius));
+            const uint32x4_t hit = vandq_u32(overlap, vtstq_u32(vld1q_u32(p_boxes.layers + i), mask));
+
+            uint32_t lanes[4];
+            vst1q_u32(lanes, hit);
+            for (uint32_t lane = 0; lane < 4; lane++)
+            {
+                if (lanes[lane])
+                    p_outHits[hits++] = static_cast<uint32_t>(i) + lane;
+            }
+        }
+#endif
+
+        for (; i < p_count; i++)
+        {
+            if (!(p_boxes.layers[i] & p_mask))
+                continue;
+
+            float dx = p_boxes.cx[i] - p_cx;
+            float dy = p_boxes.cy[i] - p_cy;
+            dx = (dx < 0.0f ? -dx : dx) - (p_boxes.hx[i] + p_hx);
+            dy = (dy < 0.0f ? -dy : dy) - (p_boxes.hy[i] + p_hy);
+            dx = dx > 0.0f ? dx : 0.0f;
+            dy = dy > 0.0f ? dy : 0.0f;
+
+            const float radius = p_boxes.r[i] + p_r;
+            if (dx * dx + dy * dy <= radius * radius)
+                p_outHits[hits++] = static_cast<uint32_t>(i);
+        }
+
+        return hits;
+    }
+
+    struct Projectiles
+    {
+        float *px{};
+        float *py{};
+        float *vx{};
+        float *vy{};
+        const float *ax{};
+        const float *ay{};
+        const float *turnRate{}; // Radians per second
+        float *life{};
+    };
+
+    // Steps every projectile by p_delta. Velocity turns by the turn rate and
+    // picks up the acceleration, position follows and lifetime counts down. The
+    // turn uses a short series of sin and cos, exact enough for frame sized steps.
+    inline void IntegrateProjectiles(const Projectiles &p_proj, float p_delta, size_t p_count)
+    {
+        size_t i = 0;
+
+#if defined(LUM_SIMD_SSE)
+        const __m128 delta = _mm_set1_ps(p_delta);
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 half = _mm_set1_ps(0.5f);
+        const __m128 sixth = _mm_set1_ps(1.0f / 6.0f);
+        const __m128 twentyFourth = _mm_set1_ps(1.0f / 24.0f);
+
+        for (; i + 4 <= p_count; i += 4)
+        {
+            const __m128 turn = _mm_mul_ps(_mm_loadu_ps(p_proj.turnRate + i), delta);
+            const __m128 turn2 = _mm_mul_ps(turn, turn);
+            const __m128 c = _mm_sub_ps(one, _mm_mul_ps(turn2, _mm_sub_ps(half, _mm_mul_ps(turn2, twentyFourth))));
+            const __m128 s = _mm_mul_ps(turn, _mm_sub_ps(one, _mm_mul_ps(turn2, sixth)));
+
+            const __m128 vx = _mm_loadu_ps(p_proj.vx + i);
+            const __m128 vy = _mm_loadu_ps(p_proj.vy + i);
+            __m128 nvx = _mm_sub_ps(_mm_mul_ps(vx, c), _mm_mul_ps(vy, s));
+            __m128 nvy = _mm_add_ps(_mm_mul_ps(vx, s), _mm_mul_ps(vy, c));
+            nvx = _mm_add_ps(nvx, _mm_mul_ps(_mm_loadu_ps(p_proj.ax + i), delta));
+            nvy = _mm_add_ps(nvy, _mm_mul_ps(_mm_loadu_ps(p_proj.ay + i), delta));
+
+            _mm_storeu_ps(p_proj.vx + i, nvx);
+            _mm_storeu_ps(p_proj.vy + i, nvy);
+            _mm_storeu_ps(p_proj.px + i, _mm_add_ps(_mm_loadu_ps(p_proj.px + i), _mm_mul_ps(nvx, delta)));
+            _mm_storeu_ps(p_proj.py + i, _mm_add_ps(_mm_loadu_ps(p_proj.py + i), _mm_mul_ps(nvy, delta)));
+            _mm_storeu_ps(p_proj.life + i, _mm_sub_ps(_mm_loadu_ps(p_proj.life + i), delta));
+        }
+#elif defined(LUM_SIMD_NEON)
+        const float32x4_t one = vdupq_n_f32(1.0f);
+        const float32x4_t half = vdupq_n_f32(0.5f);
+        const float32x4_t sixth = vdupq_n_f32(1.0f / 6.0f);
+        const float32x4_t twentyFourth = vdupq_n_f32(1.0f / 24.0f);
+
+        for (; i + 4 <= p_count; i += 4)
+        {
+            const float32x4_t turn = vmulq_n_f32(vld1q_f32(p_proj.turnRate + i), p_delta);
+            const float32x4_t turn2 = vmulq_f32(turn, turn);
+            const float32x4_t c = vmlsq_f32(one, turn2, vmlsq_f32(half, turn2, twentyFourth));
+            const float32x4_t s = vmulq_f32(turn, vmlsq_f32(one, turn2, sixth));
+
+            const float32x4_t vx = vld1q_f32(p_proj.vx + i);
+            const float32x4_t vy = vld1q_f32(p_proj.vy + i);
+            float32x4_t nvx = vmlsq_f32(vmulq_f32(vx, c), vy, s);
+            float32x4_t nvy = vmlaq_f32(vmulq_f32(vx, s), vy, c);
+            nvx = vmlaq_n_f32(nvx, vld1q_f32(p_proj.ax + i), p_delta);
+            nvy = vmlaq_n_f32(nvy, vld1q_f32(p_proj.ay + i), p_delta);
+
+            vst1q_f32(p_proj.vx + i, nvx);
+            vst1q_f32(p_proj.vy + i, nvy);
+            vst1q_f32(p_proj.px + i, vmlaq_n_f32(vld1q_f32(p_proj.px + i), nvx, p_delta));
+            vst1q_f32(p_proj.py + i, vmlaq_n_f32(vld1q_f32(p_proj.py + i), nvy, p_delta));
+            vst1q_f32(p_proj.life + i, vsubq_f32(vld1q_f32(p_proj.life + i), vdupq_n_f32(p_delta)));
+        }
+#endif
+
+        for (; i < p_count; i++)
+        {
+            const float turn = p_proj.turnRate[i] * p_delta;
+            const float turn2 = turn * turn;
+            const float c = 1.0f - turn2 * (0.5f - turn2 * (1.0f / 24.0f));
+            const float s = turn * (1.0f - turn2 * (1.0f / 6.0f));
+
+            const float vx = p_proj.vx[i];
+            const float vy = p_proj.vy[i];
+            const float nvx = vx * c - vy * s + p_proj.ax[i] * p_delta;
+            const float nvy = vx * s + vy * c + p_proj.ay[i] * p_delta;
+
+            p_proj.vx[i] = nvx;
+            p_proj.vy[i] = nvy;
+            p_proj.px[i] += nvx * p_delta;
+            p_proj.py[i] += nvy * p_delta;
+            p_proj.life[i] -= p_delta;
+        }
+    }
+
+    // Sets p_outKeep[i] to 1 for projectiles with lifetime left inside the
+    // bounds and 0 for the rest, returns how many are kept
+    inline size_t FindLiveProjectiles(const float *p_px, const float *p_py, const float *p_life,
+        float p_minX, float p_minY, float p_maxX, float p_maxY, uint8_t *p_outKeep, size_t p_count)
+    {
+        size_t i = 0;
+        size_t kept = 0;
+
+#if defined(LUM_SIMD_SSE)
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 minX = _mm_set1_ps(p_minX);
+        const __m128 minY = _mm_set1_ps(p_minY);
+        const __m128 maxX = _mm_set1_ps(p_maxX);
+        const __m128 maxY = _mm_set1_ps(p_maxY);
+
+        for (; i + 4 <= p_count; i += 4)
+        {
+            const __m128 px = _mm_loadu_ps(p_px + i);
+            const __m128 py = _mm_loadu_ps(p_py + i);
+
+            __m128 live = _mm_cmpgt_ps(_mm_loadu_ps(p_life + i), zero);
+            live = _mm_and_ps(live, _mm_and_ps(_mm_cmpge_ps(px, minX), _mm_cmple_ps(px, maxX)));
+            live = _mm_and_ps(live, _mm_and_ps(_mm_cmpge_ps(py, minY), _mm_cmple_ps(py, maxY)));
+
+            const int bits = _mm_movemask_ps(live);
+            for (uint32_t lane = 0; lane < 4; lane++)
+                p_outKeep[i + lane] = static_cast<uint8_t>((bits >> lane) & 1);
+
+            kept += static_cast<size_t>((bits & 1) + ((bits >> 1) & 1) + ((bits >> 2) & 1) + ((bits >> 3) & 1));
+        }
+#elif defined(LUM_SIMD_NEON)
+        const float32x4_t zero = vdupq_n_f32(0.0f);
+        const float32x4_t minX = vdupq_n_f32(p_minX);
+        const float32x4_t minY = vdupq_n_f32(p_minY);
+        const float32x4_t maxX = vdupq_n_f32(p_maxX);
+        const float32x4_t maxY = vdupq_n_f32(p_maxY);
+
+        for (; i + 4 <= p_count; i += 4)
+        {
+            const float32x4_t px = vld1q_f32(p_px + i);
+            const float32x4_t py = vld1q_f32(p_py + i);
+
+            uint32x4_t live = vcgtq_f32(vld1q_f32(p_life + i), zero);
+            live = vandq_u32(live, vandq_u32(vcgeq_f32(px, minX), vcleq_f32(px, maxX)));
+            live = vandq_u32(live, vandq_u32(vcgeq_f32(py, minY), vcleq_f32(py, maxY)));
+
+            uint32_t lanes[4];
+            vst1q_u32(lanes, vshrq_n_u32(live, 31));
+            for (uint32_t lane = 0; lane < 4; lane++)
+            {
+                p_outKeep[i + lane] = static_cast<uint8_t>(lanes[lane]);
+                kept += lanes[lane];
+            }
+        }
+#endif
+
+        for (; i < p_count; i++)
+        {
+            const bool live = p_life[i] > 0.0f && p_px[i] >= p_minX && p_px[i] <= p_maxX && p_py[i] >= p_minY && p_py[i] <= p_maxY;
+            p_outKeep[i] = live ? 1 : 0;
+            kept += live ? 1 : 0;
+        }
+
+        return kept;
+    }
+}
+
+#endif // !SIMD_H
@@ -0,0 +1,192 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include <SDL3/SDL.h>
+
+namespace lum
+{
+    // Appends raw bytes to a buffer. Capacity is kept between snapshots, so once
+    // the buffer has seen the biggest world nothing gets allocated.
+    class SnapshotWriter
+    {
+    public:
+        SnapshotWriter(std::vector<uint8_t> &p_buffer) : m_buffer(p_buffer) {}
+
+        void Write(const void *p_data, size_t p_size)
+        {
+            const uint8_t *bytes = static_cast<const uint8_t *>(p_data);
+            m_buffer.insert(m_buffer.end(), bytes, bytes + p_size);
+        }
+
+        template<typename T>
+        void WriteValue(const T &p_value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values go in a snapshot");
+            Write(&p_value, sizeof(T));
+        }
+
+        // Count first, then the elements in one copy
+        template<typename T>
+        void WriteArray(const std::vector<T> &p_values)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values go in a snapshot");
+            WriteValue(static_cast<uint32_t>(p_values.size()));
+            Write(p_values.data(), p_values.size() * sizeof(T));
+        }
+
+        size_t GetSize() const { return m_buffer.size(); }
+
+        // Overwrites bytes already written, for a size only known once what it
+        // covers has been written
+        void Patch(size_t p_offset, const void *p_data, size_t p_size)
+        {
+            std::memcpy(m_buffer.data() + p_offset, p_data, p_size);
+        }
+
+    private:
+        std::vector<uint8_t> &m_buffer;
+    };
+
+    // Reads back what a SnapshotWriter wrote, in the same order. Every read is
+    // bounds checked and fails instead of running off the end.
+    class SnapshotReader
+    {
+    public:
+        SnapshotReader() = default;
+        SnapshotReader(const uint8_t *p_data, size_t p_size) : m_cursor(p_data), m_end(p_data + p_size) {}
+
+        bool Read(void *p_data, size_t p_size)
+        {
+            if (static_cast<size_t>(m_end - m_cursor) < p_size)
+                return false;
+
+            if (p_size > 0)
+                std::memcpy(p_data, m_cursor, p_size);
+
+            m_cursor += p_size;
+            return true;
+        }
+
+        // Pointer to the next p_size bytes, for copying them straight to where they go
+        const uint8_t *Take(size_t p_size)
+        {
+            if (static_cast<size_t>(m_end - m_cursor) < p_size)
+                return nullptr;
+
+            const uint8_t *data = m_cursor;
+            m_cursor += p_size;
+            return data;
+        }
+
+        template<typename T>
+        bool ReadValue(T &p_outValue)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values go in a snapshot");
+            return Read(&p_outValue, sizeof(T));
+        }
+
+        template<typename T>
+        bool ReadArray(std::vector<T> &p_outValues)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values go in a snapshot");
+
+            uint32_t count{};
+            if (!ReadValue(count) || static_cast<size_t>(m_end - m_cursor) / sizeof(T) < count)
+                return false;
+
+            p_outValues.resize(count);
+            return Read(p_outValues.data(), count * sizeof(T));
+        }
+
+        bool AtEnd() const { return m_cursor == m_end; }
+        size_t GetRemaining() const { return static_cast<size_t>(m_end - m_cursor); }
+
+    private:
+        const uint8_t *m_cursor{};
+        const uint8_t *m_end{};
+    };
+
+    struct SnapshotStats
+    {
+        uint32_t count{};
+        uint32_t capacity{};
+        size_t   fullBytes{};  // The newest one, the only one stored whole
+        size_t   deltaBytes{}; // Every older one together
+        float    saveMS{};
+        float    restoreMS{};
+    };
+
+    // Ring of the last few snapshots. The newest is kept whole so restoring it
+    // is a single copy. Saving a new one turns the one before into a delta
+    // against it: only the byte ranges that differ are kept, which for a world
+    // that barely moved in a tick is a small fraction of it. Going further back
+    // applies the deltas one after the other on top of the newest.
+    //
+    // Age counts back from the newest, zero is the last one saved.
+    class SnapshotRing
+    {
+    public:
+        static constexpr uint32_t DEFAULT_CAPACITY = 120;
+        static constexpr size_t DEFAULT_RESERVE = 1 << 20;
+
+        // Equal runs shorter than this stay inside the surrounding literal, a
+        // new run costs more than the bytes it skips
+        static constexpr size_t MIN_SKIP = 8;
+
+    public:
+        SnapshotRing(uint32_t p_capacity = DEFAULT_CAPACITY, size_t p_reserve = DEFAULT_RESERVE);
+        ~SnapshotRing();
+
+        // Writer over an empty buffer, fill it and hand it to Commit
+        SnapshotWriter BeginSave();
+        void Commit(uint64_t p_tick);
+
+        // Reader over the snapshot p_age back, valid until the next call on the ring
+        bool Get(uint32_t p_age, SnapshotReader &p_outReader);
+
+        // Same as Get but the snapshot becomes the newest and the ones after it
+        // are dropped, for rolling back and simulating forward again
+        bool Rewind(uint32_t p_age, SnapshotReader &p_outReader);
+
+        // Age of the snapshot saved at p_tick, false if it's gone or never was
+        bool FindAge(uint64_t p_tick, uint32_t &p_outAge) const;
+
+        uint64_t GetTick(uint32_t p_age) const;
+        uint32_t GetCount() const;
+        void Clear();
+
+        void SetSaveTime(float p_ms);
+        void SetRestoreTime(float p_ms);
+        SnapshotStats GetStats() const;
+
+    private:
+        struct Entry
+        {
+            uint64_t tick{};
+            std::vector<uint8_t> delta{}; // Unused for the newest
+        };
+
+        std::vector<Entry> m_entries{};
+        uint32_t m_newest{};
+        uint32_t m_count{};
+
+        std::vector<uint8_t> m_full{};
+        std::vector<uint8_t> m_scratch{};
+        std::vector<uint8_t> m_restore{};
+
+        SnapshotStats m_stats{};
+
+    private:
+        uint32_t SlotOf(uint32_t p_age) const;
+        bool Reconstruct(uint32_t p_age, std::vector<uint8_t> &p_out) const;
+
+        SnapshotRing(const SnapshotRing &) = delete;
+        SnapshotRing &operator=(const SnapshotRing &) = delete;
+    };
+}
+
+#endif // !SNAPSHOT_H
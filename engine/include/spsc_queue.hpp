@@ -0,0 +1,79 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace lum
+{
+    // Bounded ring between exactly one producer and one consumer thread. Push and
+    // pop never block or allocate, a full queue just refuses the push. Capacity
+    // has to be a power of two.
+    template<typename T, uint32_t Capacity>
+    class SpscQueue
+    {
+        static_assert((Capacity & (Capacity - 1)) == 0, "SpscQueue capacity must be a power of two");
+        static_assert(std::is_trivially_copyable_v<T>, "SpscQueue only holds trivially copyable types");
+
+    public:
+        static constexpr uint32_t MASK = Capacity - 1;
+        static constexpr size_t CACHE_LINE = 64;
+
+    public:
+        // Producer only
+        bool TryPush(const T &p_item)
+        {
+            const uint32_t write = m_write.load(std::memory_order_relaxed);
+            if (write - m_readCache == Capacity)
+            {
+                m_readCache = m_read.load(std::memory_order_acquire);
+                if (write - m_readCache == Capacity)
+                    return false;
+            }
+
+            m_items[write & MASK] = p_item;
+            m_write.store(write + 1, std::memory_order_release);
+
+            return true;
+        }
+
+        // Consumer only
+        bool TryPop(T &p_outItem)
+        {
+            const uint32_t read = m_read.load(std::memory_order_relaxed);
+            if (read == m_writeCache)
+            {
+                m_writeCache = m_write.load(std::memory_order_acquire);
+                if (read == m_writeCache)
+                    return false;
+            }
+
+            p_outItem = m_items[read & MASK];
+            m_read.store(read + 1, std::memory_order_release);
+
+            return true;
+        }
+
+        uint32_t Size() const
+        {
+            return m_write.load(std::memory_order_acquire) - m_read.load(std::memory_order_acquire);
+        }
+
+    private:
+        // Each side keeps a stale copy of the other's index and only reloads it
+        // when the ring looks full or empty, so the shared lines rarely bounce
+
+        alignas(CACHE_LINE) std::atomic<uint32_t> m_write{};
+        uint32_t m_readCache{};
+
+        alignas(CACHE_LINE) std::atomic<uint32_t> m_read{};
+        uint32_t m_writeCache{};
+
+        alignas(CACHE_LINE) std::array<T, Capacity> m_items{};
+    };
+}
+
+#endif // !SPSC_QUEUE_H
@@ -0,0 +1,78 @@
+#ifndef STRING_ID_H
+#define STRING_ID_H
+
+#include <string>
+#include <functional>
+#include <unordered_map>
+
+#include <SDL3/SDL.h>
+
+#include "utilities.hpp"
+
+namespace lum
+{
+    // Compact handle to an interned string. Comparing and hashing is a single
+    // integer operation, the string itself lives in the StringTable.
+    struct StringId
+    {
+        uint32_t value{};
+
+        constexpr StringId() = default;
+        constexpr explicit StringId(uint32_t p_value) : value(p_value) {}
+
+        constexpr bool operator==(StringId p_other) const { return value == p_other.value; }
+        constexpr bool operator!=(StringId p_other) const { return value != p_other.value; }
+        constexpr explicit operator bool() const { return value != 0; }
+    };
+
+    // Computes the id without registering the string, meant for fixed tags known
+    // at compile time. The string still has to be interned once before lookups
+    // can be checked for collisions.
+    constexpr StringId SID(const char *p_str)
+    {
+        return StringId(utils::HashStr32(p_str));
+    }
+
+    constexpr StringId operator""_sid(const char *p_str, size_t)
+    {
+        return SID(p_str);
+    }
+
+    // Owns every tag string used as a key. A second 64-bit hash is kept for each
+    // id so two strings landing on the same 32-bit hash are caught when the
+    // second one is registered instead of silently sharing a slot.
+    class StringTable
+    {
+    public:
+        static constexpr uint32_t HEX_BUFFERS = 8;
+
+    public:
+        static StringId Intern(const char *p_str);
+        static bool IsInterned(StringId p_id);
+
+        // Debug builds return the original string, release builds only keep the
+        // hashes and return the id formatted as hex. Those stay valid for the
+        // next HEX_BUFFERS - 1 calls on the same thread.
+        static const char *GetString(StringId p_id);
+
+    private:
+        struct Entry
+        {
+            uint64_t    hash64{};
+#ifndef NDEBUG
+            std::string str{};
+#endif
+        };
+
+        static std::unordered_map<uint32_t, Entry> s_entries;
+        static SDL_SpinLock s_lock;
+    };
+}
+
+template<>
+struct std::hash<lum::StringId>
+{
+    size_t operator()(lum::StringId p_id) const noexcept { return p_id.value; }
+};
+
+#endif // !STRING_ID_H
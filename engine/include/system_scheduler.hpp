@@ -0,0 +1,77 @@
+#ifndef SYSTEM_SCHEDULER_H
+#define SYSTEM_SCHEDULER_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "ecs.hpp"
+#include "job_system.hpp"
+
+namespace lum
+{
+    using SystemFunc = std::function<void(ECS &p_ecs, float p_delta)>;
+
+    // Runs update systems over an ECS, in parallel wherever their component
+    // access allows it. Systems are split into waves in the order they were
+    // added, a system goes into the first wave after the last one holding a
+    // system it conflicts with, so conflicting systems always run in the order
+    // they were added. Two systems conflict when either writes a component the
+    // other reads or writes. Exclusive systems conflict with everything and run
+    // on the calling thread, use them for anything touching state outside the
+    // ECS.
+    class SystemScheduler
+    {
+    public:
+        SystemScheduler(ECS &p_ecs, JobSystem &p_jobs);
+        ~SystemScheduler();
+
+        void AddSystem(const char *p_name, const Signature &p_reads, const Signature &p_writes, SystemFunc p_func);
+        void AddExclusiveSystem(const char *p_name, SystemFunc p_func);
+
+        void Run(float p_delta);
+
+        uint32_t GetWaveCount() const;
+
+        // Per system run times summed since the last reset, in the order added
+        void GetTimings(std::vector<JobTiming> &p_outTimings) const;
+        void ResetTimings();
+
+    private:
+        struct System
+        {
+            const char *name{};
+            Signature   reads{};
+            Signature   writes{};
+            bool        exclusive{};
+            SystemFunc  func{};
+
+            // Only touched by whoever runs the system, a system never runs twice at once
+            JobTiming   timing{};
+        };
+
+        struct RunContext
+        {
+            SystemScheduler *scheduler{};
+            float            delta{};
+        };
+
+        ECS &m_ecs;
+        JobSystem &m_jobs;
+        std::vector<System> m_systems{};
+
+        // Ranges into m_order, one per wave
+        std::vector<uint32_t> m_order{};
+        std::vector<uint32_t> m_waveStarts{};
+
+    private:
+        void RunSystem(System &p_system, float p_delta);
+        static bool Conflicts(const System &p_a, const System &p_b);
+        void BuildWaves();
+
+        SystemScheduler(const SystemScheduler &) = delete;
+        SystemScheduler &operator=(const SystemScheduler &) = delete;
+    };
+}
+
+#endif // !SYSTEM_SCHEDULER_H
@@ -0,0 +1,109 @@
+#ifndef TRANSFORM_HIERARCHY_H
+#define TRANSFORM_HIERARCHY_H
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace lum
+{
+    class SnapshotReader;
+    class SnapshotWriter;
+
+    using TransformId = uint32_t;
+
+    static constexpr TransformId INVALID_TRANSFORM = ~0u;
+
+    // Rotation in degrees, scale is uniform so a chain of them stays one of them
+    struct Transform2D
+    {
+        glm::vec2 position{ 0.0f };
+        float     rotation{};
+        float     scale{ 1.0f };
+    };
+
+    // Rotation takes the short way round
+    Transform2D Interpolate(const Transform2D &p_from, const Transform2D &p_to, float p_alpha);
+
+    struct TransformStats
+    {
+        uint32_t nodes{};
+        uint32_t recomputed{}; // By the last update
+    };
+
+    // Parent and child transforms. Nodes store their local transform and the
+    // world one is derived on Update. Nodes sit in flat arrays with every parent
+    // ahead of its children, so one pass from the first dirty node recomputes
+    // the dirty subtrees and skips everything else. Moving a multi-part enemy is
+    // one SetLocal on its root.
+    //
+    // World transforms are the ones from the last Update.
+    class TransformHierarchy
+    {
+    public:
+        TransformHierarchy();
+        ~TransformHierarchy();
+
+        TransformId Create(TransformId p_parent = INVALID_TRANSFORM, const Transform2D &p_local = {});
+
+        // Destroys the node and everything under it
+        void Destroy(TransformId p_id);
+
+        // Keeps the local transform, false if it would make a cycle
+        bool SetParent(TransformId p_id, TransformId p_parent);
+        TransformId GetParent(TransformId p_id) const;
+
+        void SetLocal(TransformId p_id, const Transform2D &p_local);
+        void SetLocalPosition(TransformId p_id, glm::vec2 p_position);
+        void SetLocalRotation(TransformId p_id, float p_rotation);
+
+        const Transform2D &GetLocal(TransformId p_id) const;
+        const Transform2D &GetWorld(TransformId p_id) const;
+
+        // Between the world transforms of the last two updates, for drawing between ticks
+        Transform2D GetInterpolated(TransformId p_id, float p_alpha) const;
+
+        bool IsValid(TransformId p_id) const;
+
+        void Update();
+
+        void SaveState(SnapshotWriter &p_writer) const;
+        bool LoadState(SnapshotReader &p_reader);
+
+        TransformStats GetStats() const;
+
+    private:
+        static constexpr uint32_t NO_PARENT = ~0u;
+
+        // By position in the arrays, parents always before children
+        std::vector<Transform2D> m_local{};
+        std::vector<Transform2D> m_world{};
+        std::vector<Transform2D> m_previous{};
+        std::vector<uint32_t> m_parent{};
+        std::vector<uint8_t> m_dirty{};
+        std::vector<TransformId> m_ids{};
+
+        // Ids stay put while nodes move around
+        std::vector<uint32_t> m_indexOf{};
+        std::vector<TransformId> m_freeIds{};
+
+        // Recomputed by the last update, the only ones whose previous and world differ
+        std::vector<uint32_t> m_moved{};
+
+        uint32_t m_firstDirty{};
+        bool m_needsSort{};
+
+        TransformStats m_stats{};
+
+    private:
+        void MarkDirty(uint32_t p_index);
+        void SettleMoved();
+        void Sort();
+
+        TransformHierarchy(const TransformHierarchy &) = delete;
+        TransformHierarchy &operator=(const TransformHierarchy &) = delete;
+    };
+}
+
+#endif // !TRANSFORM_HIERARCHY_H
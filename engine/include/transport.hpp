@@ -0,0 +1,81 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <vector>
+
+#include <SDL3/SDL.h>
+
+namespace lum
+{
+    struct TransportStats
+    {
+        uint32_t sent{};
+        uint32_t received{};
+        uint32_t dropped{};
+        size_t   bytesSent{};
+    };
+
+    // Unreliable, unordered datagrams to one peer. Whatever sits on top has to
+    // cope with packets going missing or arriving late and out of order.
+    class Transport
+    {
+    public:
+        virtual ~Transport() = default;
+
+        virtual void Send(const uint8_t *p_data, size_t p_size) = 0;
+
+        // Next packet that has arrived, false when there are none
+        virtual bool Receive(std::vector<uint8_t> &p_outPacket) = 0;
+
+        virtual TransportStats GetStats() const = 0;
+    };
+
+    struct LoopbackConditions
+    {
+        float latencyMS{};  // One way
+        float jitterMS{};   // Added or taken off the latency at random, reorders packets
+        float loss{};       // Chance a packet never arrives, zero to one
+    };
+
+    // Both ends of a connection in one process. Packets wait in the receiving
+    // end until the simulated network would have delivered them, so a whole
+    // session can be tested on one machine.
+    class LoopbackTransport final : public Transport
+    {
+    public:
+        LoopbackTransport();
+        ~LoopbackTransport();
+
+        static void Connect(LoopbackTransport &p_a, LoopbackTransport &p_b);
+
+        // Applies to packets this end sends. Seeded separately from the
+        // simulation so network conditions never change what it does.
+        void SetConditions(const LoopbackConditions &p_conditions, uint64_t p_seed);
+
+        void Send(const uint8_t *p_data, size_t p_size) override;
+        bool Receive(std::vector<uint8_t> &p_outPacket) override;
+        TransportStats GetStats() const override;
+
+    private:
+        struct Packet
+        {
+            uint64_t deliverNS{};
+            std::vector<uint8_t> data{};
+        };
+
+        LoopbackTransport *m_peer{};
+        LoopbackConditions m_conditions{};
+        uint64_t m_randomState{};
+
+        std::vector<Packet> m_inbox{};
+        std::vector<std::vector<uint8_t>> m_spare{}; // Buffers of delivered packets, reused
+
+        TransportStats m_stats{};
+
+    private:
+        LoopbackTransport(const LoopbackTransport &) = delete;
+        LoopbackTransport &operator=(const LoopbackTransport &) = delete;
+    };
+}
+
+#endif // !TRANSPORT_H
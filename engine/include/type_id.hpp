@@ -0,0 +1,57 @@
+#ifndef TYPE_ID_H
+#define TYPE_ID_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace lum
+{
+    inline uint32_t NextTypeId()
+    {
+        static std::atomic<uint32_t> counter{};
+        return counter++;
+    }
+
+    // Small dense id per type, handed out on first use. Only stable for the
+    // lifetime of the process, never save it.
+    template<typename T>
+    uint32_t TypeId()
+    {
+        static const uint32_t id = NextTypeId();
+        return id;
+    }
+
+    // Readable name of T pulled out of the compiler's function signature, for
+    // debug output only
+    template<typename T>
+    const char *TypeName()
+    {
+#if defined(_MSC_VER)
+        static const std::string signature = __FUNCSIG__;
+        static const size_t start = signature.find("TypeName<") + 9;
+        static const size_t end = signature.rfind(">(void)");
+#else
+        static const std::string signature = __PRETTY_FUNCTION__;
+        static const size_t start = signature.find("T = ") + 4;
+        static const size_t end = signature.find_first_of(";]", start);
+#endif
+        static const std::string name = []
+        {
+            std::string result = signature.substr(start, end - start);
+
+            for (const char *prefix : { "class ", "struct " })
+            {
+                if (result.compare(0, std::strlen(prefix), prefix) == 0)
+                    result.erase(0, std::strlen(prefix));
+            }
+
+            return result;
+        }();
+
+        return name.c_str();
+    }
+}
+
+#endif // !TYPE_ID_H
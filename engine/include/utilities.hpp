@@ -26,6 +26,17 @@ namespace lum::utils
             return HashStr64(str + 1, (value ^ uint64_t(*str)) * 0x100000001B3);
         }
     }
+
+    // Same hash over a block of memory
+    inline uint64_t HashBytes64(const void *data, size_t size, uint64_t value = 0xCBF29CE484222325)
+    {
+        const uint8_t *bytes = static_cast<const uint8_t *>(data);
+
+        for (size_t i = 0; i < size; i++)
+            value = (value ^ uint64_t(bytes[i])) * 0x100000001B3;
+
+        return value;
+    }
 }
 
 #endif // !UTILITIES_H
@@ -1,10 +1,30 @@
 #include "src/engine.cpp"
+#include "src/string_id.cpp"
+#include "src/profiler.cpp"
+#include "src/snapshot.cpp"
+#include "src/ecs.cpp"
+#include "src/pool_allocator.cpp"
+#include "src/frame_arena.cpp"
+#include "src/job_system.cpp"
+#include "src/system_scheduler.cpp"
+#include "src/collision.cpp"
+#include "src/benchmark.cpp"
+#include "src/projectiles.cpp"
+#include "src/transform_hierarchy.cpp"
 #include "src/scene.cpp"
 #include "src/autoload.cpp"
 #include "src/scene_manager.cpp"
+#include "src/input_recorder.cpp"
+#include "src/transport.cpp"
+#include "src/rollback.cpp"
 #include "src/renderer.cpp"
 #include "src/asset_manager.cpp"
+#include "src/shader_compiler.cpp"
 #include "src/audio_manager.cpp"
+#include "src/mixer.cpp"
+#include "src/audio_effects.cpp"
+#include "src/audio_render.cpp"
+#include "src/music_stream.cpp"
 #include "src/actor.cpp"
 #include "src/component.cpp"
 
@@ -13,22 +33,55 @@
 
 #include <SDL3/SDL.h>
 
-SDL_AppResult SDL_AppInit(void **appstate, int, char **)
+SDL_AppResult SDL_AppInit(void **appstate, int argc, char **argv)
 {
+    // Before anything else allocates through SDL
+
+    lum::heap::TrackSDLAllocations();
+
     if (!SDL_SetAppMetadata("void", "1.0", "com.example.void"))
     {
         SDL_Log("Failed to set app metadata: %s", SDL_GetError());
         return SDL_APP_FAILURE;
     }
 
+    lum::Engine *engine = &lum::Engine::Get();
+    engine->config = lum::Engine::ParseArgs(argc, argv);
+
+    // Lets startup run on build machines without a display or sound card
+
+    if (engine->config.headless)
+    {
+        SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen");
+        SDL_SetHint(SDL_HINT_AUDIO_DRIVER, "dummy");
+    }
+
+    // Offline audio render, runs and quits before anything else starts
+
+    if (engine->config.audioScript)
+    {
+        SDL_SetHint(SDL_HINT_AUDIO_DRIVER, "dummy");
+
+        if (!SDL_Init(SDL_INIT_AUDIO))
+        {
+            SDL_Log("Failed to initialized SDL: %s", SDL_GetError());
+            return SDL_APP_FAILURE;
+        }
+
+        return engine->RunAudioRender() ? SDL_APP_SUCCESS : SDL_APP_FAILURE;
+    }
+
+    // Benchmarks don't need any subsystem
+
+    if (engine->config.benchmark)
+        return engine->RunBenchmark() ? SDL_APP_SUCCESS : SDL_APP_FAILURE;
+
     if (!SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO | SDL_INIT_GAMEPAD))
     {
         SDL_Log("Failed to initialized SDL: %s", SDL_GetError());
         return SDL_APP_FAILURE;
     }
 
-    lum::Engine *engine = &lum::Engine::Get();
-
     if (!engine->Init())
     {
         SDL_Log("Failed to initialized engine");
@@ -37,6 +90,9 @@ SDL_AppResult SDL_AppInit(void **appstate, int, char **)
 
     *appstate = engine;
 
+    if (engine->config.exitAfterStartup)
+        return SDL_APP_SUCCESS;
+
     return SDL_APP_CONTINUE;
 }
 
@@ -49,6 +105,9 @@ SDL_AppResult SDL_AppIterate(void *appstate)
     if (!engine->Render())
         return SDL_APP_FAILURE;
 
+    if (engine->quitRequested)
+        return SDL_APP_SUCCESS;
+
     return SDL_APP_CONTINUE;
 }
 
@@ -68,7 +127,9 @@ void SDL_AppQuit(void *appstate, SDL_AppResult)
 {
     lum::Engine *engine = static_cast<lum::Engine *>(appstate);
 
-    engine->Shutdown();
+    // Not set when init failed or an offline mode already cleaned up after itself
+    if (engine)
+        engine->Shutdown();
 
     SDL_Quit();
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "actor.hpp"
 
+#include "snapshot.hpp"
+
 namespace lum
 {
     Actor::Actor() = default;
@@ -13,7 +15,7 @@ namespace lum
 
     void Actor::Update(float p_delta)
     {
-        for (const auto &[_, comp] : m_components)
+        for (const auto &comp : m_components)
         {
             comp->Update(p_delta);
         }
@@ -21,10 +23,60 @@ namespace lum
 
     void Actor::Draw()
     {
-        for (const auto &[_, comp] : m_components)
+        for (const auto &comp : m_components)
         {
             if (comp->visual)
                 comp->Draw();
         }
     }
+
+    void Actor::SaveState(SnapshotWriter &p_writer) const
+    {
+        p_writer.WriteValue(static_cast<uint32_t>(m_components.size()));
+
+        for (const auto &comp : m_components)
+            comp->SaveState(p_writer);
+    }
+
+    bool Actor::LoadState(SnapshotReader &p_reader)
+    {
+        uint32_t count{};
+        if (!p_reader.ReadValue(count) || count != m_components.size())
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Actor: Snapshot of %s doesn't have its %zu components", tag ? tag : "<untagged>", m_components.size());
+            return false;
+        }
+
+        for (const auto &comp : m_components)
+        {
+            if (!comp->LoadState(p_reader))
+            {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Actor: Failed to load %s of %s", comp->name.c_str(), tag ? tag : "<untagged>");
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    Component *Actor::FindComponent(const std::string &p_name)
+    {
+        for (const auto &comp : m_components)
+        {
+            if (comp->name == p_name)
+                return comp.get();
+        }
+
+        return nullptr;
+    }
+
+    size_t Actor::GetComponentCount() const
+    {
+        return m_components.size();
+    }
+
+    Component *Actor::GetComponentAt(size_t p_index)
+    {
+        return p_index < m_components.size() ? m_components[p_index].get() : nullptr;
+    }
 }
\ No newline at end of file
@@ -1,10 +1,15 @@
 #include "asset_manager.hpp"
 
+#include <algorithm>
+
 #include <SDL3_shadercross/SDL_shadercross.h>
 #include <SDL3_image/SDL_image.h>
 #include <vorbis/vorbisfile.h>
 
+#include "profiler.hpp"
 #include "utilities.hpp"
+#include "music_stream.hpp"
+#include "frame_arena.hpp"
 
 namespace lum
 {
@@ -17,6 +22,12 @@ namespace lum
         const char *baseDir = SDL_GetBasePath();
         m_assetsDirectoryPath = std::string(baseDir) + "assets/";
 
+        if (!m_shaderCompiler.Init(m_assetsDirectoryPath))
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "AssetMgr: Failed to start shader compiler");
+            return false;
+        }
+
         return true;
     }
 
@@ -24,9 +35,27 @@ namespace lum
     {
         auto &gpuDevice = Engine::Get().renderer.gpuDevice;
 
-        // Release sounds
+        // Stop shader hot reloading before releasing anything it could reference
+
+        m_shaderCompiler.Shutdown();
+        m_compilingShaders.clear();
+
+        for (auto *shader : m_retiredShaders)
+        {
+            SDL_ReleaseGPUShader(gpuDevice, shader);
+        }
+
+        m_retiredShaders.clear();
+
+        // Release sounds, stopping any voice still reading from them
+
+        for (auto &[_, sound] : m_soundStorage)
+        {
+            Engine::Get().audioManager.UnregisterSound(sound);
+        }
 
         m_soundStorage.clear();
+        m_musicStorage.clear();
 
         // Release textures
 
@@ -35,57 +64,93 @@ namespace lum
             SDL_ReleaseGPUTexture(gpuDevice, texture.data);
         }
 
+        m_textureStorage.clear();
+
         // Release shaders
 
         for (const auto &[_, shader] : m_shaderStorage)
         {
             SDL_ReleaseGPUShader(gpuDevice, shader.data);
         }
+
+        m_shaderStorage.clear();
     }
 
-    Shader *AssetManager::GetShader(const char *p_tag)
+    Shader *AssetManager::GetShader(StringId p_tag)
     {
-        auto it = m_shaderStorage.find(utils::HashStr32(p_tag));
+        auto it = m_shaderStorage.find(p_tag);
         if (it == m_shaderStorage.end())
         {
-            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to get shader %s from storage", p_tag);
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to get shader %s from storage", StringTable::GetString(p_tag));
             return nullptr;
         }
 
+        it->second.lastUsedFrame = m_frameIndex;
+
         return &it->second;
     }
 
-    Texture *AssetManager::GetTexture(const char *p_tag)
+    Texture *AssetManager::GetTexture(StringId p_tag)
     {
-        auto it = m_textureStorage.find(utils::HashStr32(p_tag));
+        auto it = m_textureStorage.find(p_tag);
         if (it == m_textureStorage.end())
         {
-            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to get texture %s from storage", p_tag);
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to get texture %s from storage", StringTable::GetString(p_tag));
             return nullptr;
         }
 
+        it->second.lastUsedFrame = m_frameIndex;
+
         return &it->second;
     }
 
-    Sound *AssetManager::GetSound(const char *p_tag)
+    Sound *AssetManager::GetSound(StringId p_tag)
     {
-        auto it = m_soundStorage.find(utils::HashStr32(p_tag));
+        auto it = m_soundStorage.find(p_tag);
         if (it == m_soundStorage.end())
         {
-            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to get sound %s from storage", p_tag);
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to get sound %s from storage", StringTable::GetString(p_tag));
+            return nullptr;
+        }
+
+        it->second.lastUsedFrame = m_frameIndex;
+
+        return &it->second;
+    }
+
+    Music *AssetManager::GetMusic(StringId p_tag)
+    {
+        auto it = m_musicStorage.find(p_tag);
+        if (it == m_musicStorage.end())
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to get music %s from storage", StringTable::GetString(p_tag));
             return nullptr;
         }
 
+        it->second.lastUsedFrame = m_frameIndex;
+
         return &it->second;
     }
 
     bool AssetManager::LoadShader(const char *p_tag, const char *p_path, bool p_reload)
     {
+        const StringId tag = StringTable::Intern(p_tag);
+        if (!tag)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "AssetMgr: Can't register shader with tag: %s", p_tag);
+            return false;
+        }
+
         std::string glslFullPath = m_assetsDirectoryPath + p_path + ".glsl";
         std::string spvFullPath = m_assetsDirectoryPath + p_path + ".spv";
 
         size_t shaderSize;
-        void *shaderCode = SDL_LoadFile(spvFullPath.c_str(), &shaderSize);
+        void *shaderCode;
+        {
+            ProfileScope scope(ProfilePhase::FILE_READ, p_tag);
+            shaderCode = SDL_LoadFile(spvFullPath.c_str(), &shaderSize);
+        }
+
         if (!shaderCode)
         {
             SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed reading shader file: %s", SDL_GetError());
@@ -96,34 +161,23 @@ namespace lum
         SDL_PathInfo pathInfo{};
         SDL_GetPathInfo(glslFullPath.c_str(), &pathInfo);
 
-        SDL_ShaderCross_SPIRV_Info shaderInfo{};
-        shaderInfo.name = p_tag;
-        shaderInfo.entrypoint = "main";
-        shaderInfo.enable_debug = true;
-        shaderInfo.bytecode = static_cast<uint8_t *>(shaderCode);
-        shaderInfo.bytecode_size = static_cast<size_t>(shaderSize);
-
-        ShaderType type;
-        if (SDL_strstr(p_path, ".vert"))
-        {
-            type = ShaderType::VERTEX;
-            shaderInfo.shader_stage = SDL_SHADERCROSS_SHADERSTAGE_VERTEX;
-        }
-        else if (SDL_strstr(p_path, ".frag"))
-        {
-            type = ShaderType::FRAGMENT;
-            shaderInfo.shader_stage = SDL_SHADERCROSS_SHADERSTAGE_FRAGMENT;
-        }
-        else
+        if (!SDL_strstr(p_path, ".vert") && !SDL_strstr(p_path, ".frag"))
         {
             SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Invalid shader stage loaded");
+            SDL_free(shaderCode);
             return false;
         }
 
+        ShaderType type = ShaderCompiler::GetShaderTypeFromPath(p_path);
+
         auto &gpuDevice = Engine::Get().renderer.gpuDevice;
 
-        SDL_ShaderCross_GraphicsShaderMetadata vertMeta{};
-        SDL_GPUShader *shader = SDL_ShaderCross_CompileGraphicsShaderFromSPIRV(gpuDevice, &shaderInfo, &vertMeta);
+        SDL_GPUShader *shader;
+        {
+            ProfileScope scope(ProfilePhase::SHADER_COMPILE, p_tag);
+            shader = ShaderCompiler::CreateShaderFromSPIRV(p_tag, type, shaderCode, shaderSize);
+        }
+
         if (!shader)
         {
             SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to create shader: %s", SDL_GetError());
@@ -131,21 +185,21 @@ namespace lum
             return false;
         }
 
-        const uint32_t tagHash = utils::HashStr32(p_tag);
         if (!p_reload)
         {
-            if (m_shaderStorage.find(tagHash) != m_shaderStorage.end())
+            if (m_shaderStorage.find(tag) != m_shaderStorage.end())
             {
                 SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Overwriting existing shader with tag: %s",
                     p_tag);
             }
-            m_shaderStorage.emplace(tagHash, Shader{ p_tag, type, shader, p_path, pathInfo.modify_time });
+            m_shaderStorage.emplace(tag, Shader{ tag, type, shader, p_path, pathInfo.modify_time, shaderSize, 0, m_frameIndex });
         }
         else
         {
             SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Shader with tag '%s' is being reloaded", p_tag);
-            SDL_ReleaseGPUShader(gpuDevice, m_shaderStorage[tagHash].data);
-            m_shaderStorage[tagHash] = Shader{ p_tag, type, shader, p_path, pathInfo.modify_time };
+            auto &oldShader = m_shaderStorage[tag];
+            SDL_ReleaseGPUShader(gpuDevice, oldShader.data);
+            oldShader = Shader{ tag, type, shader, p_path, pathInfo.modify_time, shaderSize, oldShader.refCount, m_frameIndex };
         }
 
         SDL_free(shaderCode);
@@ -155,9 +209,45 @@ namespace lum
 
     bool AssetManager::LoadTexture(const char *p_tag, const char *p_path, bool p_reload)
     {
+        const StringId tag = StringTable::Intern(p_tag);
+        if (!tag)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "AssetMgr: Can't register texture with tag: %s", p_tag);
+            return false;
+        }
+
+        return LoadTexture(tag, p_path, p_reload);
+    }
+
+    bool AssetManager::LoadTexture(StringId p_tag, const char *p_path, bool p_reload)
+    {
+        const char *tagStr = StringTable::GetString(p_tag);
+
         std::string fullPath = m_assetsDirectoryPath + p_path;
 
-        SDL_Surface *imageData = IMG_Load(fullPath.c_str());
+        // Read and decode separately so each shows up on its own in the profiler
+
+        size_t fileSize;
+        void *fileData;
+        {
+            ProfileScope scope(ProfilePhase::FILE_READ, tagStr);
+            fileData = SDL_LoadFile(fullPath.c_str(), &fileSize);
+        }
+
+        if (!fileData)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to read image file: %s", SDL_GetError());
+            return false;
+        }
+
+        SDL_Surface *imageData;
+        {
+            ProfileScope scope(ProfilePhase::DECODE, tagStr);
+            imageData = IMG_Load_IO(SDL_IOFromConstMem(fileData, fileSize), true);
+        }
+
+        SDL_free(fileData);
+
         if (!imageData)
         {
             SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to load image file: %s", SDL_GetError());
@@ -165,7 +255,7 @@ namespace lum
         }
 
         if (!p_reload)
-            SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Texture '%s' loaded from '%s' (%dx%d)", p_tag, p_path, imageData->w, imageData->h);
+            SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Texture '%s' loaded from '%s' (%dx%d)", tagStr, p_path, imageData->w, imageData->h);
 
         SDL_PathInfo pathInfo{}; // Used for getting the last modify time of the file
         SDL_GetPathInfo(fullPath.c_str(), &pathInfo);
@@ -173,7 +263,13 @@ namespace lum
         // Handle different format images to force them into RGBA 32bit
 
         if (imageData->format == SDL_PIXELFORMAT_RGB24)
-            imageData = SDL_ConvertSurface(imageData, SDL_PIXELFORMAT_RGBA32);
+        {
+            ProfileScope scope(ProfilePhase::FORMAT_CONVERT, tagStr);
+
+            SDL_Surface *converted = SDL_ConvertSurface(imageData, SDL_PIXELFORMAT_RGBA32);
+            SDL_DestroySurface(imageData);
+            imageData = converted;
+        }
 
         // Create texture description
 
@@ -190,6 +286,8 @@ namespace lum
 
         auto &gpuDevice = Engine::Get().renderer.gpuDevice;
 
+        ProfileScope uploadScope(ProfilePhase::GPU_UPLOAD, tagStr);
+
         auto texture = SDL_CreateGPUTexture(gpuDevice, &textureCI);
         if (!texture)
         {
@@ -197,7 +295,7 @@ namespace lum
             return false;
         }
 
-        SDL_SetGPUTextureName(gpuDevice, texture, p_tag);
+        SDL_SetGPUTextureName(gpuDevice, texture, tagStr);
 
         // Map data
 
@@ -240,21 +338,22 @@ namespace lum
 
         // Store texture
 
-        const uint32_t tagHash = utils::HashStr32(p_tag);
+        const uint64_t textureBytes = static_cast<uint64_t>(imageData->w) * imageData->h * 4;
 
         if (!p_reload)
         {
-            if (m_textureStorage.find(tagHash) != m_textureStorage.end())
+            if (m_textureStorage.find(p_tag) != m_textureStorage.end())
             {
-                SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "AssetMgr: Overwriting existing texture with tag: %s", p_tag);
+                SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "AssetMgr: Overwriting existing texture with tag: %s", tagStr);
             }
-            m_textureStorage.emplace(tagHash, Texture{ p_tag, vec2(imageData->w, imageData->h), texture, p_path, pathInfo.modify_time });
+            m_textureStorage.emplace(p_tag, Texture{ p_tag, vec2(imageData->w, imageData->h), texture, p_path, pathInfo.modify_time, textureBytes, 0, m_frameIndex });
         }
         else
         {
-            SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "AssetMgr: Texture with tag '%s' is being reloaded", p_tag);
-            SDL_ReleaseGPUTexture(gpuDevice, m_textureStorage[tagHash].data);
-            m_textureStorage[tagHash] = Texture{ p_tag, vec2(imageData->w, imageData->h), texture, p_path, pathInfo.modify_time };
+            SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "AssetMgr: Texture with tag '%s' is being reloaded", tagStr);
+            auto &oldTexture = m_textureStorage[p_tag];
+            SDL_ReleaseGPUTexture(gpuDevice, oldTexture.data);
+            oldTexture = Texture{ p_tag, vec2(imageData->w, imageData->h), texture, p_path, pathInfo.modify_time, textureBytes, oldTexture.refCount, m_frameIndex };
         }
 
         SDL_DestroySurface(imageData);
@@ -265,49 +364,398 @@ namespace lum
 
     bool AssetManager::LoadSound(const char *p_tag, const char *p_path)
     {
-        Sound sound;
+        const StringId tag = StringTable::Intern(p_tag);
+        if (!tag)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "AssetMgr: Can't register sound with tag: %s", p_tag);
+            return false;
+        }
+
+        // The mixer has to be running, its format is what sounds get stored in
+
+        const SDL_AudioSpec &mixSpec = Engine::Get().audioManager.GetMixSpec();
+        if (mixSpec.channels == 0)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_ERROR, "AssetMgr: Can't load sound '%s' before the audio device is open", p_tag);
+            return false;
+        }
 
         std::string fullPath = m_assetsDirectoryPath + p_path;
 
-        if (SDL_strstr(p_path, ".ogg"))
+        SDL_AudioSpec pcmSpec{};
+        std::vector<uint8_t> pcm{};
         {
-            if (!LoadOGG(fullPath.c_str(), &sound.audioSpec, sound.buffer))
+            ProfileScope scope(ProfilePhase::DECODE, p_tag);
+
+            if (SDL_strstr(p_path, ".ogg"))
             {
-                return false;
+                if (!LoadOGG(fullPath.c_str(), &pcmSpec, pcm))
+                {
+                    return false;
+                }
             }
+            else if (SDL_strstr(p_path, ".wav"))
+            {
+                uint8_t *tempBuffer;
+                uint32_t tempLength;
+                if (!SDL_LoadWAV(fullPath.c_str(), &pcmSpec, &tempBuffer, &tempLength))
+                {
+                    SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to load WAV file: %s", SDL_GetError());
+                    return false;
+                }
 
-            sound.length = static_cast<uint32_t>(sound.buffer.size());
+                pcm.assign(tempBuffer, tempBuffer + tempLength);
+                SDL_free(tempBuffer);
+            }
         }
-        else if (SDL_strstr(p_path, ".wav"))
+
+        // Convert and resample once here so playing is only a gain and add
+
+        Sound sound;
         {
-            uint8_t *tempBuffer;
-            if (!SDL_LoadWAV(fullPath.c_str(), &sound.audioSpec, &tempBuffer, &sound.length))
+            ProfileScope scope(ProfilePhase::FORMAT_CONVERT, p_tag);
+
+            uint8_t *converted = nullptr;
+            int convertedLength = 0;
+            if (!SDL_ConvertAudioSamples(&pcmSpec, pcm.data(), static_cast<int>(pcm.size()), &mixSpec, &converted, &convertedLength))
             {
-                SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to load WAV file: %s", SDL_GetError());
+                SDL_LogError(SDL_LOG_CATEGORY_ERROR, "AssetMgr: Failed to convert sound '%s': %s", p_tag, SDL_GetError());
                 return false;
             }
 
-            sound.buffer.assign(tempBuffer, tempBuffer + sound.length);
-            SDL_free(tempBuffer);
+            const float *samples = reinterpret_cast<const float *>(converted);
+            sound.samples.assign(samples, samples + convertedLength / sizeof(float));
+            sound.frameCount = static_cast<uint32_t>(convertedLength / SDL_AUDIO_FRAMESIZE(mixSpec));
+
+            SDL_free(converted);
+        }
+
+        sound.tag = tag;
+        sound.audioSpec = mixSpec;
+        sound.filePath = p_path;
+        sound.sizeBytes = sound.samples.size() * sizeof(float);
+        sound.lastUsedFrame = m_frameIndex;
+
+        auto &storedSound = m_soundStorage[tag];
+        Engine::Get().audioManager.UnregisterSound(storedSound);
+        sound.refCount = storedSound.refCount;
+        sound.playback = storedSound.playback;
+        storedSound = std::move(sound);
+
+        // The mixer keeps a pointer to the samples, they don't move with the vector
+        storedSound.mixerId = Engine::Get().audioManager.RegisterSound(storedSound);
+
+        SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Sound '%s' loaded from '%s' (%d Hz, %d channels -> %d Hz, %d channels)", p_tag, p_path,
+            pcmSpec.freq, pcmSpec.channels, mixSpec.freq, mixSpec.channels);
+
+        return true;
+    }
+
+    bool AssetManager::LoadMusic(const char *p_tag, const char *p_path)
+    {
+        const StringId tag = StringTable::Intern(p_tag);
+        if (!tag)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "AssetMgr: Can't register music with tag: %s", p_tag);
+            return false;
+        }
+
+        Music music;
+        music.tag = tag;
+        music.filePath = m_assetsDirectoryPath + p_path;
+
+        // Only read the header here, the audio data gets decoded while it plays
+
+        ProfileScope scope(ProfilePhase::DECODE, p_tag);
+
+        OggVorbis_File vf;
+        if (!MusicStream::OpenVorbisFile(music.filePath.c_str(), &vf))
+            return false;
+
+        vorbis_info *info = ov_info(&vf, -1);
+        music.audioSpec.channels = info->channels;
+        music.audioSpec.freq = info->rate;
+        music.audioSpec.format = SDL_AUDIO_S16; // 16-bit signed PCM
+        music.totalFrames = ov_pcm_total(&vf, -1);
+
+        ov_clear(&vf);
+
+        SDL_PathInfo pathInfo{};
+        SDL_GetPathInfo(music.filePath.c_str(), &pathInfo);
+        music.lastModifyTime = pathInfo.modify_time;
+
+        music.lastUsedFrame = m_frameIndex;
+
+        auto &storedMusic = m_musicStorage[tag];
+        music.refCount = storedMusic.refCount;
+        storedMusic = std::move(music);
+
+        SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Music '%s' registered for streaming from '%s'", p_tag, p_path);
+
+        return true;
+    }
+
+    AssetHandle<Shader> AssetManager::AcquireShader(StringId p_tag)
+    {
+        return AssetHandle<Shader>(this, AssetType::SHADER, p_tag, GetShader(p_tag));
+    }
+
+    AssetHandle<Texture> AssetManager::AcquireTexture(StringId p_tag)
+    {
+        return AssetHandle<Texture>(this, AssetType::TEXTURE, p_tag, GetTexture(p_tag));
+    }
+
+    AssetHandle<Sound> AssetManager::AcquireSound(StringId p_tag)
+    {
+        return AssetHandle<Sound>(this, AssetType::SOUND, p_tag, GetSound(p_tag));
+    }
+
+    AssetHandle<Music> AssetManager::AcquireMusic(StringId p_tag)
+    {
+        return AssetHandle<Music>(this, AssetType::MUSIC, p_tag, GetMusic(p_tag));
+    }
+
+    bool AssetManager::IsResident(AssetType p_type, StringId p_tag) const
+    {
+        switch (p_type)
+        {
+        case AssetType::SHADER:
+            return m_shaderStorage.find(p_tag) != m_shaderStorage.end();
+        case AssetType::TEXTURE:
+            return m_textureStorage.find(p_tag) != m_textureStorage.end();
+        case AssetType::SOUND:
+            return m_soundStorage.find(p_tag) != m_soundStorage.end();
+        case AssetType::MUSIC:
+            return m_musicStorage.find(p_tag) != m_musicStorage.end();
+        default:
+            return false;
+        }
+    }
+
+    template<typename T>
+    static void AdjustRefCount(std::unordered_map<StringId, T> &p_storage, StringId p_tag, int32_t p_delta, uint64_t p_frameIndex)
+    {
+        auto it = p_storage.find(p_tag);
+        if (it == p_storage.end())
+            return;
+
+        auto &asset = it->second;
+
+        if (p_delta < 0 && asset.refCount == 0)
+        {
+            SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "AssetMgr: Released asset '%s' more times than it was acquired", StringTable::GetString(asset.tag));
+            return;
+        }
+
+        asset.refCount += p_delta;
+        asset.lastUsedFrame = p_frameIndex;
+    }
+
+    void AssetManager::AddRef(AssetType p_type, StringId p_tag)
+    {
+        switch (p_type)
+        {
+        case AssetType::SHADER:
+            AdjustRefCount(m_shaderStorage, p_tag, 1, m_frameIndex);
+            break;
+        case AssetType::TEXTURE:
+            AdjustRefCount(m_textureStorage, p_tag, 1, m_frameIndex);
+            break;
+        case AssetType::SOUND:
+            AdjustRefCount(m_soundStorage, p_tag, 1, m_frameIndex);
+            break;
+        case AssetType::MUSIC:
+            AdjustRefCount(m_musicStorage, p_tag, 1, m_frameIndex);
+            break;
+        default:
+            break;
+        }
+    }
+
+    void AssetManager::Release(AssetType p_type, StringId p_tag)
+    {
+        switch (p_type)
+        {
+        case AssetType::SHADER:
+            AdjustRefCount(m_shaderStorage, p_tag, -1, m_frameIndex);
+            break;
+        case AssetType::TEXTURE:
+            AdjustRefCount(m_textureStorage, p_tag, -1, m_frameIndex);
+            break;
+        case AssetType::SOUND:
+            AdjustRefCount(m_soundStorage, p_tag, -1, m_frameIndex);
+            break;
+        case AssetType::MUSIC:
+            AdjustRefCount(m_musicStorage, p_tag, -1, m_frameIndex);
+            break;
+        default:
+            break;
+        }
+    }
+
+    void AssetManager::SetMemoryBudgets(uint64_t p_cpuBytes, uint64_t p_gpuBytes)
+    {
+        m_cpuBudget = p_cpuBytes;
+        m_gpuBudget = p_gpuBytes;
+    }
+
+    void AssetManager::EvictUnused()
+    {
+        // Runs at the start of the frame, before anything could have looked up
+        // an asset for this frame's draws
+
+        AssetMemoryStats stats = GetMemoryStats();
+
+        while (stats.gpuBytes > m_gpuBudget && EvictLeastRecentlyUsed(true))
+            stats = GetMemoryStats();
+
+        while (stats.cpuBytes > m_cpuBudget && EvictLeastRecentlyUsed(false))
+            stats = GetMemoryStats();
+
+        m_frameIndex++;
+    }
+
+    template<typename T>
+    static bool IsPlaying(const T &)
+    {
+        return false;
+    }
+
+    // Sounds with voices still on them stay, whatever their last use was
+    static bool IsPlaying(const Sound &p_sound)
+    {
+        return Engine::Get().audioManager.IsSoundPlaying(p_sound.mixerId);
+    }
+
+    template<typename T>
+    static void FindLeastRecentlyUsed(const std::unordered_map<StringId, T> &p_storage, AssetType p_type,
+        AssetType &p_outType, StringId &p_outTag, uint64_t &p_outFrame)
+    {
+        for (const auto &[tag, asset] : p_storage)
+        {
+            if (asset.refCount == 0 && !IsPlaying(asset) && asset.lastUsedFrame < p_outFrame)
+            {
+                p_outType = p_type;
+                p_outTag = tag;
+                p_outFrame = asset.lastUsedFrame;
+            }
+        }
+    }
+
+    bool AssetManager::EvictLeastRecentlyUsed(bool p_gpu)
+    {
+        AssetType type = AssetType::COUNT;
+        StringId tag{};
+        uint64_t frame = UINT64_MAX;
+
+        if (p_gpu)
+        {
+            FindLeastRecentlyUsed(m_textureStorage, AssetType::TEXTURE, type, tag, frame);
+            FindLeastRecentlyUsed(m_shaderStorage, AssetType::SHADER, type, tag, frame);
+        }
+        else
+        {
+            FindLeastRecentlyUsed(m_soundStorage, AssetType::SOUND, type, tag, frame);
+            FindLeastRecentlyUsed(m_musicStorage, AssetType::MUSIC, type, tag, frame);
         }
 
-        m_soundStorage[utils::HashStr32(p_tag)] = std::move(sound);
+        if (type == AssetType::COUNT)
+            return false;
 
-        SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Sound '%s' loaded from '%s'", p_tag, p_path);
+        UnloadAsset(type, tag);
 
         return true;
     }
 
+    void AssetManager::UnloadAsset(AssetType p_type, StringId p_tag)
+    {
+        auto &gpuDevice = Engine::Get().renderer.gpuDevice;
+
+        // SDL defers destroying GPU resources until submitted work is done with them
+
+        switch (p_type)
+        {
+        case AssetType::SHADER:
+        {
+            auto it = m_shaderStorage.find(p_tag);
+            SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "AssetMgr: Evicting shader '%s'", StringTable::GetString(it->second.tag));
+            SDL_ReleaseGPUShader(gpuDevice, it->second.data);
+            m_shaderStorage.erase(it);
+            break;
+        }
+        case AssetType::TEXTURE:
+        {
+            auto it = m_textureStorage.find(p_tag);
+            SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "AssetMgr: Evicting texture '%s'", StringTable::GetString(it->second.tag));
+            SDL_ReleaseGPUTexture(gpuDevice, it->second.data);
+            m_textureStorage.erase(it);
+            break;
+        }
+        case AssetType::SOUND:
+        {
+            auto it = m_soundStorage.find(p_tag);
+            SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "AssetMgr: Evicting sound '%s'", StringTable::GetString(it->second.tag));
+            Engine::Get().audioManager.UnregisterSound(it->second);
+            m_soundStorage.erase(it);
+            break;
+        }
+        case AssetType::MUSIC:
+        {
+            auto it = m_musicStorage.find(p_tag);
+            SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "AssetMgr: Evicting music '%s'", StringTable::GetString(it->second.tag));
+            m_musicStorage.erase(it);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    template<typename T>
+    static void AccumulateStats(const std::unordered_map<StringId, T> &p_storage, AssetType p_type, AssetMemoryStats &p_stats)
+    {
+        const size_t index = static_cast<size_t>(p_type);
+
+        for (const auto &[_, asset] : p_storage)
+        {
+            p_stats.residentBytes[index] += asset.sizeBytes;
+            p_stats.residentCount[index]++;
+
+            if (asset.refCount == 0)
+                p_stats.cachedCount[index]++;
+        }
+    }
+
+    AssetMemoryStats AssetManager::GetMemoryStats() const
+    {
+        AssetMemoryStats stats{};
+
+        AccumulateStats(m_shaderStorage, AssetType::SHADER, stats);
+        AccumulateStats(m_textureStorage, AssetType::TEXTURE, stats);
+        AccumulateStats(m_soundStorage, AssetType::SOUND, stats);
+        AccumulateStats(m_musicStorage, AssetType::MUSIC, stats);
+
+        stats.gpuBytes = stats.residentBytes[static_cast<size_t>(AssetType::TEXTURE)] + stats.residentBytes[static_cast<size_t>(AssetType::SHADER)];
+        stats.cpuBytes = stats.residentBytes[static_cast<size_t>(AssetType::SOUND)] + stats.residentBytes[static_cast<size_t>(AssetType::MUSIC)];
+        stats.cpuBudget = m_cpuBudget;
+        stats.gpuBudget = m_gpuBudget;
+
+        return stats;
+    }
+
     void AssetManager::CheckForModifiedAssets()
     {
         auto &renderer = Engine::Get().renderer;
+        auto &arena = FrameArena::Get();
         SDL_PathInfo pathInfo{};
 
+        // Paths are built in the frame arena, this runs every frame
+
         // Textures
 
         for (auto const &[_, textureAsset] : m_textureStorage)
         {
-            if (!SDL_GetPathInfo((m_assetsDirectoryPath + textureAsset.filePath).c_str(), &pathInfo))
+            if (!SDL_GetPathInfo(arena.Format("%s%s", m_assetsDirectoryPath.c_str(), textureAsset.filePath.c_str()), &pathInfo))
             {
                 SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "AssetMgr: Couldn't find texture asset file while checking for changes");
                 continue;
@@ -322,14 +770,17 @@ namespace lum
             // maybe because of like concurrency stuff?
             SDL_WaitForGPUIdle(renderer.gpuDevice);
 
-            LoadTexture(textureAsset.tag, textureAsset.filePath, true);
+            LoadTexture(textureAsset.tag, textureAsset.filePath.c_str(), true);
         }
 
         // Shaders
+        //
+        // Compilation happens on the shader compiler thread, the old shader and
+        // pipelines keep rendering until the results are swapped in below
 
         for (auto &[tag, shaderAsset] : m_shaderStorage)
         {
-            if (!SDL_GetPathInfo((m_assetsDirectoryPath + shaderAsset.filePath + ".glsl").c_str(), &pathInfo))
+            if (!SDL_GetPathInfo(arena.Format("%s%s.glsl", m_assetsDirectoryPath.c_str(), shaderAsset.filePath.c_str()), &pathInfo))
             {
                 SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,
                     "AssetMgr: Couldn't find shader asset file while checking for changes");
@@ -341,103 +792,290 @@ namespace lum
 
             SDL_Log("--- Shader asset reload");
 
-            if (!CompileShader(shaderAsset.filePath))
+            SubmitShaderCompile(shaderAsset, pathInfo.modify_time);
+        }
+
+        ApplyShaderCompileResults();
+    }
+
+    const std::vector<ShaderCompileError> &AssetManager::GetShaderCompileErrors() const
+    {
+        return m_shaderCompileErrors;
+    }
+
+    void AssetManager::SubmitShaderCompile(Shader &p_shader, SDL_Time p_modifyTime)
+    {
+        auto &renderer = Engine::Get().renderer;
+
+        // Mark as up to date now so the same edit doesn't get queued every frame
+
+        p_shader.lastModifyTime = p_modifyTime;
+
+        ShaderCompileJob job{};
+        job.tag = p_shader.tag;
+        job.name = StringTable::GetString(p_shader.tag);
+        job.path = p_shader.filePath;
+        job.type = p_shader.type;
+        job.modifyTime = p_modifyTime;
+
+        m_compilingShaders.push_back(AcquireShader(p_shader.tag));
+
+        // Find pipelines that use the shader being compiled
+
+        for (auto const &[pipelineTag, pipelineDesc] : renderer.m_graphicsPipelines)
+        {
+            if (p_shader.tag != pipelineDesc.vertTag && p_shader.tag != pipelineDesc.fragTag)
+                continue;
+
+            PipelineRebuild rebuild{};
+            rebuild.tag = pipelineTag;
+            rebuild.vertTag = pipelineDesc.vertTag;
+            rebuild.fragTag = pipelineDesc.fragTag;
+            rebuild.layout = pipelineDesc.layout;
+            rebuild.vertShader = GetShader(pipelineDesc.vertTag)->data;
+            rebuild.fragShader = GetShader(pipelineDesc.fragTag)->data;
+
+            m_compilingShaders.push_back(AcquireShader(pipelineDesc.vertTag));
+            m_compilingShaders.push_back(AcquireShader(pipelineDesc.fragTag));
+
+            job.pipelines.push_back(rebuild);
+        }
+
+        m_shaderCompiler.Submit(std::move(job));
+    }
+
+    void AssetManager::ApplyShaderCompileResults()
+    {
+        auto &renderer = Engine::Get().renderer;
+
+        // Called at the start of the frame, so nothing recorded so far references
+        // the objects being swapped. SDL keeps released pipelines alive until the
+        // GPU is done with them, so there's no need to wait for idle here.
+
+        ShaderCompileResult result{};
+        while (m_shaderCompiler.PollResult(result))
+        {
+            const auto &job = result.job;
+
+            auto errorIt = std::find_if(m_shaderCompileErrors.begin(), m_shaderCompileErrors.end(),
+                [&](const ShaderCompileError &p_error) { return p_error.tag == job.tag; });
+
+            if (!result.success)
             {
-                SDL_GetPathInfo((m_assetsDirectoryPath + shaderAsset.filePath + ".glsl").c_str(), &pathInfo);
-                shaderAsset.lastModifyTime = pathInfo.modify_time;
+                SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "AssetMgr: Error compiling shader '%s'\n%s", job.path.c_str(), result.log.c_str());
+
+                if (errorIt != m_shaderCompileErrors.end())
+                    errorIt->log = result.log;
+                else
+                    m_shaderCompileErrors.push_back(ShaderCompileError{ job.tag, job.path, result.log });
+
+                if (result.shader)
+                    SDL_ReleaseGPUShader(renderer.gpuDevice, result.shader);
+
                 continue;
             }
 
-            SDL_WaitForGPUIdle(renderer.gpuDevice);
-            LoadShader(shaderAsset.tag, shaderAsset.filePath, true);
+            SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "AssetMgr: Shader '%s' compiling successful.", job.path.c_str());
+
+            if (errorIt != m_shaderCompileErrors.end())
+                m_shaderCompileErrors.erase(errorIt);
 
-            // Find pipelines that use the shader just compiled
+            // Evicted after the compiler went idle, nothing left to swap into
 
-            for (auto const &[pipelineTag, pipelineDesc] : renderer.m_graphicsPipelines)
+            auto shaderIt = m_shaderStorage.find(job.tag);
+            if (shaderIt == m_shaderStorage.end())
             {
-                // 1 vert tag | 2 frag tag
+                SDL_ReleaseGPUShader(renderer.gpuDevice, result.shader);
 
-                if (SDL_strcmp(shaderAsset.tag, pipelineDesc.vertTag) == 0 || SDL_strcmp(shaderAsset.tag, pipelineDesc.fragTag) == 0)
+                for (const auto &rebuild : job.pipelines)
                 {
-                    SDL_ReleaseGPUGraphicsPipeline(renderer.gpuDevice, pipelineDesc.pipeline);
-
-                    SDL_Log("Graphics pipeline '%s' will be recreated", pipelineDesc.tag);
-
-                    renderer.CreateGraphicsPipeline(pipelineDesc.tag, pipelineDesc.vertTag, pipelineDesc.fragTag, true);
+                    if (rebuild.pipeline)
+                        SDL_ReleaseGPUGraphicsPipeline(renderer.gpuDevice, rebuild.pipeline);
                 }
+
+                continue;
             }
-        }
-    }
 
-    bool AssetManager::CompileShader(const char *p_path)
-    {
-        std::string shaderStage = "-fshader-stage=";
+            // Swap shader, the old one may still be referenced by queued jobs
 
-        if (SDL_strstr(p_path, ".vert"))
-        {
-            shaderStage += "vert";
-        }
-        else if (SDL_strstr(p_path, ".frag"))
-        {
-            shaderStage += "frag";
-        }
+            m_retiredShaders.push_back(shaderIt->second.data);
+            shaderIt->second.data = result.shader;
 
-        std::string fullPath = m_assetsDirectoryPath + p_path;
-        std::string inputPath = fullPath + ".glsl";
-        std::string outputPath = fullPath + ".spv";
+            // Swap pipelines
 
-        // IMPORTANT: Assuming we have glslc installed (VulkanSDK) and in the PATH
+            for (const auto &rebuild : job.pipelines)
+            {
+                auto pipelineIt = renderer.m_graphicsPipelines.find(rebuild.tag);
+                if (!rebuild.pipeline || pipelineIt == renderer.m_graphicsPipelines.end())
+                    continue;
 
-        const char *args[] = { "glslc", shaderStage.c_str(), inputPath.c_str(), "-o", outputPath.c_str(), NULL };
-        SDL_Process *shaderCompProc = SDL_CreateProcess(args, false);
-        if (!shaderCompProc)
-        {
-            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "AssetMgr: Couldn't launch glslc process for compiling shader");
-            return false;
+                SDL_ReleaseGPUGraphicsPipeline(renderer.gpuDevice, pipelineIt->second.pipeline);
+                pipelineIt->second.pipeline = rebuild.pipeline;
+
+                SDL_LogInfo(SDL_LOG_CATEGORY_VIDEO, "Renderer: Graphics pipeline with tag '%s' is being reloaded", StringTable::GetString(rebuild.tag));
+            }
         }
 
-        int exitCode;
-        SDL_WaitProcess(shaderCompProc, true, &exitCode);
+        // Only release replaced shaders once no job can be building with them
 
-        if (exitCode == 0)
-        {
-            SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "AssetMgr: Shader '%s' compiling successful.", p_path);
-        }
-        else
+        if ((!m_retiredShaders.empty() || !m_compilingShaders.empty()) && !m_shaderCompiler.IsBusy())
         {
-            SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "AssetMgr: Error compiling shader '%s'", p_path);
-            return false;
-        }
-
-        SDL_DestroyProcess(shaderCompProc);
+            for (auto *shader : m_retiredShaders)
+            {
+                SDL_ReleaseGPUShader(renderer.gpuDevice, shader);
+            }
 
-        return true;
+            m_retiredShaders.clear();
+            m_compilingShaders.clear();
+        }
     }
 
     bool AssetManager::LoadOGG(const char *p_path, SDL_AudioSpec *p_spec, std::vector<uint8_t> &p_outBuffer)
     {
         OggVorbis_File vf;
-        ov_fopen(p_path, &vf);
+        if (ov_fopen(p_path, &vf) != 0)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to open OGG file: %s", p_path);
+            return false;
+        }
 
         vorbis_info *sound_info = ov_info(&vf, -1);
         p_spec->channels = sound_info->channels;
         p_spec->freq = sound_info->rate;
         p_spec->format = SDL_AUDIO_S16; // 16-bit signed PCM
 
+        // Decode straight into the output, sized up front from the stream length.
+        // Long tracks should go through LoadMusic and be streamed instead.
+
+        const int64_t frameSize = sound_info->channels * sizeof(int16_t);
+        const int64_t totalFrames = ov_pcm_total(&vf, -1);
+
+        p_outBuffer.resize((totalFrames > 0 ? static_cast<size_t>(totalFrames * frameSize) : 0) + 4096);
+
+        size_t  decoded = 0;
         int32_t bitstream;
-        char    buffer[4096];
         int64_t bytes;
         do
         {
-            bytes = ov_read(&vf, buffer, sizeof(buffer), 0, 2, 1, &bitstream);
+            if (p_outBuffer.size() - decoded < 4096)
+                p_outBuffer.resize(p_outBuffer.size() + 4096);
+
+            bytes = ov_read(&vf, reinterpret_cast<char *>(p_outBuffer.data() + decoded), static_cast<int>(p_outBuffer.size() - decoded), 0, 2, 1, &bitstream);
             if (bytes > 0)
             {
-                p_outBuffer.insert(p_outBuffer.end(), buffer, buffer + bytes);
+                decoded += static_cast<size_t>(bytes);
             }
-        } while (bytes > 0);
+        } while (bytes > 0 || bytes == OV_HOLE);
+
+        p_outBuffer.resize(decoded);
 
         ov_clear(&vf);
 
         return true;
     }
-}
\ No newline at end of file
+
+    // ASSET SCOPE
+    //
+
+    AssetScope::AssetScope(AssetManager &p_assetManager) : m_assetManager(p_assetManager) {}
+
+    AssetScope::~AssetScope()
+    {
+        ReleaseAll();
+    }
+
+    bool AssetScope::LoadTexture(const char *p_tag, const char *p_path)
+    {
+        // Interning here catches a colliding tag before it can alias a resident asset
+
+        const StringId tag = StringTable::Intern(p_tag);
+        if (!tag)
+            return false;
+
+        if (!m_assetManager.IsResident(AssetType::TEXTURE, tag) && !m_assetManager.LoadTexture(p_tag, p_path))
+            return false;
+
+        return Hold(AssetType::TEXTURE, tag);
+    }
+
+    bool AssetScope::LoadSound(const char *p_tag, const char *p_path)
+    {
+        // Interning here catches a colliding tag before it can alias a resident asset
+
+        const StringId tag = StringTable::Intern(p_tag);
+        if (!tag)
+            return false;
+
+        if (!m_assetManager.IsResident(AssetType::SOUND, tag) && !m_assetManager.LoadSound(p_tag, p_path))
+            return false;
+
+        return Hold(AssetType::SOUND, tag);
+    }
+
+    bool AssetScope::LoadMusic(const char *p_tag, const char *p_path)
+    {
+        // Interning here catches a colliding tag before it can alias a resident asset
+
+        const StringId tag = StringTable::Intern(p_tag);
+        if (!tag)
+            return false;
+
+        if (!m_assetManager.IsResident(AssetType::MUSIC, tag) && !m_assetManager.LoadMusic(p_tag, p_path))
+            return false;
+
+        return Hold(AssetType::MUSIC, tag);
+    }
+
+    bool AssetScope::Load(const AssetManifestEntry &p_entry)
+    {
+        switch (p_entry.type)
+        {
+        case AssetType::TEXTURE:
+            return LoadTexture(p_entry.tag, p_entry.path);
+        case AssetType::SOUND:
+            return LoadSound(p_entry.tag, p_entry.path);
+        case AssetType::MUSIC:
+            return LoadMusic(p_entry.tag, p_entry.path);
+        default:
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "AssetMgr: Asset '%s' has a type that can't be part of a scene manifest", p_entry.tag);
+            return false;
+        }
+    }
+
+    bool AssetScope::Holds(AssetType p_type, StringId p_tag) const
+    {
+        for (const auto &asset : m_assets)
+        {
+            if (asset.first == p_type && asset.second == p_tag)
+                return true;
+        }
+
+        return false;
+    }
+
+    size_t AssetScope::GetCount() const
+    {
+        return m_assets.size();
+    }
+
+    void AssetScope::ReleaseAll()
+    {
+        for (const auto &[type, tag] : m_assets)
+        {
+            m_assetManager.Release(type, tag);
+        }
+
+        m_assets.clear();
+    }
+
+    bool AssetScope::Hold(AssetType p_type, StringId p_tag)
+    {
+        if (Holds(p_type, p_tag))
+            return true;
+
+        m_assetManager.AddRef(p_type, p_tag);
+        m_assets.emplace_back(p_type, p_tag);
+
+        return true;
+    }
+}
@@ -0,0 +1,556 @@
+#include "audio_effects.hpp"
+
+#include "simd.hpp"
+
+namespace lum
+{
+	namespace
+	{
+		float DecibelsToGain(float p_decibels)
+		{
+			return SDL_powf(10.0f, p_decibels / 20.0f);
+		}
+
+		float GainToDecibels(float p_gain)
+		{
+			return 20.0f * SDL_log10f(p_gain > 1e-9f ? p_gain : 1e-9f);
+		}
+
+		// Per block coefficient of a one pole follower with the given time constant
+		float BlockCoefficient(float p_timeMS, uint32_t p_frames, int p_sampleRate)
+		{
+			if (p_timeMS <= 0.0f || p_sampleRate <= 0)
+				return 0.0f;
+
+			return SDL_expf(-static_cast<float>(p_frames) / (p_timeMS * 0.001f * static_cast<float>(p_sampleRate)));
+		}
+
+		float FollowEnvelope(float p_envelope, float p_peak, float p_attackCoef, float p_releaseCoef)
+		{
+			const float coef = p_peak > p_envelope ? p_attackCoef : p_releaseCoef;
+			return p_peak + (p_envelope - p_peak) * coef;
+		}
+	}
+
+	// SMOOTHED PARAM
+	//
+
+	SmoothedParam::SmoothedParam(float p_value)
+		: m_target(p_value), m_current(p_value)
+	{
+	}
+
+	void SmoothedParam::Set(float p_value)
+	{
+		m_target.store(p_value, std::memory_order_relaxed);
+	}
+
+	float SmoothedParam::GetTarget() const
+	{
+		return m_target.load(std::memory_order_relaxed);
+	}
+
+	float SmoothedParam::Get() const
+	{
+		return m_current;
+	}
+
+	bool SmoothedParam::Advance(uint32_t p_frames, int p_sampleRate)
+	{
+		const float target = GetTarget();
+		if (m_current == target)
+			return false;
+
+		m_current = target + (m_current - target) * BlockCoefficient(SMOOTHING_TIME_MS, p_frames, p_sampleRate);
+
+		// Land exactly on the target so settled parameters stop costing anything
+		const float scale = SDL_fabsf(target) > 1.0f ? SDL_fabsf(target) : 1.0f;
+		if (SDL_fabsf(m_current - target) < 1e-4f * scale)
+			m_current = target;
+
+		return true;
+	}
+
+	void SmoothedParam::Snap()
+	{
+		m_current = GetTarget();
+	}
+
+	// AUDIO EFFECT
+	//
+
+	void AudioEffect::Prepare(const SDL_AudioSpec &p_spec)
+	{
+		m_channels = SDL_min(static_cast<uint32_t>(p_spec.channels), MAX_CHANNELS);
+		m_sampleRate = p_spec.freq;
+	}
+
+	void AudioEffect::SetBypass(bool p_bypass)
+	{
+		m_bypass.store(p_bypass, std::memory_order_relaxed);
+	}
+
+	bool AudioEffect::IsBypassed() const
+	{
+		return m_bypass.load(std::memory_order_relaxed);
+	}
+
+	// BIQUAD FILTER
+	//
+
+	BiquadFilter::BiquadFilter(BiquadType p_type, float p_cutoffHz, float p_q)
+		: m_type(p_type), m_cutoff(p_cutoffHz), m_q(p_q)
+	{
+	}
+
+	void BiquadFilter::Prepare(const SDL_AudioSpec &p_spec)
+	{
+		AudioEffect::Prepare(p_spec);
+
+		m_cutoff.Snap();
+		m_q.Snap();
+		m_z1 = {};
+		m_z2 = {};
+
+		UpdateCoefficients();
+	}
+
+	void BiquadFilter::Process(float *p_samples, uint32_t p_frames, const EffectContext &)
+	{
+		// Coefficients only get recomputed while a parameter is still moving
+
+		bool changed = m_cutoff.Advance(p_frames, m_sampleRate);
+		changed |= m_q.Advance(p_frames, m_sampleRate);
+
+		if (changed)
+			UpdateCoefficients();
+
+		// The recursion runs frame by frame, the channels of a frame don't depend on
+		// each other so they go through side by side in one register
+
+		const uint32_t channels = m_channels;
+
+#if defined(LUM_SIMD_SSE)
+		if (channels == 2 || channels == 4)
+		{
+			const __m128 b0 = _mm_set1_ps(m_b0), b1 = _mm_set1_ps(m_b1), b2 = _mm_set1_ps(m_b2);
+			const __m128 a1 = _mm_set1_ps(m_a1), a2 = _mm_set1_ps(m_a2);
+			__m128 z1 = _mm_load_ps(m_z1.data());
+			__m128 z2 = _mm_load_ps(m_z2.data());
+
+			for (uint32_t i = 0; i < p_frames; i++)
+			{
+				float *frame = p_samples + static_cast<size_t>(i) * channels;
+				const __m128 in = channels == 4 ? _mm_loadu_ps(frame) : _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double *>(frame)));
+				const __m128 out = _mm_add_ps(_mm_mul_ps(b0, in), z1);
+
+				z1 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(b1, in), _mm_mul_ps(a1, out)), z2);
+				z2 = _mm_sub_ps(_mm_mul_ps(b2, in), _mm_mul_ps(a2, out));
+
+				if (channels == 4)
+					_mm_storeu_ps(frame, out);
+				else
+					_mm_store_sd(reinterpret_cast<double *>(frame), _mm_castps_pd(out));
+			}
+
+			_mm_store_ps(m_z1.data(), z1);
+			_mm_store_ps(m_z2.data(), z2);
+			return;
+		}
+#elif defined(LUM_SIMD_NEON)
+		if (channels == 4)
+		{
+			const float32x4_t b0 = vdupq_n_f32(m_b0), b1 = vdupq_n_f32(m_b1), b2 = vdupq_n_f32(m_b2);
+			const float32x4_t a1 = vdupq_n_f32(m_a1), a2 = vdupq_n_f32(m_a2);
+			float32x4_t z1 = vld1q_f32(m_z1.data());
+			float32x4_t z2 = vld1q_f32(m_z2.data());
+
+			for (uint32_t i = 0; i < p_frames; i++)
+			{
+				float *frame = p_samples + static_cast<size_t>(i) * channels;
+				const float32x4_t in = vld1q_f32(frame);
+				const float32x4_t out = vmlaq_f32(z1, b0, in);
+
+				z1 = vmlsq_f32(vmlaq_f32(z2, b1, in), a1, out);
+				z2 = vmlsq_f32(vmulq_f32(b2, in), a2, out);
+				vst1q_f32(frame, out);
+			}
+
+			vst1q_f32(m_z1.data(), z1);
+			vst1q_f32(m_z2.data(), z2);
+			return;
+		}
+
+		if (channels == 2)
+		{
+			const float32x2_t b0 = vdup_n_f32(m_b0), b1 = vdup_n_f32(m_b1), b2 = vdup_n_f32(m_b2);
+			const float32x2_t a1 = vdup_n_f32(m_a1), a2 = vdup_n_f32(m_a2);
+			float32x2_t z1 = vld1_f32(m_z1.data());
+			float32x2_t z2 = vld1_f32(m_z2.data());
+
+			for (uint32_t i = 0; i < p_frames; i++)
+			{
+				float *frame = p_samples + static_cast<size_t>(i) * channels;
+				const float32x2_t in = vld1_f32(frame);
+				const float32x2_t out = vmla_f32(z1, b0, in);
+
+				z1 = vmls_f32(vmla_f32(z2, b1, in), a1, out);
+				z2 = vmls_f32(vmul_f32(b2, in), a2, out);
+				vst1_f32(frame, out);
+			}
+
+			vst1_f32(m_z1.data(), z1);
+			vst1_f32(m_z2.data(), z2);
+			return;
+		}
+#endif
+
+		ProcessScalar(p_samples, p_frames);
+	}
+
+	void BiquadFilter::ProcessScalar(float *p_samples, uint32_t p_frames)
+	{
+		const float b0 = m_b0, b1 = m_b1, b2 = m_b2, a1 = m_a1, a2 = m_a2;
+		const uint32_t channels = m_channels;
+
+		for (uint32_t c = 0; c < channels; c++)
+		{
+			float z1 = m_z1[c];
+			float z2 = m_z2[c];
+
+			for (uint32_t i = 0; i < p_frames; i++)
+			{
+				float &sample = p_samples[i * channels + c];
+				const float in = sample;
+				const float out = b0 * in + z1;
+
+				z1 = b1 * in - a1 * out + z2;
+				z2 = b2 * in - a2 * out;
+				sample = out;
+			}
+
+			m_z1[c] = z1;
+			m_z2[c] = z2;
+		}
+	}
+
+	void BiquadFilter::SetCutoff(float p_cutoffHz)
+	{
+		m_cutoff.Set(p_cutoffHz);
+	}
+
+	void BiquadFilter::SetQ(float p_q)
+	{
+		m_q.Set(p_q);
+	}
+
+	void BiquadFilter::UpdateCoefficients()
+	{
+		if (m_sampleRate <= 0)
+			return;
+
+		// RBJ cookbook, cutoff kept away from DC and nyquist
+
+		const float nyquistLimit = 0.45f * static_cast<float>(m_sampleRate);
+		const float cutoff = SDL_clamp(m_cutoff.Get(), 10.0f, nyquistLimit);
+		const float q = SDL_max(m_q.Get(), 0.1f);
+
+		const float w0 = 2.0f * SDL_PI_F * cutoff / static_cast<float>(m_sampleRate);
+		const float cosW0 = SDL_cosf(w0);
+		const float alpha = SDL_sinf(w0) / (2.0f * q);
+		const float a0 = 1.0f + alpha;
+
+		if (m_type == BiquadType::LOW_PASS)
+		{
+			m_b0 = (1.0f - cosW0) * 0.5f / a0;
+			m_b1 = (1.0f - cosW0) / a0;
+		}
+		else
+		{
+			m_b0 = (1.0f + cosW0) * 0.5f / a0;
+			m_b1 = -(1.0f + cosW0) / a0;
+		}
+
+		m_b2 = m_b0;
+		m_a1 = -2.0f * cosW0 / a0;
+		m_a2 = (1.0f - alpha) / a0;
+	}
+
+	// COMPRESSOR
+	//
+
+	Compressor::Compressor(float p_thresholdDB, float p_ratio, float p_attackMS, float p_releaseMS, float p_makeupDB)
+		: m_threshold(p_thresholdDB), m_ratio(p_ratio), m_makeup(p_makeupDB), m_attackMS(p_attackMS), m_releaseMS(p_releaseMS)
+	{
+	}
+
+	void Compressor::Process(float *p_samples, uint32_t p_frames, const EffectContext &)
+	{
+		m_threshold.Advance(p_frames, m_sampleRate);
+		m_ratio.Advance(p_frames, m_sampleRate);
+		m_makeup.Advance(p_frames, m_sampleRate);
+
+		const size_t samples = static_cast<size_t>(p_frames) * m_channels;
+		const float peak = simd::PeakAbs(p_samples, samples);
+
+		m_envelope = FollowEnvelope(m_envelope, peak,
+			BlockCoefficient(m_attackMS, p_frames, m_sampleRate),
+			BlockCoefficient(m_releaseMS, p_frames, m_sampleRate));
+
+		float gainDB = m_makeup.Get();
+		const float overDB = GainToDecibels(m_envelope) - m_threshold.Get();
+		if (overDB > 0.0f)
+		{
+			const float ratio = m_ratio.Get();
+			gainDB -= ratio > 1.0f ? overDB * (1.0f - 1.0f / ratio) : (ratio <= 0.0f ? overDB : 0.0f);
+		}
+
+		const float gain = DecibelsToGain(gainDB);
+		if (gain != 1.0f || m_gain != 1.0f)
+			simd::ScaleRamp(p_samples, m_gain, gain, samples);
+
+		m_gain = gain;
+	}
+
+	void Compressor::SetThreshold(float p_thresholdDB)
+	{
+		m_threshold.Set(p_thresholdDB);
+	}
+
+	void Compressor::SetRatio(float p_ratio)
+	{
+		m_ratio.Set(p_ratio);
+	}
+
+	void Compressor::SetMakeup(float p_makeupDB)
+	{
+		m_makeup.Set(p_makeupDB);
+	}
+
+	// DUCKER
+	//
+
+	Ducker::Ducker(uint8_t p_sidechainBus, float p_depthDB, float p_thresholdDB, float p_attackMS, float p_releaseMS)
+		: m_sidechainBus(p_sidechainBus), m_depth(p_depthDB), m_threshold(p_thresholdDB), m_attackMS(p_attackMS), m_releaseMS(p_releaseMS)
+	{
+	}
+
+	void Ducker::Process(float *p_samples, uint32_t p_frames, const EffectContext &p_context)
+	{
+		m_depth.Advance(p_frames, m_sampleRate);
+		m_threshold.Advance(p_frames, m_sampleRate);
+
+		const float sidechain = m_sidechainBus < p_context.busCount ? p_context.busPeaks[m_sidechainBus] : 0.0f;
+
+		m_envelope = FollowEnvelope(m_envelope, sidechain,
+			BlockCoefficient(m_attackMS, p_frames, m_sampleRate),
+			BlockCoefficient(m_releaseMS, p_frames, m_sampleRate));
+
+		// 6 dB soft knee above the threshold before reaching full depth
+
+		const float amount = SDL_clamp((GainToDecibels(m_envelope) - m_threshold.Get()) / 6.0f, 0.0f, 1.0f);
+		const float gain = DecibelsToGain(m_depth.Get() * amount);
+
+		if (gain != 1.0f || m_gain != 1.0f)
+			simd::ScaleRamp(p_samples, m_gain, gain, static_cast<size_t>(p_frames) * m_channels);
+
+		m_gain = gain;
+	}
+
+	void Ducker::SetDepth(float p_depthDB)
+	{
+		m_depth.Set(p_depthDB);
+	}
+
+	void Ducker::SetThreshold(float p_thresholdDB)
+	{
+		m_threshold.Set(p_thresholdDB);
+	}
+
+	// REVERB
+	//
+
+	Reverb::Reverb(float p_roomSize, float p_damping, float p_wet)
+		: m_roomSize(p_roomSize), m_damping(p_damping), m_wet(p_wet)
+	{
+	}
+
+	void Reverb::Prepare(const SDL_AudioSpec &p_spec)
+	{
+		AudioEffect::Prepare(p_spec);
+
+		// Freeverb tunings, given at 44.1 kHz
+
+		constexpr uint32_t combLengths[COMB_COUNT] = { 1116, 1188, 1277, 1356 };
+		constexpr uint32_t allpassLengths[ALLPASS_COUNT] = { 556, 441 };
+		constexpr uint32_t stereoSpread = 23;
+
+		const float scale = static_cast<float>(m_sampleRate) / 44100.0f;
+
+		m_state.assign(m_channels, ChannelState{});
+		for (uint32_t c = 0; c < m_channels; c++)
+		{
+			for (uint32_t i = 0; i < COMB_COUNT; i++)
+				m_state[c].combs[i].buffer.assign(static_cast<size_t>((combLengths[i] + stereoSpread * c) * scale) + 1, 0.0f);
+
+			for (uint32_t i = 0; i < ALLPASS_COUNT; i++)
+				m_state[c].allpasses[i].buffer.assign(static_cast<size_t>((allpassLengths[i] + stereoSpread * c) * scale) + 1, 0.0f);
+		}
+
+		// A chunk can't be longer than the shortest delay or it would read back
+		// what it wrote
+
+		m_chunkFrames = CHUNK_FRAMES;
+		for (const auto &channel : m_state)
+		{
+			for (const auto &comb : channel.combs)
+				m_chunkFrames = SDL_min(m_chunkFrames, static_cast<uint32_t>(comb.buffer.size()));
+
+			for (const auto &allpass : channel.allpasses)
+				m_chunkFrames = SDL_min(m_chunkFrames, static_cast<uint32_t>(allpass.buffer.size()));
+		}
+
+		m_roomSize.Snap();
+		m_damping.Snap();
+		m_wet.Snap();
+	}
+
+	void Reverb::Process(float *p_samples, uint32_t p_frames, const EffectContext &)
+	{
+		const float wetFrom = m_wet.Get();
+		m_wet.Advance(p_frames, m_sampleRate);
+		m_roomSize.Advance(p_frames, m_sampleRate);
+		m_damping.Advance(p_frames, m_sampleRate);
+
+		const float wetStep = (m_wet.Get() - wetFrom) / static_cast<float>(p_frames);
+		const float feedback = 0.7f + 0.28f * SDL_clamp(m_roomSize.Get(), 0.0f, 1.0f);
+		const float damping = SDL_clamp(m_damping.Get(), 0.0f, 1.0f);
+		const float inputGain = 0.03f;
+
+		const uint32_t channels = m_channels;
+
+		for (uint32_t c = 0; c < channels; c++)
+		{
+			for (uint32_t done = 0; done < p_frames;)
+			{
+				const uint32_t frames = SDL_min(p_frames - done, m_chunkFrames);
+				float *samples = p_samples + static_cast<size_t>(done) * channels + c;
+
+				for (uint32_t i = 0; i < frames; i++)
+					m_input[i] = samples[static_cast<size_t>(i) * channels] * inputGain;
+
+				ProcessChunk(m_state[c], frames, feedback, damping);
+
+				for (uint32_t i = 0; i < frames; i++)
+					samples[static_cast<size_t>(i) * channels] += m_output[i] * (wetFrom + wetStep * static_cast<float>(done + i));
+
+				done += frames;
+			}
+		}
+	}
+
+	void Reverb::ProcessChunk(ChannelState &p_state, uint32_t p_frames, float p_feedback, float p_damping)
+	{
+		// Each line is read and written in at most two runs, split where it wraps
+
+		float *output = m_output.data();
+		float *filtered = m_scratch.data();
+
+		SDL_memset(output, 0, p_frames * sizeof(float));
+
+		for (uint32_t k = 0; k < COMB_COUNT; k++)
+		{
+			const auto &comb = p_state.combs[k];
+			const uint32_t first = SDL_min(p_frames, static_cast<uint32_t>(comb.buffer.size()) - comb.position);
+
+			SDL_memcpy(m_delayed[k].data(), comb.buffer.data() + comb.position, first * sizeof(float));
+			SDL_memcpy(m_delayed[k].data() + first, comb.buffer.data(), (p_frames - first) * sizeof(float));
+
+			simd::MixAdd(output, m_delayed[k].data(), 1.0f, p_frames);
+		}
+
+		// Damping is a one pole low pass per comb, the only part that has to go
+		// a sample at a time. The four combs don't depend on each other.
+
+		static_assert(COMB_COUNT == 4, "The damping loop runs the combs side by side");
+
+		const float keep = p_damping;
+		const float take = 1.0f - p_damping;
+
+		float state0 = p_state.combs[0].filterState, state1 = p_state.combs[1].filterState;
+		float state2 = p_state.combs[2].filterState, state3 = p_state.combs[3].filterState;
+
+		for (uint32_t i = 0; i < p_frames; i++)
+		{
+			state0 = m_delayed[0][i] * take + state0 * keep;
+			state1 = m_delayed[1][i] * take + state1 * keep;
+			state2 = m_delayed[2][i] * take + state2 * keep;
+			state3 = m_delayed[3][i] * take + state3 * keep;
+
+			m_filtered[0][i] = state0;
+			m_filtered[1][i] = state1;
+			m_filtered[2][i] = state2;
+			m_filtered[3][i] = state3;
+		}
+
+		p_state.combs[0].filterState = state0;
+		p_state.combs[1].filterState = state1;
+		p_state.combs[2].filterState = state2;
+		p_state.combs[3].filterState = state3;
+
+		for (uint32_t k = 0; k < COMB_COUNT; k++)
+		{
+			auto &comb = p_state.combs[k];
+
+			for (uint32_t done = 0; done < p_frames;)
+			{
+				const uint32_t frames = SDL_min(p_frames - done, static_cast<uint32_t>(comb.buffer.size()) - comb.position);
+
+				simd::AddScaled(comb.buffer.data() + comb.position, m_input.data() + done, m_filtered[k].data() + done, p_feedback, frames);
+
+				comb.position += frames;
+				if (comb.position >= comb.buffer.size())
+					comb.position = 0;
+
+				done += frames;
+			}
+		}
+
+		for (auto &allpass : p_state.allpasses)
+		{
+			for (uint32_t done = 0; done < p_frames;)
+			{
+				const uint32_t frames = SDL_min(p_frames - done, static_cast<uint32_t>(allpass.buffer.size()) - allpass.position);
+				float *delayed = allpass.buffer.data() + allpass.position;
+
+				// The line takes the input plus half its old value, the output is the
+				// old value less the input
+
+				simd::Subtract(filtered, delayed, output + done, frames);
+				simd::AddScaled(delayed, output + done, delayed, 0.5f, frames);
+				SDL_memcpy(output + done, filtered, frames * sizeof(float));
+
+				allpass.position += frames;
+				if (allpass.position >= allpass.buffer.size())
+					allpass.position = 0;
+
+				done += frames;
+			}
+		}
+	}
+
+	void Reverb::SetRoomSize(float p_roomSize)
+	{
+		m_roomSize.Set(p_roomSize);
+	}
+
+	void Reverb::SetDamping(float p_damping)
+	{
+		m_damping.Set(p_damping);
+	}
+
+	void Reverb::SetWet(float p_wet)
+	{
+		m_wet.Set(p_wet);
+	}
+}
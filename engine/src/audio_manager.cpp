@@ -8,80 +8,105 @@
 
 namespace lum
 {
-	// AUDIO CHANNEL
+	// AUDIO BUS
 	//
 
-	AudioChannel::AudioChannel() = default;
+	AudioBus::AudioBus() = default;
 
-	AudioChannel::~AudioChannel() = default;
+	AudioBus::~AudioBus() = default;
 
-	bool AudioChannel::Init(SDL_AudioDeviceID p_device)
+	bool AudioBus::Init(Mixer *p_mixer, uint8_t p_index)
 	{
-		m_device = p_device;
+		m_mixer = p_mixer;
+		m_index = p_index;
+
+		m_mixer->SetBusGain(m_index, m_volume);
 
 		return true;
 	}
 
-	void AudioChannel::Shutdown()
+	void AudioBus::Shutdown()
 	{
 		StopAll();
+
+		m_effects.clear();
+	}
+
+	uint8_t AudioBus::GetIndex() const
+	{
+		return m_index;
 	}
 
-	void AudioChannel::PlaySound(SDL_AudioSpec &p_audioSpec, uint8_t *p_buffer, uint32_t p_length)
+	VoiceHandle AudioBus::PlaySound(SoundId p_sound, float p_gain, float p_pitch)
 	{
-		SDL_AudioStream *stream = SDL_CreateAudioStream(&p_audioSpec, &p_audioSpec);
-		if (!stream)
+		return m_mixer->PlaySound(p_sound, m_index, p_gain, p_pitch);
+	}
+
+	void AudioBus::PlayMusic(const Music &p_music, bool p_loop)
+	{
+		StopMusic();
+
+		m_music = std::make_unique<MusicStream>();
+		if (!m_music->Init(p_music, m_mixer->GetSpec(), p_loop))
 		{
-			SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to create audio stream: %s", SDL_GetError());
+			SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to start music stream for %s", StringTable::GetString(p_music.tag));
+			m_music.reset();
 			return;
 		}
 
-		SDL_PutAudioStreamData(stream, p_buffer, p_length);
-		SDL_SetAudioStreamGain(stream, m_volume);
-		SDL_BindAudioStream(m_device, stream);
+		m_mixer->SetBusMusic(m_index, m_music.get());
+	}
 
-		m_activeStreams.push_back(stream);
+	void AudioBus::StopMusic()
+	{
+		if (!m_music)
+			return;
+
+		// Detach from the mixer first, the mix callback could be reading from it
+
+		m_mixer->SetBusMusic(m_index, nullptr);
+		m_music.reset();
 	}
 
-	void AudioChannel::StopAll()
+	void AudioBus::SeekMusic(double p_seconds)
 	{
-		for (auto *stream : m_activeStreams)
-		{
-			SDL_UnbindAudioStream(stream);
-			SDL_DestroyAudioStream(stream);
-		}
+		if (m_music)
+			m_music->Seek(p_seconds);
+	}
+
+	void AudioBus::StopAll()
+	{
+		StopMusic();
 
-		m_activeStreams.clear();
+		m_mixer->StopBus(m_index);
 	}
 
-	void AudioChannel::SetVolume(float p_volume)
+	void AudioBus::SetVolume(float p_volume)
 	{
 		m_volume = p_volume;
-		for (auto *stream : m_activeStreams)
-		{
-			SDL_SetAudioStreamGain(stream, m_volume);
-		}
+
+		m_mixer->SetBusGain(m_index, m_volume);
 	}
 
-	float AudioChannel::GetVolume() const
+	float AudioBus::GetVolume() const
 	{
 		return m_volume;
 	}
 
-	void AudioChannel::Pause()
+	void AudioBus::Pause()
 	{
-		for (auto *stream : m_activeStreams)
-		{
-			SDL_PauseAudioStreamDevice(stream);
-		}
+		m_mixer->SetBusPaused(m_index, true);
+
+		if (m_music)
+			m_music->Pause();
 	}
 
-	void AudioChannel::Resume()
+	void AudioBus::Resume()
 	{
-		for (auto *stream : m_activeStreams)
-		{
-			SDL_ResumeAudioStreamDevice(stream);
-		}
+		m_mixer->SetBusPaused(m_index, false);
+
+		if (m_music)
+			m_music->Resume();
 	}
 
 	// AUDIO MANAGER
@@ -100,58 +125,275 @@ namespace lum
 			return false;
 		}
 
-		// TEMPORAL
-		// 
-		// Create test audio channel
-
-		m_channels["MUSIC"] = std::make_unique<AudioChannel>();
-		m_channels["SFX"] = std::make_unique<AudioChannel>();
-
+		if (!m_mixer.Init(m_device))
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to initialize audio mixer");
+			return false;
+		}
 
-		// Init channels
+		return CreateDefaultBuses();
+	}
 
-		for (auto &[_, channel] : m_channels)
+	bool AudioManager::InitOffline(const SDL_AudioSpec &p_spec)
+	{
+		if (!m_mixer.InitOffline(p_spec))
 		{
-			channel->Init(m_device);
+			SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to initialize offline audio mixer");
+			return false;
 		}
 
+		return CreateDefaultBuses();
+	}
+
+	bool AudioManager::CreateDefaultBuses()
+	{
+		auto master = std::make_unique<AudioBus>();
+		master->Init(&m_mixer, Mixer::MASTER_BUS);
+		m_buses["MASTER"] = std::move(master);
+
+		// Default graph. SFX is created after MUSIC so it gets mixed first and
+		// the ducker on MUSIC reads this block's level instead of the last one
+
+		AudioBus *music = CreateBus("MUSIC");
+		AudioBus *sfx = CreateBus("SFX");
+		if (!music || !sfx)
+			return false;
+
+		m_musicFilter = music->AddEffect<BiquadFilter>(BiquadType::LOW_PASS, MUSIC_OPEN_CUTOFF_HZ);
+		music->AddEffect<Ducker>(sfx->GetIndex());
+		m_sfxBus = sfx->GetIndex();
+		m_buses["MASTER"]->AddEffect<Compressor>(-0.3f, 0.0f, 0.0f, 80.0f);
+
 		return true;
 	}
 
 	void AudioManager::Shutdown()
 	{
-		for (auto &[_, channel] : m_channels)
+		for (auto &[_, bus] : m_buses)
+		{
+			bus->Shutdown();
+		}
+
+		m_buses.clear();
+		m_paused = false;
+		m_sfxBus = -1;
+		m_musicFilter = nullptr;
+
+		m_mixer.Shutdown();
+
+		if (m_device)
+			SDL_CloseAudioDevice(m_device);
+
+		m_device = 0;
+	}
+
+	void AudioManager::Update()
+	{
+		// New frame, triggers from here on no longer merge with the previous ones
+
+		m_mixer.BeginFrame();
+	}
+
+	void AudioManager::Render(float *p_out, uint32_t p_frames)
+	{
+		m_mixer.Render(p_out, p_frames);
+	}
+
+	AudioBus *AudioManager::CreateBus(const std::string &p_tag, const std::string &p_parentTag)
+	{
+		if (m_buses.find(p_tag) != m_buses.end())
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Bus %s already exists", p_tag.c_str());
+			return nullptr;
+		}
+
+		auto parentIt = m_buses.find(p_parentTag);
+		if (parentIt == m_buses.end())
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to find parent bus %s for %s", p_parentTag.c_str(), p_tag.c_str());
+			return nullptr;
+		}
+
+		int32_t index = m_mixer.CreateBus(parentIt->second->GetIndex());
+		if (index < 0)
+			return nullptr;
+
+		auto bus = std::make_unique<AudioBus>();
+		bus->Init(&m_mixer, static_cast<uint8_t>(index));
+
+		AudioBus *result = bus.get();
+		m_buses[p_tag] = std::move(bus);
+
+		return result;
+	}
+
+	AudioBus *AudioManager::GetBus(const std::string &p_tag)
+	{
+		auto busIt = m_buses.find(p_tag);
+		return busIt != m_buses.end() ? busIt->second.get() : nullptr;
+	}
+
+	SoundId AudioManager::RegisterSound(const Sound &p_sound)
+	{
+		return m_mixer.RegisterSound(p_sound);
+	}
+
+	void AudioManager::UnregisterSound(Sound &p_sound)
+	{
+		m_mixer.UnregisterSound(p_sound.mixerId);
+		p_sound.mixerId = SoundId{};
+	}
+
+	bool AudioManager::IsSoundPlaying(SoundId p_sound) const
+	{
+		return m_mixer.IsSoundPlaying(p_sound);
+	}
+
+	SoundId AudioManager::GetSoundId(StringId p_tag)
+	{
+		auto sound = Engine::Get().assetManager.GetSound(p_tag);
+		return sound ? sound->mixerId : SoundId{};
+	}
+
+	void AudioManager::SetSoundPlayback(StringId p_tag, const SoundPlayback &p_playback)
+	{
+		auto sound = Engine::Get().assetManager.GetSound(p_tag);
+		if (!sound)
 		{
-			channel->Shutdown();
+			SDL_LogError(SDL_LOG_CATEGORY_ERROR, "No sound %s to set the playback of", StringTable::GetString(p_tag));
+			return;
 		}
 
-		SDL_CloseAudioDevice(m_device);
+		sound->playback = p_playback;
+		m_mixer.SetSoundPlayback(sound->mixerId, p_playback);
+	}
+
+	void AudioManager::SetSoundPlayback(SoundId p_sound, const SoundPlayback &p_playback)
+	{
+		m_mixer.SetSoundPlayback(p_sound, p_playback);
 	}
 
-	void AudioManager::PlaySound(const std::string &p_tag, const std::string &p_channelTag)
+	int32_t AudioManager::GetBusId(const std::string &p_tag)
 	{
-		auto sound = Engine::Get().assetManager.GetSound(p_tag.c_str());
+		auto busIt = m_buses.find(p_tag);
+		return busIt != m_buses.end() ? busIt->second->GetIndex() : -1;
+	}
+
+	VoiceHandle AudioManager::PlaySound(SoundId p_sound, uint8_t p_bus, float p_gain, float p_pitch)
+	{
+		return m_mixer.PlaySound(p_sound, p_bus, p_gain, p_pitch);
+	}
+
+	VoiceHandle AudioManager::PlaySound(const std::string &p_tag, const std::string &p_busTag, float p_gain)
+	{
+		auto sound = Engine::Get().assetManager.GetSound(SID(p_tag.c_str()));
 		if (!sound)
 		{
 			SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to find sound %s to play", p_tag.c_str());
+			return VoiceHandle{};
+		}
+
+		auto busIt = m_buses.find(p_busTag);
+		if (busIt == m_buses.end())
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to find bus %s in storage", p_busTag.c_str());
+			return VoiceHandle{};
+		}
+
+		return busIt->second->PlaySound(sound->mixerId, p_gain);
+	}
+
+	void AudioManager::StopVoice(VoiceHandle p_voice)
+	{
+		m_mixer.StopVoice(p_voice);
+	}
+
+	void AudioManager::SetVoiceGain(VoiceHandle p_voice, float p_gain)
+	{
+		m_mixer.SetVoiceGain(p_voice, p_gain);
+	}
+
+	void AudioManager::SetVoicePitch(VoiceHandle p_voice, float p_pitch)
+	{
+		m_mixer.SetVoicePitch(p_voice, p_pitch);
+	}
+
+	bool AudioManager::IsVoicePlaying(VoiceHandle p_voice) const
+	{
+		return m_mixer.IsVoicePlaying(p_voice);
+	}
+
+	void AudioManager::PlayMusic(const std::string &p_tag, const std::string &p_busTag, bool p_loop)
+	{
+		auto music = Engine::Get().assetManager.GetMusic(SID(p_tag.c_str()));
+		if (!music)
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to find music %s to play", p_tag.c_str());
 			return;
 		}
 
-		auto channelIt = m_channels.find(p_channelTag);
-		if (channelIt == m_channels.end())
+		auto busIt = m_buses.find(p_busTag);
+		if (busIt == m_buses.end())
 		{
-			SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to find channel %s in storage", p_tag.c_str());
+			SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to find bus %s in storage", p_busTag.c_str());
 			return;
 		}
 
-		channelIt->second->PlaySound(sound->audioSpec, sound->buffer.data(), sound->length);
+		busIt->second->PlayMusic(*music, p_loop);
+	}
+
+	void AudioManager::StopMusic(const std::string &p_busTag)
+	{
+		if (m_buses.find(p_busTag) != m_buses.end())
+		{
+			m_buses[p_busTag]->StopMusic();
+		}
+	}
+
+	void AudioManager::SeekMusic(const std::string &p_busTag, double p_seconds)
+	{
+		if (m_buses.find(p_busTag) != m_buses.end())
+		{
+			m_buses[p_busTag]->SeekMusic(p_seconds);
+		}
 	}
 
-	void AudioManager::SetChannelVolume(const std::string &p_tag, float p_volume)
+	void AudioManager::SetBusVolume(const std::string &p_tag, float p_volume)
 	{
-		if (m_channels.find(p_tag) != m_channels.end())
+		if (m_buses.find(p_tag) != m_buses.end())
 		{
-			m_channels[p_tag]->SetVolume(p_volume);
+			m_buses[p_tag]->SetVolume(p_volume);
 		}
 	}
+
+	void AudioManager::SetPaused(bool p_paused)
+	{
+		if (m_paused == p_paused)
+			return;
+
+		m_paused = p_paused;
+
+		if (m_sfxBus >= 0)
+			m_mixer.SetBusPaused(static_cast<uint8_t>(m_sfxBus), p_paused);
+
+		// The filter glides to the new cutoff on its own, no click either way
+
+		if (m_musicFilter)
+			m_musicFilter->SetCutoff(p_paused ? MUSIC_PAUSED_CUTOFF_HZ : MUSIC_OPEN_CUTOFF_HZ);
+	}
+
+	bool AudioManager::IsPaused() const
+	{
+		return m_paused;
+	}
+
+	const SDL_AudioSpec &AudioManager::GetMixSpec() const
+	{
+		return m_mixer.GetSpec();
+	}
+
+	MixerStats AudioManager::GetMixerStats() const
+	{
+		return m_mixer.GetStats();
+	}
 }
\ No newline at end of file
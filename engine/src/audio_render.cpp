@@ -0,0 +1,390 @@
+#include "audio_render.hpp"
+
+#include <algorithm>
+
+#include "engine.hpp"
+
+namespace lum
+{
+	AudioRender::AudioRender() = default;
+
+	AudioRender::~AudioRender() = default;
+
+	bool AudioRender::LoadScript(const char *p_path)
+	{
+		size_t size = 0;
+		char *text = static_cast<char *>(SDL_LoadFile(p_path, &size));
+		if (!text)
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_AUDIO, "AudioRender: Failed to read script %s: %s", p_path, SDL_GetError());
+			return false;
+		}
+
+		m_sounds.clear();
+		m_events.clear();
+		m_endSeconds = 0.0;
+		m_endFrame = 0;
+
+		bool result = true;
+		int lineNumber = 0;
+		char *lineState = nullptr;
+
+		for (char *line = SDL_strtok_r(text, "\r\n", &lineState); line; line = SDL_strtok_r(nullptr, "\r\n", &lineState))
+		{
+			lineNumber++;
+			if (!ParseLine(line, p_path, lineNumber))
+			{
+				result = false;
+				break;
+			}
+		}
+
+		SDL_free(text);
+
+		if (!result)
+			return false;
+
+		for (auto &event : m_events)
+			event.frame = static_cast<uint64_t>(event.seconds * m_spec.freq + 0.5);
+
+		m_endFrame = static_cast<uint64_t>(m_endSeconds * m_spec.freq + 0.5);
+
+		if (m_endFrame == 0)
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_AUDIO, "AudioRender: Script %s has no end", p_path);
+			return false;
+		}
+
+		// Keep the order of events sharing a frame as written
+
+		std::stable_sort(m_events.begin(), m_events.end(), [](const AudioScriptEvent &p_a, const AudioScriptEvent &p_b) { return p_a.frame < p_b.frame; });
+
+		return true;
+	}
+
+	const SDL_AudioSpec &AudioRender::GetSpec() const
+	{
+		return m_spec;
+	}
+
+	bool AudioRender::Run(const char *p_outPath, const char *p_referencePath, float p_tolerance)
+	{
+		auto &engine = Engine::Get();
+
+		for (const auto &sound : m_sounds)
+		{
+			if (!engine.assetManager.LoadSound(sound.tag.c_str(), sound.path.c_str()))
+				return false;
+		}
+
+		const uint32_t channels = static_cast<uint32_t>(m_spec.channels);
+		std::vector<float> output(static_cast<size_t>(m_endFrame) * channels, 0.0f);
+
+		uint64_t mixNS = 0;
+		uint64_t voiceFrames = 0;
+		uint64_t frame = 0;
+		size_t eventIndex = 0;
+
+		while (frame < m_endFrame)
+		{
+			// Everything scheduled on this frame goes in before it gets mixed, each
+			// distinct time counts as its own game frame for trigger coalescing
+
+			if (eventIndex < m_events.size() && m_events[eventIndex].frame <= frame)
+			{
+				engine.audioManager.Update();
+
+				for (; eventIndex < m_events.size() && m_events[eventIndex].frame <= frame; eventIndex++)
+				{
+					const auto &event = m_events[eventIndex];
+					switch (event.action)
+					{
+					case AudioScriptAction::PLAY:
+					{
+						int32_t bus = engine.audioManager.GetBusId(event.bus);
+						SoundId sound = engine.audioManager.GetSoundId(event.sound);
+						if (bus < 0 || !sound)
+						{
+							SDL_LogError(SDL_LOG_CATEGORY_AUDIO, "AudioRender: Can't play %s on %s", StringTable::GetString(event.sound), event.bus.c_str());
+							return false;
+						}
+
+						engine.audioManager.PlaySound(sound, static_cast<uint8_t>(bus), event.gain, event.pitch);
+						break;
+					}
+					case AudioScriptAction::STOP_BUS:
+						if (AudioBus *bus = engine.audioManager.GetBus(event.bus))
+							bus->StopAll();
+						break;
+					case AudioScriptAction::BUS_VOLUME:
+						engine.audioManager.SetBusVolume(event.bus, event.gain);
+						break;
+					}
+				}
+			}
+
+			// Mix up to the next event, at most one mixer block at a time so the
+			// voice count below matches what was mixed
+
+			uint64_t nextFrame = eventIndex < m_events.size() ? SDL_min(m_events[eventIndex].frame, m_endFrame) : m_endFrame;
+			uint32_t frames = static_cast<uint32_t>(SDL_min(nextFrame - frame, static_cast<uint64_t>(Mixer::MIX_BLOCK_FRAMES)));
+
+			const uint64_t start = SDL_GetTicksNS();
+			engine.audioManager.Render(output.data() + frame * channels, frames);
+			mixNS += SDL_GetTicksNS() - start;
+
+			voiceFrames += static_cast<uint64_t>(engine.audioManager.GetMixerStats().activeVoices) * frames;
+			frame += frames;
+		}
+
+		// Throughput as milliseconds of single voice audio mixed per millisecond of
+		// CPU, roughly how many voices fit in real time on one core
+
+		const double mixMS = static_cast<double>(mixNS) / SDL_NS_PER_MS;
+		const double audioMS = static_cast<double>(m_endFrame) * 1000.0 / m_spec.freq;
+		const double voiceMS = static_cast<double>(voiceFrames) * 1000.0 / m_spec.freq;
+
+		SDL_LogInfo(SDL_LOG_CATEGORY_AUDIO, "AudioRender: Mixed %.2f ms of audio in %.2f ms (%.1fx real time)",
+			audioMS, mixMS, mixMS > 0.0 ? audioMS / mixMS : 0.0);
+		SDL_LogInfo(SDL_LOG_CATEGORY_AUDIO, "AudioRender: %.1f voices/ms (%.2f voice seconds, %.2f average voices)",
+			mixMS > 0.0 ? voiceMS / mixMS : 0.0, voiceMS / 1000.0, audioMS > 0.0 ? voiceMS / audioMS : 0.0);
+
+		if (p_outPath && !WriteWav(p_outPath, output))
+			return false;
+
+		if (p_referencePath)
+			return CompareWithReference(p_referencePath, output, p_tolerance);
+
+		return true;
+	}
+
+	bool AudioRender::ParseLine(char *p_line, const char *p_path, int p_lineNumber)
+	{
+		const char *separators = " \t";
+		char *state = nullptr;
+
+		const char *first = SDL_strtok_r(p_line, separators, &state);
+		if (!first || first[0] == '#')
+			return true;
+
+		auto next = [&]() { return SDL_strtok_r(nullptr, separators, &state); };
+
+		if (SDL_strcmp(first, "format") == 0)
+		{
+			const char *freq = next();
+			const char *channels = next();
+			if (!freq || !channels || SDL_atoi(freq) <= 0 || SDL_atoi(channels) <= 0)
+			{
+				SDL_LogError(SDL_LOG_CATEGORY_AUDIO, "AudioRender: %s:%d: format takes a rate and a channel count", p_path, p_lineNumber);
+				return false;
+			}
+
+			m_spec.freq = SDL_atoi(freq);
+			m_spec.channels = SDL_atoi(channels);
+			return true;
+		}
+
+		if (SDL_strcmp(first, "sound") == 0)
+		{
+			const char *tag = next();
+			const char *path = next();
+			if (!tag || !path)
+			{
+				SDL_LogError(SDL_LOG_CATEGORY_AUDIO, "AudioRender: %s:%d: sound takes a tag and a path", p_path, p_lineNumber);
+				return false;
+			}
+
+			m_sounds.push_back(AudioScriptSound{ tag, path });
+			return true;
+		}
+
+		// Everything else is "<seconds> <action> ..."
+
+		const char *action = next();
+		if (!action)
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_AUDIO, "AudioRender: %s:%d: missing action after %s", p_path, p_lineNumber, first);
+			return false;
+		}
+
+		const double seconds = SDL_atof(first);
+		if (seconds < 0.0)
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_AUDIO, "AudioRender: %s:%d: negative time", p_path, p_lineNumber);
+			return false;
+		}
+
+		AudioScriptEvent event{};
+		event.seconds = seconds;
+
+		if (SDL_strcmp(action, "end") == 0)
+		{
+			m_endSeconds = seconds;
+			return true;
+		}
+
+		if (SDL_strcmp(action, "play") == 0)
+		{
+			const char *sound = next();
+			const char *bus = next();
+			if (!sound || !bus)
+			{
+				SDL_LogError(SDL_LOG_CATEGORY_AUDIO, "AudioRender: %s:%d: play takes a sound and a bus", p_path, p_lineNumber);
+				return false;
+			}
+
+			event.action = AudioScriptAction::PLAY;
+			event.sound = SID(sound);
+			event.bus = bus;
+
+			if (const char *gain = next())
+				event.gain = static_cast<float>(SDL_atof(gain));
+			if (const char *pitch = next())
+				event.pitch = static_cast<float>(SDL_atof(pitch));
+		}
+		else if (SDL_strcmp(action, "stop") == 0)
+		{
+			const char *bus = next();
+			if (!bus)
+			{
+				SDL_LogError(SDL_LOG_CATEGORY_AUDIO, "AudioRender: %s:%d: stop takes a bus", p_path, p_lineNumber);
+				return false;
+			}
+
+			event.action = AudioScriptAction::STOP_BUS;
+			event.bus = bus;
+		}
+		else if (SDL_strcmp(action, "volume") == 0)
+		{
+			const char *bus = next();
+			const char *gain = next();
+			if (!bus || !gain)
+			{
+				SDL_LogError(SDL_LOG_CATEGORY_AUDIO, "AudioRender: %s:%d: volume takes a bus and a gain", p_path, p_lineNumber);
+				return false;
+			}
+
+			event.action = AudioScriptAction::BUS_VOLUME;
+			event.bus = bus;
+			event.gain = static_cast<float>(SDL_atof(gain));
+		}
+		else
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_AUDIO, "AudioRender: %s:%d: unknown action %s", p_path, p_lineNumber, action);
+			return false;
+		}
+
+		m_events.push_back(event);
+
+		return true;
+	}
+
+	bool AudioRender::WriteWav(const char *p_path, const std::vector<float> &p_samples) const
+	{
+		SDL_IOStream *file = SDL_IOFromFile(p_path, "wb");
+		if (!file)
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_AUDIO, "AudioRender: Failed to open %s: %s", p_path, SDL_GetError());
+			return false;
+		}
+
+		// 32 bit float PCM, the fact chunk is required for anything but integer PCM
+
+		const uint32_t channels = static_cast<uint32_t>(m_spec.channels);
+		const uint32_t dataBytes = static_cast<uint32_t>(p_samples.size() * sizeof(float));
+		const uint32_t blockAlign = channels * sizeof(float);
+
+		bool result = SDL_WriteIO(file, "RIFF", 4) == 4;
+		result &= SDL_WriteU32LE(file, 4 + (8 + 16) + (8 + 4) + (8 + dataBytes));
+		result &= SDL_WriteIO(file, "WAVE", 4) == 4;
+
+		result &= SDL_WriteIO(file, "fmt ", 4) == 4;
+		result &= SDL_WriteU32LE(file, 16);
+		result &= SDL_WriteU16LE(file, 3); // WAVE_FORMAT_IEEE_FLOAT
+		result &= SDL_WriteU16LE(file, static_cast<uint16_t>(channels));
+		result &= SDL_WriteU32LE(file, static_cast<uint32_t>(m_spec.freq));
+		result &= SDL_WriteU32LE(file, static_cast<uint32_t>(m_spec.freq) * blockAlign);
+		result &= SDL_WriteU16LE(file, static_cast<uint16_t>(blockAlign));
+		result &= SDL_WriteU16LE(file, 32);
+
+		result &= SDL_WriteIO(file, "fact", 4) == 4;
+		result &= SDL_WriteU32LE(file, 4);
+		result &= SDL_WriteU32LE(file, static_cast<uint32_t>(p_samples.size() / channels));
+
+		// Samples go out as they are in memory, every platform we ship on is little endian
+
+		result &= SDL_WriteIO(file, "data", 4) == 4;
+		result &= SDL_WriteU32LE(file, dataBytes);
+		result &= SDL_WriteIO(file, p_samples.data(), dataBytes) == dataBytes;
+
+		if (!SDL_CloseIO(file) || !result)
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_AUDIO, "AudioRender: Failed to write %s: %s", p_path, SDL_GetError());
+			return false;
+		}
+
+		SDL_LogInfo(SDL_LOG_CATEGORY_AUDIO, "AudioRender: Wrote %s", p_path);
+
+		return true;
+	}
+
+	bool AudioRender::CompareWithReference(const char *p_path, const std::vector<float> &p_samples, float p_tolerance) const
+	{
+		SDL_AudioSpec spec{};
+		Uint8 *buffer = nullptr;
+		Uint32 length = 0;
+
+		if (!SDL_LoadWAV(p_path, &spec, &buffer, &length))
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_AUDIO, "AudioRender: Failed to load reference %s: %s", p_path, SDL_GetError());
+			return false;
+		}
+
+		bool result = true;
+		const size_t count = length / sizeof(float);
+
+		if (spec.format != SDL_AUDIO_F32 || spec.channels != m_spec.channels || spec.freq != m_spec.freq)
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_AUDIO, "AudioRender: Reference %s is not %d Hz, %d channel float", p_path, m_spec.freq, m_spec.channels);
+			result = false;
+		}
+		else if (count != p_samples.size())
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_AUDIO, "AudioRender: Reference %s has %zu samples, render has %zu", p_path, count, p_samples.size());
+			result = false;
+		}
+		else
+		{
+			const float *reference = reinterpret_cast<const float *>(buffer);
+
+			float maxDiff = 0.0f;
+			size_t maxIndex = 0;
+			double squaredSum = 0.0;
+
+			for (size_t i = 0; i < count; i++)
+			{
+				const float diff = SDL_fabsf(p_samples[i] - reference[i]);
+				squaredSum += static_cast<double>(diff) * diff;
+
+				if (diff > maxDiff)
+				{
+					maxDiff = diff;
+					maxIndex = i;
+				}
+			}
+
+			const double rms = count > 0 ? SDL_sqrt(squaredSum / static_cast<double>(count)) : 0.0;
+			result = maxDiff <= p_tolerance;
+
+			if (result)
+				SDL_LogInfo(SDL_LOG_CATEGORY_AUDIO, "AudioRender: Matches %s (max diff %g, rms %g)", p_path, maxDiff, rms);
+			else
+				SDL_LogError(SDL_LOG_CATEGORY_AUDIO, "AudioRender: Differs from %s, max diff %g at frame %zu (rms %g, tolerance %g)",
+					p_path, maxDiff, maxIndex / m_spec.channels, rms, p_tolerance);
+		}
+
+		SDL_free(buffer);
+
+		return result;
+	}
+}
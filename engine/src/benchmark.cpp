@@ -0,0 +1,274 @@
+#include "benchmark.hpp"
+
+#include <SDL3/SDL.h>
+
+#include "collision.hpp"
+#include "ecs.hpp"
+#include "projectiles.hpp"
+#include "renderer_types.hpp"
+
+namespace lum
+{
+    // Stand ins for the game's translation and velocity, the engine can't see those
+
+    struct BenchTranslation
+    {
+        glm::vec2 position{};
+        float     rotation{};
+        float     scale{ 1.0f };
+    };
+
+    struct BenchVelocity
+    {
+        glm::vec2 direction{};
+        float     speed{};
+    };
+
+    struct BenchTag
+    {
+    };
+
+    Benchmark::Benchmark() = default;
+    Benchmark::~Benchmark() = default;
+
+    bool Benchmark::Run(const char *p_name, const char *p_outPath)
+    {
+        m_random = SEED;
+        m_timings.clear();
+
+        float budgetMS = 0.0f;
+        bool result = false;
+
+        if (SDL_strcmp(p_name, "collision") == 0)
+        {
+            result = RunCollision(budgetMS);
+        }
+        else if (SDL_strcmp(p_name, "projectiles") == 0)
+        {
+            result = RunProjectiles(budgetMS);
+        }
+        else if (SDL_strcmp(p_name, "ecs") == 0)
+        {
+            result = RunEcs(budgetMS);
+        }
+        else
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Benchmark: Unknown benchmark %s", p_name);
+            return false;
+        }
+
+        return Report(p_name, p_outPath, budgetMS) && result;
+    }
+
+    bool Benchmark::RunCollision(float &p_budgetMS)
+    {
+        // Layers of a shmup, enemies want the player's bullets, the player wants
+        // enemies and their bullets and every bullet wants what it's shot at
+
+        enum : uint32_t
+        {
+            PLAYER = 1 << 0,
+            ENEMY = 1 << 1,
+            PLAYER_BULLET = 1 << 2,
+            ENEMY_BULLET = 1 << 3
+        };
+
+        const glm::vec2 size(240.0f, 360.0f);
+
+        CollisionWorld world{};
+        world.SetBounds(glm::vec2(0.0f), size);
+
+        for (uint32_t frame = 0; frame < WARMUP_FRAMES + FRAMES; frame++)
+        {
+            world.Clear();
+            world.AddCircle(glm::vec2(size.x * 0.5f, size.y * 0.1f), 4.0f, PLAYER, ENEMY | ENEMY_BULLET);
+
+            for (uint32_t i = 0; i < COLLISION_ENEMIES; i++)
+            {
+                const glm::vec2 position(SDL_randf_r(&m_random) * size.x, SDL_randf_r(&m_random) * size.y);
+                world.AddBox(position, glm::vec2(10.0f, 8.0f), ENEMY, PLAYER_BULLET);
+            }
+
+            for (uint32_t i = 0; i < COLLISION_BULLETS; i++)
+            {
+                const glm::vec2 position(SDL_randf_r(&m_random) * size.x, SDL_randf_r(&m_random) * size.y);
+                world.AddCircle(position, 2.0f, PLAYER_BULLET, ENEMY);
+            }
+
+            for (uint32_t i = 0; i < COLLISION_BULLETS; i++)
+            {
+                const glm::vec2 position(SDL_randf_r(&m_random) * size.x, SDL_randf_r(&m_random) * size.y);
+                world.AddCircle(position, 3.0f, ENEMY_BULLET, PLAYER);
+            }
+
+            world.Update();
+
+            const CollisionStats stats = world.GetStats();
+            Record("build", frame, stats.buildMS);
+            Record("query", frame, stats.queryMS);
+            Record("total", frame, stats.buildMS + stats.queryMS);
+        }
+
+        p_budgetMS = COLLISION_BUDGET_MS;
+        return true;
+    }
+
+    bool Benchmark::RunProjectiles(float &p_budgetMS)
+    {
+        const glm::vec2 size(240.0f, 360.0f);
+        const float delta = 1.0f / 60.0f;
+
+        ProjectileManager projectiles{};
+        projectiles.SetBounds(glm::vec2(0.0f), size);
+
+        if (!projectiles.Reserve(PROJECTILE_COUNT))
+            return false;
+
+        // Stands in for the instance buffer the renderer maps
+
+        std::vector<QuadInstance> instances(PROJECTILE_COUNT);
+
+        for (uint32_t frame = 0; frame < WARMUP_FRAMES + FRAMES; frame++)
+        {
+            const uint64_t start = SDL_GetTicksNS();
+
+            // Whatever died last frame is fired again, slow enough that most of
+            // them live out their lifetime on screen
+
+            while (projectiles.GetCount() < PROJECTILE_COUNT)
+            {
+                const float angle = glm::radians(SDL_randf_r(&m_random) * 360.0f);
+                const glm::vec2 direction(SDL_cosf(angle), SDL_sinf(angle));
+                const glm::vec2 position(SDL_randf_r(&m_random) * size.x, SDL_randf_r(&m_random) * size.y);
+
+                projectiles.Spawn(position, direction * (10.0f + SDL_randf_r(&m_random) * 40.0f), glm::vec2(0.0f),
+                    glm::radians(20.0f), 1.0f + SDL_randf_r(&m_random) * 4.0f);
+            }
+
+            const uint64_t spawned = SDL_GetTicksNS();
+
+            projectiles.Update(delta);
+
+            const uint64_t updated = SDL_GetTicksNS();
+
+            projectiles.WriteInstances(instances.data(), 0.5f);
+
+            const uint64_t end = SDL_GetTicksNS();
+
+            Record("spawn", frame, static_cast<float>(spawned - start) / SDL_NS_PER_MS);
+            Record("update", frame, static_cast<float>(updated - spawned) / SDL_NS_PER_MS);
+            Record("instances", frame, static_cast<float>(end - updated) / SDL_NS_PER_MS);
+            Record("total", frame, static_cast<float>(end - start) / SDL_NS_PER_MS);
+        }
+
+        p_budgetMS = PROJECTILE_BUDGET_MS;
+        return true;
+    }
+
+    bool Benchmark::RunEcs(float &p_budgetMS)
+    {
+        const float delta = 1.0f / 60.0f;
+
+        ECS ecs{};
+        ecs.RegisterComponent<BenchTranslation>();
+        ecs.RegisterComponent<BenchVelocity>();
+        ecs.RegisterComponent<BenchTag>();
+
+        // Every other entity carries an extra component, so the query walks two
+        // tables like it would in a scene
+
+        for (uint32_t i = 0; i < ECS_ENTITIES; i++)
+        {
+            const Entity entity = ecs.CreateEntity();
+
+            const float angle = glm::radians(SDL_randf_r(&m_random) * 360.0f);
+            ecs.AddComponent(entity, BenchTranslation{ glm::vec2(SDL_randf_r(&m_random) * 240.0f, SDL_randf_r(&m_random) * 360.0f) });
+            ecs.AddComponent(entity, BenchVelocity{ glm::vec2(SDL_cosf(angle), SDL_sinf(angle)), 10.0f + SDL_randf_r(&m_random) * 40.0f });
+
+            if (i % 2 == 0)
+                ecs.AddComponent(entity, BenchTag{});
+        }
+
+        const Query &movables = ecs.RegisterQuery<BenchTranslation, BenchVelocity>();
+
+        for (uint32_t frame = 0; frame < WARMUP_FRAMES + FRAMES; frame++)
+        {
+            const uint64_t start = SDL_GetTicksNS();
+
+            ecs.ForEach<BenchTranslation, BenchVelocity>(movables, [delta](BenchTranslation &tran, BenchVelocity &velo)
+            {
+                tran.position += velo.direction * velo.speed * delta;
+            });
+
+            Record("total", frame, static_cast<float>(SDL_GetTicksNS() - start) / SDL_NS_PER_MS);
+        }
+
+        p_budgetMS = ECS_BUDGET_MS;
+        return true;
+    }
+
+    void Benchmark::Record(const char *p_name, uint32_t p_frame, float p_ms)
+    {
+        if (p_frame < WARMUP_FRAMES)
+            return;
+
+        for (JobTiming &timing : m_timings)
+        {
+            if (SDL_strcmp(timing.name, p_name) != 0)
+                continue;
+
+            timing.count++;
+            timing.totalMS += p_ms;
+            timing.maxMS = SDL_max(timing.maxMS, p_ms);
+            return;
+        }
+
+        m_timings.push_back(JobTiming{ p_name, 1, p_ms, p_ms });
+    }
+
+    bool Benchmark::Report(const char *p_name, const char *p_outPath, float p_budgetMS) const
+    {
+        // The last timing is the one held against the budget
+
+        float averageMS = 0.0f;
+
+        for (const JobTiming &timing : m_timings)
+        {
+            averageMS = timing.count ? timing.totalMS / timing.count : 0.0f;
+            SDL_Log("Benchmark: %-12s %6u runs %9.3f ms (%.4f ms avg, max %.3f ms)", timing.name, timing.count, timing.totalMS,
+                averageMS, timing.maxMS);
+        }
+
+        const bool withinBudget = averageMS <= p_budgetMS;
+        if (!withinBudget)
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Benchmark: %s averages %.4f ms, over its %.3f ms budget", p_name, averageMS, p_budgetMS);
+        else
+            SDL_Log("Benchmark: %s averages %.4f ms, within its %.3f ms budget", p_name, averageMS, p_budgetMS);
+
+        if (!p_outPath)
+            return withinBudget;
+
+        SDL_IOStream *file = SDL_IOFromFile(p_outPath, "w");
+        if (!file)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Benchmark: Failed to open %s: %s", p_outPath, SDL_GetError());
+            return false;
+        }
+
+        SDL_IOprintf(file, "name,runs,total_ms,avg_ms,max_ms\n");
+
+        for (const JobTiming &timing : m_timings)
+        {
+            SDL_IOprintf(file, "%s,%u,%.4f,%.4f,%.4f\n", timing.name, timing.count, timing.totalMS,
+                timing.count ? timing.totalMS / timing.count : 0.0f, timing.maxMS);
+        }
+
+        if (!SDL_CloseIO(file))
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Benchmark: Failed to write %s: %s", p_outPath, SDL_GetError());
+            return false;
+        }
+
+        return withinBudget;
+    }
+}
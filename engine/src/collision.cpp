@@ -0,0 +1,527 @@
+#include "collision.hpp"
+
+#include <algorithm>
+
+#include <SDL3/SDL.h>
+
+#include "simd.hpp"
+
+namespace lum
+{
+    CollisionWorld::CollisionWorld()
+    {
+        SetBounds(glm::vec2(0.0f), glm::vec2(240.0f, 360.0f));
+    }
+
+    CollisionWorld::~CollisionWorld() = default;
+
+    void CollisionWorld::SetBounds(glm::vec2 p_min, glm::vec2 p_max, float p_cellSize)
+    {
+        const float cellSize = SDL_max(p_cellSize, 1.0f);
+        const float width = SDL_max(p_max.x - p_min.x, cellSize);
+        const float height = SDL_max(p_max.y - p_min.y, cellSize);
+
+        m_min = p_min;
+        m_invCellSize = 1.0f / cellSize;
+        m_columns = SDL_min(static_cast<uint32_t>(SDL_ceilf(width * m_invCellSize)), MAX_CELLS_PER_AXIS);
+        m_rows = SDL_min(static_cast<uint32_t>(SDL_ceilf(height * m_invCellSize)), MAX_CELLS_PER_AXIS);
+
+        m_cellStarts.assign(m_columns * m_rows + 1, 0);
+    }
+
+    void CollisionWorld::Clear()
+    {
+        m_cx.clear();
+        m_cy.clear();
+        m_hx.clear();
+        m_hy.clear();
+        m_r.clear();
+        m_layers.clear();
+        m_masks.clear();
+        m_userData.clear();
+        m_ranges.clear();
+        m_contacts.clear();
+    }
+
+    uint32_t CollisionWorld::AddCircle(glm::vec2 p_center, float p_radius, uint32_t p_layers, uint32_t p_mask, uint32_t p_userData)
+    {
+        return Add(p_center, glm::vec2(0.0f), p_radius, p_layers, p_mask, p_userData);
+    }
+
+    uint32_t CollisionWorld::AddBox(glm::vec2 p_center, glm::vec2 p_halfExtents, uint32_t p_layers, uint32_t p_mask, uint32_t p_userData)
+    {
+        return Add(p_center, p_halfExtents, 0.0f, p_layers, p_mask, p_userData);
+    }
+
+    void CollisionWorld::Update()
+    {
+        const uint64_t start = SDL_GetTicksNS();
+
+        const uint32_t gridLayers = AssignQueryKinds();
+
+        uint32_t queries = 0;
+        for (const QueryKind &kind : m_kinds)
+        {
+            if (!kind.skip)
+                queries += kind.count;
+        }
+
+        if (queries <= MAX_COARSE_QUERIES)
+        {
+            // Cells share the origin, so a coarse cell is the fine one shifted
+            for (CellRange &range : m_ranges)
+            {
+                range.minX >>= COARSE_CELL_SHIFT;
+                range.minY >>= COARSE_CELL_SHIFT;
+                range.maxX >>= COARSE_CELL_SHIFT;
+                range.maxY >>= COARSE_CELL_SHIFT;
+            }
+
+            m_gridColumns = ((m_columns - 1) >> COARSE_CELL_SHIFT) + 1;
+            m_gridCells = m_gridColumns * (((m_rows - 1) >> COARSE_CELL_SHIFT) + 1);
+        }
+        else
+        {
+            m_gridColumns = m_columns;
+            m_gridCells = m_columns * m_rows;
+        }
+
+        BuildGrid(gridLayers);
+
+        const uint64_t built = SDL_GetTicksNS();
+
+        FindContacts();
+
+        const uint64_t end = SDL_GetTicksNS();
+
+        m_stats.colliders = static_cast<uint32_t>(m_cx.size());
+        m_stats.gridEntries = static_cast<uint32_t>(m_gridCX.size());
+        m_stats.gridCells = m_gridCells;
+        m_stats.contacts = static_cast<uint32_t>(m_contacts.size());
+        m_stats.buildMS = static_cast<float>(built - start) / SDL_NS_PER_MS;
+        m_stats.queryMS = static_cast<float>(end - built) / SDL_NS_PER_MS;
+    }
+
+    const std::vector<Contact> &CollisionWorld::GetContacts() const
+    {
+        return m_contacts;
+    }
+
+    CollisionStats CollisionWorld::GetStats() const
+    {
+        return m_stats;
+    }
+
+    uint32_t CollisionWorld::Add(glm::vec2 p_center, glm::vec2 p_halfExtents, float p_radius, uint32_t p_layers, uint32_t p_mask, uint32_t p_userData)
+    {
+        const uint32_t index = static_cast<uint32_t>(m_cx.size());
+
+        m_cx.push_back(p_center.x);
+        m_cy.push_back(p_center.y);
+        m_hx.push_back(p_halfExtents.x);
+        m_hy.push_back(p_halfExtents.y);
+        m_r.push_back(p_radius);
+        m_layers.push_back(p_layers);
+        m_masks.push_back(p_mask);
+        m_userData.push_back(p_userData);
+
+        // Cells touched by the bounds, clamped so anything off the playfield
+        // lands in the edge cells
+
+        const glm::vec2 extents = p_halfExtents + glm::vec2(p_radius);
+        const glm::vec2 lo = (p_center - extents - m_min) * m_invCellSize;
+        const glm::vec2 hi = (p_center + extents - m_min) * m_invCellSize;
+
+        CellRange range{};
+        range.minX = static_cast<uint16_t>(SDL_clamp(static_cast<int>(SDL_floorf(lo.x)), 0, static_cast<int>(m_columns) - 1));
+        range.minY = static_cast<uint16_t>(SDL_clamp(static_cast<int>(SDL_floorf(lo.y)), 0, static_cast<int>(m_rows) - 1));
+        range.maxX = static_cast<uint16_t>(SDL_clamp(static_cast<int>(SDL_floorf(hi.x)), 0, static_cast<int>(m_columns) - 1));
+        range.maxY = static_cast<uint16_t>(SDL_clamp(static_cast<int>(SDL_floorf(hi.y)), 0, static_cast<int>(m_rows) - 1));
+        m_ranges.push_back(range);
+
+        return index;
+    }
+
+    uint32_t CollisionWorld::AssignQueryKinds()
+    {
+        const uint32_t colliderCount = static_cast<uint32_t>(m_cx.size());
+
+        m_kinds.clear();
+        m_colliderKinds.resize(colliderCount);
+
+        // Layers nobody queries for, whoever wants them has to query itself
+
+        uint32_t passiveLayers = 0;
+        uint32_t lastKind = 0;
+        bool overflow = false;
+
+        for (uint32_t i = 0; i < colliderCount; i++)
+        {
+            const uint32_t mask = m_masks[i];
+            if (!mask)
+            {
+                passiveLayers |= m_layers[i];
+                continue;
+            }
+
+            // Colliders come in runs of one kind, try the last one first
+            uint32_t kind = lastKind;
+            if (kind >= m_kinds.size() || m_kinds[kind].layers != m_layers[i] || m_kinds[kind].mask != mask)
+            {
+                kind = 0;
+                while (kind < m_kinds.size() && (m_kinds[kind].layers != m_layers[i] || m_kinds[kind].mask != mask))
+                    kind++;
+            }
+
+            if (kind == m_kinds.size())
+            {
+                if (m_kinds.size() == MAX_QUERY_KINDS)
+                {
+                    overflow = true;
+                    kind = 0;
+                }
+                else
+                {
+                    m_kinds.push_back(QueryKind{ m_layers[i], mask });
+                }
+            }
+
+            m_kinds[kind].count++;
+            m_colliderKinds[i] = static_cast<uint8_t>(kind);
+            lastKind = kind;
+        }
+
+        if (overflow)
+        {
+            std::fill(m_colliderKinds.begin(), m_colliderKinds.end(), 0);
+
+            uint32_t gridLayers = 0;
+            for (uint32_t mask : m_masks)
+                gridLayers |= mask;
+
+            m_kinds.resize(1);
+            m_kinds[0] = QueryKind{ 0, gridLayers };
+
+            return gridLayers;
+        }
+
+        // For every pair of kinds that want each other the smaller one reports,
+        // a kind whose every target reports for it doesn't need to query
+
+        const uint32_t kindCount = static_cast<uint32_t>(m_kinds.size());
+
+        for (uint32_t a = 0; a < kindCount; a++)
+        {
+            QueryKind &kind = m_kinds[a];
+            kind.skip = !(kind.mask & passiveLayers);
+
+            for (uint32_t b = 0; b < kindCount; b++)
+            {
+                const QueryKind &other = m_kinds[b];
+                if (!(kind.mask & other.layers))
+                    continue;
+
+                const bool mutual = (other.mask & kind.layers) != 0;
+                const bool reports = other.count > kind.count || (other.count == kind.count && b > a);
+
+                if (mutual && reports)
+                    kind.reportsOver |= static_cast<uint8_t>(1u << b);
+
+                if (!mutual || reports || a == b)
+                    kind.skip = false;
+            }
+        }
+
+        // Only layers somebody still queries for are worth putting in the grid
+
+        uint32_t gridLayers = 0;
+        for (const QueryKind &kind : m_kinds)
+        {
+            if (!kind.skip)
+                gridLayers |= kind.mask;
+        }
+
+        return gridLayers;
+    }
+
+    void CollisionWorld::BuildGrid(uint32_t p_gridLayers)
+    {
+        const uint32_t cellCount = m_gridCells;
+        const uint32_t colliderCount = static_cast<uint32_t>(m_cx.size());
+
+        // Group every grid entry by its layer set, runs of bullets share one so
+        // the last match is checked first
+
+        m_groupLayers.clear();
+        m_groups.resize(colliderCount);
+
+        uint32_t lastLayers = 0;
+        uint8_t lastGroup = NO_GROUP;
+
+        for (uint32_t i = 0; i < colliderCount; i++)
+        {
+            const uint32_t layers = m_layers[i];
+            if (!(layers & p_gridLayers))
+            {
+                m_groups[i] = NO_GROUP;
+                continue;
+            }
+
+            if (lastGroup == NO_GROUP || layers != lastLayers)
+            {
+                uint32_t group = 0;
+                while (group < m_groupLayers.size() && m_groupLayers[group] != layers)
+                    group++;
+
+                if (group == m_groupLayers.size())
+                {
+                    if (m_groupLayers.size() < MAX_LAYER_GROUPS)
+                        m_groupLayers.push_back(layers);
+                    else
+                        m_groupLayers[--group] |= layers;
+                }
+
+                lastLayers = layers;
+                lastGroup = static_cast<uint8_t>(group);
+            }
+
+            m_groups[i] = lastGroup;
+        }
+
+        // Counting sort on cell then group, count entries per key, turn the
+        // counts into start offsets, then scatter every collider into the cells
+        // it touches
+
+        const uint32_t groupCount = SDL_max(static_cast<uint32_t>(m_groupLayers.size()), 1u);
+        const uint32_t keyCount = cellCount * groupCount;
+
+        m_cellStarts.resize(keyCount + 1);
+        std::fill(m_cellStarts.begin(), m_cellStarts.end(), 0);
+
+        // Most colliders touch one or two cells a side, whether it's one or two
+        // is a coin toss the branch predictor loses. Those add to all four corners
+        // of a two by two block instead, a corner past the range lands back on
+        // the first cell and adds nothing. Only bigger ones loop.
+
+        const uint32_t rowKeys = m_gridColumns * groupCount;
+
+        for (uint32_t i = 0; i < colliderCount; i++)
+        {
+            const uint8_t group = m_groups[i];
+            if (group == NO_GROUP)
+                continue;
+
+            const CellRange &range = m_ranges[i];
+            const uint32_t spanX = range.maxX - range.minX;
+            const uint32_t spanY = range.maxY - range.minY;
+
+            if (spanX > 1 || spanY > 1)
+            {
+                for (uint32_t y = range.minY; y <= range.maxY; y++)
+                {
+                    for (uint32_t x = range.minX; x <= range.maxX; x++)
+                        m_cellStarts[(y * m_gridColumns + x) * groupCount + group + 1]++;
+                }
+
+                continue;
+            }
+
+            uint32_t *counts = m_cellStarts.data() + (range.minY * m_gridColumns + range.minX) * groupCount + group + 1;
+            counts[0]++;
+            counts[spanX * groupCount] += spanX;
+            counts[spanY * rowKeys] += spanY;
+            counts[spanY * rowKeys + spanX * groupCount] += spanX & spanY;
+        }
+
+        for (uint32_t key = 0; key < keyCount; key++)
+            m_cellStarts[key + 1] += m_cellStarts[key];
+
+        uint32_t largestCell = 0;
+        for (uint32_t cell = 0; cell < cellCount; cell++)
+            largestCell = SDL_max(largestCell, m_cellStarts[(cell + 1) * groupCount] - m_cellStarts[cell * groupCount]);
+
+        const uint32_t entryCount = m_cellStarts[keyCount];
+
+        m_gridCX.resize(entryCount);
+        m_gridCY.resize(entryCount);
+        m_gridHX.resize(entryCount);
+        m_gridHY.resize(entryCount);
+        m_gridR.resize(entryCount);
+        m_gridLayers.resize(entryCount);
+        m_gridIndex.resize(entryCount + 1); // The last one takes the writes of corners past a range
+        m_hits.resize(largestCell);
+
+        // Scatter using the starts as write cursors, which leaves every start
+        // shifted to the end of its key, the one before it is the real start.
+        // Corners past the range write to the spare slot and don't move on.
+
+        for (uint32_t i = 0; i < colliderCount; i++)
+        {
+            const uint8_t group = m_groups[i];
+            if (group == NO_GROUP)
+                continue;
+
+            const CellRange &range = m_ranges[i];
+            const uint32_t spanX = range.maxX - range.minX;
+            const uint32_t spanY = range.maxY - range.minY;
+
+            if (spanX > 1 || spanY > 1)
+            {
+                for (uint32_t y = range.minY; y <= range.maxY; y++)
+                {
+                    for (uint32_t x = range.minX; x <= range.maxX; x++)
+                        m_gridIndex[m_cellStarts[(y * m_gridColumns + x) * groupCount + group]++] = i;
+                }
+
+                continue;
+            }
+
+            const uint32_t both = spanX & spanY;
+            uint32_t *cursors = m_cellStarts.data() + (range.minY * m_gridColumns + range.minX) * groupCount + group;
+
+            m_gridIndex[cursors[0]++] = i;
+
+            uint32_t &right = cursors[spanX * groupCount];
+            m_gridIndex[spanX ? right : entryCount] = i;
+            right += spanX;
+
+            uint32_t &below = cursors[spanY * rowKeys];
+            m_gridIndex[spanY ? below : entryCount] = i;
+            below += spanY;
+
+            uint32_t &corner = cursors[spanY * rowKeys + spanX * groupCount];
+            m_gridIndex[both ? corner : entryCount] = i;
+            corner += both;
+        }
+
+        // Copy the shapes over in grid order, one write stream per array instead
+        // of one per cell and array during the scatter
+
+        for (uint32_t slot = 0; slot < entryCount; slot++)
+        {
+            const uint32_t i = m_gridIndex[slot];
+
+            m_gridCX[slot] = m_cx[i];
+            m_gridCY[slot] = m_cy[i];
+            m_gridHX[slot] = m_hx[i];
+            m_gridHY[slot] = m_hy[i];
+            m_gridR[slot] = m_r[i];
+            m_gridLayers[slot] = m_layers[i];
+        }
+
+        for (uint32_t key = keyCount; key > 0; key--)
+            m_cellStarts[key] = m_cellStarts[key - 1];
+
+        m_cellStarts[0] = 0;
+    }
+
+    void CollisionWorld::FindContacts()
+    {
+        const uint32_t colliderCount = static_cast<uint32_t>(m_cx.size());
+        const uint32_t groupCount = SDL_max(static_cast<uint32_t>(m_groupLayers.size()), 1u);
+        uint32_t queries = 0;
+
+        m_contacts.clear();
+
+        simd::RoundedBoxes boxes{};
+
+        // Runs of adjacent groups a mask can hit, each one contiguous in a cell.
+        // Queries come in runs with the same mask, so they're only worked out
+        // again when it changes.
+
+        struct GroupRun
+        {
+            uint32_t first{};
+            uint32_t end{};
+        };
+
+        GroupRun runs[MAX_LAYER_GROUPS]{};
+        uint32_t runCount = 0;
+        uint32_t runMask = 0;
+
+        for (uint32_t i = 0; i < colliderCount; i++)
+        {
+            const uint32_t mask = m_masks[i];
+            if (!mask)
+                continue;
+
+            const uint8_t kind = m_colliderKinds[i];
+            const uint8_t reportsOver = m_kinds[kind].reportsOver;
+
+            if (m_kinds[kind].skip)
+                continue;
+
+            queries++;
+
+            if (runMask != mask)
+            {
+                runMask = mask;
+                runCount = 0;
+
+                for (uint32_t group = 0; group < m_groupLayers.size(); group++)
+                {
+                    if (!(m_groupLayers[group] & mask))
+                        continue;
+
+                    if (runCount > 0 && runs[runCount - 1].end == group)
+                        runs[runCount - 1].end = group + 1;
+                    else
+                        runs[runCount++] = GroupRun{ group, group + 1 };
+                }
+            }
+
+            const CellRange &range = m_ranges[i];
+            for (uint32_t y = range.minY; y <= range.maxY; y++)
+            {
+                for (uint32_t x = range.minX; x <= range.maxX; x++)
+                {
+                    const uint32_t cellKey = (y * m_gridColumns + x) * groupCount;
+
+                    for (uint32_t run = 0; run < runCount; run++)
+                    {
+                        const uint32_t begin = m_cellStarts[cellKey + runs[run].first];
+                        const uint32_t count = m_cellStarts[cellKey + runs[run].end] - begin;
+
+                        if (count == 0)
+                            continue;
+
+                        boxes.cx = m_gridCX.data() + begin;
+                        boxes.cy = m_gridCY.data() + begin;
+                        boxes.hx = m_gridHX.data() + begin;
+                        boxes.hy = m_gridHY.data() + begin;
+                        boxes.r = m_gridR.data() + begin;
+                        boxes.layers = m_gridLayers.data() + begin;
+
+                        const size_t hits = simd::OverlapRoundedBoxes(m_cx[i], m_cy[i], m_hx[i], m_hy[i], m_r[i], mask, boxes, count, m_hits.data());
+
+                        for (size_t h = 0; h < hits; h++)
+                        {
+                            const uint32_t j = m_gridIndex[begin + m_hits[h]];
+                            if (j == i)
+                                continue;
+
+                            // Both span several cells, only report from the first
+                            // cell they share
+                            const CellRange &other = m_ranges[j];
+                            if (x != SDL_max(range.minX, other.minX) || y != SDL_max(range.minY, other.minY))
+                                continue;
+
+                            // Both want each other, the smaller kind reports it,
+                            // the lower index within a kind
+                            if (m_masks[j] & m_layers[i])
+                            {
+                                const uint8_t otherKind = m_colliderKinds[j];
+                                if (otherKind == kind ? j < i : !(reportsOver & (1u << otherKind)))
+                                    continue;
+                            }
+
+                            m_contacts.push_back(Contact{ i, j, m_userData[i], m_userData[j] });
+                        }
+                    }
+                }
+            }
+        }
+
+        m_stats.queries = queries;
+    }
+}
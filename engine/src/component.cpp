@@ -1,5 +1,7 @@
 #include "component.hpp"
 
+#include "snapshot.hpp"
+
 namespace lum
 {
     Component::Component(const std::string &p_name, bool p_visual) : name(p_name), visual(p_visual) {};
@@ -7,4 +9,11 @@ namespace lum
     Component::~Component() = default;
 
     void Component::Draw() {}
+
+    void Component::SaveState(SnapshotWriter &) const {}
+
+    bool Component::LoadState(SnapshotReader &)
+    {
+        return true;
+    }
 }
\ No newline at end of file
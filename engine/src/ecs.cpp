@@ -0,0 +1,578 @@
+#include "ecs.hpp"
+
+namespace lum
+{
+    // ARCHETYPE
+    //
+
+    Archetype::Archetype(const Signature &p_signature, const std::array<ComponentInfo, MAX_COMPONENTS> &p_components)
+        : signature(p_signature)
+    {
+        m_columnLookup.fill(-1);
+
+        for (uint32_t i = 0; i < MAX_COMPONENTS; i++)
+        {
+            if (!p_signature.test(i))
+                continue;
+
+            m_columnLookup[i] = static_cast<int8_t>(m_columns.size());
+            m_columns.push_back(Column{ &p_components[i], nullptr });
+        }
+    }
+
+    Archetype::~Archetype()
+    {
+        const uint32_t count = Size();
+
+        for (auto &column : m_columns)
+        {
+            if (!column.info->trivial)
+            {
+                for (uint32_t row = 0; row < count; row++)
+                    column.info->destroy(column.data + row * column.info->size);
+            }
+
+            SDL_aligned_free(column.data);
+        }
+    }
+
+    uint32_t Archetype::Size() const
+    {
+        return static_cast<uint32_t>(entities.size());
+    }
+
+    bool Archetype::Has(ComponentIndex p_component) const
+    {
+        return p_component < MAX_COMPONENTS && m_columnLookup[p_component] >= 0;
+    }
+
+    void *Archetype::GetColumn(ComponentIndex p_component)
+    {
+        return Has(p_component) ? m_columns[m_columnLookup[p_component]].data : nullptr;
+    }
+
+    void *Archetype::GetComponent(ComponentIndex p_component, uint32_t p_row)
+    {
+        const auto &column = m_columns[m_columnLookup[p_component]];
+        return column.data + p_row * column.info->size;
+    }
+
+    uint32_t Archetype::AddRow(Entity p_entity)
+    {
+        if (Size() == m_capacity)
+            Grow();
+
+        entities.push_back(p_entity);
+
+        return Size() - 1;
+    }
+
+    Entity Archetype::RemoveRow(uint32_t p_row)
+    {
+        const uint32_t last = Size() - 1;
+
+        for (auto &column : m_columns)
+        {
+            const size_t size = column.info->size;
+            uint8_t *hole = column.data + p_row * size;
+            uint8_t *tail = column.data + last * size;
+
+            if (column.info->trivial)
+            {
+                if (p_row != last)
+                    SDL_memcpy(hole, tail, size);
+                continue;
+            }
+
+            column.info->destroy(hole);
+            if (p_row != last)
+            {
+                column.info->moveConstruct(hole, tail);
+                column.info->destroy(tail);
+            }
+        }
+
+        Entity moved{};
+        if (p_row != last)
+        {
+            entities[p_row] = entities[last];
+            moved = entities[p_row];
+        }
+
+        entities.pop_back();
+
+        return moved;
+    }
+
+    uint32_t Archetype::MoveRowTo(uint32_t p_row, Archetype &p_dst, Entity &p_outMoved)
+    {
+        const uint32_t dstRow = p_dst.AddRow(entities[p_row]);
+
+        for (uint32_t i = 0; i < MAX_COMPONENTS; i++)
+        {
+            if (m_columnLookup[i] < 0 || p_dst.m_columnLookup[i] < 0)
+                continue;
+
+            const auto &column = m_columns[m_columnLookup[i]];
+            const size_t size = column.info->size;
+            uint8_t *src = column.data + p_row * size;
+            uint8_t *dst = p_dst.m_columns[p_dst.m_columnLookup[i]].data + dstRow * size;
+
+            if (column.info->trivial)
+                SDL_memcpy(dst, src, size);
+            else
+                column.info->moveConstruct(dst, src);
+        }
+
+        // The moved from components still get destroyed here
+        p_outMoved = RemoveRow(p_row);
+
+        return dstRow;
+    }
+
+    void Archetype::SaveRows(SnapshotWriter &p_writer) const
+    {
+        const uint32_t count = Size();
+
+        p_writer.WriteValue(count);
+        p_writer.Write(entities.data(), count * sizeof(Entity));
+
+        for (const auto &column : m_columns)
+        {
+            if (column.info->trivial)
+            {
+                p_writer.Write(column.data, count * column.info->size);
+                continue;
+            }
+
+            // Byte count goes first, it's only known once the rows are written
+
+            const size_t start = p_writer.GetSize();
+            p_writer.WriteValue(uint32_t{});
+
+            for (uint32_t row = 0; row < count; row++)
+                column.info->saveState(column.data + row * column.info->size, p_writer);
+
+            const uint32_t bytes = static_cast<uint32_t>(p_writer.GetSize() - start - sizeof(uint32_t));
+            p_writer.Patch(start, &bytes, sizeof(bytes));
+        }
+    }
+
+    bool Archetype::LoadRows(SnapshotReader &p_reader, bool p_apply)
+    {
+        uint32_t count{};
+        if (!p_reader.ReadValue(count))
+            return false;
+
+        const uint8_t *saved = p_reader.Take(count * sizeof(Entity));
+        if (!saved)
+            return false;
+
+        if (!p_apply)
+        {
+            for (const auto &column : m_columns)
+            {
+                if (column.info->trivial)
+                {
+                    if (!p_reader.Take(count * column.info->size))
+                        return false;
+
+                    continue;
+                }
+
+                uint32_t bytes{};
+                if (!p_reader.ReadValue(bytes) || !p_reader.Take(bytes))
+                    return false;
+
+                // Rows we'd have to make up before the hooks can fill them in
+                if (count > Size() && !column.info->defaultConstruct)
+                    return false;
+            }
+
+            return true;
+        }
+
+        Resize(count);
+
+        if (count > 0)
+            SDL_memcpy(entities.data(), saved, count * sizeof(Entity));
+
+        bool valid = true;
+
+        for (auto &column : m_columns)
+        {
+            if (column.info->trivial)
+            {
+                const uint8_t *data = p_reader.Take(count * column.info->size);
+                if (count > 0)
+                    SDL_memcpy(column.data, data, count * column.info->size);
+
+                continue;
+            }
+
+            uint32_t bytes{};
+            p_reader.ReadValue(bytes);
+
+            // The hooks only get this column's bytes, one that reads too much
+            // fails here instead of eating into the next column
+
+            SnapshotReader rows(p_reader.Take(bytes), bytes);
+            for (uint32_t row = 0; row < count; row++)
+                valid = column.info->loadState(column.data + row * column.info->size, rows) && valid;
+
+            valid = valid && rows.AtEnd();
+        }
+
+        if (!valid)
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "ECS: A component read back different bytes than it saved");
+
+        return valid;
+    }
+
+    void Archetype::Clear()
+    {
+        Resize(0);
+    }
+
+    void Archetype::Resize(uint32_t p_rows)
+    {
+        while (m_capacity < p_rows)
+            Grow();
+
+        const uint32_t count = Size();
+
+        for (auto &column : m_columns)
+        {
+            if (column.info->trivial)
+                continue;
+
+            for (uint32_t row = p_rows; row < count; row++)
+                column.info->destroy(column.data + row * column.info->size);
+
+            for (uint32_t row = count; row < p_rows; row++)
+                column.info->defaultConstruct(column.data + row * column.info->size);
+        }
+
+        entities.resize(p_rows);
+    }
+
+    void Archetype::Grow()
+    {
+        const uint32_t newCapacity = m_capacity ? m_capacity * 2 : INITIAL_CAPACITY;
+        const uint32_t count = Size();
+
+        for (auto &column : m_columns)
+        {
+            const size_t size = column.info->size;
+            const size_t alignment = SDL_max(column.info->alignment, static_cast<size_t>(16));
+
+            auto *data = static_cast<uint8_t *>(SDL_aligned_alloc(alignment, size * newCapacity));
+
+            if (column.info->trivial)
+            {
+                if (count > 0)
+                    SDL_memcpy(data, column.data, size * count);
+            }
+            else
+            {
+                for (uint32_t row = 0; row < count; row++)
+                {
+                    column.info->moveConstruct(data + row * size, column.data + row * size);
+                    column.info->destroy(column.data + row * size);
+                }
+            }
+
+            SDL_aligned_free(column.data);
+            column.data = data;
+        }
+
+        entities.reserve(newCapacity);
+        m_capacity = newCapacity;
+    }
+
+    // QUERY
+    //
+
+    Query::Query(const Signature &p_signature) : signature(p_signature) {}
+
+    Query::~Query() = default;
+
+    const std::vector<Archetype *> &Query::GetArchetypes() const
+    {
+        return m_archetypes;
+    }
+
+    uint32_t Query::Size() const
+    {
+        uint32_t size = 0;
+        for (const Archetype *archetype : m_archetypes)
+            size += archetype->Size();
+
+        return size;
+    }
+
+    // ECS
+    //
+
+    ECS::ECS()
+    {
+        m_emptyArchetype = GetOrCreateArchetype(Signature{});
+    }
+
+    ECS::~ECS() = default;
+
+    Entity ECS::CreateEntity()
+    {
+        uint32_t index = 0;
+        if (!m_freeIndices.empty())
+        {
+            index = m_freeIndices.back();
+            m_freeIndices.pop_back();
+        }
+        else
+        {
+            index = static_cast<uint32_t>(m_records.size());
+            m_records.emplace_back();
+        }
+
+        auto &record = m_records[index];
+        Entity entity{ index, record.generation };
+
+        record.alive = true;
+        record.archetype = m_emptyArchetype;
+        record.row = m_emptyArchetype->AddRow(entity);
+
+        m_entityCount++;
+
+        return entity;
+    }
+
+    void ECS::DestroyEntity(Entity p_entity)
+    {
+        if (!IsAlive(p_entity))
+            return;
+
+        auto &record = m_records[p_entity.index];
+
+        Entity moved = record.archetype->RemoveRow(record.row);
+        if (moved)
+            m_records[moved.index].row = record.row;
+
+        // Skip zero on wrap so a null entity never matches a live one
+        record.generation = record.generation + 1 == 0 ? 1 : record.generation + 1;
+        record.alive = false;
+        record.archetype = nullptr;
+
+        m_freeIndices.push_back(p_entity.index);
+        m_entityCount--;
+    }
+
+    bool ECS::IsAlive(Entity p_entity) const
+    {
+        return p_entity.index < m_records.size() && m_records[p_entity.index].alive && m_records[p_entity.index].generation == p_entity.generation;
+    }
+
+    uint32_t ECS::GetEntityCount() const
+    {
+        return m_entityCount;
+    }
+
+    Signature ECS::GetSignature(Entity p_entity) const
+    {
+        return IsAlive(p_entity) ? m_records[p_entity.index].archetype->signature : Signature{};
+    }
+
+    // Records as they're saved, archetype by id instead of pointer
+    struct SavedRecord
+    {
+        uint32_t generation{};
+        uint32_t alive{};
+        uint32_t archetype{};
+        uint32_t row{};
+    };
+
+    static constexpr uint32_t NO_ARCHETYPE = ~0u;
+
+    void ECS::SaveState(SnapshotWriter &p_writer) const
+    {
+        p_writer.WriteValue(m_componentCount);
+        p_writer.WriteValue(static_cast<uint32_t>(m_records.size()));
+
+        for (const auto &record : m_records)
+        {
+            SavedRecord saved{ record.generation, record.alive, record.archetype ? record.archetype->id : NO_ARCHETYPE, record.row };
+            p_writer.WriteValue(saved);
+        }
+
+        p_writer.WriteArray(m_freeIndices);
+        p_writer.WriteValue(m_entityCount);
+
+        p_writer.WriteValue(static_cast<uint32_t>(m_archetypes.size()));
+        for (const auto &archetype : m_archetypes)
+            archetype->SaveRows(p_writer);
+    }
+
+    bool ECS::LoadState(SnapshotReader &p_reader)
+    {
+        // Dry run on a copy of the reader, so a snapshot from another world
+        // fails before anything changed
+
+        SnapshotReader check = p_reader;
+
+        uint32_t componentCount{}, recordCount{}, freeCount{}, entityCount{}, archetypeCount{};
+        bool valid = check.ReadValue(componentCount) && componentCount == m_componentCount;
+        valid = valid && check.ReadValue(recordCount) && check.Take(static_cast<size_t>(recordCount) * sizeof(SavedRecord));
+        valid = valid && check.ReadValue(freeCount) && check.Take(static_cast<size_t>(freeCount) * sizeof(uint32_t));
+        valid = valid && check.ReadValue(entityCount);
+        valid = valid && check.ReadValue(archetypeCount) && archetypeCount <= m_archetypes.size();
+
+        for (uint32_t i = 0; valid && i < archetypeCount; i++)
+            valid = m_archetypes[i]->LoadRows(check, false);
+
+        if (!valid)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "ECS: Snapshot doesn't fit this world, not loaded");
+            return false;
+        }
+
+        // Same reads again, for real this time
+
+        p_reader.ReadValue(componentCount);
+        p_reader.ReadValue(recordCount);
+
+        m_records.resize(recordCount);
+        for (auto &record : m_records)
+        {
+            SavedRecord saved{};
+            p_reader.ReadValue(saved);
+
+            record.generation = saved.generation;
+            record.alive = saved.alive != 0;
+            record.archetype = saved.archetype != NO_ARCHETYPE ? m_archetypes[saved.archetype].get() : nullptr;
+            record.row = saved.row;
+        }
+
+        p_reader.ReadArray(m_freeIndices);
+        p_reader.ReadValue(m_entityCount);
+        p_reader.ReadValue(archetypeCount);
+
+        bool loaded = true;
+        for (uint32_t i = 0; i < archetypeCount; i++)
+            loaded = m_archetypes[i]->LoadRows(p_reader, true) && loaded;
+
+        // Tables made after the snapshot had nothing in them back then
+
+        for (size_t i = archetypeCount; i < m_archetypes.size(); i++)
+            m_archetypes[i]->Clear();
+
+        return loaded;
+    }
+
+    FrameVector<Entity> ECS::QueryEntitiesWithSignature(const Signature &p_signature) const
+    {
+        FrameVector<Entity> result{};
+
+        auto it = m_queryLookup.find(p_signature);
+        if (it != m_queryLookup.end())
+        {
+            result.reserve(it->second->Size());
+
+            for (const Archetype *archetype : it->second->GetArchetypes())
+                result.insert(result.end(), archetype->entities.begin(), archetype->entities.end());
+
+            return result;
+        }
+
+        for (const auto &archetype : m_archetypes)
+        {
+            if ((archetype->signature & p_signature) == p_signature)
+                result.insert(result.end(), archetype->entities.begin(), archetype->entities.end());
+        }
+
+        return result;
+    }
+
+    Query &ECS::RegisterQuery(const Signature &p_signature)
+    {
+        auto it = m_queryLookup.find(p_signature);
+        if (it != m_queryLookup.end())
+            return *it->second;
+
+        m_queries.push_back(std::make_unique<Query>(p_signature));
+        Query *query = m_queries.back().get();
+
+        for (const auto &archetype : m_archetypes)
+        {
+            if ((archetype->signature & p_signature) == p_signature)
+                query->m_archetypes.push_back(archetype.get());
+        }
+
+        m_queryLookup.emplace(p_signature, query);
+
+        return *query;
+    }
+
+    Archetype *ECS::GetOrCreateArchetype(const Signature &p_signature)
+    {
+        auto it = m_archetypeLookup.find(p_signature);
+        if (it != m_archetypeLookup.end())
+            return it->second;
+
+        m_archetypes.push_back(std::make_unique<Archetype>(p_signature, m_components));
+        Archetype *archetype = m_archetypes.back().get();
+        archetype->id = static_cast<uint32_t>(m_archetypes.size() - 1);
+        m_archetypeLookup.emplace(p_signature, archetype);
+
+        // Only a new table can change what a query matches
+
+        for (const auto &query : m_queries)
+        {
+            if ((p_signature & query->signature) == query->signature)
+                query->m_archetypes.push_back(archetype);
+        }
+
+        return archetype;
+    }
+
+    void *ECS::MoveToArchetype(Entity p_entity, const Signature &p_signature, ComponentIndex p_added)
+    {
+        auto &record = m_records[p_entity.index];
+        Archetype *source = record.archetype;
+
+        // Single component changes go through the cached edges, the map lookup
+        // only happens the first time a transition is taken
+
+        const Signature changed = source->signature ^ p_signature;
+        Archetype *target = nullptr;
+
+        if (changed.count() == 1)
+        {
+            size_t component = 0;
+            while (!changed.test(component))
+                component++;
+
+
+            auto &edge = p_signature.test(component) ? source->addEdges[component] : source->removeEdges[component];
+
+            if (!edge)
+                edge = GetOrCreateArchetype(p_signature);
+
+            target = edge;
+        }
+        else
+        {
+            target = GetOrCreateArchetype(p_signature);
+        }
+
+        Entity moved{};
+        const uint32_t row = source->MoveRowTo(record.row, *target, moved);
+
+        if (moved)
+            m_records[moved.index].row = record.row;
+
+        record.archetype = target;
+        record.row = row;
+
+        return p_added != INVALID_COMPONENT ? target->GetComponent(p_added, row) : nullptr;
+    }
+}
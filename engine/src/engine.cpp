@@ -1,18 +1,52 @@
 #include "engine.hpp"
 
 #include <memory>
+#include <utility>
 
 #include <imgui.h>
 #include <backends/imgui_impl_sdl3.h>
 
 #include "command.hpp"
+#include "audio_render.hpp"
+#include "benchmark.hpp"
 
 #include "../../game/scenes/levels/00_Playground.hpp"
+#include "../../game/scenes/test_ground_scn.hpp"
 
 namespace lum
 {
     std::unique_ptr<Engine> Engine::m_instance = nullptr;
 
+    // Every scene --scene can start. A loopback session makes a second one of
+    // the same kind for the peer.
+    struct SceneFactory
+    {
+        const char *tag;
+        std::shared_ptr<Scene> (*make)();
+    };
+
+    template<typename T>
+    static std::shared_ptr<Scene> MakeScene()
+    {
+        return std::make_shared<T>();
+    }
+
+    static const SceneFactory SCENE_FACTORIES[] = {
+        { "playground_lvl", MakeScene<shmup::PlaygroundLvl> },
+        { "test_ground", MakeScene<shmup::TestGroundScn> },
+    };
+
+    static const SceneFactory *FindSceneFactory(const char *p_tag)
+    {
+        for (const SceneFactory &factory : SCENE_FACTORIES)
+        {
+            if (SDL_strcmp(factory.tag, p_tag) == 0)
+                return &factory;
+        }
+
+        return nullptr;
+    }
+
     Engine::Engine() = default;
 
     Engine::~Engine() = default;
@@ -27,32 +61,120 @@ namespace lum
         return *m_instance;
     }
 
+    EngineConfig Engine::ParseArgs(int p_argc, char **p_argv)
+    {
+        EngineConfig engineConfig{};
+        bool sceneGiven = false;
+
+        for (int i = 1; i < p_argc; i++)
+        {
+            if (SDL_strcmp(p_argv[i], "--headless") == 0)
+                engineConfig.headless = true;
+            else if (SDL_strcmp(p_argv[i], "--profile-startup") == 0)
+                engineConfig.profileStartup = true;
+            else if (SDL_strcmp(p_argv[i], "--exit-after-startup") == 0)
+                engineConfig.exitAfterStartup = true;
+            else if (SDL_strcmp(p_argv[i], "--record") == 0 && i + 1 < p_argc)
+                engineConfig.recordPath = p_argv[++i];
+            else if (SDL_strcmp(p_argv[i], "--replay") == 0 && i + 1 < p_argc)
+                engineConfig.replayPath = p_argv[++i];
+            else if (SDL_strcmp(p_argv[i], "--bench-out") == 0 && i + 1 < p_argc)
+                engineConfig.benchOutPath = p_argv[++i];
+            else if (SDL_strcmp(p_argv[i], "--bench") == 0 && i + 1 < p_argc)
+                engineConfig.benchmark = p_argv[++i];
+            else if (SDL_strcmp(p_argv[i], "--no-render") == 0)
+                engineConfig.noRender = true;
+            else if (SDL_strcmp(p_argv[i], "--snapshots") == 0)
+                engineConfig.snapshots = true;
+            else if (SDL_strcmp(p_argv[i], "--loopback") == 0)
+                engineConfig.loopback = true;
+            else if (SDL_strcmp(p_argv[i], "--net-latency") == 0 && i + 1 < p_argc)
+                engineConfig.netLatencyMS = static_cast<float>(SDL_atof(p_argv[++i]));
+            else if (SDL_strcmp(p_argv[i], "--net-jitter") == 0 && i + 1 < p_argc)
+                engineConfig.netJitterMS = static_cast<float>(SDL_atof(p_argv[++i]));
+            else if (SDL_strcmp(p_argv[i], "--net-loss") == 0 && i + 1 < p_argc)
+                engineConfig.netLoss = static_cast<float>(SDL_atof(p_argv[++i]));
+            else if (SDL_strcmp(p_argv[i], "--input-delay") == 0 && i + 1 < p_argc)
+                engineConfig.inputDelay = static_cast<uint32_t>(SDL_atoi(p_argv[++i]));
+            else if (SDL_strcmp(p_argv[i], "--scene") == 0 && i + 1 < p_argc)
+            {
+                engineConfig.scene = p_argv[++i];
+                sceneGiven = true;
+            }
+            else if (SDL_strcmp(p_argv[i], "--tick-rate") == 0 && i + 1 < p_argc)
+                engineConfig.tickRate = static_cast<float>(SDL_atof(p_argv[++i]));
+            else if (SDL_strcmp(p_argv[i], "--trace") == 0 && i + 1 < p_argc)
+                engineConfig.tracePath = p_argv[++i];
+            else if (SDL_strcmp(p_argv[i], "--audio-render") == 0 && i + 1 < p_argc)
+                engineConfig.audioScript = p_argv[++i];
+            else if (SDL_strcmp(p_argv[i], "--audio-out") == 0 && i + 1 < p_argc)
+                engineConfig.audioOutPath = p_argv[++i];
+            else if (SDL_strcmp(p_argv[i], "--audio-reference") == 0 && i + 1 < p_argc)
+                engineConfig.audioReferencePath = p_argv[++i];
+            else if (SDL_strcmp(p_argv[i], "--audio-tolerance") == 0 && i + 1 < p_argc)
+                engineConfig.audioTolerance = static_cast<float>(SDL_atof(p_argv[++i]));
+            else
+                SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Ignoring unknown argument: %s", p_argv[i]);
+        }
+
+        // The playground reads no player input, there would be nothing to roll back
+
+        if (engineConfig.loopback && !sceneGiven)
+            engineConfig.scene = "test_ground";
+
+        return engineConfig;
+    }
+
     bool Engine::Init()
     {
+        if (config.profileStartup)
+            profiler.BeginCapture();
+
         // Init engine modules
 
-        if (!assetManager.Init())
         {
-            SDL_Log("Failed to initialized asset manager");
-            return false;
+            ProfileScope scope(ProfilePhase::INIT, "JobSystem");
+            if (!jobSystem.Init())
+            {
+                SDL_Log("Failed to initialized job system");
+                return false;
+            }
         }
 
-        if (!renderer.Init())
         {
-            SDL_Log("Failed to initilized renderer");
-            return false;
+            ProfileScope scope(ProfilePhase::INIT, "AssetManager");
+            if (!assetManager.Init())
+            {
+                SDL_Log("Failed to initialized asset manager");
+                return false;
+            }
         }
 
-        if (!audioManager.Init())
         {
-            SDL_Log("Failed to initilized audio manager");
-            return false;
+            ProfileScope scope(ProfilePhase::INIT, "Renderer");
+            if (!renderer.Init())
+            {
+                SDL_Log("Failed to initilized renderer");
+                return false;
+            }
         }
 
-        if (!sceneManager.Init())
         {
-            SDL_Log("Failed to initialized scene manager");
-            return false;
+            ProfileScope scope(ProfilePhase::INIT, "AudioManager");
+            if (!audioManager.Init())
+            {
+                SDL_Log("Failed to initilized audio manager");
+                return false;
+            }
+        }
+
+        {
+            ProfileScope scope(ProfilePhase::INIT, "SceneManager");
+            if (!sceneManager.Init())
+            {
+                SDL_Log("Failed to initialized scene manager");
+                return false;
+            }
         }
 
         // TEMPORAL!!!
@@ -60,23 +182,113 @@ namespace lum
         // Been thinking of having the registry of autoloads and scenes via a 
         // 'config' file instead of doing it from code.
 
-        sceneManager.RegisterScene("playground_lvl", std::make_shared<shmup::PlaygroundLvl>(), true);
+        // Seed before the first scene sets up, a replay starts from the recorded state
+
+        fixedDeltaTime = 1.0f / SDL_max(config.tickRate, 1.0f);
+
+        if (config.replayPath)
+        {
+            if (!m_input.LoadReplay(config.replayPath))
+                return false;
+
+            fixedDeltaTime = 1.0f / SDL_max(m_input.GetTickRate(), 1.0f);
+            m_randomState = m_input.GetSeed();
+            SDL_srand(m_input.GetSeed());
+        }
+        else if (config.recordPath)
+        {
+            const uint64_t seed = SDL_GetPerformanceCounter();
+
+            m_input.StartRecording(config.recordPath, 1.0f / fixedDeltaTime, seed);
+            m_randomState = seed;
+            SDL_srand(seed);
+        }
+
+        for (const SceneFactory &factory : SCENE_FACTORIES)
+            sceneManager.RegisterScene(factory.tag, factory.make());
+
+        // Rollback rewrites ticks a recording already has, they don't mix
+
+        const bool loopback = config.loopback && !config.recordPath && !config.replayPath;
+        if (config.loopback && !loopback)
+            SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Engine: --loopback is ignored while recording or replaying");
+
+        // The peer's scene sets up first, from the same state the local one will
+
+        if (loopback && !CreatePeerScene())
+            return false;
+
+        if (!sceneManager.ChangeSceneTo(config.scene))
+        {
+            SDL_Log("Failed to start scene %s", config.scene);
+            return false;
+        }
+
+        if (loopback)
+            StartLoopbackSession();
 
         lastTime = SDL_GetPerformanceCounter();
 
         SDL_Log("Engine initialized");
 
+        if (config.profileStartup)
+        {
+            profiler.EndCapture();
+            profiler.LogReport();
+            profiler.WriteTrace(config.tracePath);
+        }
+
         return true;
     }
 
+    bool Engine::RunAudioRender()
+    {
+        // Only the asset manager and an offline mixer, no window, GPU or device
+
+        AudioRender audioRender{};
+        if (!audioRender.LoadScript(config.audioScript))
+            return false;
+
+        if (!assetManager.Init())
+        {
+            SDL_Log("Failed to initialized asset manager");
+            return false;
+        }
+
+        bool result = audioManager.InitOffline(audioRender.GetSpec());
+        if (result)
+            result = audioRender.Run(config.audioOutPath, config.audioReferencePath, config.audioTolerance);
+
+        assetManager.Shutdown();
+        audioManager.Shutdown();
+
+        return result;
+    }
+
+    bool Engine::RunBenchmark()
+    {
+        // Nothing but the system being timed, no window, GPU, device or assets
+
+        Benchmark benchmark{};
+        return benchmark.Run(config.benchmark, config.benchOutPath);
+    }
+
     void Engine::Shutdown()
     {
         SDL_Log("Engine shutdown called");
 
+        if (m_input.IsRecording())
+            m_input.StopRecording(tick);
+
+        session.Stop();
+        m_peer.Stop();
+        m_peerScene.reset();
+
         sceneManager.Shutdown();
         assetManager.Shutdown();
         audioManager.Shutdown();
         renderer.Shutdown();
+        jobSystem.Shutdown();
     }
 
     void Engine::Input(SDL_Event *p_event)
@@ -112,17 +324,124 @@ namespace lum
 
     void Engine::Update()
     {
+        BeginFrame();
+
         auto start = SDL_GetTicksNS();
 
         assetManager.CheckForModifiedAssets();
+        assetManager.EvictUnused();
+        audioManager.Update();
+
+        // A stopped clock is a paused game, the audio follows along
+        audioManager.SetPaused(timeScalar <= 0.0f);
 
         currentTime = SDL_GetPerformanceCounter();
         deltaTime = static_cast<float>(currentTime - lastTime) / SDL_GetPerformanceFrequency();
         lastTime = currentTime;
 
         metricsWindows.StatsUpdate(deltaTime);
+        metricsWindows.assetStats = assetManager.GetMemoryStats();
+        metricsWindows.audioStats = audioManager.GetMixerStats();
+
+        metricsWindows.poolStats.clear();
+        for (const PoolAllocator *pool : PoolAllocator::GetAll())
+            metricsWindows.poolStats.push_back(pool->GetStats());
+
+        // Time scale applies to how much simulated time piles up, every tick
+        // still steps by the same amount so results don't depend on frame rate
+
+        scaledDeltaTime = deltaTime * SDL_max(timeScalar, 0.0f);
+        accumulator += scaledDeltaTime;
+
+        // A replay runs one tick per frame as fast as the loop goes, wall time
+        // doesn't matter, only the recorded tick count does
+
+        const bool replaying = m_input.IsReplaying();
+        if (replaying)
+        {
+            accumulator = m_input.IsReplayFinished(tick) ? 0.0f : fixedDeltaTime;
+
+            if (m_replayStartNS == 0)
+                m_replayStartNS = SDL_GetTicksNS();
+        }
+
+        uint32_t ticks = 0;
+        while (accumulator >= fixedDeltaTime && ticks < MAX_TICKS_PER_FRAME)
+        {
+            const uint64_t tickStart = SDL_GetTicksNS();
+
+            InputEvent event{};
+            while (replaying && m_input.PollCommand(tick, event))
+            {
+                const CommandType type = event.type == InputEventType::COMMAND_START ? CommandType::START : CommandType::END;
+                DispatchCommand(static_cast<SDL_Scancode>(event.value), type);
+            }
+
+            // Rewinding restores the tick and time with the rest of the world
+
+            if (session.IsRunning())
+            {
+                if (m_peer.IsRunning())
+                    m_peer.AdvanceTick(NextPeerInput());
+
+                session.AdvanceTick(sceneManager.currentScene->GetLocalInput());
+
+                accumulator -= fixedDeltaTime;
+                ticks++;
+                continue;
+            }
+
+            if (rewinding && !replaying && !m_input.IsRecording())
+            {
+                if (snapshots.GetCount() > 1)
+                    RestoreSnapshot(1, true);
+
+                accumulator -= fixedDeltaTime;
+                ticks++;
+                continue;
+            }
+
+            sceneManager.currentScene->playerInput[0] = sceneManager.currentScene->GetLocalInput();
+            sceneManager.currentScene->Update(fixedDeltaTime);
+            sceneManager.currentScene->transforms.Update();
+
+            if (replaying)
+            {
+                const uint64_t tickNS = SDL_GetTicksNS() - tickStart;
+                m_replayTickNS += tickNS;
+                m_replayWorstTickNS = SDL_max(m_replayWorstTickNS, tickNS);
+            }
+
+            accumulator -= fixedDeltaTime;
+            engineTime += fixedDeltaTime;
+            tick++;
+            ticks++;
+
+            if (config.snapshots)
+                SaveSnapshot();
+        }
+
+        // Too far behind to catch up, keep the partial tick and let the rest go
+
+        uint32_t droppedTicks = 0;
+        if (accumulator >= fixedDeltaTime)
+        {
+            droppedTicks = static_cast<uint32_t>(accumulator / fixedDeltaTime);
+            accumulator -= static_cast<float>(droppedTicks) * fixedDeltaTime;
+        }
+
+        interpolation = accumulator / fixedDeltaTime;
 
-        sceneManager.currentScene->Update(deltaTime);
+        metricsWindows.ticks = ticks;
+        metricsWindows.droppedTicks += droppedTicks;
+        metricsWindows.tickRate = 1.0f / fixedDeltaTime;
+        metricsWindows.interpolation = interpolation;
+
+        if (replaying && m_input.IsReplayFinished(tick) && !quitRequested)
+        {
+            FinishReplay();
+            quitRequested = true;
+        }
 
         auto end = SDL_GetTicksNS();
         metricsWindows.updateFrameTime = static_cast<float>(end - start) / SDL_NS_PER_MS;
@@ -130,6 +449,12 @@ namespace lum
 
     bool Engine::Render()
     {
+        if (config.noRender)
+        {
+            EndFrame();
+            return true;
+        }
+
         auto start = SDL_GetTicksNS();
 
         renderer.PreRender();
@@ -138,6 +463,8 @@ namespace lum
             sceneManager.currentScene->Draw();
 
         metricsWindows.ShowStatsWindows(deltaTime);
+        metricsWindows.ShowEngineControls(&timeScalar, config.snapshots && !session.IsRunning() ? &rewinding : nullptr);
+        metricsWindows.ShowShaderCompileErrors(assetManager.GetShaderCompileErrors());
 
         if (!renderer.RenderFrame())
             return false;
@@ -145,18 +472,344 @@ namespace lum
         auto end = SDL_GetTicksNS();
         metricsWindows.renderFrameTime = static_cast<float>(end - start) / SDL_NS_PER_MS;
 
+        EndFrame();
+
         return true;
     }
 
+    void Engine::BeginFrame()
+    {
+        FrameArena::BeginFrame();
+        session.BeginFrame();
+
+        // Loading and first frames of a scene are allowed to allocate, only the
+        // frames after that count as steady state
+
+        if (sceneManager.currentScene.get() != m_steadyScene)
+        {
+            m_steadyScene = sceneManager.currentScene.get();
+            m_steadyFrames = 0;
+        }
+
+        heap::BeginTracking();
+    }
+
+    void Engine::EndFrame()
+    {
+        const uint32_t allocations = heap::EndTracking();
+
+        metricsWindows.arenaStats = FrameArena::Get().GetStats();
+        metricsWindows.frameHeapAllocations = allocations;
+        metricsWindows.jobWorkers = jobSystem.GetWorkerCount();
+        jobSystem.CollectTimings(metricsWindows.jobTimings);
+
+        if (sceneManager.currentScene)
+        {
+            metricsWindows.collisionStats = sceneManager.currentScene->collision.GetStats();
+            metricsWindows.projectileStats = sceneManager.currentScene->projectiles.GetStats();
+            metricsWindows.transformStats = sceneManager.currentScene->transforms.GetStats();
+            metricsWindows.snapshotStats = snapshots.GetStats();
+            metricsWindows.rollbackStats = session.GetStats();
+            metricsWindows.networked = session.IsRunning();
+        }
+
+        if (m_steadyFrames < HEAP_CHECK_WARMUP_FRAMES)
+        {
+            m_steadyFrames++;
+            return;
+        }
+
+        // At most one warning a second, a leak in the loop would flood the log otherwise
+
+        const uint64_t now = SDL_GetTicks();
+        if (allocations > 0 && now - m_lastHeapWarning >= 1000)
+        {
+            SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Engine: %u heap allocations in a steady state frame", allocations);
+            m_lastHeapWarning = now;
+        }
+    }
+
     void Engine::HandleCommands(SDL_EventType p_type, SDL_Scancode p_scancode)
+    {
+        // A replay is the only input while it runs
+
+        if (m_input.IsReplaying())
+            return;
+
+        CommandType type = (p_type == SDL_EVENT_KEY_DOWN) ? CommandType::START : CommandType::END;
+
+        DispatchCommand(p_scancode, type);
+    }
+
+    void Engine::SeedRandom(uint64_t p_seed)
+    {
+        uint64_t seed = p_seed;
+
+        if (m_input.IsReplaying() && !m_input.PollSeed(seed))
+            SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Engine: Replay has no seed left, it has diverged from the recording");
+
+        m_input.Record(tick, InputEventType::SEED, seed);
+
+        m_randomState = seed;
+        SDL_srand(seed);
+    }
+
+    Sint32 Engine::Random(Sint32 p_n)
+    {
+        return SDL_rand_r(&m_randomState, p_n);
+    }
+
+    float Engine::RandomFloat()
+    {
+        return SDL_randf_r(&m_randomState);
+    }
+
+    void Engine::StartLoopbackSession()
+    {
+        LoopbackConditions conditions{};
+        conditions.latencyMS = SDL_max(config.netLatencyMS, 0.0f);
+        conditions.jitterMS = SDL_max(config.netJitterMS, 0.0f);
+        conditions.loss = SDL_clamp(config.netLoss, 0.0f, 1.0f);
+
+        // Network randomness has its own seeds, the simulation never sees it
+
+        const uint64_t seed = SDL_GetPerformanceCounter();
+
+        LoopbackTransport::Connect(m_localLink, m_peerLink);
+        m_localLink.SetConditions(conditions, seed);
+        m_peerLink.SetConditions(conditions, seed ^ 0x9E3779B97F4A7C15ull);
+        m_peerRandom = seed;
+
+        RollbackCallbacks callbacks{};
+        callbacks.save = [this]() { SaveSnapshot(); };
+        callbacks.load = [this](uint64_t p_tick)
+        {
+            uint32_t age{};
+            return snapshots.FindAge(p_tick, age) && RestoreSnapshot(age, true);
+        };
+        callbacks.advance = [this](const InputBits *p_inputs) { AdvanceWorld(*sceneManager.currentScene, p_inputs); };
+        callbacks.checksum = [this](uint64_t p_tick, uint64_t &p_outChecksum) { return HashWorld(snapshots, p_tick, p_outChecksum); };
+
+        RollbackCallbacks peerCallbacks{};
+        peerCallbacks.save = [this]()
+        {
+            SwapPeerWorld();
+            SaveWorld(*m_peerSnapshots, *m_peerScene);
+            SwapPeerWorld();
+        };
+        peerCallbacks.load = [this](uint64_t p_tick)
+        {
+            uint32_t age{};
+            SnapshotReader reader{};
+            if (!m_peerSnapshots->FindAge(p_tick, age) || !m_peerSnapshots->Rewind(age, reader))
+                return false;
+
+            SwapPeerWorld();
+            const bool loaded = LoadWorld(reader, *m_peerScene);
+            SwapPeerWorld();
+
+            return loaded;
+        };
+        peerCallbacks.advance = [this](const InputBits *p_inputs)
+        {
+            SwapPeerWorld();
+            AdvanceWorld(*m_peerScene, p_inputs);
+            SwapPeerWorld();
+        };
+        peerCallbacks.checksum = [this](uint64_t p_tick, uint64_t &p_outChecksum) { return HashWorld(*m_peerSnapshots, p_tick, p_outChecksum); };
+
+        session.Start(m_localLink, 0, tick, config.inputDelay, callbacks);
+        m_peer.Start(m_peerLink, 1, tick, config.inputDelay, peerCallbacks);
+
+        SDL_Log("Engine: Loopback session, %.0f ms latency, %.0f ms jitter, %.0f%% loss", conditions.latencyMS,
+            conditions.jitterMS, conditions.loss * 100.0f);
+    }
+
+    InputBits Engine::NextPeerInput()
+    {
+        // Holds a random mix of the first few commands for a while, like someone steering
+
+        if (m_peerHold == 0)
+        {
+            m_peerInput = static_cast<InputBits>(SDL_rand_r(&m_peerRandom, 16));
+            m_peerHold = 10 + static_cast<uint32_t>(SDL_rand_r(&m_peerRandom, 30));
+        }
+
+        m_peerHold--;
+
+        return m_peerInput;
+    }
+
+    bool Engine::CreatePeerScene()
+    {
+        const SceneFactory *factory = FindSceneFactory(config.scene);
+        if (!factory)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Engine: No scene %s for the loopback peer", config.scene);
+            return false;
+        }
+
+        // Nothing draws it, so it goes without assets
+
+        m_peerScene = factory->make();
+        m_peerSnapshots = std::make_unique<SnapshotRing>();
+
+        m_peerTick = tick;
+        m_peerTime = engineTime;
+        m_peerRandomState = m_randomState;
+
+        SwapPeerWorld();
+        m_peerScene->Setup();
+        m_peerScene->loaded = true;
+        SwapPeerWorld();
+
+        return true;
+    }
+
+    void Engine::SwapPeerWorld()
+    {
+        std::swap(tick, m_peerTick);
+        std::swap(engineTime, m_peerTime);
+        std::swap(m_randomState, m_peerRandomState);
+    }
+
+    void Engine::SaveWorld(SnapshotRing &p_ring, const Scene &p_scene)
+    {
+        SnapshotWriter writer = p_ring.BeginSave();
+        writer.WriteValue(tick);
+        writer.WriteValue(engineTime);
+        writer.WriteValue(m_randomState);
+        p_scene.SaveState(writer);
+
+        p_ring.Commit(tick);
+    }
+
+    bool Engine::LoadWorld(SnapshotReader &p_reader, Scene &p_scene)
+    {
+        return p_reader.ReadValue(tick) && p_reader.ReadValue(engineTime) && p_reader.ReadValue(m_randomState) && p_scene.LoadState(p_reader);
+    }
+
+    void Engine::AdvanceWorld(Scene &p_scene, const InputBits *p_inputs)
+    {
+        for (uint32_t player = 0; player < MAX_PLAYERS; player++)
+            p_scene.playerInput[player] = p_inputs[player];
+
+        p_scene.Update(fixedDeltaTime);
+        p_scene.transforms.Update();
+
+        engineTime += fixedDeltaTime;
+        tick++;
+    }
+
+    bool Engine::HashWorld(SnapshotRing &p_ring, uint64_t p_tick, uint64_t &p_outChecksum)
+    {
+        uint32_t age{};
+        SnapshotReader reader{};
+        if (!p_ring.FindAge(p_tick, age) || !p_ring.Get(age, reader))
+            return false;
+
+        const size_t size = reader.GetRemaining();
+        p_outChecksum = utils::HashBytes64(reader.Take(size), size);
+
+        return true;
+    }
+
+    void Engine::SaveSnapshot()
+    {
+        const Scene *scene = sceneManager.currentScene.get();
+        if (!scene)
+            return;
+
+        // Another scene's snapshots can't be loaded into this one
+
+        if (scene != m_snapshotScene)
+        {
+            snapshots.Clear();
+            m_snapshotScene = scene;
+        }
+
+        const uint64_t start = SDL_GetTicksNS();
+
+        SaveWorld(snapshots, *scene);
+
+        snapshots.SetSaveTime(static_cast<float>(SDL_GetTicksNS() - start) / SDL_NS_PER_MS);
+    }
+
+    bool Engine::RestoreSnapshot(uint32_t p_age, bool p_discardNewer)
+    {
+        Scene *scene = sceneManager.currentScene.get();
+        if (!scene || scene != m_snapshotScene)
+            return false;
+
+        const uint64_t start = SDL_GetTicksNS();
+
+        SnapshotReader reader{};
+        if (!(p_discardNewer ? snapshots.Rewind(p_age, reader) : snapshots.Get(p_age, reader)))
+            return false;
+
+        const bool loaded = LoadWorld(reader, *scene);
+
+        snapshots.SetRestoreTime(static_cast<float>(SDL_GetTicksNS() - start) / SDL_NS_PER_MS);
+
+        if (!loaded)
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Engine: Failed to restore the snapshot %u back", p_age);
+
+        return loaded;
+    }
+
+    void Engine::DispatchCommand(SDL_Scancode p_scancode, CommandType p_type)
     {
         // Check if current scene has an action mapped to this scancode/keybind
 
         if (sceneManager.currentScene->commandMap.find(p_scancode) == sceneManager.currentScene->commandMap.end())
             return;
 
-        CommandType type = (p_type == SDL_EVENT_KEY_DOWN) ? CommandType::START : CommandType::END;
+        // Lands before the next tick runs, the replay applies it at the same one
+
+        m_input.Record(tick, p_type == CommandType::START ? InputEventType::COMMAND_START : InputEventType::COMMAND_END, p_scancode);
+
+        sceneManager.currentScene->DoCommand(Command{ sceneManager.currentScene->commandMap.at(p_scancode), p_type });
+    }
+
+    void Engine::FinishReplay()
+    {
+        const float wallMS = static_cast<float>(SDL_GetTicksNS() - m_replayStartNS) / SDL_NS_PER_MS;
+        const float tickMS = static_cast<float>(m_replayTickNS) / SDL_NS_PER_MS;
+        const float worstMS = static_cast<float>(m_replayWorstTickNS) / SDL_NS_PER_MS;
+        const uint64_t length = SDL_max(m_input.GetLength(), static_cast<uint64_t>(1));
+
+        SDL_Log("Replay: %llu ticks in %.1f ms, simulation %.1f ms (%.3f ms per tick, worst %.3f ms)",
+            static_cast<unsigned long long>(m_input.GetLength()), wallMS, tickMS, tickMS / length, worstMS);
+
+        std::vector<JobTiming> timings{};
+        sceneManager.currentScene->systems.GetTimings(timings);
+
+        for (const auto &timing : timings)
+        {
+            SDL_Log("Replay:   %-24s %6u runs %9.3f ms (%.4f ms avg, max %.3f ms)", timing.name, timing.count, timing.totalMS,
+                timing.count ? timing.totalMS / timing.count : 0.0f, timing.maxMS);
+        }
+
+        if (!config.benchOutPath)
+            return;
+
+        SDL_IOStream *file = SDL_IOFromFile(config.benchOutPath, "w");
+        if (!file)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Replay: Failed to open %s: %s", config.benchOutPath, SDL_GetError());
+            return;
+        }
+
+        SDL_IOprintf(file, "name,runs,total_ms,avg_ms,max_ms\n");
+        SDL_IOprintf(file, "tick,%llu,%.4f,%.4f,%.4f\n", static_cast<unsigned long long>(m_input.GetLength()), tickMS, tickMS / length, worstMS);
+
+        for (const auto &timing : timings)
+        {
+            SDL_IOprintf(file, "%s,%u,%.4f,%.4f,%.4f\n", timing.name, timing.count, timing.totalMS,
+                timing.count ? timing.totalMS / timing.count : 0.0f, timing.maxMS);
+        }
 
-        sceneManager.currentScene->DoCommand(Command{ sceneManager.currentScene->commandMap.at(p_scancode), type });
+        if (!SDL_CloseIO(file))
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Replay: Failed to write %s: %s", config.benchOutPath, SDL_GetError());
     }
 }
\ No newline at end of file
@@ -0,0 +1,248 @@
+#include "frame_arena.hpp"
+
+#include <atomic>
+#include <cstdarg>
+#include <cstdlib>
+#include <new>
+
+namespace lum
+{
+    static std::atomic<uint64_t> s_frameIndex{ 1 };
+
+    FrameArena::FrameArena(size_t p_capacity) : m_capacity(p_capacity)
+    {
+        m_block = static_cast<uint8_t *>(SDL_aligned_alloc(alignof(std::max_align_t), m_capacity));
+        if (!m_block)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "FrameArena: Failed to allocate %zu bytes", m_capacity);
+            m_capacity = 0;
+        }
+    }
+
+    FrameArena::~FrameArena()
+    {
+        Reset();
+        SDL_aligned_free(m_block);
+    }
+
+    void *FrameArena::Allocate(size_t p_size, size_t p_alignment)
+    {
+        const size_t start = (m_offset + p_alignment - 1) & ~(p_alignment - 1);
+
+        if (start + p_size <= m_capacity)
+        {
+            m_offset = start + p_size;
+            return m_block + start;
+        }
+
+        // Out of space, keep counting so the next reset knows how big the block
+        // has to be and serve this one from the heap
+
+        m_offset = start + p_size;
+        m_overflowBytes += p_size;
+
+        void *ptr = SDL_aligned_alloc(SDL_max(p_alignment, alignof(std::max_align_t)), p_size);
+        m_overflow.push_back(ptr);
+
+        return ptr;
+    }
+
+    const char *FrameArena::Format(const char *p_fmt, ...)
+    {
+        va_list args;
+
+        va_start(args, p_fmt);
+        const int length = SDL_vsnprintf(nullptr, 0, p_fmt, args);
+        va_end(args);
+
+        if (length < 0)
+            return "";
+
+        char *buffer = AllocateArray<char>(length + 1);
+
+        va_start(args, p_fmt);
+        SDL_vsnprintf(buffer, length + 1, p_fmt, args);
+        va_end(args);
+
+        return buffer;
+    }
+
+    void FrameArena::Reset()
+    {
+        m_lastFrameUsed = m_offset;
+        m_peak = SDL_max(m_peak, m_offset);
+
+        if (!m_overflow.empty())
+        {
+            for (void *ptr : m_overflow)
+                SDL_aligned_free(ptr);
+
+            m_overflow.clear();
+
+            // Grow to the next power of two over the peak so the same load fits next frame
+
+            size_t capacity = m_capacity ? m_capacity : DEFAULT_CAPACITY;
+            while (capacity < m_peak)
+                capacity *= 2;
+
+            SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "FrameArena: Overflowed by %zu bytes, growing from %zu to %zu bytes",
+                m_overflowBytes, m_capacity, capacity);
+
+            SDL_aligned_free(m_block);
+            m_block = static_cast<uint8_t *>(SDL_aligned_alloc(alignof(std::max_align_t), capacity));
+            m_capacity = m_block ? capacity : 0;
+        }
+
+        m_offset = 0;
+        m_overflowBytes = 0;
+    }
+
+    FrameArenaStats FrameArena::GetStats() const
+    {
+        FrameArenaStats stats{};
+        stats.capacity = m_capacity;
+        stats.used = m_offset;
+        stats.lastFrameUsed = m_lastFrameUsed;
+        stats.peak = m_peak;
+        stats.overflowBytes = m_overflowBytes;
+
+        return stats;
+    }
+
+    FrameArena &FrameArena::Get()
+    {
+        thread_local FrameArena arena{};
+
+        const uint64_t frame = s_frameIndex.load(std::memory_order_acquire);
+        if (arena.m_frame != frame)
+        {
+            arena.Reset();
+            arena.m_frame = frame;
+        }
+
+        return arena;
+    }
+
+    void FrameArena::BeginFrame()
+    {
+        s_frameIndex.fetch_add(1, std::memory_order_release);
+    }
+
+    // HEAP TRACKING
+    //
+
+#ifdef LUM_TRACK_HEAP
+    static thread_local bool t_trackHeap{};
+    static thread_local uint32_t t_heapAllocations{};
+
+    namespace heap
+    {
+        void BeginTracking()
+        {
+            t_heapAllocations = 0;
+            t_trackHeap = true;
+        }
+
+        uint32_t EndTracking()
+        {
+            t_trackHeap = false;
+            return t_heapAllocations;
+        }
+
+        static void *TrackedAlloc(size_t p_size)
+        {
+            if (t_trackHeap)
+                t_heapAllocations++;
+
+            return std::malloc(p_size ? p_size : 1);
+        }
+
+        // SDL's own functions do the work, anything allocated before the swap
+        // is still freed by the same allocator
+
+        static SDL_malloc_func s_sdlMalloc{};
+        static SDL_calloc_func s_sdlCalloc{};
+        static SDL_realloc_func s_sdlRealloc{};
+        static SDL_free_func s_sdlFree{};
+
+        static void *SDLCALL TrackedSDLMalloc(size_t p_size)
+        {
+            if (t_trackHeap)
+                t_heapAllocations++;
+
+            return s_sdlMalloc(p_size);
+        }
+
+        static void *SDLCALL TrackedSDLCalloc(size_t p_count, size_t p_size)
+        {
+            if (t_trackHeap)
+                t_heapAllocations++;
+
+            return s_sdlCalloc(p_count, p_size);
+        }
+
+        static void *SDLCALL TrackedSDLRealloc(void *p_ptr, size_t p_size)
+        {
+            if (t_trackHeap)
+                t_heapAllocations++;
+
+            return s_sdlRealloc(p_ptr, p_size);
+        }
+
+        void TrackSDLAllocations()
+        {
+            if (s_sdlMalloc)
+                return;
+
+            SDL_GetOriginalMemoryFunctions(&s_sdlMalloc, &s_sdlCalloc, &s_sdlRealloc, &s_sdlFree);
+
+            if (!SDL_SetMemoryFunctions(TrackedSDLMalloc, TrackedSDLCalloc, TrackedSDLRealloc, s_sdlFree))
+                SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "FrameArena: SDL allocations won't be tracked: %s", SDL_GetError());
+        }
+    }
+#else
+    namespace heap
+    {
+        void TrackSDLAllocations() {}
+        void BeginTracking() {}
+        uint32_t EndTracking() { return 0; }
+    }
+#endif
+}
+
+#ifdef LUM_TRACK_HEAP
+
+// Replaces the plain global new/delete pairs, the aligned overloads are left to
+// the standard library and still pair up with its own deletes
+
+void *operator new(size_t p_size)
+{
+    if (void *ptr = lum::heap::TrackedAlloc(p_size))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t p_size)
+{
+    return operator new(p_size);
+}
+
+void *operator new(size_t p_size, const std::nothrow_t &) noexcept
+{
+    return lum::heap::TrackedAlloc(p_size);
+}
+
+void *operator new[](size_t p_size, const std::nothrow_t &) noexcept
+{
+    return lum::heap::TrackedAlloc(p_size);
+}
+
+void operator delete(void *p_ptr) noexcept { std::free(p_ptr); }
+void operator delete[](void *p_ptr) noexcept { std::free(p_ptr); }
+void operator delete(void *p_ptr, size_t) noexcept { std::free(p_ptr); }
+void operator delete[](void *p_ptr, size_t) noexcept { std::free(p_ptr); }
+void operator delete(void *p_ptr, const std::nothrow_t &) noexcept { std::free(p_ptr); }
+void operator delete[](void *p_ptr, const std::nothrow_t &) noexcept { std::free(p_ptr); }
+
+#endif // LUM_TRACK_HEAP
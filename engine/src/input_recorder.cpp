@@ -0,0 +1,229 @@
+#include "input_recorder.hpp"
+
+#include <cstring>
+
+namespace lum
+{
+    static void WriteVarint(std::vector<uint8_t> &p_out, uint64_t p_value)
+    {
+        while (p_value >= 0x80)
+        {
+            p_out.push_back(static_cast<uint8_t>(p_value) | 0x80);
+            p_value >>= 7;
+        }
+
+        p_out.push_back(static_cast<uint8_t>(p_value));
+    }
+
+    static void WriteLE(std::vector<uint8_t> &p_out, uint64_t p_value, size_t p_bytes)
+    {
+        for (size_t i = 0; i < p_bytes; i++)
+            p_out.push_back(static_cast<uint8_t>(p_value >> (i * 8)));
+    }
+
+    static bool ReadVarint(const uint8_t *&p_cursor, const uint8_t *p_end, uint64_t &p_outValue)
+    {
+        p_outValue = 0;
+
+        for (uint32_t shift = 0; shift < 64 && p_cursor < p_end; shift += 7)
+        {
+            const uint8_t byte = *p_cursor++;
+            p_outValue |= static_cast<uint64_t>(byte & 0x7F) << shift;
+
+            if (!(byte & 0x80))
+                return true;
+        }
+
+        return false;
+    }
+
+    static bool ReadLE(const uint8_t *&p_cursor, const uint8_t *p_end, size_t p_bytes, uint64_t &p_outValue)
+    {
+        if (static_cast<size_t>(p_end - p_cursor) < p_bytes)
+            return false;
+
+        p_outValue = 0;
+        for (size_t i = 0; i < p_bytes; i++)
+            p_outValue |= static_cast<uint64_t>(*p_cursor++) << (i * 8);
+
+        return true;
+    }
+
+    InputRecorder::InputRecorder() = default;
+
+    InputRecorder::~InputRecorder() = default;
+
+    void InputRecorder::StartRecording(const char *p_path, float p_tickRate, uint64_t p_seed)
+    {
+        m_recordPath = p_path;
+        m_replaying = false;
+        m_tickRate = p_tickRate;
+        m_seed = p_seed;
+        m_events.clear();
+
+        SDL_Log("InputRecorder: Recording to %s (seed %llu)", p_path, static_cast<unsigned long long>(p_seed));
+    }
+
+    void InputRecorder::Record(uint64_t p_tick, InputEventType p_type, uint64_t p_value)
+    {
+        if (m_recordPath)
+            m_events.push_back(InputEvent{ p_tick, p_type, p_value });
+    }
+
+    bool InputRecorder::StopRecording(uint64_t p_length)
+    {
+        if (!m_recordPath)
+            return false;
+
+        const char *path = m_recordPath;
+        m_recordPath = nullptr;
+
+        uint32_t tickRateBits{};
+        std::memcpy(&tickRateBits, &m_tickRate, sizeof(tickRateBits));
+
+        std::vector<uint8_t> data{};
+        data.reserve(32 + m_events.size() * 4);
+
+        WriteLE(data, MAGIC, 4);
+        WriteLE(data, VERSION, 2);
+        WriteLE(data, tickRateBits, 4);
+        WriteLE(data, m_seed, 8);
+        WriteLE(data, p_length, 8);
+        WriteLE(data, m_events.size(), 4);
+
+        uint64_t lastTick = 0;
+        for (const InputEvent &event : m_events)
+        {
+            WriteVarint(data, event.tick - lastTick);
+            data.push_back(static_cast<uint8_t>(event.type));
+            WriteVarint(data, event.value);
+
+            lastTick = event.tick;
+        }
+
+        if (!SDL_SaveFile(path, data.data(), data.size()))
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InputRecorder: Failed to write %s: %s", path, SDL_GetError());
+            return false;
+        }
+
+        SDL_Log("InputRecorder: Wrote %zu events over %llu ticks to %s (%zu bytes)", m_events.size(),
+            static_cast<unsigned long long>(p_length), path, data.size());
+
+        return true;
+    }
+
+    bool InputRecorder::LoadReplay(const char *p_path)
+    {
+        size_t size = 0;
+        uint8_t *data = static_cast<uint8_t *>(SDL_LoadFile(p_path, &size));
+        if (!data)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InputRecorder: Failed to load %s: %s", p_path, SDL_GetError());
+            return false;
+        }
+
+        const uint8_t *cursor = data;
+        const uint8_t *end = data + size;
+
+        uint64_t magic{}, version{}, tickRateBits{}, eventCount{};
+        bool valid = ReadLE(cursor, end, 4, magic) && magic == MAGIC;
+        valid = valid && ReadLE(cursor, end, 2, version) && version == VERSION;
+        valid = valid && ReadLE(cursor, end, 4, tickRateBits);
+        valid = valid && ReadLE(cursor, end, 8, m_seed);
+        valid = valid && ReadLE(cursor, end, 8, m_length);
+        valid = valid && ReadLE(cursor, end, 4, eventCount);
+
+        const uint32_t tickRateBits32 = static_cast<uint32_t>(tickRateBits);
+        std::memcpy(&m_tickRate, &tickRateBits32, sizeof(m_tickRate));
+
+        m_events.clear();
+        m_seeds.clear();
+
+        uint64_t tick = 0;
+        for (uint64_t i = 0; valid && i < eventCount; i++)
+        {
+            uint64_t delta{}, value{};
+            valid = ReadVarint(cursor, end, delta) && cursor < end;
+            if (!valid)
+                break;
+
+            const uint8_t type = *cursor++;
+            valid = type <= static_cast<uint8_t>(InputEventType::SEED) && ReadVarint(cursor, end, value);
+            if (!valid)
+                break;
+
+            tick += delta;
+
+            if (type == static_cast<uint8_t>(InputEventType::SEED))
+                m_seeds.push_back(value);
+            else
+                m_events.push_back(InputEvent{ tick, static_cast<InputEventType>(type), value });
+        }
+
+        SDL_free(data);
+
+        if (!valid)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InputRecorder: %s is not a valid replay", p_path);
+            return false;
+        }
+
+        m_replaying = true;
+        m_nextEvent = 0;
+        m_nextSeed = 0;
+
+        SDL_Log("InputRecorder: Replaying %s, %llu ticks at %.0f Hz (seed %llu)", p_path,
+            static_cast<unsigned long long>(m_length), m_tickRate, static_cast<unsigned long long>(m_seed));
+
+        return true;
+    }
+
+    bool InputRecorder::PollCommand(uint64_t p_tick, InputEvent &p_outEvent)
+    {
+        if (m_nextEvent >= m_events.size() || m_events[m_nextEvent].tick > p_tick)
+            return false;
+
+        p_outEvent = m_events[m_nextEvent++];
+        return true;
+    }
+
+    bool InputRecorder::PollSeed(uint64_t &p_outSeed)
+    {
+        if (m_nextSeed >= m_seeds.size())
+            return false;
+
+        p_outSeed = m_seeds[m_nextSeed++];
+        return true;
+    }
+
+    bool InputRecorder::IsRecording() const
+    {
+        return m_recordPath != nullptr;
+    }
+
+    bool InputRecorder::IsReplaying() const
+    {
+        return m_replaying;
+    }
+
+    bool InputRecorder::IsReplayFinished(uint64_t p_tick) const
+    {
+        return m_replaying && p_tick >= m_length;
+    }
+
+    float InputRecorder::GetTickRate() const
+    {
+        return m_tickRate;
+    }
+
+    uint64_t InputRecorder::GetSeed() const
+    {
+        return m_seed;
+    }
+
+    uint64_t InputRecorder::GetLength() const
+    {
+        return m_length;
+    }
+}
@@ -0,0 +1,277 @@
+#include "job_system.hpp"
+
+#include <algorithm>
+
+namespace lum
+{
+    // Workers get 1..N, the main thread and anything else that submits uses 0
+    static thread_local uint32_t t_threadIndex{};
+
+    JobSystem::JobSystem() = default;
+
+    JobSystem::~JobSystem()
+    {
+        Shutdown();
+    }
+
+    bool JobSystem::Init(uint32_t p_workerCount)
+    {
+        uint32_t workers = p_workerCount;
+        if (workers == 0)
+            workers = static_cast<uint32_t>(SDL_max(SDL_GetNumLogicalCPUCores() - 1, 0));
+
+        workers = SDL_min(workers, MAX_THREADS - 1);
+
+        m_wake = SDL_CreateSemaphore(0);
+        if (!m_wake)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "JobSystem: Failed to create semaphore: %s", SDL_GetError());
+            return false;
+        }
+
+        // Set before any worker starts, they read it to pick steal victims. A
+        // worker that fails to start just leaves an empty queue behind.
+
+        m_running = true;
+        m_threadCount = workers + 1;
+
+        for (uint32_t i = 1; i <= workers; i++)
+        {
+            m_starts[i] = WorkerStart{ this, i };
+
+            SDL_Thread *thread = SDL_CreateThread(WorkerMain, "job_worker", &m_starts[i]);
+            if (!thread)
+            {
+                // Fewer workers is fine, the main thread picks up the slack
+                SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "JobSystem: Failed to create worker %u: %s", i, SDL_GetError());
+                break;
+            }
+
+            m_threads.push_back(thread);
+        }
+
+        SDL_Log("JobSystem: %u workers", GetWorkerCount());
+
+        return true;
+    }
+
+    void JobSystem::Shutdown()
+    {
+        if (!m_wake)
+            return;
+
+        // Anything still queued runs before the workers go away
+
+        while (TryRunOne(GetThreadIndex()))
+        {
+        }
+
+        m_running = false;
+
+        for (size_t i = 0; i < m_threads.size(); i++)
+            SDL_SignalSemaphore(m_wake);
+
+        for (SDL_Thread *thread : m_threads)
+            SDL_WaitThread(thread, nullptr);
+
+        m_threads.clear();
+        m_threadCount = 1;
+
+        SDL_DestroySemaphore(m_wake);
+        m_wake = nullptr;
+    }
+
+    uint32_t JobSystem::GetWorkerCount() const
+    {
+        return static_cast<uint32_t>(m_threads.size());
+    }
+
+    void JobSystem::Submit(const Job &p_job)
+    {
+        if (p_job.counter)
+            p_job.counter->m_pending.fetch_add(1, std::memory_order_relaxed);
+
+        const uint32_t index = GetThreadIndex();
+        WorkerQueue &queue = m_queues[index];
+
+        SDL_LockSpinlock(&queue.lock);
+        const bool full = queue.bottom - queue.top == DEQUE_CAPACITY;
+        if (!full)
+        {
+            queue.jobs[queue.bottom % DEQUE_CAPACITY] = p_job;
+            queue.bottom++;
+        }
+        SDL_UnlockSpinlock(&queue.lock);
+
+        // No room left, doing it right here beats dropping it
+        if (full)
+        {
+            Execute(index, p_job);
+            return;
+        }
+
+        // Pairs with the sleeping check in WorkerMain, one of the two sides always
+        // sees the other so a job never sits there with everyone asleep
+
+        m_queued.fetch_add(1, std::memory_order_seq_cst);
+        if (m_sleeping.load(std::memory_order_seq_cst) > 0)
+            SDL_SignalSemaphore(m_wake);
+    }
+
+    void JobSystem::Wait(JobCounter &p_counter)
+    {
+        const uint32_t index = GetThreadIndex();
+
+        while (!p_counter.IsDone())
+        {
+            if (!TryRunOne(index))
+                SDL_CPUPauseInstruction();
+        }
+    }
+
+    void JobSystem::CollectTimings(std::vector<JobTiming> &p_outTimings)
+    {
+        p_outTimings.clear();
+
+        for (uint32_t i = 0; i < m_threadCount; i++)
+        {
+            WorkerQueue &queue = m_queues[i];
+
+            SDL_LockSpinlock(&queue.timingLock);
+
+            for (uint32_t t = 0; t < queue.timingCount; t++)
+            {
+                const JobTiming &timing = queue.timings[t];
+
+                auto it = std::find_if(p_outTimings.begin(), p_outTimings.end(), [&](const JobTiming &p_other) { return p_other.name == timing.name; });
+                if (it == p_outTimings.end())
+                {
+                    p_outTimings.push_back(timing);
+                    continue;
+                }
+
+                it->count += timing.count;
+                it->totalMS += timing.totalMS;
+                it->maxMS = SDL_max(it->maxMS, timing.maxMS);
+            }
+
+            queue.timingCount = 0;
+
+            SDL_UnlockSpinlock(&queue.timingLock);
+        }
+    }
+
+    bool JobSystem::Pop(uint32_t p_queue, Job &p_outJob)
+    {
+        WorkerQueue &queue = m_queues[p_queue];
+
+        SDL_LockSpinlock(&queue.lock);
+        const bool found = queue.bottom != queue.top;
+        if (found)
+        {
+            queue.bottom--;
+            p_outJob = queue.jobs[queue.bottom % DEQUE_CAPACITY];
+        }
+        SDL_UnlockSpinlock(&queue.lock);
+
+        return found;
+    }
+
+    bool JobSystem::Steal(uint32_t p_thief, Job &p_outJob)
+    {
+        // Start past the thief so workers don't all hammer the same victim
+
+        for (uint32_t i = 1; i < m_threadCount; i++)
+        {
+            WorkerQueue &queue = m_queues[(p_thief + i) % m_threadCount];
+
+            SDL_LockSpinlock(&queue.lock);
+            const bool found = queue.bottom != queue.top;
+            if (found)
+            {
+                p_outJob = queue.jobs[queue.top % DEQUE_CAPACITY];
+                queue.top++;
+            }
+            SDL_UnlockSpinlock(&queue.lock);
+
+            if (found)
+                return true;
+        }
+
+        return false;
+    }
+
+    bool JobSystem::TryRunOne(uint32_t p_queue)
+    {
+        Job job{};
+        if (!Pop(p_queue, job) && !Steal(p_queue, job))
+            return false;
+
+        m_queued.fetch_sub(1, std::memory_order_relaxed);
+        Execute(p_queue, job);
+
+        return true;
+    }
+
+    void JobSystem::Execute(uint32_t p_queue, const Job &p_job)
+    {
+        const uint64_t start = SDL_GetTicksNS();
+        p_job.func(p_job.data, p_job.begin, p_job.end);
+        const float elapsedMS = static_cast<float>(SDL_GetTicksNS() - start) / SDL_NS_PER_MS;
+
+        if (p_job.name)
+        {
+            WorkerQueue &queue = m_queues[p_queue];
+
+            SDL_LockSpinlock(&queue.timingLock);
+
+            uint32_t slot = 0;
+            while (slot < queue.timingCount && queue.timings[slot].name != p_job.name)
+                slot++;
+
+            if (slot == queue.timingCount && slot < MAX_TIMED_JOBS)
+                queue.timings[queue.timingCount++] = JobTiming{ p_job.name };
+
+            if (slot < queue.timingCount)
+            {
+                JobTiming &timing = queue.timings[slot];
+                timing.count++;
+                timing.totalMS += elapsedMS;
+                timing.maxMS = SDL_max(timing.maxMS, elapsedMS);
+            }
+
+            SDL_UnlockSpinlock(&queue.timingLock);
+        }
+
+        if (p_job.counter)
+            p_job.counter->m_pending.fetch_sub(1, std::memory_order_release);
+    }
+
+    uint32_t JobSystem::GetThreadIndex()
+    {
+        return t_threadIndex;
+    }
+
+    int JobSystem::WorkerMain(void *p_data)
+    {
+        const WorkerStart *start = static_cast<WorkerStart *>(p_data);
+        JobSystem *self = start->system;
+
+        t_threadIndex = start->index;
+
+        while (self->m_running.load(std::memory_order_acquire))
+        {
+            if (self->TryRunOne(t_threadIndex))
+                continue;
+
+            self->m_sleeping.fetch_add(1, std::memory_order_seq_cst);
+
+            if (self->m_queued.load(std::memory_order_seq_cst) <= 0 && self->m_running.load(std::memory_order_acquire))
+                SDL_WaitSemaphore(self->m_wake);
+
+            self->m_sleeping.fetch_sub(1, std::memory_order_seq_cst);
+        }
+
+        return 0;
+    }
+}
@@ -0,0 +1,809 @@
+#include "mixer.hpp"
+
+#include "simd.hpp"
+#include "music_stream.hpp"
+
+namespace lum
+{
+	Mixer::Mixer() = default;
+
+	Mixer::~Mixer() = default;
+
+	bool Mixer::Init(SDL_AudioDeviceID p_device)
+	{
+		SDL_AudioSpec deviceSpec{};
+		if (!SDL_GetAudioDeviceFormat(p_device, &deviceSpec, nullptr))
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_AUDIO, "Mixer: Failed to query device format: %s", SDL_GetError());
+			return false;
+		}
+
+		if (!CreateStream(deviceSpec))
+			return false;
+
+		SDL_SetAudioStreamGetCallback(m_stream, MixCallback, this);
+
+		if (!SDL_BindAudioStream(p_device, m_stream))
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_AUDIO, "Mixer: Failed to bind audio stream: %s", SDL_GetError());
+			return false;
+		}
+
+		SDL_LogInfo(SDL_LOG_CATEGORY_AUDIO, "Mixer: Mixing %d channels at %d Hz with %u voices", m_spec.channels, m_spec.freq, MAX_VOICES);
+
+		return true;
+	}
+
+	bool Mixer::InitOffline(const SDL_AudioSpec &p_spec)
+	{
+		// No device and no callback, the stream is only there for its lock and
+		// everything gets mixed by calling Render
+
+		if (!CreateStream(p_spec))
+			return false;
+
+		SDL_LogInfo(SDL_LOG_CATEGORY_AUDIO, "Mixer: Offline mixing %d channels at %d Hz with %u voices", m_spec.channels, m_spec.freq, MAX_VOICES);
+
+		return true;
+	}
+
+	void Mixer::Render(float *p_out, uint32_t p_frames)
+	{
+		if (!m_stream)
+			return;
+
+		SDL_LockAudioStream(m_stream);
+
+		ProcessCommands();
+
+		while (p_frames > 0)
+		{
+			uint32_t frames = SDL_min(p_frames, MIX_BLOCK_FRAMES);
+
+			Mix(p_out, frames);
+
+			p_out += static_cast<size_t>(frames) * m_spec.channels;
+			p_frames -= frames;
+		}
+
+		SDL_UnlockAudioStream(m_stream);
+	}
+
+	void Mixer::Shutdown()
+	{
+		if (!m_stream)
+			return;
+
+		SDL_UnbindAudioStream(m_stream);
+		SDL_DestroyAudioStream(m_stream);
+		m_stream = nullptr;
+
+		// Nothing consumes the ring anymore, throw away what's left in it
+
+		AudioCommand command{};
+		while (m_commands.TryPop(command)) {}
+
+		m_voices = {};
+		m_frameTriggers.clear();
+
+		for (auto &id : m_voiceIds)
+			id = 0;
+
+		for (auto &sound : m_sounds)
+		{
+			sound.samples = nullptr;
+			sound.frameCount = 0;
+			sound.used = false;
+			sound.activeVoices = 0;
+		}
+
+		for (auto &bus : m_buses)
+		{
+			bus.gain.Set(1.0f);
+			bus.gain.Snap();
+			bus.parent = MASTER_BUS;
+			bus.used = false;
+			bus.paused = false;
+			bus.music = nullptr;
+			bus.buffer.clear();
+			bus.effects.clear();
+		}
+
+		m_activeVoices = 0;
+	}
+
+	const SDL_AudioSpec &Mixer::GetSpec() const
+	{
+		return m_spec;
+	}
+
+	SoundId Mixer::RegisterSound(const Sound &p_sound)
+	{
+		if (!m_stream || p_sound.frameCount == 0)
+			return SoundId{};
+
+		if (p_sound.audioSpec.format != m_spec.format || p_sound.audioSpec.channels != m_spec.channels || p_sound.audioSpec.freq != m_spec.freq)
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_AUDIO, "Mixer: Sound %s isn't in the mix format", StringTable::GetString(p_sound.tag));
+			return SoundId{};
+		}
+
+		uint16_t index = 0;
+		while (index < MAX_SOUNDS && m_sounds[index].used)
+			index++;
+
+		if (index == MAX_SOUNDS)
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_AUDIO, "Mixer: No free sound slot for %s", StringTable::GetString(p_sound.tag));
+			return SoundId{};
+		}
+
+		auto &slot = m_sounds[index];
+
+		SDL_LockAudioStream(m_stream);
+
+		slot.samples = p_sound.samples.data();
+		slot.frameCount = p_sound.frameCount;
+		slot.playback = p_sound.playback;
+		slot.generation = static_cast<uint16_t>(slot.generation + 1 == 0 ? 1 : slot.generation + 1);
+		slot.activeVoices = 0;
+		slot.used = true;
+
+		SDL_UnlockAudioStream(m_stream);
+
+		return SoundId{ index, slot.generation };
+	}
+
+	void Mixer::UnregisterSound(SoundId p_sound)
+	{
+		if (!m_stream || !p_sound || p_sound.slot >= MAX_SOUNDS)
+			return;
+
+		auto &slot = m_sounds[p_sound.slot];
+		if (!slot.used || slot.generation != p_sound.generation)
+			return;
+
+		// Commands still queued for this sound get rejected by the generation check,
+		// only the voices reading from its samples have to go before it's freed
+
+		SDL_LockAudioStream(m_stream);
+
+		for (uint32_t i = 0; i < MAX_VOICES; i++)
+		{
+			if (m_voices[i].active && m_voices[i].slot == p_sound.slot)
+				ReleaseVoice(i);
+		}
+
+		slot.samples = nullptr;
+		slot.frameCount = 0;
+		slot.used = false;
+
+		SDL_UnlockAudioStream(m_stream);
+	}
+
+	bool Mixer::IsSoundPlaying(SoundId p_sound) const
+	{
+		if (!p_sound || p_sound.slot >= MAX_SOUNDS)
+			return false;
+
+		const auto &slot = m_sounds[p_sound.slot];
+		return slot.used && slot.generation == p_sound.generation && slot.activeVoices > 0;
+	}
+
+	void Mixer::SetSoundPlayback(SoundId p_sound, const SoundPlayback &p_playback)
+	{
+		if (!p_sound || p_sound.slot >= MAX_SOUNDS)
+			return;
+
+		AudioCommand command{};
+		command.type = AudioCommandType::SET_SOUND_PLAYBACK;
+		command.sound = p_sound;
+		command.playback = p_playback;
+		PushCommand(command);
+	}
+
+	void Mixer::BeginFrame()
+	{
+		m_frameTriggers.clear();
+	}
+
+	VoiceHandle Mixer::PlaySound(SoundId p_sound, uint8_t p_bus, float p_gain, float p_pitch)
+	{
+		if (!m_stream || !p_sound || p_bus >= MAX_BUSES)
+			return VoiceHandle{};
+
+		// Same sound already triggered this frame, the copies would play in phase
+		// so add their energy to the existing voice instead of starting another
+
+		for (auto &trigger : m_frameTriggers)
+		{
+			if (trigger.sound != p_sound || trigger.bus != p_bus)
+				continue;
+
+			trigger.gainSquared += p_gain * p_gain;
+			SetVoiceGain(trigger.voice, SDL_sqrtf(trigger.gainSquared));
+
+			return trigger.voice;
+		}
+
+		// The mixer applies the instance cap and voice stealing once it picks the
+		// command up, the handle is valid right away either way
+
+		VoiceHandle handle{ m_nextVoiceId };
+
+		AudioCommand command{};
+		command.type = AudioCommandType::PLAY;
+		command.bus = p_bus;
+		command.sound = p_sound;
+		command.voice = handle.id;
+		command.gain = p_gain;
+		command.pitch = p_pitch;
+
+		if (!PushCommand(command))
+			return VoiceHandle{};
+
+		m_nextVoiceId++;
+		if (m_nextVoiceId == 0)
+			m_nextVoiceId = 1;
+
+		// Past the reserved size later triggers just don't get folded, the list
+		// never grows on the game thread
+
+		if (m_frameTriggers.size() < MAX_FRAME_TRIGGERS)
+			m_frameTriggers.push_back(FrameTrigger{ p_sound, p_bus, handle, p_gain * p_gain });
+
+		return handle;
+	}
+
+	void Mixer::StopVoice(VoiceHandle p_voice)
+	{
+		if (!p_voice)
+			return;
+
+		AudioCommand command{};
+		command.type = AudioCommandType::STOP_VOICE;
+		command.voice = p_voice.id;
+		PushCommand(command);
+	}
+
+	void Mixer::SetVoiceGain(VoiceHandle p_voice, float p_gain)
+	{
+		if (!p_voice)
+			return;
+
+		AudioCommand command{};
+		command.type = AudioCommandType::SET_VOICE_GAIN;
+		command.voice = p_voice.id;
+		command.gain = p_gain;
+		PushCommand(command);
+	}
+
+	void Mixer::SetVoicePitch(VoiceHandle p_voice, float p_pitch)
+	{
+		if (!p_voice)
+			return;
+
+		AudioCommand command{};
+		command.type = AudioCommandType::SET_VOICE_PITCH;
+		command.voice = p_voice.id;
+		command.pitch = p_pitch;
+		PushCommand(command);
+	}
+
+	bool Mixer::IsVoicePlaying(VoiceHandle p_voice) const
+	{
+		// Only true once the mixer picked up the play command, a voice started
+		// this frame may not be there yet
+
+		if (!p_voice)
+			return false;
+
+		for (const auto &id : m_voiceIds)
+		{
+			if (id.load(std::memory_order_relaxed) == p_voice.id)
+				return true;
+		}
+
+		return false;
+	}
+
+	int32_t Mixer::CreateBus(uint8_t p_parent)
+	{
+		if (!m_stream || p_parent >= MAX_BUSES || !m_buses[p_parent].used)
+			return -1;
+
+		SDL_LockAudioStream(m_stream);
+
+		int32_t index = -1;
+		for (uint32_t i = p_parent + 1; i < MAX_BUSES; i++)
+		{
+			auto &bus = m_buses[i];
+			if (bus.used)
+				continue;
+
+			bus.gain.Set(1.0f);
+			bus.gain.Snap();
+			bus.parent = p_parent;
+			bus.paused = false;
+			bus.music = nullptr;
+			bus.buffer.assign(MIX_BLOCK_FRAMES * m_spec.channels, 0.0f);
+			bus.effects.clear();
+			bus.effects.reserve(MAX_BUS_EFFECTS);
+			bus.used = true;
+
+			index = static_cast<int32_t>(i);
+			break;
+		}
+
+		SDL_UnlockAudioStream(m_stream);
+
+		if (index < 0)
+			SDL_LogError(SDL_LOG_CATEGORY_AUDIO, "Mixer: No free bus left after parent %u", p_parent);
+
+		return index;
+	}
+
+	AudioEffect *Mixer::AddBusEffect(uint8_t p_bus, std::unique_ptr<AudioEffect> p_effect)
+	{
+		if (!m_stream || !p_effect || p_bus >= MAX_BUSES || !m_buses[p_bus].used)
+			return nullptr;
+
+		if (m_buses[p_bus].effects.size() >= MAX_BUS_EFFECTS)
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_AUDIO, "Mixer: Bus %u already has %u effects", p_bus, MAX_BUS_EFFECTS);
+			return nullptr;
+		}
+
+		// Allocations happen here, the mix callback only ever runs Process
+
+		p_effect->Prepare(m_spec);
+		AudioEffect *effect = p_effect.get();
+
+		SDL_LockAudioStream(m_stream);
+		m_buses[p_bus].effects.push_back(std::move(p_effect));
+		SDL_UnlockAudioStream(m_stream);
+
+		return effect;
+	}
+
+	void Mixer::StopBus(uint8_t p_bus)
+	{
+		if (p_bus >= MAX_BUSES)
+			return;
+
+		AudioCommand command{};
+		command.type = AudioCommandType::STOP_BUS;
+		command.bus = p_bus;
+		PushCommand(command);
+	}
+
+	void Mixer::SetBusGain(uint8_t p_bus, float p_gain)
+	{
+		if (p_bus >= MAX_BUSES)
+			return;
+
+		m_buses[p_bus].gain.Set(p_gain);
+	}
+
+	void Mixer::SetBusPaused(uint8_t p_bus, bool p_paused)
+	{
+		if (p_bus >= MAX_BUSES)
+			return;
+
+		AudioCommand command{};
+		command.type = AudioCommandType::SET_BUS_PAUSED;
+		command.bus = p_bus;
+		command.paused = p_paused;
+		PushCommand(command);
+	}
+
+	void Mixer::SetBusMusic(uint8_t p_bus, MusicStream *p_music)
+	{
+		if (!m_stream || p_bus >= MAX_BUSES)
+			return;
+
+		SDL_LockAudioStream(m_stream);
+		m_buses[p_bus].music = p_music;
+		SDL_UnlockAudioStream(m_stream);
+	}
+
+	MixerStats Mixer::GetStats() const
+	{
+		MixerStats stats{};
+		stats.activeVoices = m_activeVoices;
+		stats.maxVoices = MAX_VOICES;
+		stats.mixTimeMS = static_cast<float>(m_mixTimeNS) / SDL_NS_PER_MS;
+
+		stats.droppedCommands = m_droppedCommands;
+
+		if (m_spec.freq > 0)
+			stats.blockTimeMS = static_cast<float>(m_mixedFrames) * 1000.0f / m_spec.freq;
+
+		return stats;
+	}
+
+	bool Mixer::CreateStream(const SDL_AudioSpec &p_outSpec)
+	{
+		// Mix in float at the output rate and channel count, SDL only has to
+		// convert the sample format on the way out
+
+		m_spec.format = SDL_AUDIO_F32;
+		m_spec.channels = p_outSpec.channels;
+		m_spec.freq = p_outSpec.freq;
+
+		const size_t blockSamples = MIX_BLOCK_FRAMES * m_spec.channels;
+		m_mixBuffer.resize(blockSamples);
+		m_musicBuffer.resize(blockSamples);
+		m_frameTriggers.reserve(MAX_FRAME_TRIGGERS);
+
+		auto &master = m_buses[MASTER_BUS];
+		master.buffer.assign(blockSamples, 0.0f);
+		master.effects.reserve(MAX_BUS_EFFECTS);
+		master.used = true;
+
+		m_stream = SDL_CreateAudioStream(&m_spec, &p_outSpec);
+		if (!m_stream)
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_AUDIO, "Mixer: Failed to create audio stream: %s", SDL_GetError());
+			return false;
+		}
+
+		return true;
+	}
+
+	void SDLCALL Mixer::MixCallback(void *p_userdata, SDL_AudioStream *p_stream, int p_additionalAmount, int)
+	{
+		auto *self = static_cast<Mixer *>(p_userdata);
+
+		self->ProcessCommands();
+
+		if (p_additionalAmount <= 0)
+			return;
+
+		const uint64_t start = SDL_GetTicksNS();
+
+		const int frameSize = SDL_AUDIO_FRAMESIZE(self->m_spec);
+		const uint32_t totalFrames = static_cast<uint32_t>((p_additionalAmount + frameSize - 1) / frameSize);
+
+		uint32_t framesLeft = totalFrames;
+		while (framesLeft > 0)
+		{
+			uint32_t frames = SDL_min(framesLeft, MIX_BLOCK_FRAMES);
+
+			self->Mix(self->m_mixBuffer.data(), frames);
+			SDL_PutAudioStreamData(p_stream, self->m_mixBuffer.data(), static_cast<int>(frames * frameSize));
+
+			framesLeft -= frames;
+		}
+
+		self->m_mixTimeNS = SDL_GetTicksNS() - start;
+		self->m_mixedFrames = totalFrames;
+	}
+
+	bool Mixer::PushCommand(const AudioCommand &p_command)
+	{
+		// Dropping is better than stalling the game, it only happens if the mixer
+		// hasn't run for a long time
+
+		if (m_commands.TryPush(p_command))
+			return true;
+
+		m_droppedCommands++;
+		return false;
+	}
+
+	void Mixer::ProcessCommands()
+	{
+		AudioCommand command{};
+		while (m_commands.TryPop(command))
+		{
+			if (command.type == AudioCommandType::PLAY)
+			{
+				StartVoice(command);
+				continue;
+			}
+
+			if (command.type == AudioCommandType::SET_SOUND_PLAYBACK)
+			{
+				auto &sound = m_sounds[command.sound.slot];
+				if (sound.used && sound.generation == command.sound.generation)
+					sound.playback = command.playback;
+				continue;
+			}
+
+			if (command.type == AudioCommandType::STOP_BUS)
+			{
+				for (uint32_t i = 0; i < MAX_VOICES; i++)
+				{
+					if (m_voices[i].active && m_voices[i].bus == command.bus)
+						ReleaseVoice(i);
+				}
+				continue;
+			}
+
+			if (command.type == AudioCommandType::SET_BUS_PAUSED)
+			{
+				m_buses[command.bus].paused = command.paused;
+				continue;
+			}
+
+			Voice *voice = FindVoice(command.voice);
+			if (!voice)
+				continue;
+
+			switch (command.type)
+			{
+			case AudioCommandType::STOP_VOICE:
+				ReleaseVoice(static_cast<uint32_t>(voice - m_voices.data()));
+				break;
+			case AudioCommandType::SET_VOICE_GAIN:
+				voice->gain = command.gain;
+				break;
+			case AudioCommandType::SET_VOICE_PITCH:
+				voice->pitch = SDL_clamp(command.pitch, MIN_PITCH, MAX_PITCH);
+				break;
+			default:
+				break;
+			}
+		}
+	}
+
+	void Mixer::StartVoice(const AudioCommand &p_command)
+	{
+		if (p_command.sound.slot >= MAX_SOUNDS || p_command.bus >= MAX_BUSES || !m_buses[p_command.bus].used)
+			return;
+
+		auto &sound = m_sounds[p_command.sound.slot];
+		if (!sound.used || sound.generation != p_command.sound.generation)
+			return;
+
+		// Instance cap, then a free voice, then steal from the whole pool
+
+		int32_t index = -1;
+		if (sound.activeVoices >= sound.playback.maxInstances)
+		{
+			index = PickVoiceToSteal(sound, p_command.sound.slot, true);
+		}
+		else
+		{
+			for (uint32_t i = 0; i < MAX_VOICES && index < 0; i++)
+			{
+				if (!m_voices[i].active)
+					index = static_cast<int32_t>(i);
+			}
+
+			if (index < 0)
+				index = PickVoiceToSteal(sound, p_command.sound.slot, false);
+		}
+
+		if (index < 0)
+			return;
+
+		if (m_voices[index].active)
+			ReleaseVoice(static_cast<uint32_t>(index));
+
+		auto &voice = m_voices[index];
+		voice.samples = sound.samples;
+		voice.frameCount = sound.frameCount;
+		voice.position = 0;
+		voice.fraction = 0.0f;
+		voice.gain = p_command.gain;
+		voice.pitch = SDL_clamp(p_command.pitch, MIN_PITCH, MAX_PITCH);
+		voice.startOrder = m_playOrder++;
+		voice.id = p_command.voice;
+		voice.slot = p_command.sound.slot;
+		voice.priority = sound.playback.priority;
+		voice.bus = p_command.bus;
+		voice.active = true;
+
+		sound.activeVoices++;
+		m_voiceIds[index].store(voice.id, std::memory_order_relaxed);
+	}
+
+	void Mixer::ReleaseVoice(uint32_t p_index)
+	{
+		auto &voice = m_voices[p_index];
+
+		voice.active = false;
+		m_sounds[voice.slot].activeVoices--;
+		m_voiceIds[p_index].store(0, std::memory_order_relaxed);
+	}
+
+	Mixer::Voice *Mixer::FindVoice(uint32_t p_id)
+	{
+		for (auto &voice : m_voices)
+		{
+			if (voice.active && voice.id == p_id)
+				return &voice;
+		}
+
+		return nullptr;
+	}
+
+	int32_t Mixer::PickVoiceToSteal(const SoundSlot &p_sound, uint16_t p_slot, bool p_sameSoundOnly) const
+	{
+		// Only voices of the same or lower priority can be taken, for the instance
+		// cap the candidates are the other copies of the same sound
+
+		if (p_sound.playback.steal == VoiceStealPolicy::NONE)
+			return -1;
+
+		int32_t best = -1;
+
+		for (uint32_t i = 0; i < MAX_VOICES; i++)
+		{
+			const auto &voice = m_voices[i];
+
+			if (!voice.active || voice.priority > p_sound.playback.priority)
+				continue;
+
+			if (p_sameSoundOnly && voice.slot != p_slot)
+				continue;
+
+			if (best < 0)
+			{
+				best = static_cast<int32_t>(i);
+				continue;
+			}
+
+			const auto &current = m_voices[best];
+			const float gain = voice.gain * m_buses[voice.bus].gain.GetTarget();
+			const float currentGain = current.gain * m_buses[current.bus].gain.GetTarget();
+
+			bool better = false;
+			switch (p_sound.playback.steal)
+			{
+			case VoiceStealPolicy::OLDEST:
+				better = voice.startOrder < current.startOrder;
+				break;
+			case VoiceStealPolicy::QUIETEST:
+				better = gain < currentGain || (gain == currentGain && voice.startOrder < current.startOrder);
+				break;
+			case VoiceStealPolicy::LOWEST_PRIORITY:
+				better = voice.priority < current.priority || (voice.priority == current.priority && voice.startOrder < current.startOrder);
+				break;
+			default:
+				break;
+			}
+
+			if (better)
+				best = static_cast<int32_t>(i);
+		}
+
+		return best;
+	}
+
+	void Mixer::MixVoice(Voice &p_voice, float *p_out, uint32_t p_frames)
+	{
+		const uint32_t channelCount = m_spec.channels;
+
+		// Unpitched voices are a straight vector add
+
+		if (p_voice.pitch == 1.0f && p_voice.fraction == 0.0f)
+		{
+			uint32_t frames = SDL_min(p_frames, p_voice.frameCount - p_voice.position);
+
+			simd::MixAdd(p_out, p_voice.samples + static_cast<size_t>(p_voice.position) * channelCount, p_voice.gain, frames * channelCount);
+
+			p_voice.position += frames;
+			return;
+		}
+
+		// Pitched voices step through the samples with linear interpolation
+
+		for (uint32_t i = 0; i < p_frames; i++)
+		{
+			if (p_voice.position + 1 >= p_voice.frameCount)
+			{
+				p_voice.position = p_voice.frameCount;
+				break;
+			}
+
+			const float *a = p_voice.samples + static_cast<size_t>(p_voice.position) * channelCount;
+			const float *b = a + channelCount;
+			float *out = p_out + static_cast<size_t>(i) * channelCount;
+
+			for (uint32_t c = 0; c < channelCount; c++)
+				out[c] += (a[c] + (b[c] - a[c]) * p_voice.fraction) * p_voice.gain;
+
+			p_voice.fraction += p_voice.pitch;
+			const uint32_t step = static_cast<uint32_t>(p_voice.fraction);
+			p_voice.position += step;
+			p_voice.fraction -= static_cast<float>(step);
+		}
+	}
+
+	void Mixer::Mix(float *p_out, uint32_t p_frames)
+	{
+		const uint32_t channelCount = m_spec.channels;
+		const size_t samples = static_cast<size_t>(p_frames) * channelCount;
+
+		SDL_memset(p_out, 0, samples * sizeof(float));
+
+		for (auto &bus : m_buses)
+		{
+			if (bus.used)
+				SDL_memset(bus.buffer.data(), 0, samples * sizeof(float));
+		}
+
+		// Voices, paused buses keep their voices where they are
+
+		uint32_t activeVoices = 0;
+
+		for (uint32_t i = 0; i < MAX_VOICES; i++)
+		{
+			auto &voice = m_voices[i];
+			if (!voice.active)
+				continue;
+
+			auto &bus = m_buses[voice.bus];
+			if (bus.paused)
+			{
+				activeVoices++;
+				continue;
+			}
+
+			MixVoice(voice, bus.buffer.data(), p_frames);
+
+			// Reclaim the voice as soon as it runs out of samples
+			if (voice.position >= voice.frameCount)
+				ReleaseVoice(i);
+			else
+				activeVoices++;
+		}
+
+		// Music
+
+		for (auto &bus : m_buses)
+		{
+			if (!bus.used || !bus.music || bus.paused)
+				continue;
+
+			uint32_t frames = bus.music->Read(m_musicBuffer.data(), p_frames);
+			if (frames > 0)
+				simd::MixAdd(bus.buffer.data(), m_musicBuffer.data(), 1.0f, frames * channelCount);
+		}
+
+		// Effects, gain and routing, children first. Buses processed earlier in
+		// the block already have their peak updated for sidechains to read
+
+		const EffectContext context{ m_busPeaks.data(), MAX_BUSES };
+
+		for (int32_t b = MAX_BUSES - 1; b >= 0; b--)
+		{
+			auto &bus = m_buses[b];
+			if (!bus.used)
+				continue;
+
+			float *buffer = bus.buffer.data();
+
+			for (auto &effect : bus.effects)
+			{
+				if (!effect->IsBypassed())
+					effect->Process(buffer, p_frames, context);
+			}
+
+			const float gainFrom = bus.gain.Get();
+			bus.gain.Advance(p_frames, m_spec.freq);
+			const float gainTo = bus.gain.Get();
+
+			float *destination = b == MASTER_BUS ? p_out : m_buses[bus.parent].buffer.data();
+
+			if (gainFrom == gainTo)
+			{
+				simd::MixAdd(destination, buffer, gainTo, samples);
+			}
+			else
+			{
+				simd::ScaleRamp(buffer, gainFrom, gainTo, samples);
+				simd::MixAdd(destination, buffer, 1.0f, samples);
+			}
+
+			m_busPeaks[b] = simd::PeakAbs(buffer, samples) * (gainFrom == gainTo ? gainTo : 1.0f);
+		}
+
+		simd::Clip(p_out, samples);
+
+		m_activeVoices = activeVoices;
+	}
+}
@@ -0,0 +1,295 @@
+#include "music_stream.hpp"
+
+namespace lum
+{
+	// Vorbisfile IO on top of SDL_IOStream, so music is read from disk as it's
+	// decoded instead of being held in memory
+
+	static size_t VorbisRead(void *p_ptr, size_t p_size, size_t p_count, void *p_source)
+	{
+		if (p_size == 0)
+			return 0;
+
+		return SDL_ReadIO(static_cast<SDL_IOStream *>(p_source), p_ptr, p_size * p_count) / p_size;
+	}
+
+	static int VorbisSeek(void *p_source, ogg_int64_t p_offset, int p_whence)
+	{
+		SDL_IOWhence whence = SDL_IO_SEEK_SET;
+		if (p_whence == SEEK_CUR)
+			whence = SDL_IO_SEEK_CUR;
+		else if (p_whence == SEEK_END)
+			whence = SDL_IO_SEEK_END;
+
+		return SDL_SeekIO(static_cast<SDL_IOStream *>(p_source), p_offset, whence) < 0 ? -1 : 0;
+	}
+
+	static int VorbisClose(void *p_source)
+	{
+		return SDL_CloseIO(static_cast<SDL_IOStream *>(p_source)) ? 0 : EOF;
+	}
+
+	static long VorbisTell(void *p_source)
+	{
+		return static_cast<long>(SDL_TellIO(static_cast<SDL_IOStream *>(p_source)));
+	}
+
+	MusicStream::MusicStream() = default;
+
+	MusicStream::~MusicStream()
+	{
+		Shutdown();
+	}
+
+	bool MusicStream::OpenVorbisFile(const char *p_path, OggVorbis_File *p_outFile)
+	{
+		SDL_IOStream *io = SDL_IOFromFile(p_path, "rb");
+		if (!io)
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_AUDIO, "MusicStream: Failed to open '%s': %s", p_path, SDL_GetError());
+			return false;
+		}
+
+		ov_callbacks callbacks{ VorbisRead, VorbisSeek, VorbisClose, VorbisTell };
+		if (ov_open_callbacks(io, p_outFile, nullptr, 0, callbacks) != 0)
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_AUDIO, "MusicStream: '%s' is not a valid Ogg Vorbis file", p_path);
+			SDL_CloseIO(io);
+			return false;
+		}
+
+		return true;
+	}
+
+	bool MusicStream::Init(const Music &p_music, const SDL_AudioSpec &p_mixSpec, bool p_loop)
+	{
+		if (!OpenVorbisFile(p_music.filePath.c_str(), &m_vorbisFile))
+			return false;
+
+		m_vorbisOpen = true;
+		m_audioSpec = p_music.audioSpec;
+		m_mixSpec = p_mixSpec;
+		m_loop = p_loop;
+
+		m_ringSamples = RING_BUFFER_FRAMES * m_mixSpec.channels;
+		m_ring.resize(m_ringSamples);
+		m_decodeBuffer.resize(DECODE_CHUNK_SIZE);
+
+		m_drained = SDL_CreateSemaphore(0);
+		if (!m_drained)
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_AUDIO, "MusicStream: Failed to create semaphore: %s", SDL_GetError());
+			return false;
+		}
+
+		// Never bound to a device, only used to convert the decoded PCM
+
+		m_converter = SDL_CreateAudioStream(&m_audioSpec, &m_mixSpec);
+		if (!m_converter)
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_AUDIO, "MusicStream: Failed to create audio stream: %s", SDL_GetError());
+			return false;
+		}
+
+		// Fill the ring before the mixer starts pulling so playback starts clean
+
+		Decode();
+
+		m_decoderThread = SDL_CreateThread(DecoderMain, "music_decoder", this);
+		if (!m_decoderThread)
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_AUDIO, "MusicStream: Failed to create decoder thread: %s", SDL_GetError());
+			return false;
+		}
+
+		return true;
+	}
+
+	void MusicStream::Shutdown()
+	{
+		if (m_decoderThread)
+		{
+			m_quit = true;
+			SDL_SignalSemaphore(m_drained);
+			SDL_WaitThread(m_decoderThread, nullptr);
+			m_decoderThread = nullptr;
+		}
+
+		if (m_converter)
+		{
+			SDL_DestroyAudioStream(m_converter);
+			m_converter = nullptr;
+		}
+
+		if (m_drained)
+		{
+			SDL_DestroySemaphore(m_drained);
+			m_drained = nullptr;
+		}
+
+		if (m_vorbisOpen)
+		{
+			ov_clear(&m_vorbisFile);
+			m_vorbisOpen = false;
+		}
+
+		m_ring.clear();
+		m_ring.shrink_to_fit();
+	}
+
+	uint32_t MusicStream::Read(float *p_out, uint32_t p_frames)
+	{
+		// Called from the mix callback
+
+		if (m_paused || m_ringSamples == 0)
+			return 0;
+
+		const uint32_t channels = m_mixSpec.channels;
+
+		uint64_t readPos = m_readPos.load(std::memory_order_relaxed);
+		uint64_t discardPos = m_discardPos.load(std::memory_order_acquire);
+		if (readPos < discardPos)
+			readPos = discardPos;
+
+		uint64_t available = m_writePos.load(std::memory_order_acquire) - readPos;
+		uint64_t toRead = SDL_min(available, static_cast<uint64_t>(p_frames) * channels);
+		uint64_t read = 0;
+
+		// Copy out in at most two pieces, around the end of the ring
+
+		while (read < toRead)
+		{
+			uint32_t offset = static_cast<uint32_t>((readPos + read) % m_ringSamples);
+			uint32_t size = static_cast<uint32_t>(SDL_min(toRead - read, static_cast<uint64_t>(m_ringSamples - offset)));
+
+			SDL_memcpy(p_out + read, m_ring.data() + offset, size * sizeof(float));
+
+			read += size;
+		}
+
+		m_readPos.store(readPos + read, std::memory_order_release);
+
+		SDL_SignalSemaphore(m_drained);
+
+		return static_cast<uint32_t>(read / channels);
+	}
+
+	void MusicStream::Seek(double p_seconds)
+	{
+		m_seekFrame = static_cast<int64_t>(SDL_max(p_seconds, 0.0) * m_audioSpec.freq);
+		SDL_SignalSemaphore(m_drained);
+	}
+
+	void MusicStream::Pause()
+	{
+		m_paused = true;
+	}
+
+	void MusicStream::Resume()
+	{
+		m_paused = false;
+	}
+
+	bool MusicStream::IsFinished() const
+	{
+		return m_decodeFinished && m_readPos == m_writePos;
+	}
+
+	int MusicStream::DecoderMain(void *p_data)
+	{
+		auto *self = static_cast<MusicStream *>(p_data);
+
+		while (!self->m_quit)
+		{
+			int64_t seekFrame = self->m_seekFrame.exchange(-1);
+			if (seekFrame >= 0)
+				self->ApplySeek(seekFrame);
+
+			self->Decode();
+
+			// Sleep until the mixer drained part of the ring. The timeout covers a
+			// stream that got paused with a full ring.
+
+			SDL_WaitSemaphoreTimeout(self->m_drained, 50);
+		}
+
+		return 0;
+	}
+
+	void MusicStream::Decode()
+	{
+		while (!m_decodeFinished && !m_quit && m_seekFrame < 0)
+		{
+			uint64_t writePos = m_writePos.load(std::memory_order_relaxed);
+			uint64_t readPos = SDL_max(m_readPos.load(std::memory_order_acquire), m_discardPos.load(std::memory_order_relaxed));
+			uint64_t freeSamples = m_ringSamples - (writePos - readPos);
+
+			// Write straight into the ring, never past its end. Offsets are always
+			// frame aligned since the ring holds a whole number of frames.
+
+			uint32_t offset = static_cast<uint32_t>(writePos % m_ringSamples);
+			uint32_t space = static_cast<uint32_t>(SDL_min(freeSamples, static_cast<uint64_t>(m_ringSamples - offset)));
+			space -= space % m_mixSpec.channels;
+
+			if (space == 0)
+				break;
+
+			int bytes = SDL_GetAudioStreamData(m_converter, m_ring.data() + offset, static_cast<int>(space * sizeof(float)));
+			if (bytes > 0)
+			{
+				m_writePos.store(writePos + bytes / sizeof(float), std::memory_order_release);
+				continue;
+			}
+
+			if (m_endOfFile)
+			{
+				m_decodeFinished = true;
+				break;
+			}
+
+			// Converter ran dry, decode the next chunk into it
+
+			int bitstream;
+			long decoded = ov_read(&m_vorbisFile, m_decodeBuffer.data(), DECODE_CHUNK_SIZE, 0, 2, 1, &bitstream);
+
+			if (decoded > 0)
+			{
+				SDL_PutAudioStreamData(m_converter, m_decodeBuffer.data(), static_cast<int>(decoded));
+			}
+			else if (decoded == 0)
+			{
+				// End of the track, jump back to the start without draining the ring
+				// so the loop point is seamless
+
+				if (m_loop && ov_pcm_seek(&m_vorbisFile, 0) == 0)
+					continue;
+
+				SDL_FlushAudioStream(m_converter);
+				m_endOfFile = true;
+			}
+			else if (decoded != OV_HOLE)
+			{
+				SDL_LogError(SDL_LOG_CATEGORY_AUDIO, "MusicStream: Error decoding vorbis stream (%ld)", decoded);
+				SDL_FlushAudioStream(m_converter);
+				m_endOfFile = true;
+			}
+		}
+	}
+
+	void MusicStream::ApplySeek(int64_t p_frame)
+	{
+		// Runs on the decoder thread. Whatever is still buffered gets skipped by
+		// the reader instead of cleared here, the ring is only ever advanced by it.
+
+		int64_t totalFrames = ov_pcm_total(&m_vorbisFile, -1);
+		if (totalFrames > 0)
+			p_frame = m_loop ? p_frame % totalFrames : SDL_min(p_frame, totalFrames);
+
+		ov_pcm_seek(&m_vorbisFile, p_frame);
+		SDL_ClearAudioStream(m_converter);
+
+		m_discardPos.store(m_writePos.load(std::memory_order_relaxed), std::memory_order_release);
+		m_endOfFile = false;
+		m_decodeFinished = false;
+	}
+}
@@ -0,0 +1,196 @@
+#include "pool_allocator.hpp"
+
+#include <algorithm>
+
+namespace lum
+{
+    PoolAllocator::PoolAllocator(const char *p_name, size_t p_slotSize, size_t p_alignment, uint32_t p_slotsPerSlab)
+        : m_name(p_name), m_alignment(SDL_max(p_alignment, alignof(void *))), m_slotsPerSlab(SDL_max(p_slotsPerSlab, 1u))
+    {
+        // Free slots hold the next pointer, so a slot is at least a pointer and
+        // every slot stays aligned
+
+        const size_t size = SDL_max(p_slotSize, sizeof(void *));
+        m_slotSize = (size + m_alignment - 1) & ~(m_alignment - 1);
+
+        Registry().push_back(this);
+    }
+
+    PoolAllocator::~PoolAllocator()
+    {
+        if (m_used > 0)
+            SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "PoolAllocator: %s destroyed with %u live objects", m_name, m_used);
+
+        for (auto &slab : m_slabs)
+            SDL_aligned_free(slab.memory);
+
+        auto &registry = Registry();
+        registry.erase(std::remove(registry.begin(), registry.end(), this), registry.end());
+    }
+
+    void *PoolAllocator::Allocate()
+    {
+        while (m_firstFree < m_slabs.size() && !m_slabs[m_firstFree].freeList)
+            m_firstFree++;
+
+        const size_t index = m_firstFree < m_slabs.size() ? m_firstFree : AddSlab();
+        if (index == m_slabs.size())
+            return nullptr;
+
+        Slab &slab = m_slabs[index];
+
+        void *slot = slab.freeList;
+        slab.freeList = *static_cast<void **>(slot);
+        slab.used++;
+
+        m_used++;
+        m_peak = SDL_max(m_peak, m_used);
+
+        return slot;
+    }
+
+    void PoolAllocator::Free(void *p_ptr)
+    {
+        if (!p_ptr)
+            return;
+
+        const size_t index = FindSlab(p_ptr);
+        if (index == m_slabs.size())
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "PoolAllocator: %s doesn't own %p", m_name, p_ptr);
+            return;
+        }
+
+        Slab &slab = m_slabs[index];
+
+        *static_cast<void **>(p_ptr) = slab.freeList;
+        slab.freeList = p_ptr;
+        slab.used--;
+
+        m_used--;
+        m_firstFree = SDL_min(m_firstFree, index);
+
+        if (m_autoCompact > 0.0f && slab.used == 0 && m_used < m_autoCompact * m_slabs.size() * m_slotsPerSlab)
+            Compact();
+    }
+
+    void PoolAllocator::Compact(uint32_t p_keepEmpty)
+    {
+        uint32_t kept = 0;
+
+        // Walk from the back so the slabs that stay are the low ones allocations
+        // are served from first
+        for (size_t i = m_slabs.size(); i-- > 0;)
+        {
+            if (m_slabs[i].used > 0)
+                continue;
+
+            if (kept < p_keepEmpty)
+            {
+                kept++;
+                continue;
+            }
+
+            SDL_aligned_free(m_slabs[i].memory);
+            m_slabs.erase(m_slabs.begin() + i);
+        }
+
+        m_firstFree = 0;
+    }
+
+    void PoolAllocator::SetAutoCompactThreshold(float p_occupancy)
+    {
+        m_autoCompact = SDL_clamp(p_occupancy, 0.0f, 1.0f);
+    }
+
+    PoolStats PoolAllocator::GetStats() const
+    {
+        PoolStats stats{};
+        stats.name = m_name;
+        stats.slotSize = m_slotSize;
+        stats.slabCount = static_cast<uint32_t>(m_slabs.size());
+        stats.capacity = stats.slabCount * m_slotsPerSlab;
+        stats.used = m_used;
+        stats.peak = m_peak;
+
+        uint32_t stranded = 0;
+        for (const auto &slab : m_slabs)
+        {
+            if (slab.used > 0)
+                stranded += m_slotsPerSlab - slab.used;
+        }
+
+        if (stats.capacity > 0)
+        {
+            stats.occupancy = static_cast<float>(m_used) / stats.capacity;
+            stats.fragmentation = static_cast<float>(stranded) / stats.capacity;
+        }
+
+        return stats;
+    }
+
+    const std::vector<PoolAllocator *> &PoolAllocator::GetAll()
+    {
+        return Registry();
+    }
+
+    size_t PoolAllocator::FindSlab(const void *p_ptr) const
+    {
+        const auto *ptr = static_cast<const uint8_t *>(p_ptr);
+        const size_t slabBytes = m_slotSize * m_slotsPerSlab;
+
+        auto it = std::upper_bound(m_slabs.begin(), m_slabs.end(), ptr, [](const uint8_t *p_value, const Slab &p_slab)
+        {
+            return std::less<const uint8_t *>()(p_value, p_slab.memory);
+        });
+
+        if (it == m_slabs.begin())
+            return m_slabs.size();
+
+        --it;
+        if (ptr >= it->memory + slabBytes)
+            return m_slabs.size();
+
+        return static_cast<size_t>(it - m_slabs.begin());
+    }
+
+    size_t PoolAllocator::AddSlab()
+    {
+        Slab slab{};
+        slab.memory = static_cast<uint8_t *>(SDL_aligned_alloc(m_alignment, m_slotSize * m_slotsPerSlab));
+
+        if (!slab.memory)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "PoolAllocator: %s failed to allocate a slab", m_name);
+            return m_slabs.size();
+        }
+
+        // Thread the free list front to back so slots get handed out in address order
+
+        for (uint32_t i = m_slotsPerSlab; i-- > 0;)
+        {
+            void *slot = slab.memory + i * m_slotSize;
+            *static_cast<void **>(slot) = slab.freeList;
+            slab.freeList = slot;
+        }
+
+        auto it = std::upper_bound(m_slabs.begin(), m_slabs.end(), slab.memory, [](const uint8_t *p_value, const Slab &p_slab)
+        {
+            return std::less<const uint8_t *>()(p_value, p_slab.memory);
+        });
+
+        const size_t index = static_cast<size_t>(it - m_slabs.begin());
+        m_slabs.insert(it, slab);
+
+        // A new slab below m_firstFree has room, and ones above just shifted up
+        m_firstFree = SDL_min(m_firstFree, index);
+
+        return index;
+    }
+
+    std::vector<PoolAllocator *> &PoolAllocator::Registry()
+    {
+        static std::vector<PoolAllocator *> registry{};
+        return registry;
+    }
+}
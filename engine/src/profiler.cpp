@@ -0,0 +1,246 @@
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+
+#include "engine.hpp"
+
+namespace lum
+{
+    Profiler::Profiler() = default;
+
+    Profiler::~Profiler()
+    {
+        if (m_mutex)
+            SDL_DestroyMutex(m_mutex);
+    }
+
+    void Profiler::BeginCapture()
+    {
+        if (!m_mutex)
+            m_mutex = SDL_CreateMutex();
+
+        SDL_LockMutex(m_mutex);
+        m_events.clear();
+        m_captureStartNS = SDL_GetTicksNS();
+        m_captureEndNS = 0;
+        SDL_UnlockMutex(m_mutex);
+
+        m_capturing = true;
+    }
+
+    void Profiler::EndCapture()
+    {
+        m_capturing = false;
+        m_captureEndNS = SDL_GetTicksNS();
+    }
+
+    bool Profiler::IsCapturing() const
+    {
+        return m_capturing;
+    }
+
+    void Profiler::Record(ProfilePhase p_phase, const char *p_name, uint64_t p_startNS, uint64_t p_durationNS)
+    {
+        if (!IsCapturing())
+            return;
+
+        SDL_LockMutex(m_mutex);
+        m_events.push_back(ProfileEvent{ p_phase, p_name ? p_name : "", p_startNS, p_durationNS, SDL_GetCurrentThreadID() });
+        SDL_UnlockMutex(m_mutex);
+    }
+
+    void Profiler::LogReport() const
+    {
+        constexpr size_t phaseCount = static_cast<size_t>(ProfilePhase::COUNT);
+
+        struct AssetCost
+        {
+            std::string name{};
+            uint64_t    phaseNS[phaseCount]{};
+            uint64_t    totalNS{};
+        };
+
+        const uint64_t captureNS = (m_captureEndNS ? m_captureEndNS : SDL_GetTicksNS()) - m_captureStartNS;
+
+        SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Profiler: Startup took %.2f ms (%zu events)",
+            static_cast<double>(captureNS) / SDL_NS_PER_MS, m_events.size());
+
+        // Module init and scene setup scopes contain the asset loads below them,
+        // so they're listed in order instead of being summed with the rest
+
+        SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Profiler: -- Startup phases (inclusive)");
+
+        for (const auto &event : m_events)
+        {
+            if (event.phase != ProfilePhase::INIT && event.phase != ProfilePhase::SCENE_SETUP)
+                continue;
+
+            SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Profiler: %9.2f ms  %-12s %s",
+                static_cast<double>(event.durationNS) / SDL_NS_PER_MS, GetPhaseName(event.phase), event.name.c_str());
+        }
+
+        // Per asset breakdown, most expensive first
+
+        std::vector<AssetCost> assets{};
+        std::unordered_map<std::string, size_t> assetIndices{};
+        uint64_t phaseTotalNS[phaseCount]{};
+
+        for (const auto &event : m_events)
+        {
+            if (event.phase == ProfilePhase::INIT || event.phase == ProfilePhase::SCENE_SETUP)
+                continue;
+
+            auto it = assetIndices.find(event.name);
+            if (it == assetIndices.end())
+            {
+                it = assetIndices.emplace(event.name, assets.size()).first;
+                assets.push_back(AssetCost{ event.name });
+            }
+
+            auto &asset = assets[it->second];
+            asset.phaseNS[static_cast<size_t>(event.phase)] += event.durationNS;
+            asset.totalNS += event.durationNS;
+
+            phaseTotalNS[static_cast<size_t>(event.phase)] += event.durationNS;
+        }
+
+        std::sort(assets.begin(), assets.end(), [](const AssetCost &p_a, const AssetCost &p_b) { return p_a.totalNS > p_b.totalNS; });
+
+        SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Profiler: -- Assets by cost");
+
+        for (const auto &asset : assets)
+        {
+            std::string breakdown{};
+            for (size_t i = 0; i < phaseCount; i++)
+            {
+                if (asset.phaseNS[i] == 0)
+                    continue;
+
+                char part[64];
+                SDL_snprintf(part, sizeof(part), "  %s %.2f", GetPhaseName(static_cast<ProfilePhase>(i)), static_cast<double>(asset.phaseNS[i]) / SDL_NS_PER_MS);
+                breakdown += part;
+            }
+
+            SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Profiler: %9.2f ms  %-24s%s",
+                static_cast<double>(asset.totalNS) / SDL_NS_PER_MS, asset.name.c_str(), breakdown.c_str());
+        }
+
+        SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Profiler: -- Totals per phase");
+
+        for (size_t i = 0; i < phaseCount; i++)
+        {
+            if (phaseTotalNS[i] == 0)
+                continue;
+
+            SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Profiler: %9.2f ms  %s",
+                static_cast<double>(phaseTotalNS[i]) / SDL_NS_PER_MS, GetPhaseName(static_cast<ProfilePhase>(i)));
+        }
+    }
+
+    bool Profiler::WriteTrace(const char *p_path) const
+    {
+        // Chrome trace event format, opens in chrome://tracing or ui.perfetto.dev
+
+        SDL_IOStream *file = SDL_IOFromFile(p_path, "w");
+        if (!file)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Profiler: Failed to open trace file %s: %s", p_path, SDL_GetError());
+            return false;
+        }
+
+        SDL_IOprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+        for (size_t i = 0; i < m_events.size(); i++)
+        {
+            const auto &event = m_events[i];
+
+            SDL_IOprintf(file, "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%llu}%s\n",
+                EscapeJson(event.name).c_str(), GetPhaseName(event.phase),
+                static_cast<double>(event.startNS - m_captureStartNS) / SDL_NS_PER_US,
+                static_cast<double>(event.durationNS) / SDL_NS_PER_US,
+                static_cast<unsigned long long>(event.threadId),
+                (i + 1 < m_events.size()) ? "," : "");
+        }
+
+        SDL_IOprintf(file, "]}\n");
+
+        if (!SDL_CloseIO(file))
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Profiler: Failed to write trace file %s: %s", p_path, SDL_GetError());
+            return false;
+        }
+
+        SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Profiler: Trace written to %s", p_path);
+
+        return true;
+    }
+
+    std::string Profiler::EscapeJson(const std::string &p_str)
+    {
+        std::string escaped{};
+        escaped.reserve(p_str.size());
+
+        for (const char c : p_str)
+        {
+            if (c == '"' || c == '\\')
+            {
+                escaped += '\\';
+                escaped += c;
+            }
+            else if (static_cast<unsigned char>(c) < 0x20)
+            {
+                char code[8];
+                SDL_snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned char>(c));
+                escaped += code;
+            }
+            else
+            {
+                escaped += c;
+            }
+        }
+
+        return escaped;
+    }
+
+    const char *Profiler::GetPhaseName(ProfilePhase p_phase)
+    {
+        switch (p_phase)
+        {
+        case ProfilePhase::INIT:
+            return "init";
+        case ProfilePhase::FILE_READ:
+            return "file_read";
+        case ProfilePhase::DECODE:
+            return "decode";
+        case ProfilePhase::FORMAT_CONVERT:
+            return "convert";
+        case ProfilePhase::GPU_UPLOAD:
+            return "gpu_upload";
+        case ProfilePhase::SHADER_COMPILE:
+            return "shader_compile";
+        case ProfilePhase::PIPELINE_CREATE:
+            return "pipeline";
+        case ProfilePhase::SCENE_SETUP:
+            return "scene";
+        default:
+            return "unknown";
+        }
+    }
+
+    // PROFILE SCOPE
+    //
+
+    ProfileScope::ProfileScope(ProfilePhase p_phase, const char *p_name)
+        : m_phase(p_phase), m_name(p_name), m_active(Engine::Get().profiler.IsCapturing())
+    {
+        if (m_active)
+            m_startNS = SDL_GetTicksNS();
+    }
+
+    ProfileScope::~ProfileScope()
+    {
+        if (m_active)
+            Engine::Get().profiler.Record(m_phase, m_name, m_startNS, SDL_GetTicksNS() - m_startNS);
+    }
+}
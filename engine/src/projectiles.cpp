@@ -0,0 +1,337 @@
+#include "projectiles.hpp"
+
+#include <SDL3/SDL.h>
+
+#include "collision.hpp"
+#include "renderer.hpp"
+#include "simd.hpp"
+#include "snapshot.hpp"
+
+namespace lum
+{
+    // Every array starts on its own cache line
+    static constexpr uint32_t PROJECTILE_ARRAYS = 9;
+    static constexpr uint32_t PROJECTILE_STRIDE_ALIGN = 64 / sizeof(float);
+
+    ProjectileManager::ProjectileManager() = default;
+
+    ProjectileManager::~ProjectileManager()
+    {
+        SDL_aligned_free(m_px);
+    }
+
+    bool ProjectileManager::Reserve(uint32_t p_capacity)
+    {
+        if (p_capacity <= m_capacity)
+            return true;
+
+        if (p_capacity > MAX_CAPACITY)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Projectiles: Can't hold %u projectiles, the limit is %u", p_capacity, MAX_CAPACITY);
+            return false;
+        }
+
+        const uint32_t capacity = SDL_max(p_capacity, MIN_CAPACITY);
+        const uint32_t stride = (capacity + PROJECTILE_STRIDE_ALIGN - 1) & ~(PROJECTILE_STRIDE_ALIGN - 1);
+
+        float *block = static_cast<float *>(SDL_aligned_alloc(64, sizeof(float) * stride * PROJECTILE_ARRAYS));
+        if (!block)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Projectiles: Failed to allocate %u projectiles", capacity);
+            return false;
+        }
+
+        float *arrays[PROJECTILE_ARRAYS]{};
+        for (uint32_t a = 0; a < PROJECTILE_ARRAYS; a++)
+            arrays[a] = block + stride * a;
+
+        // Live bullets move over to the new arrays in the same order
+
+        if (m_count > 0)
+        {
+            const float *old[PROJECTILE_ARRAYS] = { m_px, m_py, m_vx, m_vy, m_ax, m_ay, m_turnRate, m_life, m_frame };
+            for (uint32_t a = 0; a < PROJECTILE_ARRAYS; a++)
+                SDL_memcpy(arrays[a], old[a], sizeof(float) * m_count);
+        }
+
+        SDL_aligned_free(m_px);
+
+        m_capacity = capacity;
+        m_px = arrays[0];
+        m_py = arrays[1];
+        m_vx = arrays[2];
+        m_vy = arrays[3];
+        m_ax = arrays[4];
+        m_ay = arrays[5];
+        m_turnRate = arrays[6];
+        m_life = arrays[7];
+        m_frame = arrays[8];
+
+        m_keep.resize(m_capacity);
+
+        m_stats.capacity = m_capacity;
+
+        return true;
+    }
+
+    void ProjectileManager::SetBounds(glm::vec2 p_min, glm::vec2 p_max, float p_margin)
+    {
+        m_min = p_min - glm::vec2(p_margin);
+        m_max = p_max + glm::vec2(p_margin);
+    }
+
+    bool ProjectileManager::Spawn(glm::vec2 p_position, glm::vec2 p_velocity, glm::vec2 p_acceleration, float p_turnRate, float p_lifetime, float p_frame)
+    {
+        if (m_count == m_capacity)
+        {
+            if (m_capacity == MAX_CAPACITY || !Reserve(SDL_min(SDL_max(m_capacity * 2, MIN_CAPACITY), MAX_CAPACITY)))
+                return false;
+        }
+
+        const uint32_t i = m_count++;
+
+        m_px[i] = p_position.x;
+        m_py[i] = p_position.y;
+        m_vx[i] = p_velocity.x;
+        m_vy[i] = p_velocity.y;
+        m_ax[i] = p_acceleration.x;
+        m_ay[i] = p_acceleration.y;
+        m_turnRate[i] = p_turnRate;
+        m_life[i] = p_lifetime;
+        m_frame[i] = p_frame;
+
+        m_spawned++;
+
+        return true;
+    }
+
+    uint32_t ProjectileManager::Fire(const EmitterPattern &p_pattern, glm::vec2 p_origin, float p_angle)
+    {
+        const uint32_t bullets = SDL_max(p_pattern.bullets, 1u);
+
+        // A full circle would put the last bullet on top of the first, a fan
+        // reaches both edges
+
+        const bool fullCircle = p_pattern.spread >= 360.0f;
+        const float step = bullets > 1 ? p_pattern.spread / static_cast<float>(fullCircle ? bullets : bullets - 1) : 0.0f;
+        const float start = fullCircle || bullets == 1 ? p_angle : p_angle - p_pattern.spread * 0.5f;
+        const float turnRate = glm::radians(p_pattern.turnRate);
+
+        uint32_t fired = 0;
+        for (uint32_t b = 0; b < bullets; b++)
+        {
+            const float angle = glm::radians(start + step * static_cast<float>(b));
+            const glm::vec2 direction(SDL_cosf(angle), SDL_sinf(angle));
+
+            if (!Spawn(p_origin, direction * p_pattern.speed, direction * p_pattern.acceleration, turnRate, p_pattern.lifetime, p_pattern.frame))
+                break;
+
+            fired++;
+        }
+
+        return fired;
+    }
+
+    void ProjectileManager::UpdateEmitter(Emitter &p_emitter, float p_delta)
+    {
+        if (!p_emitter.active)
+            return;
+
+        const EmitterPattern &pattern = p_emitter.pattern;
+
+        p_emitter.timer -= p_delta;
+
+        while (p_emitter.timer <= 0.0f)
+        {
+            float angle = pattern.angle;
+
+            if (pattern.type == EmitterPatternType::SPIRAL)
+            {
+                angle += pattern.spin * static_cast<float>(p_emitter.volley);
+            }
+            else if (pattern.type == EmitterPatternType::AIMED)
+            {
+                const glm::vec2 toTarget = p_emitter.target - p_emitter.position;
+                if (toTarget.x != 0.0f || toTarget.y != 0.0f)
+                    angle += glm::degrees(SDL_atan2f(toTarget.y, toTarget.x));
+            }
+
+            Fire(pattern, p_emitter.position, angle);
+            p_emitter.volley++;
+
+            // No interval means one volley per update
+            if (pattern.interval <= 0.0f)
+            {
+                p_emitter.timer = 0.0f;
+                break;
+            }
+
+            p_emitter.timer += pattern.interval;
+        }
+    }
+
+    void ProjectileManager::Kill(uint32_t p_index)
+    {
+        if (p_index < m_count)
+            m_life[p_index] = 0.0f;
+    }
+
+    void ProjectileManager::Clear()
+    {
+        m_count = 0;
+    }
+
+    void ProjectileManager::Update(float p_delta)
+    {
+        const uint64_t start = SDL_GetTicksNS();
+
+        simd::Projectiles proj{};
+        proj.px = m_px;
+        proj.py = m_py;
+        proj.vx = m_vx;
+        proj.vy = m_vy;
+        proj.ax = m_ax;
+        proj.ay = m_ay;
+        proj.turnRate = m_turnRate;
+        proj.life = m_life;
+
+        simd::IntegrateProjectiles(proj, p_delta, m_count);
+        m_lastDelta = p_delta;
+
+        const uint32_t before = m_count;
+        Compact();
+
+        m_stats.live = m_count;
+        m_stats.peak = SDL_max(m_stats.peak, before);
+        m_stats.despawned = before - m_count;
+        m_stats.updateMS = static_cast<float>(SDL_GetTicksNS() - start) / SDL_NS_PER_MS;
+        m_stats.spawned = m_spawned;
+        m_spawned = 0;
+    }
+
+    void ProjectileManager::AddColliders(CollisionWorld &p_world, float p_radius, uint32_t p_layers, uint32_t p_mask) const
+    {
+        for (uint32_t i = 0; i < m_count; i++)
+            p_world.AddCircle(glm::vec2(m_px[i], m_py[i]), p_radius, p_layers, p_mask, i);
+    }
+
+    void ProjectileManager::Draw(Renderer &p_renderer, StringId p_textureTag, int p_horizontalFrames, uint8_t p_layer, float p_interpolation) const
+    {
+        QuadInstance *instances = p_renderer.AddInstancedQuads(p_textureTag, p_horizontalFrames, p_layer, m_count);
+        if (!instances)
+            return;
+
+        WriteInstances(instances, p_interpolation);
+    }
+
+    void ProjectileManager::WriteInstances(QuadInstance *p_instances, float p_interpolation) const
+    {
+        // Position only moves by the final velocity over an update, so the
+        // previous one is a step back along it and needs no extra storage.
+        // Bullets spawned since then haven't moved, the spawns are the last
+        // ones in the arrays and stay put.
+
+        const float back = m_lastDelta * (1.0f - p_interpolation);
+        const uint32_t stepped = m_count - SDL_min(m_spawned, m_count);
+
+        // Mapped GPU memory, write every field in order and never read it back
+
+        for (uint32_t i = 0; i < stepped; i++)
+        {
+            p_instances[i].position = glm::vec2(m_px[i] - m_vx[i] * back, m_py[i] - m_vy[i] * back);
+            p_instances[i].heading = glm::vec2(m_vx[i], m_vy[i]);
+            p_instances[i].frame = m_frame[i];
+        }
+
+        for (uint32_t i = stepped; i < m_count; i++)
+        {
+            p_instances[i].position = glm::vec2(m_px[i], m_py[i]);
+            p_instances[i].heading = glm::vec2(m_vx[i], m_vy[i]);
+            p_instances[i].frame = m_frame[i];
+        }
+    }
+
+    void ProjectileManager::SaveState(SnapshotWriter &p_writer) const
+    {
+        p_writer.WriteValue(m_count);
+        p_writer.WriteValue(m_spawned);
+        p_writer.WriteValue(m_lastDelta);
+        p_writer.WriteValue(m_min);
+        p_writer.WriteValue(m_max);
+
+        const size_t bytes = sizeof(float) * m_count;
+        for (const float *array : { m_px, m_py, m_vx, m_vy, m_ax, m_ay, m_turnRate, m_life, m_frame })
+            p_writer.Write(array, bytes);
+    }
+
+    bool ProjectileManager::LoadState(SnapshotReader &p_reader)
+    {
+        uint32_t count{};
+        if (!p_reader.ReadValue(count) || !Reserve(count))
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Projectiles: Snapshot has more bullets than the pool holds");
+            return false;
+        }
+
+        bool valid = p_reader.ReadValue(m_spawned) && p_reader.ReadValue(m_lastDelta);
+        valid = valid && p_reader.ReadValue(m_min) && p_reader.ReadValue(m_max);
+
+        const size_t bytes = sizeof(float) * count;
+        for (float *array : { m_px, m_py, m_vx, m_vy, m_ax, m_ay, m_turnRate, m_life, m_frame })
+            valid = valid && p_reader.Read(array, bytes);
+
+        m_count = valid ? count : 0;
+        m_stats.live = m_count;
+
+        return valid;
+    }
+
+    uint32_t ProjectileManager::GetCount() const
+    {
+        return m_count;
+    }
+
+    glm::vec2 ProjectileManager::GetPosition(uint32_t p_index) const
+    {
+        return glm::vec2(m_px[p_index], m_py[p_index]);
+    }
+
+    ProjectileStats ProjectileManager::GetStats() const
+    {
+        return m_stats;
+    }
+
+    void ProjectileManager::Compact()
+    {
+        const uint32_t kept = static_cast<uint32_t>(simd::FindLiveProjectiles(m_px, m_py, m_life,
+            m_min.x, m_min.y, m_max.x, m_max.y, m_keep.data(), m_count));
+
+        if (kept == m_count)
+            return;
+
+        // Everything before the first dead bullet is already in place
+
+        uint32_t write = 0;
+        while (m_keep[write])
+            write++;
+
+        for (uint32_t read = write + 1; read < m_count; read++)
+        {
+            if (!m_keep[read])
+                continue;
+
+            m_px[write] = m_px[read];
+            m_py[write] = m_py[read];
+            m_vx[write] = m_vx[read];
+            m_vy[write] = m_vy[read];
+            m_ax[write] = m_ax[read];
+            m_ay[write] = m_ay[read];
+            m_turnRate[write] = m_turnRate[read];
+            m_life[write] = m_life[read];
+            m_frame[write] = m_frame[read];
+            write++;
+        }
+
+        m_count = kept;
+    }
+}
@@ -1,6 +1,7 @@
 #include "renderer.hpp"
 
 #include <array>
+#include <cstddef>
 #include <algorithm>
 
 #include <glm/gtc/matrix_transform.hpp>
@@ -28,8 +29,11 @@ namespace lum
         windowDesc.size = vec2(1280, 720);
         windowDesc.resolution = vec2(240, 360);
 
-        if (!CreateWindowAndGPUDevice())
-            return false;
+        {
+            ProfileScope scope(ProfilePhase::INIT, "Window and GPU device");
+            if (!CreateWindowAndGPUDevice())
+                return false;
+        }
 
         auto &assetManager = Engine::Get().assetManager;
 
@@ -38,11 +42,20 @@ namespace lum
         assetManager.LoadShader("color_quad_frag", "shaders/color_quad.frag");
         assetManager.LoadShader("texture_quad_vert", "shaders/texture_quad.vert");
         assetManager.LoadShader("texture_quad_frag", "shaders/texture_quad.frag");
+        assetManager.LoadShader("instanced_quad_vert", "shaders/instanced_quad.vert");
+
+        // Pipelines are rebuilt from these on hot reload, keep them resident
+
+        m_shaderHandles.push_back(assetManager.AcquireShader("color_quad_frag"_sid));
+        m_shaderHandles.push_back(assetManager.AcquireShader("texture_quad_vert"_sid));
+        m_shaderHandles.push_back(assetManager.AcquireShader("texture_quad_frag"_sid));
+        m_shaderHandles.push_back(assetManager.AcquireShader("instanced_quad_vert"_sid));
 
         // Create graphics pipeline
 
         CreateGraphicsPipeline("color_quad", "texture_quad_vert", "color_quad_frag");
         CreateGraphicsPipeline("texture_quad", "texture_quad_vert", "texture_quad_frag");
+        CreateGraphicsPipeline("instanced_quad", "instanced_quad_vert", "texture_quad_frag", VertexLayout::QUAD_INSTANCED);
 
         // Create texture sampler
 
@@ -58,12 +71,21 @@ namespace lum
             return false;
         }
 
+        if (!SetupInstanceBuffers())
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_VIDEO, "Failed to setup instance buffers");
+            return false;
+        }
+
         if (!SetupRenderTargetSampler())
         {
             return false;
         }
 
-        ImGuiInit();
+        {
+            ProfileScope scope(ProfilePhase::INIT, "ImGui");
+            ImGuiInit();
+        }
 
         //
 
@@ -78,6 +100,8 @@ namespace lum
 
     void Renderer::Shutdown()
     {
+        m_shaderHandles.clear();
+
         ImGuiShutdown();
 
         SDL_ReleaseGPUTexture(gpuDevice, m_rtTexture);
@@ -88,6 +112,12 @@ namespace lum
         SDL_ReleaseGPUBuffer(gpuDevice, m_rtIndexBuffer);
         SDL_ReleaseGPUBuffer(gpuDevice, m_quadVertexBuffer);
         SDL_ReleaseGPUBuffer(gpuDevice, m_quadIndexBuffer);
+        SDL_ReleaseGPUBuffer(gpuDevice, m_instanceBuffer);
+
+        if (m_mappedInstances)
+            SDL_UnmapGPUTransferBuffer(gpuDevice, m_instanceTransferBuffer);
+
+        SDL_ReleaseGPUTransferBuffer(gpuDevice, m_instanceTransferBuffer);
 
         for (const auto &[_, pipelineInfo] : m_graphicsPipelines)
         {
@@ -136,6 +166,11 @@ namespace lum
             return false;
         }
 
+        // Instances were written straight into the transfer buffer during Draw,
+        // copy them over before any render pass starts
+
+        UploadInstances();
+
         SDL_GPUTexture *swapchainTexture;
         if (!SDL_WaitAndAcquireGPUSwapchainTexture(m_commandBuffer, m_window, &swapchainTexture, nullptr, nullptr))
         {
@@ -165,10 +200,19 @@ namespace lum
                 return a->layer < b->layer;
             });
 
-            // Drawing
+            std::stable_sort(m_instanceBatches.begin(), m_instanceBatches.end(), [](const auto &a, const auto &b) {
+                return a.layer < b.layer;
+            });
+
+            // Drawing, instanced batches go on top of the sprites on their layer
+
+            auto batch = m_instanceBatches.begin();
 
             for (auto &drawable : m_drawQueue)
             {
+                for (; batch != m_instanceBatches.end() && batch->layer < drawable->layer; ++batch)
+                    DrawInstanceBatch(*batch);
+
                 switch (drawable->drawableType)
                 {
                 case shmup::DrawableType::SPRITE:
@@ -180,6 +224,9 @@ namespace lum
                 }
             }
 
+            for (; batch != m_instanceBatches.end(); ++batch)
+                DrawInstanceBatch(*batch);
+
             SDL_EndGPURenderPass(m_renderPass);
 
             m_drawQueue.clear();
@@ -193,7 +240,7 @@ namespace lum
 
             m_renderPass = SDL_BeginGPURenderPass(m_commandBuffer, &colorTI, 1, nullptr);
 
-            SDL_BindGPUGraphicsPipeline(m_renderPass, m_graphicsPipelines[utils::HashStr32("texture_quad")].pipeline);
+            SDL_BindGPUGraphicsPipeline(m_renderPass, m_graphicsPipelines[TEXTURE_QUAD_PIPELINE].pipeline);
             SDL_SetGPUViewport(m_renderPass, &m_windowViewport);
 
             SDL_GPUBufferBinding vertexBinding = { m_rtVertexBuffer, 0 };
@@ -218,6 +265,8 @@ namespace lum
             SDL_EndGPURenderPass(m_renderPass);
         }
 
+        m_instanceBatches.clear();
+
         if (!SDL_SubmitGPUCommandBuffer(m_commandBuffer))
         {
             SDL_LogError(SDL_LOG_CATEGORY_GPU, "Failed to submit a gpu command buffer: %s", SDL_GetError());
@@ -232,17 +281,112 @@ namespace lum
         m_drawQueue.push_back(p_drawable);
     }
 
+    QuadInstance *Renderer::AddInstancedQuads(StringId p_textureTag, int p_horizontalFrames, uint8_t p_layer, uint32_t p_count)
+    {
+        if (p_count == 0)
+            return nullptr;
+
+        if (m_instanceCount + p_count > MAX_QUAD_INSTANCES)
+        {
+            SDL_LogWarn(SDL_LOG_CATEGORY_VIDEO, "Renderer: Out of quad instances, dropping a batch of %u", p_count);
+            return nullptr;
+        }
+
+        // Cycle so this frame's writes don't wait on the GPU reading the last one
+
+        if (!m_mappedInstances)
+        {
+            m_mappedInstances = static_cast<QuadInstance *>(SDL_MapGPUTransferBuffer(gpuDevice, m_instanceTransferBuffer, true));
+            if (!m_mappedInstances)
+            {
+                SDL_LogError(SDL_LOG_CATEGORY_GPU, "Failed to map instance transfer buffer: %s", SDL_GetError());
+                return nullptr;
+            }
+        }
+
+        m_instanceBatches.push_back(InstanceBatch{ p_textureTag, p_horizontalFrames, p_layer, m_instanceCount, p_count });
+
+        QuadInstance *instances = m_mappedInstances + m_instanceCount;
+        m_instanceCount += p_count;
+
+        return instances;
+    }
+
+    void Renderer::UploadInstances()
+    {
+        if (!m_mappedInstances)
+            return;
+
+        SDL_UnmapGPUTransferBuffer(gpuDevice, m_instanceTransferBuffer);
+        m_mappedInstances = nullptr;
+
+        SDL_GPUCopyPass *copyPass = SDL_BeginGPUCopyPass(m_commandBuffer);
+
+        SDL_GPUTransferBufferLocation instanceBufferLoc{};
+        instanceBufferLoc.transfer_buffer = m_instanceTransferBuffer;
+        instanceBufferLoc.offset = 0;
+
+        SDL_GPUBufferRegion instanceBufferReg{};
+        instanceBufferReg.buffer = m_instanceBuffer;
+        instanceBufferReg.offset = 0;
+        instanceBufferReg.size = sizeof(QuadInstance) * m_instanceCount;
+
+        SDL_UploadToGPUBuffer(copyPass, &instanceBufferLoc, &instanceBufferReg, true);
+
+        SDL_EndGPUCopyPass(copyPass);
+
+        m_instanceCount = 0;
+    }
+
+    void Renderer::DrawInstanceBatch(const InstanceBatch &p_batch)
+    {
+        Texture *texture = Engine::Get().assetManager.GetTexture(p_batch.textureTag);
+        if (!texture)
+            return;
+
+        SDL_GPUGraphicsPipeline *pipeline = m_graphicsPipelines[INSTANCED_QUAD_PIPELINE].pipeline;
+        if (currentPipelineBinded != pipeline)
+        {
+            SDL_BindGPUGraphicsPipeline(m_renderPass, pipeline);
+
+            currentPipelineBinded = pipeline;
+        }
+
+        std::array<SDL_GPUBufferBinding, 2> vertBufferBindings = {
+            SDL_GPUBufferBinding{ m_quadVertexBuffer, 0 },
+            SDL_GPUBufferBinding{ m_instanceBuffer, static_cast<uint32_t>(sizeof(QuadInstance) * p_batch.first) }
+        };
+        SDL_BindGPUVertexBuffers(m_renderPass, 0, vertBufferBindings.data(), 2);
+
+        SDL_GPUBufferBinding idxBufferBinding{ m_quadIndexBuffer, 0 };
+        SDL_BindGPUIndexBuffer(m_renderPass, &idxBufferBinding, SDL_GPU_INDEXELEMENTSIZE_16BIT);
+
+        SDL_GPUTextureSamplerBinding texSamplerBinding{ texture->data, m_rtSampler };
+        SDL_BindGPUFragmentSamplers(m_renderPass, 0, &texSamplerBinding, 1);
+
+        const float horizontalFrames = static_cast<float>(SDL_max(p_batch.horizontalFrames, 1));
+
+        InstancedQuadUniform instancedUni{ m_viewMat, m_projMat, vec2(texture->size.x / horizontalFrames, texture->size.y), horizontalFrames };
+        SDL_PushGPUVertexUniformData(m_commandBuffer, 0, &instancedUni, sizeof(InstancedQuadUniform));
+
+        // The vertex shader already picked the frame
+        TimeColorUniform timeColUni = { 0.0f, 1, 0, vec4(1.0f) };
+        SDL_PushGPUFragmentUniformData(m_commandBuffer, 0, &timeColUni, sizeof(TimeColorUniform));
+
+        SDL_DrawGPUIndexedPrimitives(m_renderPass, 6, p_batch.count, 0, 0, 0);
+    }
+
     void Renderer::DrawSprite(shmup::cDrawable *p_drawable)
     {
         auto spriteDrawable = static_cast<shmup::cSprite *>(p_drawable);
 
-        Texture *texture = Engine::Get().assetManager.GetTexture(spriteDrawable->textureTag.c_str());
+        Texture *texture = Engine::Get().assetManager.GetTexture(spriteDrawable->textureTag);
 
-        if (currentPipelineBinded != m_graphicsPipelines[utils::HashStr32("texture_quad")].pipeline)
+        if (currentPipelineBinded != m_graphicsPipelines[TEXTURE_QUAD_PIPELINE].pipeline)
         {
-            SDL_BindGPUGraphicsPipeline(m_renderPass, m_graphicsPipelines[utils::HashStr32("texture_quad")].pipeline);
+            SDL_BindGPUGraphicsPipeline(m_renderPass, m_graphicsPipelines[TEXTURE_QUAD_PIPELINE].pipeline);
 
-            currentPipelineBinded = m_graphicsPipelines[utils::HashStr32("texture_quad")].pipeline;
+            currentPipelineBinded = m_graphicsPipelines[TEXTURE_QUAD_PIPELINE].pipeline;
         }
 
         SDL_GPUBufferBinding vertBufferBinding{ m_quadVertexBuffer, 0 };
@@ -272,13 +416,13 @@ namespace lum
     {
         auto animSpriteDrawable = static_cast<shmup::cAnimSprite *>(p_drawable);
 
-        Texture *texture = Engine::Get().assetManager.GetTexture(animSpriteDrawable->textureTag.c_str());
+        Texture *texture = Engine::Get().assetManager.GetTexture(animSpriteDrawable->textureTag);
 
-        if (currentPipelineBinded != m_graphicsPipelines[utils::HashStr32("texture_quad")].pipeline)
+        if (currentPipelineBinded != m_graphicsPipelines[TEXTURE_QUAD_PIPELINE].pipeline)
         {
-            SDL_BindGPUGraphicsPipeline(m_renderPass, m_graphicsPipelines[utils::HashStr32("texture_quad")].pipeline);
+            SDL_BindGPUGraphicsPipeline(m_renderPass, m_graphicsPipelines[TEXTURE_QUAD_PIPELINE].pipeline);
 
-            currentPipelineBinded = m_graphicsPipelines[utils::HashStr32("texture_quad")].pipeline;
+            currentPipelineBinded = m_graphicsPipelines[TEXTURE_QUAD_PIPELINE].pipeline;
         }
 
         SDL_GPUBufferBinding vertBufferBinding{ m_quadVertexBuffer, 0 };
@@ -328,11 +472,51 @@ namespace lum
 
         SDL_SetGPUSwapchainParameters(gpuDevice, m_window, SDL_GPU_SWAPCHAINCOMPOSITION_SDR, SDL_GPU_PRESENTMODE_VSYNC);
 
+        m_swapchainTextureFormat = SDL_GetGPUSwapchainTextureFormat(gpuDevice, m_window);
+
         return true;
     }
 
-    bool Renderer::CreateGraphicsPipeline(const char *p_tag, const char *p_vertTag, const char *p_fragTag, bool p_reload)
+    bool Renderer::CreateGraphicsPipeline(const char *p_tag, const char *p_vertTag, const char *p_fragTag, VertexLayout p_layout, bool p_reload)
     {
+        auto &assetManager = Engine::Get().assetManager;
+
+        ProfileScope scope(ProfilePhase::PIPELINE_CREATE, p_tag);
+
+        const StringId tag = StringTable::Intern(p_tag);
+        const StringId vertTag = StringTable::Intern(p_vertTag);
+        const StringId fragTag = StringTable::Intern(p_fragTag);
+        if (!tag || !vertTag || !fragTag)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_VIDEO, "Renderer: Can't register graphics pipeline with tag: %s", p_tag);
+            return false;
+        }
+
+        SDL_GPUGraphicsPipeline *pipeline = BuildGraphicsPipeline(assetManager.GetShader(vertTag)->data, assetManager.GetShader(fragTag)->data, p_layout);
+        if (!pipeline)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_VIDEO, "Failed to create a graphics pipeline SDL_CreateGPUGraphicsPipeline: %s", SDL_GetError());
+            return false;
+        }
+
+        if (!p_reload)
+        {
+            m_graphicsPipelines.emplace(tag, GraphicPipelineInfo{ tag, pipeline, vertTag, fragTag, p_layout });
+        }
+        else
+        {
+            SDL_LogInfo(SDL_LOG_CATEGORY_VIDEO, "Renderer: Graphics pipeline with tag '%s' is being reloaded", p_tag);
+            m_graphicsPipelines[tag] = GraphicPipelineInfo{ tag, pipeline, vertTag, fragTag, p_layout };
+        }
+
+        return true;
+    }
+
+    SDL_GPUGraphicsPipeline *Renderer::BuildGraphicsPipeline(SDL_GPUShader *p_vertShader, SDL_GPUShader *p_fragShader, VertexLayout p_layout) const
+    {
+        // Only touches immutable renderer state, so the shader compiler can call
+        // this from its worker thread while the old pipeline keeps rendering
+
         // Blend state for color target
 
         SDL_GPUColorTargetBlendState blendState{};
@@ -344,14 +528,10 @@ namespace lum
         blendState.dst_color_blendfactor = SDL_GPU_BLENDFACTOR_ONE_MINUS_SRC_ALPHA;
         blendState.dst_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ONE_MINUS_SRC_ALPHA;
 
-        // Screen texture format
-
-        SDL_GPUTextureFormat screenTextureFormat = SDL_GetGPUSwapchainTextureFormat(gpuDevice, m_window);
-
         // Build color target description struct
 
         SDL_GPUColorTargetDescription colorTargetDesc{};
-        colorTargetDesc.format = screenTextureFormat;
+        colorTargetDesc.format = m_swapchainTextureFormat;
         colorTargetDesc.blend_state = blendState;
 
         std::array<SDL_GPUColorTargetDescription, 1> colorTargetDescs = { colorTargetDesc };
@@ -364,15 +544,28 @@ namespace lum
         vertBufferDesc.input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX;
         vertBufferDesc.instance_step_rate = 0;
 
-        std::array<SDL_GPUVertexBufferDescription, 1> vertBufferDescs = { vertBufferDesc };
+        // Instanced quads read a second buffer that steps once per instance
+
+        SDL_GPUVertexBufferDescription instanceBufferDesc{};
+        instanceBufferDesc.slot = 1;
+        instanceBufferDesc.pitch = sizeof(QuadInstance);
+        instanceBufferDesc.input_rate = SDL_GPU_VERTEXINPUTRATE_INSTANCE;
+        instanceBufferDesc.instance_step_rate = 0;
+
+        std::array<SDL_GPUVertexBufferDescription, 2> vertBufferDescs = { vertBufferDesc, instanceBufferDesc };
 
         // Vertex attributes
 
-        std::array<SDL_GPUVertexAttribute, 2> vertAttributes = {
+        std::array<SDL_GPUVertexAttribute, 5> vertAttributes = {
             SDL_GPUVertexAttribute{0, 0, SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3, 0},
-            SDL_GPUVertexAttribute{1, 0, SDL_GPU_VERTEXELEMENTFORMAT_FLOAT2, sizeof(vec3)}
+            SDL_GPUVertexAttribute{1, 0, SDL_GPU_VERTEXELEMENTFORMAT_FLOAT2, sizeof(vec3)},
+            SDL_GPUVertexAttribute{2, 1, SDL_GPU_VERTEXELEMENTFORMAT_FLOAT2, offsetof(QuadInstance, position)},
+            SDL_GPUVertexAttribute{3, 1, SDL_GPU_VERTEXELEMENTFORMAT_FLOAT2, offsetof(QuadInstance, heading)},
+            SDL_GPUVertexAttribute{4, 1, SDL_GPU_VERTEXELEMENTFORMAT_FLOAT, offsetof(QuadInstance, frame)}
         };
 
+        const bool instanced = p_layout == VertexLayout::QUAD_INSTANCED;
+
         // Pipeline target info
 
         SDL_GPUGraphicsPipelineTargetInfo pipelineTI{};
@@ -382,9 +575,9 @@ namespace lum
         // Vertex input state
 
         SDL_GPUVertexInputState vertIS{};
-        vertIS.num_vertex_buffers = 1;
+        vertIS.num_vertex_buffers = instanced ? 2 : 1;
         vertIS.vertex_buffer_descriptions = vertBufferDescs.data();
-        vertIS.num_vertex_attributes = 2;
+        vertIS.num_vertex_attributes = instanced ? 5 : 2;
         vertIS.vertex_attributes = vertAttributes.data();
 
         // GPU rasterizer state
@@ -396,11 +589,9 @@ namespace lum
 
         // Pipeline create info
 
-        auto &assetManager = Engine::Get().assetManager;
-
         SDL_GPUGraphicsPipelineCreateInfo pipelineCI{};
-        pipelineCI.vertex_shader = assetManager.GetShader(p_vertTag)->data;
-        pipelineCI.fragment_shader = assetManager.GetShader(p_fragTag)->data;
+        pipelineCI.vertex_shader = p_vertShader;
+        pipelineCI.fragment_shader = p_fragShader;
         pipelineCI.vertex_input_state = vertIS;
         pipelineCI.primitive_type = SDL_GPU_PRIMITIVETYPE_TRIANGLELIST;
         pipelineCI.rasterizer_state = gpuRS;
@@ -408,24 +599,7 @@ namespace lum
         // pipelineCI.depth_stencil_state
         pipelineCI.target_info = pipelineTI;
 
-        SDL_GPUGraphicsPipeline *pipeline = SDL_CreateGPUGraphicsPipeline(gpuDevice, &pipelineCI);
-        if (!pipeline)
-        {
-            SDL_LogError(SDL_LOG_CATEGORY_VIDEO, "Failed to create a graphics pipeline SDL_CreateGPUGraphicsPipeline: %s", SDL_GetError());
-            return false;
-        }
-
-        if (!p_reload)
-        {
-            m_graphicsPipelines.emplace(utils::HashStr32(p_tag), GraphicPipelineInfo{ p_tag, pipeline, p_vertTag, p_fragTag });
-        }
-        else
-        {
-            SDL_LogInfo(SDL_LOG_CATEGORY_VIDEO, "Renderer: Graphics pipeline with tag '%s' is being reloaded", p_tag);
-            m_graphicsPipelines[utils::HashStr32(p_tag)] = GraphicPipelineInfo{ p_tag, pipeline, p_vertTag, p_fragTag };
-        }
-
-        return true;
+        return SDL_CreateGPUGraphicsPipeline(gpuDevice, &pipelineCI);
     }
 
     SDL_GPUBuffer *Renderer::CreateGPUBuffer(SDL_GPUBufferUsageFlags p_usage, uint32_t p_size, const char *p_debugName) const
@@ -626,6 +800,29 @@ namespace lum
         return true;
     }
 
+    bool Renderer::SetupInstanceBuffers()
+    {
+        // Sized for a full frame of instances up front, Draw writes into the
+        // mapped transfer buffer and RenderFrame copies whatever got used
+
+        m_instanceBuffer = CreateGPUBuffer(SDL_GPU_BUFFERUSAGE_VERTEX, sizeof(QuadInstance) * MAX_QUAD_INSTANCES, "quad_instance_buffer");
+        if (!m_instanceBuffer)
+            return false;
+
+        SDL_GPUTransferBufferCreateInfo transferCI{};
+        transferCI.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD;
+        transferCI.size = sizeof(QuadInstance) * MAX_QUAD_INSTANCES;
+
+        m_instanceTransferBuffer = SDL_CreateGPUTransferBuffer(gpuDevice, &transferCI);
+        if (!m_instanceTransferBuffer)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_GPU, "Failed to create instance transfer buffer: %s", SDL_GetError());
+            return false;
+        }
+
+        return true;
+    }
+
     bool Renderer::SetupRenderTargetSampler()
     {
         // Sampler with nearest neighbour filtering and without repeating
@@ -0,0 +1,333 @@
+#include "rollback.hpp"
+
+namespace lum
+{
+    // Packet layout, little endian: first tick, input count, the sender's
+    // confirmed end, its latest checksum and the tick it's of, then one input
+    // per tick from the first
+    static constexpr size_t INPUT_PACKET_HEADER = sizeof(uint64_t) + sizeof(uint8_t) + sizeof(uint64_t) * 3;
+
+    RollbackSession::RollbackSession() = default;
+
+    RollbackSession::~RollbackSession() = default;
+
+    void RollbackSession::Start(Transport &p_transport, uint32_t p_localPlayer, uint64_t p_startTick, uint32_t p_inputDelay, const RollbackCallbacks &p_callbacks)
+    {
+        m_running = true;
+        m_transport = &p_transport;
+        m_callbacks = p_callbacks;
+        m_localPlayer = SDL_min(p_localPlayer, MAX_PLAYERS - 1);
+        m_inputDelay = SDL_min(p_inputDelay, MAX_INPUT_DELAY);
+
+        m_startTick = p_startTick;
+        m_tick = p_startTick;
+        m_confirmedEnd = p_startTick;
+        m_peerAckEnd = p_startTick;
+        m_rollbackTo = NO_ROLLBACK;
+        m_checkTick = p_startTick;
+        m_sentChecksumTick = NO_CHECKSUM;
+        m_inputs.fill(TickInput{});
+        m_checksums.fill(TickChecksum{});
+
+        // Nobody pressed anything during the first delayed ticks
+
+        for (uint64_t tick = p_startTick; tick < p_startTick + m_inputDelay; tick++)
+            GetInput(tick).local = 0;
+
+        m_localEnd = p_startTick + m_inputDelay;
+
+        m_packet.reserve(INPUT_PACKET_HEADER + MAX_INPUTS_PER_PACKET * sizeof(InputBits));
+
+        m_stats = RollbackStats{};
+        m_stats.tick = m_tick;
+        m_stats.inputDelay = m_inputDelay;
+
+        SDL_Log("Rollback: Started as player %u at tick %llu, %u ticks of input delay", m_localPlayer,
+            static_cast<unsigned long long>(p_startTick), m_inputDelay);
+    }
+
+    void RollbackSession::Stop()
+    {
+        m_running = false;
+        m_transport = nullptr;
+    }
+
+    bool RollbackSession::IsRunning() const
+    {
+        return m_running;
+    }
+
+    bool RollbackSession::AdvanceTick(InputBits p_localInput)
+    {
+        if (!m_running)
+            return false;
+
+        Poll();
+
+        // A guess was wrong, go back to it and run everything since again
+
+        if (m_rollbackTo < m_tick)
+        {
+            const uint64_t start = SDL_GetTicksNS();
+            const uint32_t depth = static_cast<uint32_t>(m_tick - m_rollbackTo);
+
+            if (!m_callbacks.load(m_rollbackTo))
+            {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Rollback: No snapshot of tick %llu, stopping the session",
+                    static_cast<unsigned long long>(m_rollbackTo));
+                Stop();
+                return false;
+            }
+
+            for (uint64_t tick = m_rollbackTo; tick < m_tick; tick++)
+            {
+                if (tick != m_rollbackTo)
+                    m_callbacks.save();
+
+                Simulate(tick);
+            }
+
+            m_stats.rollbacks++;
+            m_stats.rollbackDepth = SDL_max(m_stats.rollbackDepth, depth);
+            m_stats.maxRollbackDepth = SDL_max(m_stats.maxRollbackDepth, depth);
+            m_stats.resimMS += static_cast<float>(SDL_GetTicksNS() - start) / SDL_NS_PER_MS;
+        }
+
+        m_rollbackTo = NO_ROLLBACK;
+
+        HashConfirmedTicks();
+
+        // Too far ahead to guess any further, wait for the remote
+
+        if (m_tick >= m_confirmedEnd + MAX_PREDICTION)
+        {
+            m_stats.stalls++;
+            SendInputs();
+            return false;
+        }
+
+        GetInput(m_tick + m_inputDelay).local = p_localInput;
+        m_localEnd = m_tick + m_inputDelay + 1;
+
+        m_callbacks.save();
+        Simulate(m_tick);
+        m_tick++;
+
+        SendInputs();
+
+        m_stats.tick = m_tick;
+        m_stats.predicted = static_cast<uint32_t>(m_tick - SDL_min(m_tick, m_confirmedEnd));
+
+        return true;
+    }
+
+    void RollbackSession::BeginFrame()
+    {
+        m_stats.rollbacks = 0;
+        m_stats.rollbackDepth = 0;
+        m_stats.resimMS = 0.0f;
+    }
+
+    RollbackStats RollbackSession::GetStats() const
+    {
+        RollbackStats stats = m_stats;
+        if (m_transport)
+            stats.transport = m_transport->GetStats();
+
+        return stats;
+    }
+
+    RollbackSession::TickInput &RollbackSession::GetInput(uint64_t p_tick)
+    {
+        // Slots get reused once the window has moved past their tick
+
+        TickInput &input = m_inputs[p_tick % INPUT_WINDOW];
+        if (input.tick != p_tick)
+        {
+            input = TickInput{};
+            input.tick = p_tick;
+        }
+
+        return input;
+    }
+
+    InputBits RollbackSession::PredictRemote()
+    {
+        return m_confirmedEnd > m_startTick ? GetInput(m_confirmedEnd - 1).remote : 0;
+    }
+
+    void RollbackSession::Simulate(uint64_t p_tick)
+    {
+        TickInput &input = GetInput(p_tick);
+
+        input.usedRemote = input.received ? input.remote : PredictRemote();
+        input.simulated = true;
+
+        InputBits inputs[MAX_PLAYERS]{};
+        inputs[m_localPlayer] = input.local;
+        inputs[1 - m_localPlayer] = input.usedRemote;
+
+        const uint64_t start = SDL_GetTicksNS();
+
+        m_callbacks.advance(inputs);
+
+        const float tickMS = static_cast<float>(SDL_GetTicksNS() - start) / SDL_NS_PER_MS;
+        m_stats.tickMS = m_stats.tickMS == 0.0f ? tickMS : m_stats.tickMS * 0.95f + tickMS * 0.05f;
+    }
+
+    void RollbackSession::Poll()
+    {
+        while (m_running && m_transport->Receive(m_received))
+        {
+            if (m_received.size() < INPUT_PACKET_HEADER)
+                continue;
+
+            uint64_t first{}, ackEnd{}, checksumTick{}, checksum{};
+            uint8_t count{};
+
+            const uint8_t *header = m_received.data();
+            SDL_memcpy(&first, header, sizeof(first));
+            SDL_memcpy(&count, header + sizeof(first), sizeof(count));
+            SDL_memcpy(&ackEnd, header + sizeof(first) + sizeof(count), sizeof(ackEnd));
+            SDL_memcpy(&checksumTick, header + sizeof(first) + sizeof(count) + sizeof(ackEnd), sizeof(checksumTick));
+            SDL_memcpy(&checksum, header + sizeof(first) + sizeof(count) + sizeof(ackEnd) + sizeof(checksumTick), sizeof(checksum));
+
+            first = SDL_Swap64LE(first);
+            ackEnd = SDL_Swap64LE(ackEnd);
+            checksumTick = SDL_Swap64LE(checksumTick);
+            checksum = SDL_Swap64LE(checksum);
+
+            if (m_received.size() < INPUT_PACKET_HEADER + count * sizeof(InputBits))
+                continue;
+
+            m_peerAckEnd = SDL_max(m_peerAckEnd, SDL_min(ackEnd, m_localEnd));
+
+            // Sent again with every packet until a newer one replaces it
+
+            TickChecksum *remote = checksumTick != NO_CHECKSUM ? GetChecksum(checksumTick) : nullptr;
+            if (remote && !remote->hasRemote)
+            {
+                remote->remote = checksum;
+                remote->hasRemote = true;
+                CompareChecksums(*remote);
+            }
+
+            for (uint32_t i = 0; i < count; i++)
+            {
+                const uint64_t tick = first + i;
+
+                // Already confirmed, or so far ahead it would land on a slot still in use
+                if (tick < m_confirmedEnd || tick >= m_confirmedEnd + INPUT_WINDOW / 2)
+                    continue;
+
+                InputBits bits{};
+                SDL_memcpy(&bits, m_received.data() + INPUT_PACKET_HEADER + i * sizeof(InputBits), sizeof(bits));
+                bits = SDL_Swap32LE(bits);
+
+                TickInput &input = GetInput(tick);
+                if (input.received)
+                    continue;
+
+                input.remote = bits;
+                input.received = true;
+
+                if (input.simulated && input.usedRemote != bits)
+                    m_rollbackTo = SDL_min(m_rollbackTo, tick);
+            }
+
+            while (GetInput(m_confirmedEnd).received)
+                m_confirmedEnd++;
+        }
+    }
+
+    void RollbackSession::SendInputs()
+    {
+        const uint64_t first = m_peerAckEnd;
+        const uint8_t count = static_cast<uint8_t>(SDL_min(m_localEnd - first, static_cast<uint64_t>(MAX_INPUTS_PER_PACKET)));
+
+        const TickChecksum *sent = m_sentChecksumTick != NO_CHECKSUM ? GetChecksum(m_sentChecksumTick) : nullptr;
+
+        const uint64_t firstLE = SDL_Swap64LE(first);
+        const uint64_t ackEndLE = SDL_Swap64LE(m_confirmedEnd);
+        const uint64_t checksumTickLE = SDL_Swap64LE(sent ? m_sentChecksumTick : NO_CHECKSUM);
+        const uint64_t checksumLE = SDL_Swap64LE(sent ? sent->local : 0);
+
+        m_packet.resize(INPUT_PACKET_HEADER + count * sizeof(InputBits));
+
+        uint8_t *header = m_packet.data();
+        SDL_memcpy(header, &firstLE, sizeof(firstLE));
+        SDL_memcpy(header + sizeof(firstLE), &count, sizeof(count));
+        SDL_memcpy(header + sizeof(firstLE) + sizeof(count), &ackEndLE, sizeof(ackEndLE));
+        SDL_memcpy(header + sizeof(firstLE) + sizeof(count) + sizeof(ackEndLE), &checksumTickLE, sizeof(checksumTickLE));
+        SDL_memcpy(header + sizeof(firstLE) + sizeof(count) + sizeof(ackEndLE) + sizeof(checksumTickLE), &checksumLE, sizeof(checksumLE));
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const InputBits bits = SDL_Swap32LE(GetInput(first + i).local);
+            SDL_memcpy(m_packet.data() + INPUT_PACKET_HEADER + i * sizeof(InputBits), &bits, sizeof(bits));
+        }
+
+        m_transport->Send(m_packet.data(), m_packet.size());
+    }
+
+    RollbackSession::TickChecksum *RollbackSession::GetChecksum(uint64_t p_tick)
+    {
+        TickChecksum &checksum = m_checksums[(p_tick / CHECKSUM_INTERVAL) % CHECKSUM_HISTORY];
+        if (checksum.tick > p_tick)
+            return nullptr;
+
+        if (checksum.tick != p_tick)
+        {
+            checksum = TickChecksum{};
+            checksum.tick = p_tick;
+        }
+
+        return &checksum;
+    }
+
+    void RollbackSession::HashConfirmedTicks()
+    {
+        // Final once every input before it is confirmed and any rollback it
+        // needed has run, nothing can change the snapshot taken at it after that
+
+        while (m_callbacks.checksum && m_checkTick < m_tick && m_checkTick <= m_confirmedEnd)
+        {
+            uint64_t value{};
+            TickChecksum *checksum = GetChecksum(m_checkTick);
+
+            if (checksum && m_callbacks.checksum(m_checkTick, value))
+            {
+                checksum->local = value;
+                checksum->hasLocal = true;
+                m_sentChecksumTick = m_checkTick;
+
+                CompareChecksums(*checksum);
+            }
+
+            m_checkTick += CHECKSUM_INTERVAL;
+        }
+    }
+
+    void RollbackSession::CompareChecksums(TickChecksum &p_checksum)
+    {
+        if (!p_checksum.hasLocal || !p_checksum.hasRemote || p_checksum.compared)
+            return;
+
+        p_checksum.compared = true;
+
+        if (p_checksum.local == p_checksum.remote)
+        {
+            m_stats.checkedTick = SDL_max(m_stats.checkedTick, p_checksum.tick);
+            return;
+        }
+
+        // Once apart the worlds rarely come back together, only the first one is logged
+
+        if (m_stats.desyncs++ > 0)
+            return;
+
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Rollback: Desync at tick %llu, hashed %016llx here and %016llx on the remote",
+            static_cast<unsigned long long>(p_checksum.tick), static_cast<unsigned long long>(p_checksum.local),
+            static_cast<unsigned long long>(p_checksum.remote));
+    }
+}
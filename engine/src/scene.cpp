@@ -7,15 +7,74 @@ namespace lum
     Scene::Scene() :
         assetMgr(Engine::Get().assetManager),
         renderer(Engine::Get().renderer),
-        audioMgr(Engine::Get().audioManager)
+        audioMgr(Engine::Get().audioManager),
+        systems(ecs, Engine::Get().jobSystem),
+        assets(Engine::Get().assetManager)
     {
+        collision.SetBounds(vec2(0.0f), renderer.windowDesc.resolution);
+        projectiles.SetBounds(vec2(0.0f), renderer.windowDesc.resolution);
     };
 
     Scene::~Scene() = default;
 
+    void Scene::DeclareAssets(AssetManifest &) {}
+
+    void Scene::SaveState(SnapshotWriter &p_writer) const
+    {
+        ecs.SaveState(p_writer);
+        projectiles.SaveState(p_writer);
+        transforms.SaveState(p_writer);
+    }
+
+    bool Scene::LoadState(SnapshotReader &p_reader)
+    {
+        return ecs.LoadState(p_reader) && projectiles.LoadState(p_reader) && transforms.LoadState(p_reader);
+    }
+
     void Scene::BindCommand(SDL_Scancode p_key, const char *p_command)
     {
         commandMap[p_key] = p_command;
+
+        for (const char *command : commandBits)
+        {
+            if (SDL_strcmp(command, p_command) == 0)
+                return;
+        }
+
+        if (commandBits.size() >= MAX_INPUT_COMMANDS)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Scene: Can't bind more than %u commands, %s won't reach player input", MAX_INPUT_COMMANDS, p_command);
+            return;
+        }
+
+        commandBits.push_back(p_command);
+    }
+
+    InputBits Scene::GetLocalInput() const
+    {
+        InputBits bits = 0;
+
+        for (size_t i = 0; i < commandBits.size(); i++)
+        {
+            if (activeCommands.count(commandBits[i]))
+                bits |= 1u << i;
+        }
+
+        return bits;
+    }
+
+    bool Scene::IsCommandActive(uint32_t p_player, const char *p_command) const
+    {
+        if (p_player >= MAX_PLAYERS)
+            return false;
+
+        for (size_t i = 0; i < commandBits.size(); i++)
+        {
+            if (SDL_strcmp(commandBits[i], p_command) == 0)
+                return (playerInput[p_player] >> i) & 1u;
+        }
+
+        return false;
     }
 
     void Scene::DoCommand(Command &p_command)
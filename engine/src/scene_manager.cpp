@@ -1,5 +1,7 @@
 #include "scene_manager.hpp"
 
+#include "engine.hpp"
+
 namespace lum
 {
     SceneManager::SceneManager() = default;
@@ -13,6 +15,13 @@ namespace lum
 
     void SceneManager::Shutdown()
     {
+        currentScene.reset();
+
+        for (auto &[_, scene] : sceneRegister)
+        {
+            scene->assets.ReleaseAll();
+            scene->assetsPreloaded = false;
+        }
     }
 
     bool SceneManager::ChangeSceneTo(const std::string &p_tag)
@@ -24,22 +33,136 @@ namespace lum
             return false;
         }
 
+        // Make sure everything the next scene declared is resident before switching.
+        // Does nothing if PreloadScene was already called ahead of the change.
+
+        if (!it->second->assetsPreloaded && !PreloadScene(p_tag))
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_ERROR, "SceneMgr: Failed to preload assets for scene: %s", p_tag.c_str());
+            return false;
+        }
+
+        std::shared_ptr<Scene> previousScene = currentScene;
+
         currentScene.reset();
         currentScene = it->second;
 
         // Setup scene if its being loaded for the first time or if it was unloaded previously
         if (!currentScene->loaded)
         {
+            ProfileScope scope(ProfilePhase::SCENE_SETUP, p_tag.c_str());
+
             currentScene->Setup();
             currentScene->loaded = true;
             SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "SceneMgr: Scene had setup method called: %s", p_tag.c_str());
         }
 
+        // Drop the previous scene's references. Assets shared with the new scene
+        // are still held by it, the rest fall back to the evictable cache.
+
+        if (previousScene && previousScene != currentScene)
+        {
+            size_t released = 0;
+            for (const auto &entry : previousScene->manifest.entries)
+            {
+                if (!currentScene->assets.Holds(entry.type, SID(entry.tag)))
+                    released++;
+            }
+
+            previousScene->assets.ReleaseAll();
+            previousScene->assetsPreloaded = false;
+
+            SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "SceneMgr: Released %zu assets not used by: %s", released, p_tag.c_str());
+        }
+
         SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "SceneMgr: Current scene changed to: %s", p_tag.c_str());
 
         return true;
     }
 
+    bool SceneManager::PreloadScene(const std::string &p_tag)
+    {
+        auto it = sceneRegister.find(p_tag);
+        if (it == sceneRegister.end())
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_ERROR, "SceneMgr: Failed to find scene: %s", p_tag.c_str());
+            return false;
+        }
+
+        auto &scene = it->second;
+        if (scene->assetsPreloaded)
+            return true;
+
+        const std::string scopeName = "preload " + p_tag;
+        ProfileScope scope(ProfilePhase::SCENE_SETUP, scopeName.c_str());
+
+        scene->manifest.entries.clear();
+        scene->DeclareAssets(scene->manifest);
+
+        // Diff against what's resident, only the missing assets hit the disk
+
+        auto &assetManager = Engine::Get().assetManager;
+
+        size_t shared = 0;
+        size_t loaded = 0;
+        bool success = true;
+
+        for (const auto &entry : scene->manifest.entries)
+        {
+            if (assetManager.IsResident(entry.type, SID(entry.tag)))
+                shared++;
+            else
+                loaded++;
+
+            if (!scene->assets.Load(entry))
+            {
+                SDL_LogError(SDL_LOG_CATEGORY_ERROR, "SceneMgr: Failed to load asset '%s' for scene: %s", entry.tag, p_tag.c_str());
+                success = false;
+            }
+        }
+
+        // A half loaded scene keeps nothing pinned, the next change tries it again
+
+        if (!success)
+        {
+            scene->assets.ReleaseAll();
+            return false;
+        }
+
+        scene->assetsPreloaded = true;
+
+        SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "SceneMgr: Preloaded scene %s (%zu shared, %zu loaded)", p_tag.c_str(), shared, loaded);
+
+        return true;
+    }
+
+    bool SceneManager::UnloadScene(const std::string &p_tag)
+    {
+        auto it = sceneRegister.find(p_tag);
+        if (it == sceneRegister.end())
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_ERROR, "SceneMgr: Failed to find scene: %s", p_tag.c_str());
+            return false;
+        }
+
+        if (it->second == currentScene)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_ERROR, "SceneMgr: Can't unload the current scene: %s", p_tag.c_str());
+            return false;
+        }
+
+        // Assets only referenced by this scene become evictable, they stay cached
+        // until the memory budget needs the space
+
+        it->second->assets.ReleaseAll();
+        it->second->assetsPreloaded = false;
+        it->second->loaded = false;
+
+        SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "SceneMgr: Scene unloaded: %s", p_tag.c_str());
+
+        return true;
+    }
+
     bool SceneManager::RegisterScene(const std::string &p_tag, std::shared_ptr<Scene> p_scene, bool p_setCurrent)
     {
         sceneRegister.emplace(p_tag, std::move(p_scene));
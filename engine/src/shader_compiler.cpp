@@ -0,0 +1,273 @@
+#include "shader_compiler.hpp"
+
+#include <SDL3_shadercross/SDL_shadercross.h>
+
+#include "engine.hpp"
+
+namespace lum
+{
+    ShaderCompiler::ShaderCompiler() = default;
+
+    ShaderCompiler::~ShaderCompiler() = default;
+
+    bool ShaderCompiler::Init(const std::string &p_assetsDirectoryPath)
+    {
+        m_assetsDirectoryPath = p_assetsDirectoryPath;
+
+        m_mutex = SDL_CreateMutex();
+        m_condition = SDL_CreateCondition();
+        if (!m_mutex || !m_condition)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "ShaderCompiler: Failed to create sync primitives: %s", SDL_GetError());
+            return false;
+        }
+
+        m_thread = SDL_CreateThread(WorkerMain, "shader_compiler", this);
+        if (!m_thread)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "ShaderCompiler: Failed to create worker thread: %s", SDL_GetError());
+            return false;
+        }
+
+        return true;
+    }
+
+    void ShaderCompiler::Shutdown()
+    {
+        if (m_thread)
+        {
+            SDL_LockMutex(m_mutex);
+            m_quit = true;
+            m_jobs.clear();
+            SDL_SignalCondition(m_condition);
+            SDL_UnlockMutex(m_mutex);
+
+            SDL_WaitThread(m_thread, nullptr);
+            m_thread = nullptr;
+        }
+
+        // Results that never got applied still own GPU objects
+
+        auto &gpuDevice = Engine::Get().renderer.gpuDevice;
+
+        for (auto &result : m_results)
+        {
+            for (auto &rebuild : result.job.pipelines)
+            {
+                if (rebuild.pipeline)
+                    SDL_ReleaseGPUGraphicsPipeline(gpuDevice, rebuild.pipeline);
+            }
+
+            if (result.shader)
+                SDL_ReleaseGPUShader(gpuDevice, result.shader);
+        }
+
+        m_results.clear();
+        m_latestShaders.clear();
+
+        SDL_DestroyCondition(m_condition);
+        SDL_DestroyMutex(m_mutex);
+        m_condition = nullptr;
+        m_mutex = nullptr;
+    }
+
+    void ShaderCompiler::Submit(ShaderCompileJob p_job)
+    {
+        SDL_LockMutex(m_mutex);
+        m_jobs.push_back(std::move(p_job));
+        m_inFlight++;
+        SDL_SignalCondition(m_condition);
+        SDL_UnlockMutex(m_mutex);
+    }
+
+    bool ShaderCompiler::PollResult(ShaderCompileResult &p_outResult)
+    {
+        SDL_LockMutex(m_mutex);
+
+        bool hasResult = !m_results.empty();
+        if (hasResult)
+        {
+            p_outResult = std::move(m_results.front());
+            m_results.pop_front();
+        }
+
+        SDL_UnlockMutex(m_mutex);
+
+        return hasResult;
+    }
+
+    bool ShaderCompiler::IsBusy()
+    {
+        SDL_LockMutex(m_mutex);
+        bool busy = m_inFlight > 0;
+        SDL_UnlockMutex(m_mutex);
+
+        return busy;
+    }
+
+    ShaderType ShaderCompiler::GetShaderTypeFromPath(const char *p_path)
+    {
+        return SDL_strstr(p_path, ".vert") ? ShaderType::VERTEX : ShaderType::FRAGMENT;
+    }
+
+    SDL_GPUShader *ShaderCompiler::CreateShaderFromSPIRV(const char *p_tag, ShaderType p_type, const void *p_code, size_t p_size)
+    {
+        SDL_ShaderCross_SPIRV_Info shaderInfo{};
+        shaderInfo.name = p_tag;
+        shaderInfo.entrypoint = "main";
+        shaderInfo.enable_debug = true;
+        shaderInfo.bytecode = static_cast<const uint8_t *>(p_code);
+        shaderInfo.bytecode_size = p_size;
+        shaderInfo.shader_stage = (p_type == ShaderType::VERTEX) ? SDL_SHADERCROSS_SHADERSTAGE_VERTEX : SDL_SHADERCROSS_SHADERSTAGE_FRAGMENT;
+
+        SDL_ShaderCross_GraphicsShaderMetadata shaderMeta{};
+        return SDL_ShaderCross_CompileGraphicsShaderFromSPIRV(Engine::Get().renderer.gpuDevice, &shaderInfo, &shaderMeta);
+    }
+
+    bool ShaderCompiler::RunGlslc(const std::string &p_assetsDirectoryPath, const char *p_path, std::string &p_outLog)
+    {
+        std::string shaderStage = "-fshader-stage=";
+        shaderStage += (GetShaderTypeFromPath(p_path) == ShaderType::VERTEX) ? "vert" : "frag";
+
+        std::string fullPath = p_assetsDirectoryPath + p_path;
+        std::string inputPath = fullPath + ".glsl";
+        std::string outputPath = fullPath + ".spv";
+
+        // IMPORTANT: Assuming we have glslc installed (VulkanSDK) and in the PATH
+
+        const char *args[] = { "glslc", shaderStage.c_str(), inputPath.c_str(), "-o", outputPath.c_str(), NULL };
+
+        // Capture stdout and stderr together so compile errors can be shown in the editor
+
+        SDL_PropertiesID props = SDL_CreateProperties();
+        SDL_SetPointerProperty(props, SDL_PROP_PROCESS_CREATE_ARGS_POINTER, args);
+        SDL_SetNumberProperty(props, SDL_PROP_PROCESS_CREATE_STDOUT_NUMBER, SDL_PROCESS_STDIO_APP);
+        SDL_SetBooleanProperty(props, SDL_PROP_PROCESS_CREATE_STDERR_TO_STDOUT_BOOLEAN, true);
+
+        SDL_Process *shaderCompProc = SDL_CreateProcessWithProperties(props);
+        SDL_DestroyProperties(props);
+
+        if (!shaderCompProc)
+        {
+            p_outLog = "Couldn't launch glslc process for compiling shader";
+            return false;
+        }
+
+        int exitCode = -1;
+        size_t outputSize = 0;
+        char *output = static_cast<char *>(SDL_ReadProcess(shaderCompProc, &outputSize, &exitCode));
+        if (output)
+        {
+            p_outLog.assign(output, outputSize);
+            SDL_free(output);
+        }
+
+        SDL_DestroyProcess(shaderCompProc);
+
+        return exitCode == 0;
+    }
+
+    int ShaderCompiler::WorkerMain(void *p_data)
+    {
+        auto *self = static_cast<ShaderCompiler *>(p_data);
+
+        SDL_SetCurrentThreadPriority(SDL_THREAD_PRIORITY_LOW);
+
+        while (true)
+        {
+            SDL_LockMutex(self->m_mutex);
+
+            while (self->m_jobs.empty() && !self->m_quit)
+                SDL_WaitCondition(self->m_condition, self->m_mutex);
+
+            if (self->m_quit)
+            {
+                SDL_UnlockMutex(self->m_mutex);
+                break;
+            }
+
+            ShaderCompileJob job = std::move(self->m_jobs.front());
+            self->m_jobs.pop_front();
+
+            SDL_UnlockMutex(self->m_mutex);
+
+            self->ProcessJob(job);
+        }
+
+        return 0;
+    }
+
+    void ShaderCompiler::ProcessJob(ShaderCompileJob &p_job)
+    {
+        ShaderCompileResult result{};
+
+        // GLSL -> SPIR-V
+
+        result.success = RunGlslc(m_assetsDirectoryPath, p_job.path.c_str(), result.log);
+
+        // SPIR-V -> backend shader
+
+        if (result.success)
+        {
+            std::string spvFullPath = m_assetsDirectoryPath + p_job.path + ".spv";
+
+            size_t shaderSize;
+            void *shaderCode = SDL_LoadFile(spvFullPath.c_str(), &shaderSize);
+            if (shaderCode)
+            {
+                result.shader = CreateShaderFromSPIRV(p_job.name.c_str(), p_job.type, shaderCode, shaderSize);
+                SDL_free(shaderCode);
+            }
+
+            if (!result.shader)
+            {
+                result.success = false;
+                result.log += SDL_GetError();
+            }
+        }
+
+        // Rebuild the pipelines that use this shader against the newest stages
+
+        if (result.success)
+        {
+            m_latestShaders[p_job.tag] = result.shader;
+
+            auto &renderer = Engine::Get().renderer;
+
+            for (auto &rebuild : p_job.pipelines)
+            {
+                auto vertIt = m_latestShaders.find(rebuild.vertTag);
+                auto fragIt = m_latestShaders.find(rebuild.fragTag);
+
+                if (vertIt != m_latestShaders.end())
+                    rebuild.vertShader = vertIt->second;
+                if (fragIt != m_latestShaders.end())
+                    rebuild.fragShader = fragIt->second;
+
+                rebuild.pipeline = renderer.BuildGraphicsPipeline(rebuild.vertShader, rebuild.fragShader, rebuild.layout);
+                if (!rebuild.pipeline)
+                {
+                    result.log += "Failed to rebuild a graphics pipeline using '";
+                    result.log += p_job.name;
+                    result.log += "': ";
+                    result.log += SDL_GetError();
+                    result.log += "\n";
+                }
+            }
+        }
+
+        result.job = std::move(p_job);
+
+        SDL_LockMutex(m_mutex);
+        m_results.push_back(std::move(result));
+        m_inFlight--;
+
+        // Only jobs queued together share shaders, once idle the main thread
+        // stops holding them and they can be evicted
+
+        if (m_inFlight == 0)
+            m_latestShaders.clear();
+
+        SDL_UnlockMutex(m_mutex);
+    }
+}
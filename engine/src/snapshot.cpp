@@ -0,0 +1,313 @@
+#include "snapshot.hpp"
+
+namespace lum
+{
+    static void WriteDeltaVarint(std::vector<uint8_t> &p_out, uint64_t p_value)
+    {
+        while (p_value >= 0x80)
+        {
+            p_out.push_back(static_cast<uint8_t>(p_value) | 0x80);
+            p_value >>= 7;
+        }
+
+        p_out.push_back(static_cast<uint8_t>(p_value));
+    }
+
+    static bool ReadDeltaVarint(const uint8_t *&p_cursor, const uint8_t *p_end, uint64_t &p_outValue)
+    {
+        p_outValue = 0;
+
+        for (uint32_t shift = 0; shift < 64 && p_cursor < p_end; shift += 7)
+        {
+            const uint8_t byte = *p_cursor++;
+            p_outValue |= static_cast<uint64_t>(byte & 0x7F) << shift;
+
+            if (!(byte & 0x80))
+                return true;
+        }
+
+        return false;
+    }
+
+    // Where p_target first differs from p_base at or after p_from, whole words at a time
+    static size_t FindDifference(const uint8_t *p_target, const uint8_t *p_base, size_t p_from, size_t p_size)
+    {
+        size_t i = p_from;
+
+        for (; i + sizeof(uint64_t) <= p_size; i += sizeof(uint64_t))
+        {
+            uint64_t a{}, b{};
+            std::memcpy(&a, p_target + i, sizeof(a));
+            std::memcpy(&b, p_base + i, sizeof(b));
+
+            if (a != b)
+                break;
+        }
+
+        while (i < p_size && p_target[i] == p_base[i])
+            i++;
+
+        return i;
+    }
+
+    // Where the next MIN_SKIP equal bytes start at or after p_from, stepping a
+    // word at a time. Equal runs that don't line up with the steps get copied
+    // along with the literal, which costs a few bytes and keeps this fast.
+    static size_t FindEqualRun(const uint8_t *p_target, const uint8_t *p_base, size_t p_from, size_t p_size)
+    {
+        static_assert(SnapshotRing::MIN_SKIP == sizeof(uint64_t), "Equal runs are found a word at a time");
+
+        for (size_t i = p_from; i + sizeof(uint64_t) <= p_size; i += sizeof(uint64_t))
+        {
+            uint64_t a{}, b{};
+            std::memcpy(&a, p_target + i, sizeof(a));
+            std::memcpy(&b, p_base + i, sizeof(b));
+
+            if (a == b)
+                return i;
+        }
+
+        return p_size;
+    }
+
+    // p_target as the ranges that differ from p_base: its size, then pairs of
+    // bytes to skip and bytes to copy. Anything past the end of p_base differs.
+    static void EncodeDelta(const std::vector<uint8_t> &p_target, const std::vector<uint8_t> &p_base, std::vector<uint8_t> &p_out)
+    {
+        const size_t size = p_target.size();
+        const size_t shared = SDL_min(size, p_base.size());
+
+        p_out.clear();
+        WriteDeltaVarint(p_out, size);
+
+        size_t written = 0;
+        size_t i = FindDifference(p_target.data(), p_base.data(), 0, shared);
+
+        while (i < size)
+        {
+            // The literal runs until enough equal bytes in a row or the end
+
+            size_t end = i < shared ? FindEqualRun(p_target.data(), p_base.data(), i, shared) : size;
+            if (end >= shared)
+                end = size;
+
+            WriteDeltaVarint(p_out, i - written);
+            WriteDeltaVarint(p_out, end - i);
+            p_out.insert(p_out.end(), p_target.begin() + i, p_target.begin() + end);
+
+            written = end;
+            i = end < shared ? FindDifference(p_target.data(), p_base.data(), end, shared) : end;
+        }
+    }
+
+    // Turns p_buffer, holding the base, into the target in place
+    static bool ApplyDelta(const std::vector<uint8_t> &p_delta, std::vector<uint8_t> &p_buffer)
+    {
+        const uint8_t *cursor = p_delta.data();
+        const uint8_t *end = cursor + p_delta.size();
+
+        uint64_t size{};
+        if (!ReadDeltaVarint(cursor, end, size))
+            return false;
+
+        p_buffer.resize(size);
+
+        uint64_t position = 0;
+        while (cursor < end)
+        {
+            uint64_t skip{}, length{};
+            if (!ReadDeltaVarint(cursor, end, skip) || !ReadDeltaVarint(cursor, end, length))
+                return false;
+
+            position += skip;
+            if (position + length > size || static_cast<uint64_t>(end - cursor) < length)
+                return false;
+
+            std::memcpy(p_buffer.data() + position, cursor, length);
+            cursor += length;
+            position += length;
+        }
+
+        return true;
+    }
+
+    SnapshotRing::SnapshotRing(uint32_t p_capacity, size_t p_reserve)
+    {
+        m_entries.resize(SDL_max(p_capacity, 1u));
+        m_full.reserve(p_reserve);
+        m_scratch.reserve(p_reserve);
+        m_restore.reserve(p_reserve);
+
+        m_stats.capacity = static_cast<uint32_t>(m_entries.size());
+    }
+
+    SnapshotRing::~SnapshotRing() = default;
+
+    SnapshotWriter SnapshotRing::BeginSave()
+    {
+        m_scratch.clear();
+        return SnapshotWriter(m_scratch);
+    }
+
+    void SnapshotRing::Commit(uint64_t p_tick)
+    {
+        const uint32_t capacity = static_cast<uint32_t>(m_entries.size());
+
+        // The newest becomes a delta against the one replacing it
+
+        if (m_count > 0)
+        {
+            Entry &previous = m_entries[m_newest];
+            EncodeDelta(m_full, m_scratch, previous.delta);
+            m_stats.deltaBytes += previous.delta.size();
+        }
+
+        m_newest = m_count > 0 ? (m_newest + 1) % capacity : 0;
+
+        // A full ring drops the oldest, nothing depends on it
+
+        if (m_count == capacity)
+            m_stats.deltaBytes -= m_entries[m_newest].delta.size();
+        else
+            m_count++;
+
+        m_entries[m_newest].tick = p_tick;
+        m_entries[m_newest].delta.clear();
+
+        m_full.swap(m_scratch);
+
+        m_stats.count = m_count;
+        m_stats.fullBytes = m_full.size();
+    }
+
+    bool SnapshotRing::Get(uint32_t p_age, SnapshotReader &p_outReader)
+    {
+        if (p_age == 0 && m_count > 0)
+        {
+            p_outReader = SnapshotReader(m_full.data(), m_full.size());
+            return true;
+        }
+
+        if (!Reconstruct(p_age, m_restore))
+            return false;
+
+        p_outReader = SnapshotReader(m_restore.data(), m_restore.size());
+        return true;
+    }
+
+    bool SnapshotRing::Rewind(uint32_t p_age, SnapshotReader &p_outReader)
+    {
+        if (p_age > 0)
+        {
+            if (!Reconstruct(p_age, m_restore))
+                return false;
+
+            m_full.swap(m_restore);
+
+            for (uint32_t age = 0; age < p_age; age++)
+            {
+                Entry &dropped = m_entries[SlotOf(age)];
+                if (age > 0)
+                    m_stats.deltaBytes -= dropped.delta.size();
+
+                dropped.delta.clear();
+            }
+
+            // The new newest was a delta, it's whole now
+
+            Entry &newest = m_entries[SlotOf(p_age)];
+            m_stats.deltaBytes -= newest.delta.size();
+            newest.delta.clear();
+
+            const uint32_t capacity = static_cast<uint32_t>(m_entries.size());
+            m_newest = (m_newest + capacity - p_age) % capacity;
+            m_count -= p_age;
+
+            m_stats.count = m_count;
+            m_stats.fullBytes = m_full.size();
+        }
+
+        return Get(0, p_outReader);
+    }
+
+    bool SnapshotRing::FindAge(uint64_t p_tick, uint32_t &p_outAge) const
+    {
+        for (uint32_t age = 0; age < m_count; age++)
+        {
+            if (m_entries[SlotOf(age)].tick == p_tick)
+            {
+                p_outAge = age;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    uint64_t SnapshotRing::GetTick(uint32_t p_age) const
+    {
+        return p_age < m_count ? m_entries[SlotOf(p_age)].tick : 0;
+    }
+
+    uint32_t SnapshotRing::GetCount() const
+    {
+        return m_count;
+    }
+
+    void SnapshotRing::Clear()
+    {
+        for (Entry &entry : m_entries)
+            entry.delta.clear();
+
+        m_full.clear();
+        m_count = 0;
+        m_newest = 0;
+
+        m_stats.count = 0;
+        m_stats.fullBytes = 0;
+        m_stats.deltaBytes = 0;
+    }
+
+    void SnapshotRing::SetSaveTime(float p_ms)
+    {
+        m_stats.saveMS = p_ms;
+    }
+
+    void SnapshotRing::SetRestoreTime(float p_ms)
+    {
+        m_stats.restoreMS = p_ms;
+    }
+
+    SnapshotStats SnapshotRing::GetStats() const
+    {
+        return m_stats;
+    }
+
+    uint32_t SnapshotRing::SlotOf(uint32_t p_age) const
+    {
+        const uint32_t capacity = static_cast<uint32_t>(m_entries.size());
+        return (m_newest + capacity - p_age) % capacity;
+    }
+
+    bool SnapshotRing::Reconstruct(uint32_t p_age, std::vector<uint8_t> &p_out) const
+    {
+        if (p_age >= m_count)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Snapshots: Asked for %u back, only %u kept", p_age, m_count);
+            return false;
+        }
+
+        p_out.assign(m_full.begin(), m_full.end());
+
+        for (uint32_t age = 1; age <= p_age; age++)
+        {
+            if (!ApplyDelta(m_entries[SlotOf(age)].delta, p_out))
+            {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Snapshots: Delta %u back is corrupt", age);
+                return false;
+            }
+        }
+
+        return true;
+    }
+}
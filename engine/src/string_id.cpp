@@ -0,0 +1,92 @@
+#include "string_id.hpp"
+
+namespace lum
+{
+    std::unordered_map<uint32_t, StringTable::Entry> StringTable::s_entries{};
+    SDL_SpinLock StringTable::s_lock{};
+
+    StringId StringTable::Intern(const char *p_str)
+    {
+        const StringId id = SID(p_str);
+        const uint64_t hash64 = utils::HashStr64(p_str);
+
+        if (!id)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "StringTable: '%s' hashes to the reserved null id", p_str);
+            return StringId{};
+        }
+
+        SDL_LockSpinlock(&s_lock);
+
+        auto it = s_entries.find(id.value);
+        if (it == s_entries.end())
+        {
+            Entry entry{};
+            entry.hash64 = hash64;
+#ifndef NDEBUG
+            entry.str = p_str;
+#endif
+            s_entries.emplace(id.value, std::move(entry));
+
+            SDL_UnlockSpinlock(&s_lock);
+            return id;
+        }
+
+        const bool collision = it->second.hash64 != hash64;
+
+#ifndef NDEBUG
+        std::string existing = it->second.str;
+#endif
+
+        SDL_UnlockSpinlock(&s_lock);
+
+        if (collision)
+        {
+#ifndef NDEBUG
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "StringTable: Hash collision between '%s' and '%s' (0x%08X)", p_str, existing.c_str(), id.value);
+#else
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "StringTable: Hash collision for '%s' (0x%08X)", p_str, id.value);
+#endif
+            return StringId{};
+        }
+
+        return id;
+    }
+
+    bool StringTable::IsInterned(StringId p_id)
+    {
+        SDL_LockSpinlock(&s_lock);
+        bool interned = s_entries.find(p_id.value) != s_entries.end();
+        SDL_UnlockSpinlock(&s_lock);
+
+        return interned;
+    }
+
+    const char *StringTable::GetString(StringId p_id)
+    {
+#ifndef NDEBUG
+        // Entries are never removed and map nodes don't move, so the pointer
+        // stays valid after unlocking
+
+        SDL_LockSpinlock(&s_lock);
+        auto it = s_entries.find(p_id.value);
+        const char *str = (it != s_entries.end()) ? it->second.str.c_str() : nullptr;
+        SDL_UnlockSpinlock(&s_lock);
+
+        if (str)
+            return str;
+#endif
+
+        // A few buffers taken in turn, so several ids can go in one log call
+
+        thread_local char hexBuffers[HEX_BUFFERS][16];
+        thread_local uint32_t nextBuffer = 0;
+
+        char *hexBuffer = hexBuffers[nextBuffer];
+        nextBuffer = (nextBuffer + 1) % HEX_BUFFERS;
+
+        SDL_snprintf(hexBuffer, sizeof(hexBuffers[0]), "#%08X", p_id.value);
+
+        return hexBuffer;
+    }
+}
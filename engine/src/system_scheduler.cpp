@@ -0,0 +1,132 @@
+#include "system_scheduler.hpp"
+
+namespace lum
+{
+    SystemScheduler::SystemScheduler(ECS &p_ecs, JobSystem &p_jobs) : m_ecs(p_ecs), m_jobs(p_jobs) {}
+
+    SystemScheduler::~SystemScheduler() = default;
+
+    void SystemScheduler::AddSystem(const char *p_name, const Signature &p_reads, const Signature &p_writes, SystemFunc p_func)
+    {
+        m_systems.push_back(System{ p_name, p_reads, p_writes, false, std::move(p_func), JobTiming{ p_name } });
+        BuildWaves();
+    }
+
+    void SystemScheduler::AddExclusiveSystem(const char *p_name, SystemFunc p_func)
+    {
+        m_systems.push_back(System{ p_name, {}, {}, true, std::move(p_func), JobTiming{ p_name } });
+        BuildWaves();
+    }
+
+    void SystemScheduler::Run(float p_delta)
+    {
+        RunContext context{ this, p_delta };
+
+        for (size_t wave = 0; wave + 1 < m_waveStarts.size(); wave++)
+        {
+            const uint32_t begin = m_waveStarts[wave];
+            const uint32_t end = m_waveStarts[wave + 1];
+
+            // A lone system runs right here, no point going through a queue
+
+            if (end - begin == 1)
+            {
+                RunSystem(m_systems[m_order[begin]], p_delta);
+                continue;
+            }
+
+            JobCounter counter{};
+
+            for (uint32_t i = begin; i < end; i++)
+            {
+                Job job{};
+                job.func = [](void *p_data, uint32_t p_system, uint32_t)
+                {
+                    auto *context = static_cast<RunContext *>(p_data);
+                    context->scheduler->RunSystem(context->scheduler->m_systems[p_system], context->delta);
+                };
+                job.data = &context;
+                job.begin = m_order[i];
+                job.counter = &counter;
+                job.name = m_systems[m_order[i]].name;
+
+                m_jobs.Submit(job);
+            }
+
+            m_jobs.Wait(counter);
+        }
+    }
+
+    uint32_t SystemScheduler::GetWaveCount() const
+    {
+        return m_waveStarts.empty() ? 0 : static_cast<uint32_t>(m_waveStarts.size() - 1);
+    }
+
+    void SystemScheduler::GetTimings(std::vector<JobTiming> &p_outTimings) const
+    {
+        p_outTimings.clear();
+
+        for (const System &system : m_systems)
+            p_outTimings.push_back(system.timing);
+    }
+
+    void SystemScheduler::ResetTimings()
+    {
+        for (System &system : m_systems)
+            system.timing = JobTiming{ system.name };
+    }
+
+    void SystemScheduler::RunSystem(System &p_system, float p_delta)
+    {
+        const uint64_t start = SDL_GetTicksNS();
+        p_system.func(m_ecs, p_delta);
+        const float elapsedMS = static_cast<float>(SDL_GetTicksNS() - start) / SDL_NS_PER_MS;
+
+        p_system.timing.count++;
+        p_system.timing.totalMS += elapsedMS;
+        p_system.timing.maxMS = SDL_max(p_system.timing.maxMS, elapsedMS);
+    }
+
+    bool SystemScheduler::Conflicts(const System &p_a, const System &p_b)
+    {
+        if (p_a.exclusive || p_b.exclusive)
+            return true;
+
+        return (p_a.writes & (p_b.reads | p_b.writes)).any() || (p_b.writes & p_a.reads).any();
+    }
+
+    void SystemScheduler::BuildWaves()
+    {
+        std::vector<uint32_t> waveOf(m_systems.size());
+        uint32_t waveCount = 0;
+
+        for (size_t i = 0; i < m_systems.size(); i++)
+        {
+            uint32_t wave = 0;
+            for (size_t j = 0; j < i; j++)
+            {
+                if (Conflicts(m_systems[i], m_systems[j]))
+                    wave = SDL_max(wave, waveOf[j] + 1);
+            }
+
+            waveOf[i] = wave;
+            waveCount = SDL_max(waveCount, wave + 1);
+        }
+
+        m_order.clear();
+        m_waveStarts.clear();
+
+        for (uint32_t wave = 0; wave < waveCount; wave++)
+        {
+            m_waveStarts.push_back(static_cast<uint32_t>(m_order.size()));
+
+            for (size_t i = 0; i < m_systems.size(); i++)
+            {
+                if (waveOf[i] == wave)
+                    m_order.push_back(static_cast<uint32_t>(i));
+            }
+        }
+
+        m_waveStarts.push_back(static_cast<uint32_t>(m_order.size()));
+    }
+}
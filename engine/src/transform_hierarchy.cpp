@@ -0,0 +1,387 @@
+#include "transform_hierarchy.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+#include <SDL3/SDL.h>
+
+#include "snapshot.hpp"
+
+namespace lum
+{
+    static const Transform2D IDENTITY_TRANSFORM{};
+
+    static Transform2D Combine(const Transform2D &p_parent, const Transform2D &p_local)
+    {
+        const float angle = glm::radians(p_parent.rotation);
+        const float c = SDL_cosf(angle);
+        const float s = SDL_sinf(angle);
+        const glm::vec2 offset = p_local.position * p_parent.scale;
+
+        Transform2D world{};
+        world.position = p_parent.position + glm::vec2(offset.x * c - offset.y * s, offset.x * s + offset.y * c);
+        world.rotation = p_parent.rotation + p_local.rotation;
+        world.scale = p_parent.scale * p_local.scale;
+
+        return world;
+    }
+
+    Transform2D Interpolate(const Transform2D &p_from, const Transform2D &p_to, float p_alpha)
+    {
+        float turn = SDL_fmodf(p_to.rotation - p_from.rotation, 360.0f);
+        if (turn > 180.0f) turn -= 360.0f;
+        if (turn < -180.0f) turn += 360.0f;
+
+        Transform2D result{};
+        result.position = p_from.position + (p_to.position - p_from.position) * p_alpha;
+        result.rotation = p_from.rotation + turn * p_alpha;
+        result.scale = p_from.scale + (p_to.scale - p_from.scale) * p_alpha;
+
+        return result;
+    }
+
+    TransformHierarchy::TransformHierarchy() = default;
+
+    TransformHierarchy::~TransformHierarchy() = default;
+
+    TransformId TransformHierarchy::Create(TransformId p_parent, const Transform2D &p_local)
+    {
+        uint32_t parentIndex = NO_PARENT;
+        if (p_parent != INVALID_TRANSFORM)
+        {
+            if (!IsValid(p_parent))
+            {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Transforms: Can't create a node under invalid parent %u", p_parent);
+                return INVALID_TRANSFORM;
+            }
+
+            parentIndex = m_indexOf[p_parent];
+        }
+
+        TransformId id{};
+        if (!m_freeIds.empty())
+        {
+            id = m_freeIds.back();
+            m_freeIds.pop_back();
+        }
+        else
+        {
+            id = static_cast<TransformId>(m_indexOf.size());
+            m_indexOf.push_back(NO_PARENT);
+        }
+
+        // Appended after everything, so after its parent too. Starts where its
+        // parent was last update so it doesn't slide in from the origin
+
+        const uint32_t index = static_cast<uint32_t>(m_local.size());
+        const Transform2D world = parentIndex == NO_PARENT ? p_local : Combine(m_world[parentIndex], p_local);
+
+        m_local.push_back(p_local);
+        m_world.push_back(world);
+        m_previous.push_back(world);
+        m_parent.push_back(parentIndex);
+        m_dirty.push_back(0);
+        m_ids.push_back(id);
+        m_indexOf[id] = index;
+
+        MarkDirty(index);
+
+        return id;
+    }
+
+    void TransformHierarchy::Destroy(TransformId p_id)
+    {
+        if (!IsValid(p_id))
+            return;
+
+        if (m_needsSort)
+            Sort();
+
+        // Indices are about to move, settle what moved last update first
+
+        SettleMoved();
+
+        // Children come after their parents, one pass from the root of the
+        // subtree finds all of it
+
+        const uint32_t root = m_indexOf[p_id];
+        const uint32_t count = static_cast<uint32_t>(m_local.size());
+
+        std::vector<uint8_t> removed(count, 0);
+        removed[root] = 1;
+
+        for (uint32_t i = root + 1; i < count; i++)
+        {
+            if (m_parent[i] != NO_PARENT && removed[m_parent[i]])
+                removed[i] = 1;
+        }
+
+        // Stable compaction, parents stay ahead of their children
+
+        std::vector<uint32_t> newIndex(count, NO_PARENT);
+        uint32_t write = 0;
+
+        for (uint32_t read = 0; read < count; read++)
+        {
+            if (removed[read])
+            {
+                m_indexOf[m_ids[read]] = NO_PARENT;
+                m_freeIds.push_back(m_ids[read]);
+                continue;
+            }
+
+            newIndex[read] = write;
+
+            m_local[write] = m_local[read];
+            m_world[write] = m_world[read];
+            m_previous[write] = m_previous[read];
+            m_parent[write] = m_parent[read] == NO_PARENT ? NO_PARENT : newIndex[m_parent[read]];
+            m_dirty[write] = m_dirty[read];
+            m_ids[write] = m_ids[read];
+            m_indexOf[m_ids[write]] = write;
+            write++;
+        }
+
+        m_local.resize(write);
+        m_world.resize(write);
+        m_previous.resize(write);
+        m_parent.resize(write);
+        m_dirty.resize(write);
+        m_ids.resize(write);
+
+        m_firstDirty = SDL_min(m_firstDirty, root);
+    }
+
+    bool TransformHierarchy::SetParent(TransformId p_id, TransformId p_parent)
+    {
+        if (!IsValid(p_id) || (p_parent != INVALID_TRANSFORM && !IsValid(p_parent)))
+            return false;
+
+        const uint32_t index = m_indexOf[p_id];
+        uint32_t parentIndex = NO_PARENT;
+
+        if (p_parent != INVALID_TRANSFORM)
+        {
+            parentIndex = m_indexOf[p_parent];
+
+            for (uint32_t ancestor = parentIndex; ancestor != NO_PARENT; ancestor = m_parent[ancestor])
+            {
+                if (ancestor == index)
+                {
+                    SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Transforms: Parenting %u to %u would make a cycle", p_id, p_parent);
+                    return false;
+                }
+            }
+        }
+
+        m_parent[index] = parentIndex;
+
+        // A parent behind its child breaks the single pass, reorder before the next update
+        if (parentIndex != NO_PARENT && parentIndex > index)
+            m_needsSort = true;
+
+        MarkDirty(index);
+
+        return true;
+    }
+
+    TransformId TransformHierarchy::GetParent(TransformId p_id) const
+    {
+        if (!IsValid(p_id))
+            return INVALID_TRANSFORM;
+
+        const uint32_t parentIndex = m_parent[m_indexOf[p_id]];
+        return parentIndex == NO_PARENT ? INVALID_TRANSFORM : m_ids[parentIndex];
+    }
+
+    void TransformHierarchy::SetLocal(TransformId p_id, const Transform2D &p_local)
+    {
+        if (!IsValid(p_id))
+            return;
+
+        const uint32_t index = m_indexOf[p_id];
+        m_local[index] = p_local;
+        MarkDirty(index);
+    }
+
+    void TransformHierarchy::SetLocalPosition(TransformId p_id, glm::vec2 p_position)
+    {
+        if (!IsValid(p_id))
+            return;
+
+        const uint32_t index = m_indexOf[p_id];
+        m_local[index].position = p_position;
+        MarkDirty(index);
+    }
+
+    void TransformHierarchy::SetLocalRotation(TransformId p_id, float p_rotation)
+    {
+        if (!IsValid(p_id))
+            return;
+
+        const uint32_t index = m_indexOf[p_id];
+        m_local[index].rotation = p_rotation;
+        MarkDirty(index);
+    }
+
+    const Transform2D &TransformHierarchy::GetLocal(TransformId p_id) const
+    {
+        return IsValid(p_id) ? m_local[m_indexOf[p_id]] : IDENTITY_TRANSFORM;
+    }
+
+    const Transform2D &TransformHierarchy::GetWorld(TransformId p_id) const
+    {
+        return IsValid(p_id) ? m_world[m_indexOf[p_id]] : IDENTITY_TRANSFORM;
+    }
+
+    Transform2D TransformHierarchy::GetInterpolated(TransformId p_id, float p_alpha) const
+    {
+        if (!IsValid(p_id))
+            return IDENTITY_TRANSFORM;
+
+        const uint32_t index = m_indexOf[p_id];
+        return Interpolate(m_previous[index], m_world[index], p_alpha);
+    }
+
+    bool TransformHierarchy::IsValid(TransformId p_id) const
+    {
+        return p_id < m_indexOf.size() && m_indexOf[p_id] != NO_PARENT;
+    }
+
+    void TransformHierarchy::Update()
+    {
+        if (m_needsSort)
+            Sort();
+
+        const uint32_t count = static_cast<uint32_t>(m_local.size());
+
+        // Whatever moved last time is standing still unless it moves again below
+
+        SettleMoved();
+
+        // Dirty flags flow down, a node is recomputed when it or its parent is dirty
+
+        for (uint32_t i = m_firstDirty; i < count; i++)
+        {
+            const uint32_t parent = m_parent[i];
+            const bool parentDirty = parent != NO_PARENT && m_dirty[parent];
+
+            if (!m_dirty[i] && !parentDirty)
+                continue;
+
+            m_previous[i] = m_world[i];
+            m_world[i] = parent == NO_PARENT ? m_local[i] : Combine(m_world[parent], m_local[i]);
+            m_dirty[i] = 1;
+            m_moved.push_back(i);
+        }
+
+        if (m_firstDirty < count)
+            std::fill(m_dirty.begin() + m_firstDirty, m_dirty.end(), 0);
+
+        m_firstDirty = count;
+
+        m_stats.nodes = count;
+        m_stats.recomputed = static_cast<uint32_t>(m_moved.size());
+    }
+
+    void TransformHierarchy::SaveState(SnapshotWriter &p_writer) const
+    {
+        p_writer.WriteArray(m_local);
+        p_writer.WriteArray(m_world);
+        p_writer.WriteArray(m_previous);
+        p_writer.WriteArray(m_parent);
+        p_writer.WriteArray(m_dirty);
+        p_writer.WriteArray(m_ids);
+        p_writer.WriteArray(m_indexOf);
+        p_writer.WriteArray(m_freeIds);
+        p_writer.WriteArray(m_moved);
+        p_writer.WriteValue(m_firstDirty);
+        p_writer.WriteValue(m_needsSort);
+    }
+
+    bool TransformHierarchy::LoadState(SnapshotReader &p_reader)
+    {
+        bool valid = p_reader.ReadArray(m_local) && p_reader.ReadArray(m_world) && p_reader.ReadArray(m_previous);
+        valid = valid && p_reader.ReadArray(m_parent) && p_reader.ReadArray(m_dirty) && p_reader.ReadArray(m_ids);
+        valid = valid && p_reader.ReadArray(m_indexOf) && p_reader.ReadArray(m_freeIds) && p_reader.ReadArray(m_moved);
+        valid = valid && p_reader.ReadValue(m_firstDirty) && p_reader.ReadValue(m_needsSort);
+
+        if (!valid)
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Transforms: Snapshot is truncated");
+
+        return valid;
+    }
+
+    TransformStats TransformHierarchy::GetStats() const
+    {
+        return m_stats;
+    }
+
+    void TransformHierarchy::MarkDirty(uint32_t p_index)
+    {
+        m_dirty[p_index] = 1;
+        m_firstDirty = SDL_min(m_firstDirty, p_index);
+    }
+
+    void TransformHierarchy::SettleMoved()
+    {
+        for (uint32_t i : m_moved)
+            m_previous[i] = m_world[i];
+
+        m_moved.clear();
+    }
+
+    void TransformHierarchy::Sort()
+    {
+        const uint32_t count = static_cast<uint32_t>(m_local.size());
+
+        SettleMoved();
+
+        // Stable sort by depth keeps siblings in creation order
+
+        std::vector<uint32_t> depth(count, 0);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            for (uint32_t ancestor = m_parent[i]; ancestor != NO_PARENT; ancestor = m_parent[ancestor])
+                depth[i]++;
+        }
+
+        std::vector<uint32_t> order(count);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return depth[a] < depth[b]; });
+
+        std::vector<uint32_t> newIndex(count);
+        for (uint32_t i = 0; i < count; i++)
+            newIndex[order[i]] = i;
+
+        std::vector<Transform2D> local(count);
+        std::vector<Transform2D> world(count);
+        std::vector<Transform2D> previous(count);
+        std::vector<uint32_t> parent(count);
+        std::vector<uint8_t> dirty(count);
+        std::vector<TransformId> ids(count);
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const uint32_t from = order[i];
+
+            local[i] = m_local[from];
+            world[i] = m_world[from];
+            previous[i] = m_previous[from];
+            parent[i] = m_parent[from] == NO_PARENT ? NO_PARENT : newIndex[m_parent[from]];
+            dirty[i] = m_dirty[from];
+            ids[i] = m_ids[from];
+            m_indexOf[ids[i]] = i;
+        }
+
+        m_local.swap(local);
+        m_world.swap(world);
+        m_previous.swap(previous);
+        m_parent.swap(parent);
+        m_dirty.swap(dirty);
+        m_ids.swap(ids);
+
+        m_firstDirty = 0;
+        m_needsSort = false;
+    }
+}
@@ -0,0 +1,84 @@
+#include "transport.hpp"
+
+namespace lum
+{
+    LoopbackTransport::LoopbackTransport() = default;
+
+    LoopbackTransport::~LoopbackTransport() = default;
+
+    void LoopbackTransport::Connect(LoopbackTransport &p_a, LoopbackTransport &p_b)
+    {
+        p_a.m_peer = &p_b;
+        p_b.m_peer = &p_a;
+    }
+
+    void LoopbackTransport::SetConditions(const LoopbackConditions &p_conditions, uint64_t p_seed)
+    {
+        m_conditions = p_conditions;
+        m_randomState = p_seed;
+    }
+
+    void LoopbackTransport::Send(const uint8_t *p_data, size_t p_size)
+    {
+        if (!m_peer)
+            return;
+
+        m_stats.sent++;
+        m_stats.bytesSent += p_size;
+
+        if (SDL_randf_r(&m_randomState) < m_conditions.loss)
+        {
+            m_stats.dropped++;
+            return;
+        }
+
+        const float jitter = (SDL_randf_r(&m_randomState) * 2.0f - 1.0f) * m_conditions.jitterMS;
+        const float delayMS = SDL_max(m_conditions.latencyMS + jitter, 0.0f);
+
+        Packet packet{};
+        packet.deliverNS = SDL_GetTicksNS() + static_cast<uint64_t>(delayMS * SDL_NS_PER_MS);
+
+        if (!m_peer->m_spare.empty())
+        {
+            packet.data.swap(m_peer->m_spare.back());
+            m_peer->m_spare.pop_back();
+        }
+
+        packet.data.assign(p_data, p_data + p_size);
+        m_peer->m_inbox.push_back(std::move(packet));
+    }
+
+    bool LoopbackTransport::Receive(std::vector<uint8_t> &p_outPacket)
+    {
+        // Few packets are ever in flight, a scan for the earliest due one is enough
+
+        const uint64_t now = SDL_GetTicksNS();
+        size_t due = m_inbox.size();
+
+        for (size_t i = 0; i < m_inbox.size(); i++)
+        {
+            if (m_inbox[i].deliverNS <= now && (due == m_inbox.size() || m_inbox[i].deliverNS < m_inbox[due].deliverNS))
+                due = i;
+        }
+
+        if (due == m_inbox.size())
+            return false;
+
+        p_outPacket.swap(m_inbox[due].data);
+        m_spare.push_back(std::move(m_inbox[due].data));
+
+        if (due != m_inbox.size() - 1)
+            m_inbox[due] = std::move(m_inbox.back());
+
+        m_inbox.pop_back();
+
+        m_stats.received++;
+
+        return true;
+    }
+
+    TransportStats LoopbackTransport::GetStats() const
+    {
+        return m_stats;
+    }
+}
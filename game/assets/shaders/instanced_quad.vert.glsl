@@ -0,0 +1,42 @@
+#version 450 core
+
+// Input
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec2 inTexCoord;
+
+// Per instance input
+
+layout(location = 2) in vec2 inInstancePosition;
+layout(location = 3) in vec2 inInstanceHeading;
+layout(location = 4) in float inInstanceFrame;
+
+// Output
+
+layout(location = 0) out vec2 fragTexCoord;
+
+layout(set = 1, binding = 0) uniform UniformBufferObject
+{
+	mat4 view;
+	mat4 proj;
+	vec2 size;
+	float horizontalFrames;
+} ubo;
+
+void main()
+{
+	// Turn the quad so its up side follows the heading, straight up when there's none
+
+	float headingLength = length(inInstanceHeading);
+	vec2 up = headingLength > 0.0 ? inInstanceHeading / headingLength : vec2(0.0, 1.0);
+	vec2 right = vec2(up.y, -up.x);
+
+	vec2 local = inPosition.xy * ubo.size;
+	vec2 world = inInstancePosition + right * local.x + up * local.y;
+
+	gl_Position = ubo.proj * ubo.view * vec4(world, 0.0, 1.0);
+
+	// Pick the frame on the sprite atlas here, the fragment shader sees a single frame
+
+	fragTexCoord = vec2((inTexCoord.x + inInstanceFrame) / ubo.horizontalFrames, inTexCoord.y);
+}
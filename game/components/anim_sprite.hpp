@@ -9,7 +9,7 @@ namespace shmup
     {
     public:
         cTranslation translation{};
-        std::string  textureTag{};
+        lum::StringId textureTag{};
         uint8_t      horizontalFrames{ 1 };
         uint8_t      verticalFrames{ 1 };
         uint8_t      currentFrame{};
@@ -34,7 +34,33 @@ namespace shmup
 
         void Draw() override
         {
-            lum::Engine::Get().renderer.AddToDrawQueue(this);
+            lum::Engine &engine = lum::Engine::Get();
+
+            if (transform != lum::INVALID_TRANSFORM)
+                translation = ToTranslation(engine.sceneManager.currentScene->transforms.GetInterpolated(transform, engine.interpolation));
+
+            engine.renderer.AddToDrawQueue(this);
+        }
+
+        // The frame and how long it's been showing move every tick
+        void SaveState(lum::SnapshotWriter &p_writer) const override
+        {
+            cDrawable::SaveState(p_writer);
+            p_writer.WriteValue(translation);
+            p_writer.WriteValue(textureTag);
+            p_writer.WriteValue(horizontalFrames);
+            p_writer.WriteValue(verticalFrames);
+            p_writer.WriteValue(currentFrame);
+            p_writer.WriteValue(framerate);
+            p_writer.WriteValue(timer);
+            p_writer.WriteValue(loop);
+        }
+
+        bool LoadState(lum::SnapshotReader &p_reader) override
+        {
+            return cDrawable::LoadState(p_reader) && p_reader.ReadValue(translation) && p_reader.ReadValue(textureTag)
+                && p_reader.ReadValue(horizontalFrames) && p_reader.ReadValue(verticalFrames) && p_reader.ReadValue(currentFrame)
+                && p_reader.ReadValue(framerate) && p_reader.ReadValue(timer) && p_reader.ReadValue(loop);
         }
     };
 }
@@ -6,6 +6,8 @@
 #include <glm/glm.hpp>
 
 #include "component.hpp"
+#include "snapshot.hpp"
+#include "transform_hierarchy.hpp"
 
 namespace shmup
 {
@@ -25,6 +27,9 @@ namespace shmup
         uint8_t      layer{};
         vec4         modulateColor{ 1.0f };
 
+        // When set, translation follows this node of the scene's transform hierarchy
+        lum::TransformId transform{ lum::INVALID_TRANSFORM };
+
     public:
         ~cDrawable() = default;
 
@@ -34,6 +39,19 @@ namespace shmup
         };
 
         void Update(float) override {}
+
+        void SaveState(lum::SnapshotWriter &p_writer) const override
+        {
+            p_writer.WriteValue(visible);
+            p_writer.WriteValue(layer);
+            p_writer.WriteValue(modulateColor);
+            p_writer.WriteValue(transform);
+        }
+
+        bool LoadState(lum::SnapshotReader &p_reader) override
+        {
+            return p_reader.ReadValue(visible) && p_reader.ReadValue(layer) && p_reader.ReadValue(modulateColor) && p_reader.ReadValue(transform);
+        }
     };
 }
 
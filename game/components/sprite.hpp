@@ -11,7 +11,7 @@ namespace shmup
     {
     public:
         cTranslation translation{};
-        std::string  textureTag{};
+        lum::StringId textureTag{};
         uint8_t      horizontalFrames{ 1 };
         uint8_t      verticalFrames{ 1 };
         uint8_t      currentFrame{};
@@ -27,7 +27,28 @@ namespace shmup
 
         void Draw() override
         {
-            lum::Engine::Get().renderer.AddToDrawQueue(this);
+            lum::Engine &engine = lum::Engine::Get();
+
+            if (transform != lum::INVALID_TRANSFORM)
+                translation = ToTranslation(engine.sceneManager.currentScene->transforms.GetInterpolated(transform, engine.interpolation));
+
+            engine.renderer.AddToDrawQueue(this);
+        }
+
+        void SaveState(lum::SnapshotWriter &p_writer) const override
+        {
+            cDrawable::SaveState(p_writer);
+            p_writer.WriteValue(translation);
+            p_writer.WriteValue(textureTag);
+            p_writer.WriteValue(horizontalFrames);
+            p_writer.WriteValue(verticalFrames);
+            p_writer.WriteValue(currentFrame);
+        }
+
+        bool LoadState(lum::SnapshotReader &p_reader) override
+        {
+            return cDrawable::LoadState(p_reader) && p_reader.ReadValue(translation) && p_reader.ReadValue(textureTag)
+                && p_reader.ReadValue(horizontalFrames) && p_reader.ReadValue(verticalFrames) && p_reader.ReadValue(currentFrame);
         }
     };
 }
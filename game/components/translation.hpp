@@ -2,6 +2,9 @@
 #define TRANSLATION_COMP_H
 
 #include <glm/glm.hpp>
+#include <SDL3/SDL.h>
+
+#include "transform_hierarchy.hpp"
 
 using namespace glm;
 
@@ -18,6 +21,31 @@ namespace shmup
         cTranslation() = default;
         ~cTranslation() = default;
     };
+
+    // Translation at the start of the current tick, for entities drawn between ticks
+    class cPrevTranslation final : public cTranslation
+    {
+    };
+
+    inline cTranslation ToTranslation(const lum::Transform2D &p_transform)
+    {
+        return cTranslation{ p_transform.position, p_transform.rotation, p_transform.scale };
+    }
+
+    // Rotation takes the short way round
+    inline cTranslation Interpolate(const cTranslation &p_from, const cTranslation &p_to, float p_alpha)
+    {
+        float turn = SDL_fmodf(p_to.rotation - p_from.rotation, 360.0f);
+        if (turn > 180.0f) turn -= 360.0f;
+        if (turn < -180.0f) turn += 360.0f;
+
+        cTranslation result{};
+        result.position = mix(p_from.position, p_to.position, p_alpha);
+        result.rotation = p_from.rotation + turn * p_alpha;
+        result.scale = mix(p_from.scale, p_to.scale, p_alpha);
+
+        return result;
+    }
 }
 
 #endif // !TRANSLATION_COMP_H
\ No newline at end of file
@@ -0,0 +1,18 @@
+#ifndef VELOCITY_COMP_H
+#define VELOCITY_COMP_H
+
+#include <glm/glm.hpp>
+
+using namespace glm;
+
+namespace shmup
+{
+    class cVelocity
+    {
+    public:
+        vec2  direction{};
+        float speed{};
+    };
+}
+
+#endif // !VELOCITY_COMP_H
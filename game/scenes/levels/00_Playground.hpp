@@ -21,22 +21,34 @@ namespace shmup
 		PlaygroundLvl() = default;
 		~PlaygroundLvl() = default;
 
+		void DeclareAssets(AssetManifest &p_manifest) override
+		{
+			p_manifest.AddTexture("ship_body", "sprites/player/ship.png");
+			p_manifest.AddTexture("ship_engine_fire", "sprites/player/ship_engine_fire.png");
+		}
+
 		void Setup() override
 		{
 			renderer.clearColor = vec4( 0.1f, 0.1f, 0.1f, 1.0f );
 
-			assetMgr.LoadTexture("ship_body", "sprites/player/ship.png");
-			assetMgr.LoadTexture("ship_engine_fire", "sprites/player/ship_engine_fire.png");
+			// Parts hang off the ship's root, moving the ship is moving the root
+
+			Transform2D root{};
+			root.position = vec2(140.0f, 90.0f);
+			const TransformId shipRoot = transforms.Create(INVALID_TRANSFORM, root);
 
 			auto bodySpriteComp = ship.AddComponent<cSprite>("body_sprite");
-			bodySpriteComp->translation.position = vec2(140.0f, 90.0f);
-			bodySpriteComp->textureTag = "ship_body";
+			bodySpriteComp->transform = transforms.Create(shipRoot);
+			bodySpriteComp->textureTag = "ship_body"_sid;
 			bodySpriteComp->horizontalFrames = 5;
 			bodySpriteComp->currentFrame = 2;
 
+			Transform2D engineFire{};
+			engineFire.position = vec2(-40.0f, -40.0f);
+
 			auto engineFireComp = ship.AddComponent<cAnimSprite>("ship_engine_fire");
-			engineFireComp->translation.position = vec2(100.0f, 50.0f);
-			engineFireComp->textureTag = "ship_engine_fire";
+			engineFireComp->transform = transforms.Create(shipRoot, engineFire);
+			engineFireComp->textureTag = "ship_engine_fire"_sid;
 			engineFireComp->horizontalFrames = 2;
 			engineFireComp->framerate = 15;
 		}
@@ -46,6 +58,18 @@ namespace shmup
 			ship.Update(p_delta);
 		}
 
+		// The ship lives outside the ECS, its components go in after the world
+		void SaveState(SnapshotWriter &p_writer) const override
+		{
+			Scene::SaveState(p_writer);
+			ship.SaveState(p_writer);
+		}
+
+		bool LoadState(SnapshotReader &p_reader) override
+		{
+			return Scene::LoadState(p_reader) && ship.LoadState(p_reader);
+		}
+
 		void Draw() override
 		{
 			ship.Draw();
@@ -2,6 +2,9 @@
 #define TEST_GROUND_SCN_H
 
 #include "scene.hpp"
+#include "components/sprite.hpp"
+#include "components/translation.hpp"
+#include "components/velocity.hpp"
 
 using namespace glm;
 using namespace lum;
@@ -18,84 +21,166 @@ namespace shmup
 	{
 	public:
 		Entity skull{};
-		Signature drawablesSig{};
-		Signature movablesSig{};
+		Entity partner{};
+		bool hasPartner{};
+		Emitter spiral{};
+		Query *snapshots{};
+		Query *movables{};
+		Query *drawables{};
 
 	public:
 		TestGroundScn() = default;
 
+		void DeclareAssets(AssetManifest &p_manifest) override
+		{
+			p_manifest.AddTexture("skull", "sprites/skull.png");
+			p_manifest.AddMusic("wind", "sounds/music/windchill.ogg");
+		}
+
 		void Setup() override
 		{
-			SDL_srand(1337);
+			Engine::Get().SeedRandom(1337);
 
 			renderer.clearColor = vec4(0.8, 0.3, 0.4, 1.0);
 
-			assetMgr.LoadTexture("skull", "sprites/skull.png");
-			assetMgr.LoadSound("wind", "sounds/music/windchill.ogg");
-
 			BindCommand(SDL_SCANCODE_UP, "MoveUp");
 			BindCommand(SDL_SCANCODE_DOWN, "MoveDown");
 			BindCommand(SDL_SCANCODE_RIGHT, "MoveRight");
 			BindCommand(SDL_SCANCODE_LEFT, "MoveLeft");
 
 			ecs.RegisterComponent<cTranslation>();
+			ecs.RegisterComponent<cPrevTranslation>();
 			ecs.RegisterComponent<cVelocity>();
 			ecs.RegisterComponent<cSprite>();
 
 
-			auto skull = ecs.CreateEntity();
-				
-			ecs.AddComponent(skull, cTranslation{ vec2(120.0f, 50.0f), 0.0f, 1.0f});
+			skull = ecs.CreateEntity();
+
+			cSprite sprite{ "skull" };
+			sprite.textureTag = "skull"_sid;
+
+			ecs.AddComponent(skull, cTranslation{ vec2(120.0f, 50.0f), 0.0f, 1.0f });
+			ecs.AddComponent(skull, cPrevTranslation{ { vec2(120.0f, 50.0f), 0.0f, 1.0f } });
 			ecs.AddComponent(skull, cVelocity{ vec2(0.0), 150.0f });
-			ecs.AddComponent(skull, cSprite{ "skull" });
+			ecs.AddComponent(skull, std::move(sprite));
 
+			// The second player of a --loopback session gets a skull of its own
 
-			drawablesSig.set(ecs.GetComponentIndex<cTranslation>());
-			drawablesSig.set(ecs.GetComponentIndex<cSprite>());
+			hasPartner = Engine::Get().config.loopback;
+			if (hasPartner)
+			{
+				partner = ecs.CreateEntity();
 
-			movablesSig.set(ecs.GetComponentIndex<cTranslation>());
-			movablesSig.set(ecs.GetComponentIndex<cVelocity>());
-		};
+				cSprite partnerSprite{ "skull" };
+				partnerSprite.textureTag = "skull"_sid;
 
-		void Update(float p_delta) override
-		{
-			// Player movement system
+				ecs.AddComponent(partner, cTranslation{ vec2(220.0f, 50.0f), 0.0f, 1.0f });
+				ecs.AddComponent(partner, cPrevTranslation{ { vec2(220.0f, 50.0f), 0.0f, 1.0f } });
+				ecs.AddComponent(partner, cVelocity{ vec2(0.0), 150.0f });
+				ecs.AddComponent(partner, std::move(partnerSprite));
+			}
+
+			// Queries stay up to date as entities change, systems just walk them
+
+			snapshots = &ecs.RegisterQuery<cPrevTranslation, cTranslation>();
+			movables = &ecs.RegisterQuery<cTranslation, cVelocity>();
+			drawables = &ecs.RegisterQuery<cPrevTranslation, cTranslation, cSprite>();
+
+			// Keep where everything was before this tick moves it, Draw blends from there
+
+			systems.AddSystem("SnapshotTranslation", ecs.MakeSignature<cTranslation>(), ecs.MakeSignature<cPrevTranslation>(), [this](ECS &p_ecs, float)
+			{
+				p_ecs.ParallelForEach<cPrevTranslation, cTranslation>(*snapshots, Engine::Get().jobSystem, "SnapshotTranslation", [](cPrevTranslation &prev, cTranslation &tran)
+				{
+					static_cast<cTranslation &>(prev) = tran;
+				});
+			});
 
-			auto &velo = ecs.GetComponent<cVelocity>(skull)->get();
+			// Player movement system, reads input so it can't run alongside anything.
+			// Input comes from playerInput, never the keyboard, so a rollback can
+			// run the tick again with what the remote really pressed.
 
-			velo.direction = vec2(0.0);
+			systems.AddExclusiveSystem("PlayerInput", [this](ECS &p_ecs, float)
+			{
+				const auto steer = [this, &p_ecs](Entity p_entity, uint32_t p_player)
+				{
+					auto &velo = p_ecs.GetComponent<cVelocity>(p_entity)->get();
+
+					velo.direction = vec2(0.0);
+
+					if (IsCommandActive(p_player, "MoveUp")) velo.direction.y += 1.0f;
+					if (IsCommandActive(p_player, "MoveDown")) velo.direction.y -= 1.0f;
+					if (IsCommandActive(p_player, "MoveRight")) velo.direction.x += 1.0f;
+					if (IsCommandActive(p_player, "MoveLeft")) velo.direction.x -= 1.0f;
+
+					if (length(velo.direction) > 0)
+						velo.direction = normalize(velo.direction);
+				};
 
-			if (activeCommands.count("MoveUp")) velo.direction.y += 1.0f;
-			if (activeCommands.count("MoveDown")) velo.direction.y -= 1.0f;
-			if (activeCommands.count("MoveRight")) velo.direction.x += 1.0f;
-			if (activeCommands.count("MoveLeft")) velo.direction.x -= 1.0f;
+				steer(skull, 0);
 
-			if (length(velo.direction) > 0)
-				velo.direction = normalize(velo.direction);
+				if (hasPartner)
+					steer(partner, 1);
+			});
 
-			
 			// Move system
 
-			auto movableEntities = ecs.QueryEntitiesWithSignature(movablesSig);
-			for (const auto &e : movableEntities)
+			systems.AddSystem("Move", ecs.MakeSignature<cVelocity>(), ecs.MakeSignature<cTranslation>(), [this](ECS &p_ecs, float p_delta)
 			{
-				auto &tran = ecs.GetComponent<cTranslation>(e)->get();
-				auto &velo = ecs.GetComponent<cVelocity>(e)->get();
+				p_ecs.ParallelForEach<cTranslation, cVelocity>(*movables, Engine::Get().jobSystem, "Move", [p_delta](cTranslation &tran, cVelocity &velo)
+				{
+					tran.position += velo.direction * velo.speed * p_delta;
+				});
+			});
+
+			// Bullet pattern
+
+			spiral.pattern.type = EmitterPatternType::SPIRAL;
+			spiral.pattern.bullets = 4;
+			spiral.pattern.spin = 7.0f;
+			spiral.pattern.interval = 0.05f;
+			spiral.pattern.speed = 60.0f;
+			spiral.pattern.turnRate = 10.0f;
+			spiral.pattern.lifetime = 8.0f;
+			spiral.position = vec2(120.0f, 240.0f);
+
+			// Four bullets every 0.05 s for 8 s, the pool never has to grow mid play
+
+			projectiles.Reserve(640);
+		};
 
-				tran.position += velo.direction * velo.speed * p_delta;
-			}
+		void Update(float p_delta) override
+		{
+			systems.Run(p_delta);
+
+			projectiles.UpdateEmitter(spiral, p_delta);
+			projectiles.Update(p_delta);
 		};
 
+		void SaveState(SnapshotWriter &p_writer) const override
+		{
+			Scene::SaveState(p_writer);
+			p_writer.WriteValue(skull);
+			p_writer.WriteValue(partner);
+			p_writer.WriteValue(spiral);
+		}
+
+		bool LoadState(SnapshotReader &p_reader) override
+		{
+			return Scene::LoadState(p_reader) && p_reader.ReadValue(skull) && p_reader.ReadValue(partner) && p_reader.ReadValue(spiral);
+		}
+
 		void Draw() override
 		{
-			auto drawableEntities = ecs.QueryEntitiesWithSignature(drawablesSig);
-			for (const auto &e : drawableEntities)
+			const float alpha = Engine::Get().interpolation;
+
+			ecs.ForEach<cPrevTranslation, cTranslation, cSprite>(*drawables, [alpha, this](cPrevTranslation &prev, cTranslation &tran, cSprite &sprt)
 			{
-				auto &tran = ecs.GetComponent<cTranslation>(e)->get();
-				auto &sprt = ecs.GetComponent<cSprite>(e)->get();
+				sprt.translation = Interpolate(prev, tran, alpha);
+				renderer.AddToDrawQueue(&sprt);
+			});
 
-				renderer.AddToDrawQueue(DrawDesc{ tran, sprt });
-			}
+			projectiles.Draw(renderer, "skull"_sid, 1, 0, alpha);
 		};
 	};
 }